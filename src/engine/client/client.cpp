@@ -80,6 +80,8 @@
 #include <thread>
 #include <tuple>
 
+#include <zlib.h>
+
 using namespace std::chrono_literals;
 
 static constexpr ColorRGBA gs_ClientNetworkPrintColor{0.7f, 1, 0.7f, 1.0f};
@@ -256,6 +258,10 @@ void CClient::SendMapRequest()
 {
 	dbg_assert(!m_MapdownloadFileTemp, "Map download already in progress");
 	m_MapdownloadFileTemp = Storage()->OpenFile(m_aMapdownloadFilenameTemp, IOFLAG_WRITE, IStorage::TYPE_SAVE);
+	// the hashes are only complete if the file is downloaded from the start
+	m_MapdownloadHashing = m_MapdownloadChunk == 0;
+	sha256_init(&m_MapdownloadSha256Ctx);
+	m_MapdownloadFileCrc = 0;
 	if(IsSixup())
 	{
 		CMsgPacker MsgP(protocol7::NETMSG_REQUEST_MAP_DATA, true, true);
@@ -1078,7 +1084,7 @@ void CClient::Render()
 	RenderGraphs();
 }
 
-const char *CClient::LoadMap(const char *pName, const char *pFilename, SHA256_DIGEST *pWantedSha256, unsigned WantedCrc)
+const char *CClient::LoadMap(const char *pName, const char *pFilename, SHA256_DIGEST *pWantedSha256, unsigned WantedCrc, const SHA256_DIGEST *pKnownSha256, unsigned KnownCrc)
 {
 	static char s_aErrorMsg[128];
 
@@ -1087,7 +1093,7 @@ const char *CClient::LoadMap(const char *pName, const char *pFilename, SHA256_DI
 	if((bool)m_LoadingCallback)
 		m_LoadingCallback(IClient::LOADING_CALLBACK_DETAIL_MAP);
 
-	if(!m_pMap->Load(pFilename))
+	if(!m_pMap->Load(pFilename, pKnownSha256, KnownCrc))
 	{
 		str_format(s_aErrorMsg, sizeof(s_aErrorMsg), "map '%s' not found", pFilename);
 		return s_aErrorMsg;
@@ -1664,7 +1670,15 @@ void CClient::ProcessServerPacket(CNetChunk *pPacket, int Conn, bool Dummy)
 				return;
 			}
 
-			io_write(m_MapdownloadFileTemp, pData, Size);
+			if(io_write(m_MapdownloadFileTemp, pData, Size) != (unsigned)Size)
+			{
+				m_MapdownloadHashing = false;
+			}
+			else if(m_MapdownloadHashing)
+			{
+				sha256_update(&m_MapdownloadSha256Ctx, pData, Size);
+				m_MapdownloadFileCrc = crc32(m_MapdownloadFileCrc, pData, Size);
+			}
 
 			m_MapdownloadAmount += Size;
 
@@ -2409,6 +2423,8 @@ void CClient::ResetMapDownload(bool ResetActive)
 		Storage()->RemoveFile(m_aMapdownloadFilenameTemp, IStorage::TYPE_SAVE);
 	}
 
+	m_MapdownloadHashing = false;
+
 	if(ResetActive)
 	{
 		m_MapdownloadChunk = 0;
@@ -2440,7 +2456,24 @@ void CClient::FinishMapDownload()
 		return;
 	}
 
-	const char *pError = LoadMap(m_aMapdownloadName, m_aMapdownloadFilename, pSha256, m_MapdownloadCrc);
+	// the hashes were calculated during the download, so the map does not
+	// have to be read twice
+	SHA256_DIGEST KnownSha256 = SHA256_ZEROED;
+	unsigned KnownCrc = 0;
+	if(m_pMapdownloadTask)
+	{
+		KnownSha256 = m_pMapdownloadTask->ResultSha256();
+		KnownCrc = m_pMapdownloadTask->ResultCrc();
+	}
+	else if(m_MapdownloadHashing)
+	{
+		KnownSha256 = sha256_finish(&m_MapdownloadSha256Ctx);
+		KnownCrc = m_MapdownloadFileCrc;
+		m_MapdownloadHashing = false;
+	}
+	const SHA256_DIGEST *pKnownSha256 = KnownSha256 != SHA256_ZEROED ? &KnownSha256 : nullptr;
+
+	const char *pError = LoadMap(m_aMapdownloadName, m_aMapdownloadFilename, pSha256, m_MapdownloadCrc, pKnownSha256, KnownCrc);
 	if(!pError)
 	{
 		ResetMapDownload(true);
@@ -3376,6 +3409,7 @@ void CClient::Run()
 				m_LastRenderTime = Now;
 
 				Render();
+				m_pTextRender->OnFrameEnd();
 				m_pGraphics->Swap();
 			}
 			else if(!IsRenderActive)
@@ -4199,6 +4233,7 @@ void CClient::BenchmarkQuit(int Seconds, const char *pFilename)
 void CClient::UpdateAndSwap()
 {
 	Input()->Update();
+	TextRender()->OnFrameEnd();
 	Graphics()->Swap();
 	Graphics()->Clear(0, 0, 0);
 	m_GlobalTime = (time_get() - m_GlobalStartTime) / (float)time_freq();
@@ -157,6 +157,10 @@ class CClient : public IClient, public CDemoPlayer::IListener
 	int m_MapdownloadTotalsize = -1;
 	bool m_MapdownloadSha256Present = false;
 	SHA256_DIGEST m_MapdownloadSha256 = SHA256_ZEROED;
+	// hashes of the downloaded data, calculated while receiving it
+	bool m_MapdownloadHashing = false;
+	SHA256_CTX m_MapdownloadSha256Ctx;
+	unsigned m_MapdownloadFileCrc = 0;
 
 	bool m_MapDetailsPresent = false;
 	char m_aMapDetailsName[256] = "";
@@ -368,7 +372,7 @@ public:
 	const char *DummyName() override;
 	const char *ErrorString() const override;
 
-	const char *LoadMap(const char *pName, const char *pFilename, SHA256_DIGEST *pWantedSha256, unsigned WantedCrc);
+	const char *LoadMap(const char *pName, const char *pFilename, SHA256_DIGEST *pWantedSha256, unsigned WantedCrc, const SHA256_DIGEST *pKnownSha256 = nullptr, unsigned KnownCrc = 0);
 	const char *LoadMapSearch(const char *pMapName, SHA256_DIGEST *pWantedSha256, int WantedCrc);
 
 	int TranslateSysMsg(int *pMsgId, bool System, CUnpacker *pUnpacker, CPacker *pPacker, CNetChunk *pPacket, bool *pIsExMsg);
@@ -5,7 +5,11 @@
 #include <base/system.h>
 
 #include <engine/console.h>
+#include <engine/engine.h>
+#include <engine/gfx/glyph_atlas.h>
 #include <engine/graphics.h>
+#include <engine/shared/config.h>
+#include <engine/shared/jobs.h>
 #include <engine/shared/json.h>
 #include <engine/storage.h>
 #include <engine/textrender.h>
@@ -16,9 +20,12 @@
 
 #include <chrono>
 #include <cstddef>
+#include <functional>
 #include <limits>
+#include <memory>
 #include <tuple>
 #include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 using namespace std::chrono_literals;
@@ -67,6 +74,19 @@ struct SGlyph
 	float m_AdvanceX;
 
 	float m_aUVs[4];
+
+	// value of the use stamp of the glyph map when the glyph was last requested
+	uint64_t m_LastUsed = 0;
+};
+
+struct SGlyphAtlasStats
+{
+	size_t m_TextureDimension;
+	size_t m_NumGlyphs;
+	size_t m_UsedArea;
+	size_t m_NumResizes;
+	size_t m_NumCompactions;
+	size_t m_NumEvictedGlyphs;
 };
 
 struct SGlyphKeyHash
@@ -89,201 +109,6 @@ struct SGlyphKeyEquals
 	}
 };
 
-class CAtlas
-{
-	struct SSectionKeyHash
-	{
-		size_t operator()(const std::tuple<size_t, size_t> &Key) const
-		{
-			// Width and height should never be above 2^16 so this hash should cause no collisions
-			return (std::get<0>(Key) << 16) ^ std::get<1>(Key);
-		}
-	};
-
-	struct SSectionKeyEquals
-	{
-		bool operator()(const std::tuple<size_t, size_t> &Lhs, const std::tuple<size_t, size_t> &Rhs) const
-		{
-			return std::get<0>(Lhs) == std::get<0>(Rhs) && std::get<1>(Lhs) == std::get<1>(Rhs);
-		}
-	};
-
-	struct SSection
-	{
-		size_t m_X;
-		size_t m_Y;
-		size_t m_W;
-		size_t m_H;
-
-		SSection() = default;
-
-		SSection(size_t X, size_t Y, size_t W, size_t H) :
-			m_X(X), m_Y(Y), m_W(W), m_H(H)
-		{
-		}
-	};
-
-	/**
-	 * Sections with a smaller width or height will not be created
-	 * when cutting larger sections, to prevent collecting many
-	 * small, mostly unusable sections.
-	 */
-	static constexpr size_t MIN_SECTION_DIMENSION = 6;
-
-	/**
-	 * Sections with larger width or height will be stored in m_vSections.
-	 * Sections with width and height equal or smaller will be stored in m_SectionsMap.
-	 * This achieves a good balance between the size of the vector storing all large
-	 * sections and the map storing vectors of all sections with specific small sizes.
-	 * Lowering this value will result in the size of m_vSections becoming the bottleneck.
-	 * Increasing this value will result in the map becoming the bottleneck.
-	 */
-	static constexpr size_t MAX_SECTION_DIMENSION_MAPPED = 8 * MIN_SECTION_DIMENSION;
-
-	size_t m_TextureDimension;
-	std::vector<SSection> m_vSections;
-	std::unordered_map<std::tuple<size_t, size_t>, std::vector<SSection>, SSectionKeyHash, SSectionKeyEquals> m_SectionsMap;
-
-	void AddSection(size_t X, size_t Y, size_t W, size_t H)
-	{
-		std::vector<SSection> &vSections = W <= MAX_SECTION_DIMENSION_MAPPED && H <= MAX_SECTION_DIMENSION_MAPPED ? m_SectionsMap[std::make_tuple(W, H)] : m_vSections;
-		vSections.emplace_back(X, Y, W, H);
-	}
-
-	void UseSection(const SSection &Section, size_t Width, size_t Height, int &PosX, int &PosY)
-	{
-		PosX = Section.m_X;
-		PosY = Section.m_Y;
-
-		// Create cut sections
-		const size_t CutW = Section.m_W - Width;
-		const size_t CutH = Section.m_H - Height;
-		if(CutW == 0)
-		{
-			if(CutH >= MIN_SECTION_DIMENSION)
-				AddSection(Section.m_X, Section.m_Y + Height, Section.m_W, CutH);
-		}
-		else if(CutH == 0)
-		{
-			if(CutW >= MIN_SECTION_DIMENSION)
-				AddSection(Section.m_X + Width, Section.m_Y, CutW, Section.m_H);
-		}
-		else if(CutW > CutH)
-		{
-			if(CutW >= MIN_SECTION_DIMENSION)
-				AddSection(Section.m_X + Width, Section.m_Y, CutW, Section.m_H);
-			if(CutH >= MIN_SECTION_DIMENSION)
-				AddSection(Section.m_X, Section.m_Y + Height, Width, CutH);
-		}
-		else
-		{
-			if(CutH >= MIN_SECTION_DIMENSION)
-				AddSection(Section.m_X, Section.m_Y + Height, Section.m_W, CutH);
-			if(CutW >= MIN_SECTION_DIMENSION)
-				AddSection(Section.m_X + Width, Section.m_Y, CutW, Height);
-		}
-	}
-
-public:
-	void Clear(size_t TextureDimension)
-	{
-		m_TextureDimension = TextureDimension;
-		m_vSections.clear();
-		m_vSections.emplace_back(0, 0, m_TextureDimension, m_TextureDimension);
-		m_SectionsMap.clear();
-	}
-
-	void IncreaseDimension(size_t NewTextureDimension)
-	{
-		dbg_assert(NewTextureDimension == m_TextureDimension * 2, "New atlas dimension must be twice the old one");
-		// Create 3 square sections to cover the new area, add the sections
-		// to the beginning of the vector so they are considered last.
-		m_vSections.emplace_back(m_TextureDimension, m_TextureDimension, m_TextureDimension, m_TextureDimension);
-		m_vSections.emplace_back(m_TextureDimension, 0, m_TextureDimension, m_TextureDimension);
-		m_vSections.emplace_back(0, m_TextureDimension, m_TextureDimension, m_TextureDimension);
-		std::rotate(m_vSections.rbegin(), m_vSections.rbegin() + 3, m_vSections.rend());
-		m_TextureDimension = NewTextureDimension;
-	}
-
-	bool Add(size_t Width, size_t Height, int &PosX, int &PosY)
-	{
-		if(m_vSections.empty() || m_TextureDimension < Width || m_TextureDimension < Height)
-			return false;
-
-		// Find small section more efficiently by using maps
-		if(Width <= MAX_SECTION_DIMENSION_MAPPED && Height <= MAX_SECTION_DIMENSION_MAPPED)
-		{
-			const auto UseSectionFromVector = [&](std::vector<SSection> &vSections) {
-				if(!vSections.empty())
-				{
-					const SSection Section = vSections.back();
-					vSections.pop_back();
-					UseSection(Section, Width, Height, PosX, PosY);
-					return true;
-				}
-				return false;
-			};
-
-			if(UseSectionFromVector(m_SectionsMap[std::make_tuple(Width, Height)]))
-				return true;
-
-			for(size_t CheckWidth = Width + 1; CheckWidth <= MAX_SECTION_DIMENSION_MAPPED; ++CheckWidth)
-			{
-				if(UseSectionFromVector(m_SectionsMap[std::make_tuple(CheckWidth, Height)]))
-					return true;
-			}
-
-			for(size_t CheckHeight = Height + 1; CheckHeight <= MAX_SECTION_DIMENSION_MAPPED; ++CheckHeight)
-			{
-				if(UseSectionFromVector(m_SectionsMap[std::make_tuple(Width, CheckHeight)]))
-					return true;
-			}
-
-			// We don't iterate sections in the map with increasing width and height at the same time,
-			// because it's slower and doesn't noticeable increase the atlas utilization.
-		}
-
-		// Check vector for larger section
-		size_t SmallestLossValue = std::numeric_limits<size_t>::max();
-		size_t SmallestLossIndex = m_vSections.size();
-		size_t SectionIndex = m_vSections.size();
-		do
-		{
-			--SectionIndex;
-			const SSection &Section = m_vSections[SectionIndex];
-			if(Section.m_W < Width || Section.m_H < Height)
-				continue;
-
-			const size_t LossW = Section.m_W - Width;
-			const size_t LossH = Section.m_H - Height;
-
-			size_t Loss;
-			if(LossW == 0)
-				Loss = LossH;
-			else if(LossH == 0)
-				Loss = LossW;
-			else
-				Loss = LossW * LossH;
-
-			if(Loss < SmallestLossValue)
-			{
-				SmallestLossValue = Loss;
-				SmallestLossIndex = SectionIndex;
-				if(SmallestLossValue == 0)
-					break;
-			}
-		} while(SectionIndex > 0);
-		if(SmallestLossIndex == m_vSections.size())
-			return false; // No usable section found in vector
-
-		// Use the section with the smallest loss
-		const SSection Section = m_vSections[SmallestLossIndex];
-		m_vSections.erase(m_vSections.begin() + SmallestLossIndex);
-		UseSection(Section, Width, Height, PosX, PosY);
-		return true;
-	}
-};
-
 class CGlyphMap
 {
 public:
@@ -304,6 +129,7 @@ private:
 	/**
 	 * The maximum dimension of the atlas textures.
 	 * Results in 256 MB of memory being used per texture.
+	 * The dimension is further limited by gfx_text_atlas_max_size.
 	 */
 	static constexpr int MAXIMUM_ATLAS_DIMENSION = 16 * 1024;
 
@@ -322,8 +148,61 @@ private:
 	 */
 	static constexpr int REPLACEMENT_CHARACTER = 0x25a1;
 
+	/**
+	 * Computes the outline of a glyph in a worker thread, because growing the outline
+	 * is the most expensive part of rendering glyphs with large font sizes.
+	 */
+	class CGlyphOutlineJob : public IJob
+	{
+	public:
+		int m_PosX;
+		int m_PosY;
+		size_t m_Width;
+		size_t m_Height;
+		int m_OutlineThickness;
+		std::unique_ptr<uint8_t[]> m_pFill;
+		std::unique_ptr<uint8_t[]> m_pOutline;
+
+	protected:
+		void Run() override
+		{
+			Grow(m_pFill.get(), m_pOutline.get(), m_Width, m_Height, m_OutlineThickness);
+		}
+	};
+
+	/**
+	 * Bounding rectangle of the texture data that was changed since the last upload.
+	 */
+	class CDirtyRect
+	{
+	public:
+		size_t m_X0;
+		size_t m_Y0;
+		size_t m_X1;
+		size_t m_Y1;
+
+		CDirtyRect() { Reset(); }
+
+		void Reset()
+		{
+			m_X0 = m_Y0 = std::numeric_limits<size_t>::max();
+			m_X1 = m_Y1 = 0;
+		}
+
+		bool Empty() const { return m_X1 <= m_X0 || m_Y1 <= m_Y0; }
+
+		void Add(size_t X, size_t Y, size_t Width, size_t Height)
+		{
+			m_X0 = std::min(m_X0, X);
+			m_Y0 = std::min(m_Y0, Y);
+			m_X1 = std::max(m_X1, X + Width);
+			m_Y1 = std::max(m_Y1, Y + Height);
+		}
+	};
+
 	IGraphics *m_pGraphics;
 	IGraphics *Graphics() { return m_pGraphics; }
+	IEngine *m_pEngine;
 
 	// Atlas textures and data
 	IGraphics::CTextureHandle m_aTextures[NUM_FONT_TEXTURES];
@@ -331,8 +210,19 @@ private:
 	size_t m_TextureDimension = INITIAL_ATLAS_DIMENSION;
 	// Keep the full texture data, because OpenGL doesn't provide texture copying
 	uint8_t *m_apTextureData[NUM_FONT_TEXTURES];
-	CAtlas m_TextureAtlas;
+	CGlyphAtlas m_TextureAtlas;
 	std::unordered_map<std::tuple<FT_Face, int, int>, SGlyph, SGlyphKeyHash, SGlyphKeyEquals> m_Glyphs;
+	// Texture data is uploaded in batches, at most one rectangle per texture and frame
+	CDirtyRect m_aDirtyRects[NUM_FONT_TEXTURES];
+	std::vector<std::shared_ptr<CGlyphOutlineJob>> m_vpOutlineJobs;
+	// Incremented once per frame, glyphs requested with the current stamp are never evicted
+	uint64_t m_UseStamp = 1;
+	// Last use of glyph rectangles rendered by text containers that were deleted since, by rectangle
+	std::unordered_map<uint64_t, uint64_t> m_RectsLastUsed;
+	size_t m_UsedArea = 0;
+	size_t m_NumResizes = 0;
+	size_t m_NumCompactions = 0;
+	size_t m_NumEvictedGlyphs = 0;
 
 	// Font faces
 	FT_Face m_DefaultFace = nullptr;
@@ -381,7 +271,7 @@ private:
 
 	bool IncreaseGlyphMapSize()
 	{
-		if(m_TextureDimension >= MAXIMUM_ATLAS_DIMENSION)
+		if(m_TextureDimension * 2 > (size_t)std::min(MAXIMUM_ATLAS_DIMENSION, g_Config.m_GfxTextAtlasMaxSize))
 			return false;
 
 		const size_t NewTextureDimension = m_TextureDimension * 2;
@@ -403,11 +293,152 @@ private:
 		m_TextureAtlas.IncreaseDimension(NewTextureDimension);
 
 		m_TextureDimension = NewTextureDimension;
+		++m_NumResizes;
 
+		// The full upload also contains all pending changes
 		UploadTextures();
+		for(CDirtyRect &DirtyRect : m_aDirtyRects)
+			DirtyRect.Reset();
+		return true;
+	}
+
+	/**
+	 * Repacks the atlas when it is full and cannot grow anymore. Glyphs used by text containers
+	 * or requested during the current frame are kept, the remaining glyphs are kept in order
+	 * of their last use as long as the atlas stays at most half full and the others are evicted.
+	 *
+	 * @return `true` if glyphs were evicted, `false` if nothing could be evicted.
+	 */
+	bool Compact()
+	{
+		// Multiple glyphs share the same rectangle if the replacement character was used for them
+		std::unordered_map<uint64_t, size_t> RectIndices;
+		std::vector<SGlyphRect> vRects;
+		for(const auto &[Key, Glyph] : m_Glyphs)
+		{
+			if(Glyph.m_State != SGlyph::EState::RENDERED || Glyph.m_Width <= 0.0f || Glyph.m_Height <= 0.0f)
+				continue;
+			const uint64_t RectKey = GlyphRectKey(Glyph.m_aUVs[0], Glyph.m_aUVs[1]);
+			const auto [RectIt, Inserted] = RectIndices.emplace(RectKey, vRects.size());
+			if(Inserted)
+				vRects.push_back({RectKey, (size_t)Glyph.m_aUVs[0], (size_t)Glyph.m_aUVs[1], (size_t)Glyph.m_Width, (size_t)Glyph.m_Height, Glyph.m_LastUsed, false});
+			SGlyphRect &Rect = vRects[RectIt->second];
+			Rect.m_LastUsed = std::max(Rect.m_LastUsed, Glyph.m_LastUsed);
+		}
+
+		std::unordered_set<uint64_t> ReferencedRects;
+		if(m_fnCollectReferencedGlyphs)
+			m_fnCollectReferencedGlyphs(ReferencedRects);
+		for(SGlyphRect &Rect : vRects)
+		{
+			const auto LastUsedIt = m_RectsLastUsed.find(Rect.m_Key);
+			if(LastUsedIt != m_RectsLastUsed.end())
+				Rect.m_LastUsed = std::max(Rect.m_LastUsed, LastUsedIt->second);
+			Rect.m_Keep = Rect.m_LastUsed == m_UseStamp || ReferencedRects.count(Rect.m_Key) != 0;
+		}
+
+		const size_t TextureSize = m_TextureDimension * m_TextureDimension;
+		uint8_t *apNewTextureData[NUM_FONT_TEXTURES];
+		for(auto &pNewTextureData : apNewTextureData)
+		{
+			pNewTextureData = new uint8_t[TextureSize];
+			mem_zero(pNewTextureData, TextureSize * sizeof(uint8_t));
+		}
+		SGlyphAtlasCompaction Compaction;
+		if(!CompactGlyphAtlas(vRects, m_TextureDimension, m_apTextureData, apNewTextureData, NUM_FONT_TEXTURES, Compaction))
+		{
+			for(auto &pNewTextureData : apNewTextureData)
+				delete[] pNewTextureData;
+			return false;
+		}
+
+		for(auto GlyphIt = m_Glyphs.begin(); GlyphIt != m_Glyphs.end();)
+		{
+			SGlyph &Glyph = GlyphIt->second;
+			if(Glyph.m_State == SGlyph::EState::RENDERED && Glyph.m_Width > 0.0f && Glyph.m_Height > 0.0f)
+			{
+				const uint64_t RectKey = GlyphRectKey(Glyph.m_aUVs[0], Glyph.m_aUVs[1]);
+				if(Compaction.m_EvictedRects.count(RectKey) != 0)
+				{
+					GlyphIt = m_Glyphs.erase(GlyphIt);
+					++m_NumEvictedGlyphs;
+					continue;
+				}
+				const auto LastUsedIt = m_RectsLastUsed.find(RectKey);
+				if(LastUsedIt != m_RectsLastUsed.end())
+					Glyph.m_LastUsed = std::max(Glyph.m_LastUsed, LastUsedIt->second);
+				const uint64_t NewRectKey = Compaction.m_MovedRects.at(RectKey);
+				Glyph.m_aUVs[0] = GlyphRectX(NewRectKey);
+				Glyph.m_aUVs[1] = GlyphRectY(NewRectKey);
+				Glyph.m_aUVs[2] = Glyph.m_aUVs[0] + Glyph.m_Width;
+				Glyph.m_aUVs[3] = Glyph.m_aUVs[1] + Glyph.m_Height;
+			}
+			++GlyphIt;
+		}
+
+		// Outlines that are still being computed are copied to the new positions
+		for(auto JobIt = m_vpOutlineJobs.begin(); JobIt != m_vpOutlineJobs.end();)
+		{
+			auto MovedIt = Compaction.m_MovedRects.find(GlyphRectKey((*JobIt)->m_PosX, (*JobIt)->m_PosY));
+			if(MovedIt == Compaction.m_MovedRects.end())
+			{
+				JobIt = m_vpOutlineJobs.erase(JobIt);
+				continue;
+			}
+			(*JobIt)->m_PosX = GlyphRectX(MovedIt->second);
+			(*JobIt)->m_PosY = GlyphRectY(MovedIt->second);
+			++JobIt;
+		}
+
+		for(size_t TextureIndex = 0; TextureIndex < NUM_FONT_TEXTURES; ++TextureIndex)
+		{
+			delete[] m_apTextureData[TextureIndex];
+			m_apTextureData[TextureIndex] = apNewTextureData[TextureIndex];
+		}
+		m_TextureAtlas = Compaction.m_Atlas;
+		m_UsedArea = Compaction.m_UsedArea;
+		m_RectsLastUsed.clear();
+		++m_NumCompactions;
+		log_debug("textrender", "Compacted atlas, %" PRIzu " glyphs remaining, %" PRIzu " evicted in total", m_Glyphs.size(), m_NumEvictedGlyphs);
+
+		if(m_fnMoveGlyphs)
+			m_fnMoveGlyphs(Compaction.m_MovedRects);
+
+		// The kept rectangles cover all texture data that is still used, the rest of the
+		// textures is only overwritten by new glyphs. The moved glyphs are uploaded right
+		// away because text containers already use their new rectangles.
+		CDirtyRect MovedRect;
+		for(const SGlyphRect &Rect : vRects)
+		{
+			const auto MovedIt = Compaction.m_MovedRects.find(Rect.m_Key);
+			if(MovedIt != Compaction.m_MovedRects.end())
+				MovedRect.Add(GlyphRectX(MovedIt->second), GlyphRectY(MovedIt->second), Rect.m_Width, Rect.m_Height);
+		}
+		for(CDirtyRect &DirtyRect : m_aDirtyRects)
+			DirtyRect = MovedRect;
+		UploadDirtyRects();
 		return true;
 	}
 
+	void UploadDirtyRects()
+	{
+		for(size_t TextureIndex = 0; TextureIndex < NUM_FONT_TEXTURES; ++TextureIndex)
+		{
+			CDirtyRect &DirtyRect = m_aDirtyRects[TextureIndex];
+			if(DirtyRect.Empty())
+				continue;
+			const size_t Width = DirtyRect.m_X1 - DirtyRect.m_X0;
+			const size_t Height = DirtyRect.m_Y1 - DirtyRect.m_Y0;
+			uint8_t *pData = static_cast<uint8_t *>(malloc(Width * Height));
+			for(size_t y = 0; y < Height; ++y)
+			{
+				mem_copy(&pData[y * Width], &m_apTextureData[TextureIndex][DirtyRect.m_X0 + (y + DirtyRect.m_Y0) * m_TextureDimension], Width);
+			}
+			Graphics()->UpdateTextTexture(m_aTextures[TextureIndex], DirtyRect.m_X0, DirtyRect.m_Y0, Width, Height, pData, true);
+			DirtyRect.Reset();
+		}
+	}
+
 	void UploadTextures()
 	{
 		const size_t NewTextureSize = m_TextureDimension * m_TextureDimension;
@@ -468,7 +499,7 @@ private:
 		return GlyphIndex;
 	}
 
-	void Grow(const unsigned char *pIn, unsigned char *pOut, int w, int h, int OutlineCount) const
+	static void Grow(const unsigned char *pIn, unsigned char *pOut, int w, int h, int OutlineCount)
 	{
 		for(int y = 0; y < h; y++)
 		{
@@ -505,13 +536,13 @@ private:
 		return OutlineThickness;
 	}
 
-	void UploadGlyph(int TextureIndex, int PosX, int PosY, size_t Width, size_t Height, uint8_t *pData)
+	void UploadGlyph(int TextureIndex, int PosX, int PosY, size_t Width, size_t Height, const uint8_t *pData)
 	{
 		for(size_t y = 0; y < Height; ++y)
 		{
 			mem_copy(&m_apTextureData[TextureIndex][PosX + ((y + PosY) * m_TextureDimension)], &pData[y * Width], Width);
 		}
-		Graphics()->UpdateTextTexture(m_aTextures[TextureIndex], PosX, PosY, Width, Height, pData, true);
+		m_aDirtyRects[TextureIndex].Add(PosX, PosY, Width, Height);
 	}
 
 	bool FitGlyph(size_t Width, size_t Height, int &PosX, int &PosY)
@@ -561,27 +592,42 @@ private:
 			// find space in atlas, or increase size if necessary
 			while(!FitGlyph(Width, Height, X, Y))
 			{
-				if(!IncreaseGlyphMapSize())
+				if(!IncreaseGlyphMapSize() && !Compact())
 				{
 					log_debug("textrender", "Cannot fit glyph into atlas, which is already at maximum size. Chr=%d GlyphIndex=%u", Glyph.m_Chr, Glyph.m_GlyphIndex);
 					return false;
 				}
 			}
+			m_UsedArea += (size_t)Width * Height;
 
 			// prepare glyph data
 			const size_t GlyphDataSize = (size_t)Width * Height * sizeof(uint8_t);
-			uint8_t *pGlyphDataFill = static_cast<uint8_t *>(malloc(GlyphDataSize));
-			uint8_t *pGlyphDataOutline = static_cast<uint8_t *>(malloc(GlyphDataSize));
-			mem_zero(pGlyphDataFill, GlyphDataSize);
+			std::shared_ptr<CGlyphOutlineJob> pJob = std::make_shared<CGlyphOutlineJob>();
+			pJob->m_PosX = X;
+			pJob->m_PosY = Y;
+			pJob->m_Width = Width;
+			pJob->m_Height = Height;
+			pJob->m_OutlineThickness = OutlineThickness;
+			pJob->m_pFill = std::make_unique<uint8_t[]>(GlyphDataSize);
+			pJob->m_pOutline = std::make_unique<uint8_t[]>(GlyphDataSize);
+			mem_zero(pJob->m_pFill.get(), GlyphDataSize);
 			for(unsigned py = 0; py < pBitmap->rows; ++py)
 			{
-				mem_copy(&pGlyphDataFill[(py + y) * Width + x], &pBitmap->buffer[py * pBitmap->width], pBitmap->width);
+				mem_copy(&pJob->m_pFill[(py + y) * Width + x], &pBitmap->buffer[py * pBitmap->width], pBitmap->width);
 			}
-			Grow(pGlyphDataFill, pGlyphDataOutline, Width, Height, OutlineThickness);
 
-			// upload the glyph
-			UploadGlyph(FONT_TEXTURE_FILL, X, Y, Width, Height, pGlyphDataFill);
-			UploadGlyph(FONT_TEXTURE_OUTLINE, X, Y, Width, Height, pGlyphDataOutline);
+			// The fill is available right away, the outline follows when the job is done
+			UploadGlyph(FONT_TEXTURE_FILL, X, Y, Width, Height, pJob->m_pFill.get());
+			if(m_pEngine != nullptr)
+			{
+				m_vpOutlineJobs.push_back(pJob);
+				m_pEngine->AddJob(std::move(pJob));
+			}
+			else
+			{
+				Grow(pJob->m_pFill.get(), pJob->m_pOutline.get(), Width, Height, OutlineThickness);
+				UploadGlyph(FONT_TEXTURE_OUTLINE, X, Y, Width, Height, pJob->m_pOutline.get());
+			}
 		}
 
 		// set glyph info
@@ -605,9 +651,20 @@ private:
 	}
 
 public:
-	CGlyphMap(IGraphics *pGraphics)
+	/**
+	 * Adds the rectangles of all glyphs referenced by text containers, these are not evicted.
+	 */
+	std::function<void(std::unordered_set<uint64_t> &)> m_fnCollectReferencedGlyphs;
+
+	/**
+	 * Moves the glyphs referenced by text containers to their new rectangles after compaction.
+	 */
+	std::function<void(const std::unordered_map<uint64_t, uint64_t> &)> m_fnMoveGlyphs;
+
+	CGlyphMap(IGraphics *pGraphics, IEngine *pEngine)
 	{
 		m_pGraphics = pGraphics;
+		m_pEngine = pEngine;
 		for(auto &pTextureData : m_apTextureData)
 		{
 			pTextureData = new uint8_t[m_TextureDimension * m_TextureDimension];
@@ -726,6 +783,63 @@ public:
 
 		m_TextureAtlas.Clear(m_TextureDimension);
 		m_Glyphs.clear();
+		m_RectsLastUsed.clear();
+		m_UsedArea = 0;
+		// Results of outline jobs that are still running are discarded
+		m_vpOutlineJobs.clear();
+		for(CDirtyRect &DirtyRect : m_aDirtyRects)
+			DirtyRect.Reset();
+	}
+
+	uint64_t UseStamp() const { return m_UseStamp; }
+
+	/**
+	 * Marks the rectangle of a glyph as used with the given stamp, for glyphs
+	 * that were rendered by a text container after they were requested.
+	 */
+	void MarkRectUsed(uint64_t RectKey, uint64_t UseStamp)
+	{
+		uint64_t &LastUsed = m_RectsLastUsed[RectKey];
+		LastUsed = std::max(LastUsed, UseStamp);
+	}
+
+	/**
+	 * Copies the outlines of finished jobs into the texture data, uploads all texture
+	 * data that changed during the frame and starts the next frame. Called once per frame,
+	 * glyphs that were new in this frame are therefore rendered from the next frame on.
+	 */
+	void OnFrameEnd()
+	{
+		if(!m_vpOutlineJobs.empty())
+		{
+			auto FinishedEnd = std::stable_partition(m_vpOutlineJobs.begin(), m_vpOutlineJobs.end(), [](const std::shared_ptr<CGlyphOutlineJob> &pJob) {
+				return pJob->Done();
+			});
+			for(auto JobIt = m_vpOutlineJobs.begin(); JobIt != FinishedEnd; ++JobIt)
+			{
+				const CGlyphOutlineJob &Job = **JobIt;
+				UploadGlyph(FONT_TEXTURE_OUTLINE, Job.m_PosX, Job.m_PosY, Job.m_Width, Job.m_Height, Job.m_pOutline.get());
+			}
+			m_vpOutlineJobs.erase(m_vpOutlineJobs.begin(), FinishedEnd);
+		}
+
+		UploadDirtyRects();
+		++m_UseStamp;
+	}
+
+	/**
+	 * Renders the printable ASCII characters of the default font in advance,
+	 * so the first text using them does not have to wait for them.
+	 */
+	void Prewarm(int FontSize)
+	{
+		const FT_Face SelectedFace = m_SelectedFace;
+		m_SelectedFace = nullptr;
+		for(int Chr = 0x20; Chr < 0x7f; ++Chr)
+		{
+			GetGlyph(Chr, FontSize);
+		}
+		m_SelectedFace = SelectedFace;
 	}
 
 	const SGlyph *GetGlyph(int Chr, int FontSize)
@@ -744,6 +858,7 @@ public:
 
 		// Check if glyph for this (font face, character, font size)-combination was already rendered.
 		SGlyph &Glyph = m_Glyphs[std::make_tuple(Face, Chr, FontSize)];
+		Glyph.m_LastUsed = m_UseStamp;
 		if(Glyph.m_State == SGlyph::EState::RENDERED)
 			return &Glyph;
 		else if(Glyph.m_State == SGlyph::EState::ERROR)
@@ -763,6 +878,7 @@ public:
 		if(pReplacementCharacter)
 		{
 			Glyph = *pReplacementCharacter;
+			Glyph.m_LastUsed = m_UseStamp;
 			return &Glyph;
 		}
 
@@ -851,6 +967,11 @@ public:
 		return m_TextureDimension;
 	}
 
+	SGlyphAtlasStats Stats() const
+	{
+		return {m_TextureDimension, m_Glyphs.size(), m_UsedArea, m_NumResizes, m_NumCompactions, m_NumEvictedGlyphs};
+	}
+
 	IGraphics::CTextureHandle Texture(size_t TextureIndex) const
 	{
 		return m_aTextures[TextureIndex];
@@ -915,6 +1036,10 @@ struct STextContainer
 
 	bool m_SingleTimeUse;
 
+	// Use stamps of the glyph map when the glyphs were requested and when the container was last rendered
+	uint64_t m_GlyphUseStamp;
+	uint64_t m_RenderStamp;
+
 	STextBoundingBox m_BoundingBox;
 
 	// prefix of the container's text stored for debugging purposes
@@ -940,6 +1065,8 @@ struct STextContainer
 
 		m_SingleTimeUse = false;
 
+		m_GlyphUseStamp = m_RenderStamp = 0;
+
 		m_BoundingBox = {0.0f, 0.0f, 0.0f, 0.0f};
 
 		m_aDebugText[0] = '\0';
@@ -1034,6 +1161,42 @@ class CTextRender : public IEngineTextRender
 		return *m_vpTextContainers[Index.m_Index];
 	}
 
+	void CollectReferencedGlyphs(std::unordered_set<uint64_t> &ReferencedRects) const
+	{
+		for(const STextContainer *pTextContainer : m_vpTextContainers)
+		{
+			// The top left corner of the glyph rectangle is stored in the last vertex
+			for(const STextCharQuad &TextCharQuad : pTextContainer->m_StringInfo.m_vCharacterQuads)
+				ReferencedRects.insert(GlyphRectKey(TextCharQuad.m_aVertices[3].m_U, TextCharQuad.m_aVertices[3].m_V));
+		}
+	}
+
+	void MoveGlyphs(const std::unordered_map<uint64_t, uint64_t> &MovedRects)
+	{
+		for(STextContainer *pTextContainer : m_vpTextContainers)
+		{
+			if(pTextContainer->m_StringInfo.m_vCharacterQuads.empty())
+				continue;
+			for(STextCharQuad &TextCharQuad : pTextContainer->m_StringInfo.m_vCharacterQuads)
+				MoveGlyphQuad(TextCharQuad.m_aVertices, MovedRects);
+			if(pTextContainer->m_StringInfo.m_QuadBufferObjectIndex != -1)
+			{
+				const size_t DataSize = pTextContainer->m_StringInfo.m_vCharacterQuads.size() * sizeof(STextCharQuad);
+				void *pUploadData = pTextContainer->m_StringInfo.m_vCharacterQuads.data();
+				Graphics()->RecreateBufferObject(pTextContainer->m_StringInfo.m_QuadBufferObjectIndex, DataSize, pUploadData, pTextContainer->m_SingleTimeUse ? IGraphics::EBufferObjectCreateFlags::BUFFER_OBJECT_CREATE_FLAGS_ONE_TIME_USE_BIT : 0);
+			}
+		}
+	}
+
+	static void ConTextAtlasStats(IConsole::IResult *pResult, void *pUserData)
+	{
+		const CTextRender *pThis = static_cast<CTextRender *>(pUserData);
+		const SGlyphAtlasStats Stats = pThis->m_pGlyphMap->Stats();
+		const size_t TextureArea = Stats.m_TextureDimension * Stats.m_TextureDimension;
+		log_info("textrender", "Atlas %" PRIzu "x%" PRIzu ", %" PRIzu " glyphs, %.1f%% occupied", Stats.m_TextureDimension, Stats.m_TextureDimension, Stats.m_NumGlyphs, Stats.m_UsedArea * 100.0f / TextureArea);
+		log_info("textrender", "%" PRIzu " resizes, %" PRIzu " compactions, %" PRIzu " evicted glyphs", Stats.m_NumResizes, Stats.m_NumCompactions, Stats.m_NumEvictedGlyphs);
+	}
+
 	int WordLength(const char *pText) const
 	{
 		const char *pCursor = pText;
@@ -1120,7 +1283,14 @@ public:
 		m_pGraphics = Kernel()->RequestInterface<IGraphics>();
 		m_pStorage = Kernel()->RequestInterface<IStorage>();
 		FT_Init_FreeType(&m_FTLibrary);
-		m_pGlyphMap = new CGlyphMap(m_pGraphics);
+		m_pGlyphMap = new CGlyphMap(m_pGraphics, Kernel()->RequestInterface<IEngine>());
+		m_pGlyphMap->m_fnCollectReferencedGlyphs = [this](std::unordered_set<uint64_t> &ReferencedRects) {
+			CollectReferencedGlyphs(ReferencedRects);
+		};
+		m_pGlyphMap->m_fnMoveGlyphs = [this](const std::unordered_map<uint64_t, uint64_t> &MovedRects) {
+			MoveGlyphs(MovedRects);
+		};
+		m_pConsole->Register("text_atlas_stats", "", CFGFLAG_CLIENT, ConTextAtlasStats, this, "Print glyph atlas occupancy and eviction statistics");
 
 		// print freetype version
 		{
@@ -1427,6 +1597,14 @@ public:
 		m_pGlyphMap->SetFontPreset(FontPreset);
 	}
 
+	void PrewarmGlyphs(float FontSize) override
+	{
+		float ScreenX0, ScreenY0, ScreenX1, ScreenY1;
+		Graphics()->GetScreen(&ScreenX0, &ScreenY0, &ScreenX1, &ScreenY1);
+		const float FakeToScreenY = Graphics()->ScreenHeight() / (ScreenY1 - ScreenY0);
+		m_pGlyphMap->Prewarm(round_truncate(FontSize * FakeToScreenY));
+	}
+
 	void SetFontLanguageVariant(const char *pLanguageFile) override
 	{
 		for(const auto &Variant : m_vVariants)
@@ -1609,6 +1787,7 @@ public:
 
 		STextContainer &TextContainer = GetTextContainer(TextContainerIndex);
 		TextContainer.m_SingleTimeUse = (m_RenderFlags & TEXT_RENDER_FLAG_ONE_TIME_USE) != 0;
+		TextContainer.m_GlyphUseStamp = m_pGlyphMap->UseStamp();
 		const vec2 FakeToScreen = vec2(Graphics()->ScreenWidth() / (ScreenX1 - ScreenX0), Graphics()->ScreenHeight() / (ScreenY1 - ScreenY0));
 		TextContainer.m_AlignedStartX = round_to_int(pCursor->m_X * FakeToScreen.x) / FakeToScreen.x;
 		TextContainer.m_AlignedStartY = round_to_int(pCursor->m_Y * FakeToScreen.y) / FakeToScreen.y;
@@ -2209,6 +2388,7 @@ public:
 	{
 		STextContainer &TextContainer = GetTextContainer(TextContainerIndex);
 		TextContainer.m_StringInfo.m_vCharacterQuads.clear();
+		TextContainer.m_GlyphUseStamp = m_pGlyphMap->UseStamp();
 		// the text buffer gets then recreated by the appended quads
 		AppendTextContainer(TextContainerIndex, pCursor, pText, Length);
 	}
@@ -2219,6 +2399,12 @@ public:
 			return;
 
 		STextContainer &TextContainer = GetTextContainer(TextContainerIndex);
+		// The glyphs were used when the container was last rendered, not only when they were requested
+		if(TextContainer.m_RenderStamp > TextContainer.m_GlyphUseStamp)
+		{
+			for(const STextCharQuad &TextCharQuad : TextContainer.m_StringInfo.m_vCharacterQuads)
+				m_pGlyphMap->MarkRectUsed(GlyphRectKey(TextCharQuad.m_aVertices[3].m_U, TextCharQuad.m_aVertices[3].m_V), TextContainer.m_RenderStamp);
+		}
 		if(Graphics()->IsTextBufferingEnabled())
 			Graphics()->DeleteBufferContainer(TextContainer.m_StringInfo.m_QuadBufferContainerIndex, true);
 		Graphics()->DeleteQuadContainer(TextContainer.m_StringInfo.m_SelectionQuadContainerIndex);
@@ -2243,7 +2429,8 @@ public:
 
 	void RenderTextContainer(STextContainerIndex TextContainerIndex, const ColorRGBA &TextColor, const ColorRGBA &TextOutlineColor) override
 	{
-		const STextContainer &TextContainer = GetTextContainer(TextContainerIndex);
+		STextContainer &TextContainer = GetTextContainer(TextContainerIndex);
+		TextContainer.m_RenderStamp = m_pGlyphMap->UseStamp();
 
 		if(!TextContainer.m_StringInfo.m_vCharacterQuads.empty())
 		{
@@ -2466,6 +2653,11 @@ public:
 
 		dbg_assert(!HasNonEmptyTextContainer, "text container was not empty");
 	}
+
+	void OnFrameEnd() override
+	{
+		m_pGlyphMap->OnFrameEnd();
+	}
 };
 
 IEngineTextRender *CreateEngineTextRender() { return new CTextRender; }
@@ -5,6 +5,7 @@
 
 #include "kernel.h"
 
+#include <functional>
 #include <memory>
 
 class CFutureLogger;
@@ -21,6 +22,7 @@ public:
 	virtual void Init() = 0;
 	virtual void AddJob(std::shared_ptr<IJob> pJob) = 0;
 	virtual void ShutdownJobs() = 0;
+	virtual void ParallelFor(int Count, int GrainSize, const std::function<void(int Begin, int End)> &Function) = 0;
 	virtual void SetAdditionalLogger(std::shared_ptr<ILogger> &&pLogger) = 0;
 };
 
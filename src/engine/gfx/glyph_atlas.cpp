@@ -0,0 +1,186 @@
+#include "glyph_atlas.h"
+
+#include <base/system.h>
+
+#include <algorithm>
+#include <limits>
+
+void CGlyphAtlas::AddSection(size_t X, size_t Y, size_t W, size_t H)
+{
+	std::vector<SSection> &vSections = W <= MAX_SECTION_DIMENSION_MAPPED && H <= MAX_SECTION_DIMENSION_MAPPED ? m_SectionsMap[std::make_tuple(W, H)] : m_vSections;
+	vSections.emplace_back(X, Y, W, H);
+}
+
+void CGlyphAtlas::UseSection(const SSection &Section, size_t Width, size_t Height, int &PosX, int &PosY)
+{
+	PosX = Section.m_X;
+	PosY = Section.m_Y;
+
+	// Create cut sections
+	const size_t CutW = Section.m_W - Width;
+	const size_t CutH = Section.m_H - Height;
+	if(CutW == 0)
+	{
+		if(CutH >= MIN_SECTION_DIMENSION)
+			AddSection(Section.m_X, Section.m_Y + Height, Section.m_W, CutH);
+	}
+	else if(CutH == 0)
+	{
+		if(CutW >= MIN_SECTION_DIMENSION)
+			AddSection(Section.m_X + Width, Section.m_Y, CutW, Section.m_H);
+	}
+	else if(CutW > CutH)
+	{
+		if(CutW >= MIN_SECTION_DIMENSION)
+			AddSection(Section.m_X + Width, Section.m_Y, CutW, Section.m_H);
+		if(CutH >= MIN_SECTION_DIMENSION)
+			AddSection(Section.m_X, Section.m_Y + Height, Width, CutH);
+	}
+	else
+	{
+		if(CutH >= MIN_SECTION_DIMENSION)
+			AddSection(Section.m_X, Section.m_Y + Height, Section.m_W, CutH);
+		if(CutW >= MIN_SECTION_DIMENSION)
+			AddSection(Section.m_X + Width, Section.m_Y, CutW, Height);
+	}
+}
+
+void CGlyphAtlas::Clear(size_t TextureDimension)
+{
+	m_TextureDimension = TextureDimension;
+	m_vSections.clear();
+	m_vSections.emplace_back(0, 0, m_TextureDimension, m_TextureDimension);
+	m_SectionsMap.clear();
+}
+
+void CGlyphAtlas::IncreaseDimension(size_t NewTextureDimension)
+{
+	dbg_assert(NewTextureDimension == m_TextureDimension * 2, "New atlas dimension must be twice the old one");
+	// Create 3 square sections to cover the new area, add the sections
+	// to the beginning of the vector so they are considered last.
+	m_vSections.emplace_back(m_TextureDimension, m_TextureDimension, m_TextureDimension, m_TextureDimension);
+	m_vSections.emplace_back(m_TextureDimension, 0, m_TextureDimension, m_TextureDimension);
+	m_vSections.emplace_back(0, m_TextureDimension, m_TextureDimension, m_TextureDimension);
+	std::rotate(m_vSections.rbegin(), m_vSections.rbegin() + 3, m_vSections.rend());
+	m_TextureDimension = NewTextureDimension;
+}
+
+bool CGlyphAtlas::Add(size_t Width, size_t Height, int &PosX, int &PosY)
+{
+	if(m_vSections.empty() || m_TextureDimension < Width || m_TextureDimension < Height)
+		return false;
+
+	// Find small section more efficiently by using maps
+	if(Width <= MAX_SECTION_DIMENSION_MAPPED && Height <= MAX_SECTION_DIMENSION_MAPPED)
+	{
+		const auto UseSectionFromVector = [&](std::vector<SSection> &vSections) {
+			if(!vSections.empty())
+			{
+				const SSection Section = vSections.back();
+				vSections.pop_back();
+				UseSection(Section, Width, Height, PosX, PosY);
+				return true;
+			}
+			return false;
+		};
+
+		if(UseSectionFromVector(m_SectionsMap[std::make_tuple(Width, Height)]))
+			return true;
+
+		for(size_t CheckWidth = Width + 1; CheckWidth <= MAX_SECTION_DIMENSION_MAPPED; ++CheckWidth)
+		{
+			if(UseSectionFromVector(m_SectionsMap[std::make_tuple(CheckWidth, Height)]))
+				return true;
+		}
+
+		for(size_t CheckHeight = Height + 1; CheckHeight <= MAX_SECTION_DIMENSION_MAPPED; ++CheckHeight)
+		{
+			if(UseSectionFromVector(m_SectionsMap[std::make_tuple(Width, CheckHeight)]))
+				return true;
+		}
+
+		// We don't iterate sections in the map with increasing width and height at the same time,
+		// because it's slower and doesn't noticeable increase the atlas utilization.
+	}
+
+	// Check vector for larger section
+	size_t SmallestLossValue = std::numeric_limits<size_t>::max();
+	size_t SmallestLossIndex = m_vSections.size();
+	size_t SectionIndex = m_vSections.size();
+	do
+	{
+		--SectionIndex;
+		const SSection &Section = m_vSections[SectionIndex];
+		if(Section.m_W < Width || Section.m_H < Height)
+			continue;
+
+		const size_t LossW = Section.m_W - Width;
+		const size_t LossH = Section.m_H - Height;
+
+		size_t Loss;
+		if(LossW == 0)
+			Loss = LossH;
+		else if(LossH == 0)
+			Loss = LossW;
+		else
+			Loss = LossW * LossH;
+
+		if(Loss < SmallestLossValue)
+		{
+			SmallestLossValue = Loss;
+			SmallestLossIndex = SectionIndex;
+			if(SmallestLossValue == 0)
+				break;
+		}
+	} while(SectionIndex > 0);
+	if(SmallestLossIndex == m_vSections.size())
+		return false; // No usable section found in vector
+
+	// Use the section with the smallest loss
+	const SSection Section = m_vSections[SmallestLossIndex];
+	m_vSections.erase(m_vSections.begin() + SmallestLossIndex);
+	UseSection(Section, Width, Height, PosX, PosY);
+	return true;
+}
+
+bool CompactGlyphAtlas(std::vector<SGlyphRect> &vRects, size_t TextureDimension, const uint8_t *const *ppTextureData, uint8_t *const *ppNewTextureData, size_t NumTextures, SGlyphAtlasCompaction &Compaction)
+{
+	std::sort(vRects.begin(), vRects.end(), [](const SGlyphRect &Lhs, const SGlyphRect &Rhs) {
+		if(Lhs.m_Keep != Rhs.m_Keep)
+			return Lhs.m_Keep;
+		return Lhs.m_LastUsed > Rhs.m_LastUsed;
+	});
+
+	Compaction.m_Atlas.Clear(TextureDimension);
+	Compaction.m_UsedArea = 0;
+	Compaction.m_MovedRects.clear();
+	Compaction.m_EvictedRects.clear();
+	const size_t TextureSize = TextureDimension * TextureDimension;
+	for(const SGlyphRect &Rect : vRects)
+	{
+		const size_t Area = Rect.m_Width * Rect.m_Height;
+		int NewX, NewY;
+		if((Rect.m_Keep || Compaction.m_UsedArea + Area <= TextureSize / 2) && Compaction.m_Atlas.Add(Rect.m_Width, Rect.m_Height, NewX, NewY))
+		{
+			for(size_t TextureIndex = 0; TextureIndex < NumTextures; ++TextureIndex)
+			{
+				for(size_t y = 0; y < Rect.m_Height; ++y)
+				{
+					mem_copy(&ppNewTextureData[TextureIndex][NewX + (y + NewY) * TextureDimension], &ppTextureData[TextureIndex][Rect.m_X + (y + Rect.m_Y) * TextureDimension], Rect.m_Width);
+				}
+			}
+			Compaction.m_UsedArea += Area;
+			Compaction.m_MovedRects.emplace(Rect.m_Key, GlyphRectKey(NewX, NewY));
+		}
+		else if(Rect.m_Keep)
+		{
+			// Glyphs in use cannot be evicted, keep the old atlas
+			return false;
+		}
+		else
+		{
+			Compaction.m_EvictedRects.insert(Rect.m_Key);
+		}
+	}
+	return !Compaction.m_EvictedRects.empty();
+}
@@ -0,0 +1,156 @@
+#ifndef ENGINE_GFX_GLYPH_ATLAS_H
+#define ENGINE_GFX_GLYPH_ATLAS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <tuple>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+/**
+ * Identifies the atlas rectangle of a glyph by the position of its top left corner.
+ */
+inline uint64_t GlyphRectKey(float X, float Y)
+{
+	return ((uint64_t)X << 32) | (uint64_t)Y;
+}
+
+inline float GlyphRectX(uint64_t Key)
+{
+	return Key >> 32;
+}
+
+inline float GlyphRectY(uint64_t Key)
+{
+	return Key & 0xffffffff;
+}
+
+/**
+ * Packs rectangles into a square texture.
+ */
+class CGlyphAtlas
+{
+	struct SSectionKeyHash
+	{
+		size_t operator()(const std::tuple<size_t, size_t> &Key) const
+		{
+			// Width and height should never be above 2^16 so this hash should cause no collisions
+			return (std::get<0>(Key) << 16) ^ std::get<1>(Key);
+		}
+	};
+
+	struct SSectionKeyEquals
+	{
+		bool operator()(const std::tuple<size_t, size_t> &Lhs, const std::tuple<size_t, size_t> &Rhs) const
+		{
+			return std::get<0>(Lhs) == std::get<0>(Rhs) && std::get<1>(Lhs) == std::get<1>(Rhs);
+		}
+	};
+
+	struct SSection
+	{
+		size_t m_X;
+		size_t m_Y;
+		size_t m_W;
+		size_t m_H;
+
+		SSection() = default;
+
+		SSection(size_t X, size_t Y, size_t W, size_t H) :
+			m_X(X), m_Y(Y), m_W(W), m_H(H)
+		{
+		}
+	};
+
+	/**
+	 * Sections with a smaller width or height will not be created
+	 * when cutting larger sections, to prevent collecting many
+	 * small, mostly unusable sections.
+	 */
+	static constexpr size_t MIN_SECTION_DIMENSION = 6;
+
+	/**
+	 * Sections with larger width or height will be stored in m_vSections.
+	 * Sections with width and height equal or smaller will be stored in m_SectionsMap.
+	 * This achieves a good balance between the size of the vector storing all large
+	 * sections and the map storing vectors of all sections with specific small sizes.
+	 * Lowering this value will result in the size of m_vSections becoming the bottleneck.
+	 * Increasing this value will result in the map becoming the bottleneck.
+	 */
+	static constexpr size_t MAX_SECTION_DIMENSION_MAPPED = 8 * MIN_SECTION_DIMENSION;
+
+	size_t m_TextureDimension;
+	std::vector<SSection> m_vSections;
+	std::unordered_map<std::tuple<size_t, size_t>, std::vector<SSection>, SSectionKeyHash, SSectionKeyEquals> m_SectionsMap;
+
+	void AddSection(size_t X, size_t Y, size_t W, size_t H);
+	void UseSection(const SSection &Section, size_t Width, size_t Height, int &PosX, int &PosY);
+
+public:
+	void Clear(size_t TextureDimension);
+	void IncreaseDimension(size_t NewTextureDimension);
+	bool Add(size_t Width, size_t Height, int &PosX, int &PosY);
+};
+
+/**
+ * A rectangle of the glyph atlas, shared by all glyphs with the same texture data.
+ */
+struct SGlyphRect
+{
+	uint64_t m_Key;
+	size_t m_X;
+	size_t m_Y;
+	size_t m_Width;
+	size_t m_Height;
+	uint64_t m_LastUsed;
+	// used by text that is still rendered, must not be evicted
+	bool m_Keep;
+};
+
+struct SGlyphAtlasCompaction
+{
+	CGlyphAtlas m_Atlas;
+	size_t m_UsedArea = 0;
+	// New top left corners of the kept rectangles by their old ones
+	std::unordered_map<uint64_t, uint64_t> m_MovedRects;
+	std::unordered_set<uint64_t> m_EvictedRects;
+};
+
+/**
+ * Repacks the rectangles into a new atlas with the same dimension and copies their texture data.
+ * Rectangles that must be kept come first, the others are kept in order of their last use as long
+ * as the new atlas stays at most half full and the rest are evicted.
+ *
+ * @param vRects The rectangles of the old atlas, reordered by this function.
+ * @param ppTextureData The textures of the old atlas.
+ * @param ppNewTextureData Zeroed textures of the same dimension for the new atlas.
+ *
+ * @return `false` if a rectangle that must be kept does not fit or nothing would be evicted,
+ * the new atlas must not be used then.
+ */
+bool CompactGlyphAtlas(std::vector<SGlyphRect> &vRects, size_t TextureDimension, const uint8_t *const *ppTextureData, uint8_t *const *ppNewTextureData, size_t NumTextures, SGlyphAtlasCompaction &Compaction);
+
+/**
+ * Moves the texture coordinates of a quad to the new rectangle of its glyph,
+ * the top left corner of the glyph rectangle is stored in the last vertex.
+ *
+ * @return `false` if the rectangle of the glyph was not moved.
+ */
+template<typename TVertex>
+bool MoveGlyphQuad(TVertex (&aVertices)[4], const std::unordered_map<uint64_t, uint64_t> &MovedRects)
+{
+	const auto MovedIt = MovedRects.find(GlyphRectKey(aVertices[3].m_U, aVertices[3].m_V));
+	if(MovedIt == MovedRects.end())
+		return false;
+	const float OffsetU = GlyphRectX(MovedIt->second) - aVertices[3].m_U;
+	const float OffsetV = GlyphRectY(MovedIt->second) - aVertices[3].m_V;
+	for(TVertex &Vertex : aVertices)
+	{
+		Vertex.m_U += OffsetU;
+		Vertex.m_V += OffsetV;
+	}
+	return true;
+}
+
+#endif // ENGINE_GFX_GLYPH_ATLAS_H
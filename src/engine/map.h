@@ -36,6 +36,16 @@ class IEngineMap : public IMap
 	MACRO_INTERFACE("enginemap")
 public:
 	virtual bool Load(const char *pMapName) = 0;
+	// loads a map from the save directory whose hashes are already known,
+	// the file is not read completely to calculate them again
+	virtual bool Load(const char *pMapName, const SHA256_DIGEST *pKnownSha256, unsigned KnownCrc) = 0;
+	// loads a map that was already read into memory next to the current one
+	// and reads all data that is not only used by the client, can be called
+	// from any thread while the current map is in use, the map data must stay
+	// valid until the map is unloaded or replaced
+	virtual bool Prepare(const char *pMapName, const unsigned char *pMapData, size_t MapSize, const SHA256_DIGEST *pKnownSha256, unsigned KnownCrc) = 0;
+	// replaces the current map with the prepared one
+	virtual void SwapPrepared() = 0;
 	virtual void Unload() = 0;
 	virtual bool IsLoaded() const = 0;
 	virtual IOHANDLE File() const = 0;
@@ -291,6 +291,12 @@ public:
 	virtual const char *GetMapName() const = 0;
 
 	virtual bool IsSixup(int ClientId) const = 0;
+
+	/**
+	 * Factor for the view of the client, below 1 while its snapshots
+	 * exceed the snapshot budget.
+	 */
+	virtual float SnapViewScale(int ClientId) const = 0;
 };
 
 class IGameServer : public IInterface
@@ -302,7 +308,10 @@ public:
 	// is instantiated.
 	virtual void OnInit(const void *pPersistentData) = 0;
 	virtual void OnConsoleInit() = 0;
-	virtual void OnMapChange(char *pNewMapName, int MapNameSize) = 0;
+	// Called from a worker thread while the game is running, so it must not
+	// access the game state. Returns whether `pNewMapName` was changed to a
+	// temporary copy of the map, which the caller removes after loading it.
+	virtual bool OnMapChange(const char *pMapName, char *pNewMapName, int MapNameSize) = 0;
 	// `pPersistentData` may be null if this is the last time `IGameServer`
 	// is destroyed.
 	virtual void OnShutdown(void *pPersistentData) = 0;
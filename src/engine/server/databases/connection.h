@@ -10,6 +10,9 @@ enum
 {
 	// MAX_NAME_LENGTH includes the size with \0, which is not necessary in SQL
 	MAX_NAME_LENGTH_SQL = MAX_NAME_LENGTH - 1,
+	// number of prepared statements kept per connection, the score worker
+	// uses a few dozen distinct queries
+	PREPARED_STATEMENT_CACHE_SIZE = 64,
 };
 
 class IConsole;
@@ -50,7 +53,17 @@ public:
 	// has to be called to return the connection back to the pool
 	virtual void Disconnect() = 0;
 
+	// groups the following statements into one transaction, which has to be
+	// committed or rolled back before disconnecting
+	//
+	// returns true on success
+	virtual bool BeginTransaction(char *pError, int ErrorSize) = 0;
+	virtual bool CommitTransaction(char *pError, int ErrorSize) = 0;
+	virtual bool RollbackTransaction(char *pError, int ErrorSize) = 0;
+
 	// ? for Placeholders, connection has to be established, can overwrite previous prepared statements
+	// statements are cached per connection by their text, a cached statement is
+	// reset and has to be bound again
 	//
 	// returns true on success
 	virtual bool PrepareStatement(const char *pStmt, char *pError, int ErrorSize) = 0;
@@ -103,7 +116,7 @@ bool MysqlAvailable();
 int MysqlInit();
 void MysqlUninit();
 
-std::unique_ptr<IDbConnection> CreateSqliteConnection(const char *pFilename, bool Setup);
+std::unique_ptr<IDbConnection> CreateSqliteConnection(const char *pFilename, bool Setup, int StatementCacheSize = PREPARED_STATEMENT_CACHE_SIZE);
 // Returns nullptr if MySQL support is not compiled in.
 std::unique_ptr<IDbConnection> CreateMysqlConnection(CMysqlConfig Config);
 
@@ -7,6 +7,7 @@
 #include <engine/console.h>
 
 #include <chrono>
+#include <cinttypes>
 #include <iterator>
 #include <memory>
 #include <thread>
@@ -65,6 +66,8 @@ struct CSqlExecData
 
 	std::unique_ptr<const ISqlData> m_pThreadData;
 	const char *m_pName;
+	// when the query was added to the queue, used for the lane statistics
+	std::chrono::nanoseconds m_QueuedTime = time_get_nanoseconds();
 };
 
 CSqlExecData::CSqlExecData(
@@ -118,8 +121,56 @@ CSqlExecData::CSqlExecData(IConsole *pConsole, CDbConnectionPool::Mode m) :
 	m_Ptr.m_Print.m_Mode = m;
 }
 
+void CDbConnectionPool::CLaneStats::OnQueued()
+{
+	const int NumQueued = m_NumQueued.fetch_add(1) + 1;
+	int MaxQueued = m_MaxQueued.load();
+	while(NumQueued > MaxQueued && !m_MaxQueued.compare_exchange_weak(MaxQueued, NumQueued))
+	{
+	}
+}
+
+void CDbConnectionPool::CLaneStats::OnCompleted(int64_t LatencyUs)
+{
+	m_NumQueued.fetch_sub(1);
+	m_NumCompleted.fetch_add(1);
+	m_TotalLatencyUs.fetch_add(LatencyUs);
+	uint64_t MaxLatencyUs = m_MaxLatencyUs.load();
+	while((uint64_t)LatencyUs > MaxLatencyUs && !m_MaxLatencyUs.compare_exchange_weak(MaxLatencyUs, LatencyUs))
+	{
+	}
+}
+
+static int64_t QueryLatencyUs(const CSqlExecData *pThreadData)
+{
+	return std::chrono::duration_cast<std::chrono::microseconds>(time_get_nanoseconds() - pThreadData->m_QueuedTime).count();
+}
+
 void CDbConnectionPool::Print(IConsole *pConsole, Mode DatabaseMode)
 {
+	if(DatabaseMode != Mode::WRITE_BACKUP)
+	{
+		const bool Read = DatabaseMode == Mode::READ;
+		const CLaneStats &Stats = m_pShared->m_aLaneStats[Read ? LANE_READ : LANE_WRITE];
+		const uint64_t NumCompleted = Stats.m_NumCompleted.load();
+		char aBuf[256];
+		str_format(aBuf, sizeof(aBuf), "%s lane: %d worker(s), %d queued (max %d), %" PRIu64 " done, latency avg %.2fms max %.2fms",
+			Read ? "Read" : "Write",
+			Read ? (int)m_vpReadWorkerThreads.size() : 1,
+			Stats.m_NumQueued.load(), Stats.m_MaxQueued.load(), NumCompleted,
+			NumCompleted > 0 ? Stats.m_TotalLatencyUs.load() / (float)NumCompleted / 1000.0f : 0.0f,
+			Stats.m_MaxLatencyUs.load() / 1000.0f);
+		pConsole->Print(IConsole::OUTPUT_LEVEL_STANDARD, "server", aBuf);
+	}
+
+	if(DatabaseMode == Mode::READ)
+	{
+		if(m_vpReadWorkerThreads.empty())
+			pConsole->Print(IConsole::OUTPUT_LEVEL_STANDARD, "server", "There are no read databases");
+		else
+			AddReadQuery(std::make_unique<CSqlExecData>(pConsole, DatabaseMode));
+		return;
+	}
 	m_pShared->m_aQueries[m_InsertIdx++] = std::make_unique<CSqlExecData>(pConsole, DatabaseMode);
 	m_InsertIdx %= std::size(m_pShared->m_aQueries);
 	m_pShared->m_NumBackup.Signal();
@@ -127,6 +178,15 @@ void CDbConnectionPool::Print(IConsole *pConsole, Mode DatabaseMode)
 
 void CDbConnectionPool::RegisterSqliteDatabase(Mode DatabaseMode, const char aFileName[64])
 {
+	if(DatabaseMode == Mode::READ)
+	{
+		{
+			CLockScope LockScope(m_pShared->m_ReadLock);
+			m_pShared->m_vpReadServers.push_back(std::make_unique<CSqlExecData>(DatabaseMode, aFileName));
+		}
+		StartReadWorkers();
+		return;
+	}
 	m_pShared->m_aQueries[m_InsertIdx++] = std::make_unique<CSqlExecData>(DatabaseMode, aFileName);
 	m_InsertIdx %= std::size(m_pShared->m_aQueries);
 	m_pShared->m_NumBackup.Signal();
@@ -134,6 +194,15 @@ void CDbConnectionPool::RegisterSqliteDatabase(Mode DatabaseMode, const char aFi
 
 void CDbConnectionPool::RegisterMysqlDatabase(Mode DatabaseMode, const CMysqlConfig *pMysqlConfig)
 {
+	if(DatabaseMode == Mode::READ)
+	{
+		{
+			CLockScope LockScope(m_pShared->m_ReadLock);
+			m_pShared->m_vpReadServers.push_back(std::make_unique<CSqlExecData>(DatabaseMode, pMysqlConfig));
+		}
+		StartReadWorkers();
+		return;
+	}
 	m_pShared->m_aQueries[m_InsertIdx++] = std::make_unique<CSqlExecData>(DatabaseMode, pMysqlConfig);
 	m_InsertIdx %= std::size(m_pShared->m_aQueries);
 	m_pShared->m_NumBackup.Signal();
@@ -144,9 +213,18 @@ void CDbConnectionPool::Execute(
 	std::unique_ptr<const ISqlData> pSqlRequestData,
 	const char *pName)
 {
-	m_pShared->m_aQueries[m_InsertIdx++] = std::make_unique<CSqlExecData>(pFunc, std::move(pSqlRequestData), pName);
-	m_InsertIdx %= std::size(m_pShared->m_aQueries);
-	m_pShared->m_NumBackup.Signal();
+	if(m_vpReadWorkerThreads.empty())
+	{
+		// same as failing on all read servers, there are none
+		dbg_msg("sql", "%s failed on all databases", pName);
+		if(pSqlRequestData->m_pResult != nullptr)
+		{
+			pSqlRequestData->m_pResult->m_Success = false;
+			pSqlRequestData->m_pResult->m_Completed.store(true);
+		}
+		return;
+	}
+	AddReadQuery(std::make_unique<CSqlExecData>(pFunc, std::move(pSqlRequestData), pName));
 }
 
 void CDbConnectionPool::ExecuteWrite(
@@ -154,11 +232,23 @@ void CDbConnectionPool::ExecuteWrite(
 	std::unique_ptr<const ISqlData> pSqlRequestData,
 	const char *pName)
 {
+	m_pShared->m_aLaneStats[LANE_WRITE].OnQueued();
 	m_pShared->m_aQueries[m_InsertIdx++] = std::make_unique<CSqlExecData>(pFunc, std::move(pSqlRequestData), pName);
 	m_InsertIdx %= std::size(m_pShared->m_aQueries);
 	m_pShared->m_NumBackup.Signal();
 }
 
+void CDbConnectionPool::AddReadQuery(std::unique_ptr<CSqlExecData> pQuery)
+{
+	if(pQuery != nullptr && pQuery->m_Mode == CSqlExecData::READ_ACCESS)
+		m_pShared->m_aLaneStats[LANE_READ].OnQueued();
+	{
+		CLockScope LockScope(m_pShared->m_ReadLock);
+		m_pShared->m_ReadQueries.push_back(std::move(pQuery));
+	}
+	m_pShared->m_NumRead.Signal();
+}
+
 void CDbConnectionPool::OnShutdown()
 {
 	if(m_Shutdown)
@@ -166,8 +256,10 @@ void CDbConnectionPool::OnShutdown()
 	m_Shutdown = true;
 	m_pShared->m_Shutdown.store(true);
 	m_pShared->m_NumBackup.Signal();
+	for(size_t i = 0; i < m_vpReadWorkerThreads.size(); i++)
+		AddReadQuery(nullptr);
 	int i = 0;
-	while(m_pShared->m_Shutdown.load())
+	while(m_pShared->m_Shutdown.load() || m_pShared->m_NumReadWorkers.load() > 0)
 	{
 		// print a log about every two seconds
 		if(i % 20 == 0 && i > 0)
@@ -211,10 +303,24 @@ void CBackup::Start(void *pUser)
 
 void CBackup::ProcessQueries()
 {
-	for(int JobNum = 0;; JobNum++)
+	std::vector<CSqlExecData *> vpBatch;
+	std::vector<Write> vWrites;
+	// query taken from the queue while collecting a batch, but not part of it
+	CSqlExecData *pNext = nullptr;
+	bool HaveNext = false;
+	for(int JobNum = 0;;)
 	{
-		m_pShared->m_NumBackup.Wait();
-		CSqlExecData *pThreadData = m_pShared->m_aQueries[JobNum % std::size(m_pShared->m_aQueries)].get();
+		CSqlExecData *pThreadData;
+		if(HaveNext)
+		{
+			pThreadData = pNext;
+			HaveNext = false;
+		}
+		else
+		{
+			m_pShared->m_NumBackup.Wait();
+			pThreadData = m_pShared->m_aQueries[JobNum++ % std::size(m_pShared->m_aQueries)].get();
+		}
 
 		// work through all database jobs after OnShutdown is called before exiting the thread
 		if(pThreadData == nullptr)
@@ -230,9 +336,31 @@ void CBackup::ProcessQueries()
 		}
 		else if(pThreadData->m_Mode == CSqlExecData::WRITE_ACCESS && m_pWriteBackup.get())
 		{
-			bool Success = CDbConnectionPool::ExecSqlFunc(m_pWriteBackup.get(), pThreadData, Write::BACKUP_FIRST);
-			if(m_DebugSql || !Success)
-				dbg_msg("sql", "[%i] %s done on write backup database, Success=%i", JobNum, pThreadData->m_pName, Success);
+			// back up all writes that are already queued in one transaction
+			vpBatch.assign(1, pThreadData);
+			while((int)vpBatch.size() < g_Config.m_SvSqlWriteBatch && m_pShared->m_NumBackup.GetApproximateValue() > 0)
+			{
+				m_pShared->m_NumBackup.Wait();
+				CSqlExecData *pQueued = m_pShared->m_aQueries[JobNum++ % std::size(m_pShared->m_aQueries)].get();
+				if(pQueued == nullptr || pQueued->m_Mode != CSqlExecData::WRITE_ACCESS)
+				{
+					pNext = pQueued;
+					HaveNext = true;
+					break;
+				}
+				vpBatch.push_back(pQueued);
+			}
+			vWrites.assign(vpBatch.size(), Write::BACKUP_FIRST);
+			const bool BatchSuccess = vpBatch.size() > 1 && CDbConnectionPool::ExecSqlBatch(m_pWriteBackup.get(), vpBatch.data(), vWrites.data(), vpBatch.size());
+			for(CSqlExecData *pWrite : vpBatch)
+			{
+				bool Success = BatchSuccess || CDbConnectionPool::ExecSqlFunc(m_pWriteBackup.get(), pWrite, Write::BACKUP_FIRST);
+				if(m_DebugSql || !Success)
+					dbg_msg("sql", "[%i] %s done on write backup database, Success=%i", JobNum, pWrite->m_pName, Success);
+			}
+			for(size_t i = 0; i < vpBatch.size(); i++)
+				m_pShared->m_NumWorker.Signal();
+			continue;
 		}
 		m_pShared->m_NumWorker.Signal();
 	}
@@ -252,6 +380,8 @@ public:
 
 private:
 	void Print(IConsole *pConsole, CDbConnectionPool::Mode DatabaseMode);
+	// executes consecutive write queries, in one transaction per database if possible
+	void ProcessWrites(std::vector<std::unique_ptr<CSqlExecData>> &vpWrites, int FirstJobNum, bool &FailMode);
 
 	bool m_DebugSql;
 
@@ -262,8 +392,8 @@ private:
 	//                most one WRITE server. The WRITE server for all DDNet
 	//                Servers must be the same (to counteract double loads).
 	//                There may be one WRITE_BACKUP sqlite server.
+	// The READ servers are handled by the read workers.
 	// This variable should only change, before the worker threads
-	std::vector<std::unique_ptr<IDbConnection>> m_vpReadConnections;
 	std::unique_ptr<IDbConnection> m_pWriteConnection;
 	std::unique_ptr<IDbConnection> m_pWriteBackup;
 
@@ -280,92 +410,87 @@ void CWorker::Start(void *pUser)
 
 void CWorker::ProcessQueries()
 {
-	// remember last working server and try to connect to it first
-	int ReadServer = 0;
-	// enter fail mode when a sql request fails, skip read request during it and
-	// write to the backup database until all requests are handled
+	// enter fail mode when a sql request fails, write to the backup database
+	// until all requests are handled
 	bool FailMode = false;
-	for(int JobNum = 0;; JobNum++)
+	std::vector<std::unique_ptr<CSqlExecData>> vpBatch;
+	// query taken from the queue while collecting a batch, but not part of it
+	std::unique_ptr<CSqlExecData> pNext;
+	bool HaveNext = false;
+	int QueueIdx = 0;
+	for(;;)
 	{
-		if(FailMode && m_pShared->m_NumWorker.GetApproximateValue() == 0)
+		if(FailMode && !HaveNext && m_pShared->m_NumWorker.GetApproximateValue() == 0)
 		{
 			FailMode = false;
 		}
-		m_pShared->m_NumWorker.Wait();
-		auto pThreadData = std::move(m_pShared->m_aQueries[JobNum % std::size(m_pShared->m_aQueries)]);
+		std::unique_ptr<CSqlExecData> pThreadData;
+		int JobNum;
+		if(HaveNext)
+		{
+			pThreadData = std::move(pNext);
+			JobNum = QueueIdx - 1;
+			HaveNext = false;
+		}
+		else
+		{
+			m_pShared->m_NumWorker.Wait();
+			JobNum = QueueIdx++;
+			pThreadData = std::move(m_pShared->m_aQueries[JobNum % std::size(m_pShared->m_aQueries)]);
+		}
 		// work through all database jobs after OnShutdown is called before exiting the thread
 		if(pThreadData == nullptr)
 		{
 			m_pShared->m_Shutdown.store(false);
 			return;
 		}
-		bool Success = false;
-		switch(pThreadData->m_Mode)
-		{
-		case CSqlExecData::READ_ACCESS:
+
+		if(pThreadData->m_Mode == CSqlExecData::WRITE_ACCESS)
 		{
-			for(size_t i = 0; i < m_vpReadConnections.size(); i++)
+			// group commit: collect the writes that are queued already or
+			// arrive within sv_sql_write_batch_delay
+			vpBatch.clear();
+			vpBatch.push_back(std::move(pThreadData));
+			const auto Deadline = time_get_nanoseconds() + std::chrono::milliseconds(g_Config.m_SvSqlWriteBatchDelay);
+			while((int)vpBatch.size() < g_Config.m_SvSqlWriteBatch)
 			{
-				if(m_pShared->m_Shutdown)
+				if(m_pShared->m_NumWorker.GetApproximateValue() == 0)
 				{
-					dbg_msg("sql", "[%i] %s dismissed read request during shutdown", JobNum, pThreadData->m_pName);
-					break;
-				}
-				if(FailMode)
-				{
-					dbg_msg("sql", "[%i] %s dismissed read request during FailMode", JobNum, pThreadData->m_pName);
-					break;
+					if(m_pShared->m_Shutdown || time_get_nanoseconds() >= Deadline)
+						break;
+					std::this_thread::sleep_for(1ms);
+					continue;
 				}
-				int CurServer = (ReadServer + i) % (int)m_vpReadConnections.size();
-				if(CDbConnectionPool::ExecSqlFunc(m_vpReadConnections[CurServer].get(), pThreadData.get(), Write::NORMAL))
+				m_pShared->m_NumWorker.Wait();
+				auto pQueued = std::move(m_pShared->m_aQueries[QueueIdx++ % std::size(m_pShared->m_aQueries)]);
+				if(pQueued == nullptr || pQueued->m_Mode != CSqlExecData::WRITE_ACCESS)
 				{
-					ReadServer = CurServer;
-					if(m_DebugSql)
-						dbg_msg("sql", "[%i] %s done on read database %d", JobNum, pThreadData->m_pName, CurServer);
-					Success = true;
+					pNext = std::move(pQueued);
+					HaveNext = true;
 					break;
 				}
+				vpBatch.push_back(std::move(pQueued));
 			}
-			if(!Success)
-			{
-				FailMode = true;
-			}
+			ProcessWrites(vpBatch, JobNum, FailMode);
+			continue;
 		}
-		break;
-		case CSqlExecData::WRITE_ACCESS:
+
+		bool Success = false;
+		switch(pThreadData->m_Mode)
 		{
-			if(m_pShared->m_Shutdown && m_pWriteBackup != nullptr)
-			{
-				dbg_msg("sql", "[%i] %s skipped to backup database during shutdown", JobNum, pThreadData->m_pName);
-			}
-			else if(FailMode && m_pWriteBackup != nullptr)
-			{
-				dbg_msg("sql", "[%i] %s skipped to backup database during FailMode", JobNum, pThreadData->m_pName);
-			}
-			else if(CDbConnectionPool::ExecSqlFunc(m_pWriteConnection.get(), pThreadData.get(), Write::NORMAL))
-			{
-				if(m_DebugSql)
-					dbg_msg("sql", "[%i] %s done on write database", JobNum, pThreadData->m_pName);
-				Success = true;
-			}
-			// enter fail mode if not successful
-			FailMode = FailMode || !Success;
-			const Write w = Success ? Write::NORMAL_SUCCEEDED : Write::NORMAL_FAILED;
-			if(m_pWriteBackup && CDbConnectionPool::ExecSqlFunc(m_pWriteBackup.get(), pThreadData.get(), w))
-			{
-				if(m_DebugSql)
-					dbg_msg("sql", "[%i] %s done move write on backup database to non-backup table", JobNum, pThreadData->m_pName);
-				Success = true;
-			}
-		}
-		break;
+		case CSqlExecData::READ_ACCESS:
+			dbg_assert(false, "read queries are handled by the read workers");
+			break;
+		case CSqlExecData::WRITE_ACCESS:
+			dbg_assert(false, "write queries are handled in batches");
+			break;
 		case CSqlExecData::ADD_MYSQL:
 		{
 			auto pMysql = CreateMysqlConnection(pThreadData->m_Ptr.m_Mysql.m_Config);
 			switch(pThreadData->m_Ptr.m_Mysql.m_Mode)
 			{
 			case CDbConnectionPool::Mode::READ:
-				m_vpReadConnections.push_back(std::move(pMysql));
+				dbg_assert(false, "read servers are registered with the read workers");
 				break;
 			case CDbConnectionPool::Mode::WRITE:
 				m_pWriteConnection = std::move(pMysql);
@@ -385,7 +510,7 @@ void CWorker::ProcessQueries()
 			switch(pThreadData->m_Ptr.m_Sqlite.m_Mode)
 			{
 			case CDbConnectionPool::Mode::READ:
-				m_vpReadConnections.push_back(std::move(pSqlite));
+				dbg_assert(false, "read servers are registered with the read workers");
 				break;
 			case CDbConnectionPool::Mode::WRITE:
 				m_pWriteConnection = std::move(pSqlite);
@@ -414,16 +539,89 @@ void CWorker::ProcessQueries()
 	}
 }
 
-void CWorker::Print(IConsole *pConsole, CDbConnectionPool::Mode DatabaseMode)
+void CWorker::ProcessWrites(std::vector<std::unique_ptr<CSqlExecData>> &vpWrites, int FirstJobNum, bool &FailMode)
 {
-	if(DatabaseMode == CDbConnectionPool::Mode::READ)
+	const int NumWrites = vpWrites.size();
+	std::vector<CSqlExecData *> vpData(NumWrites);
+	std::vector<Write> vWrites(NumWrites, Write::NORMAL);
+	std::vector<bool> vSuccess(NumWrites, false);
+	for(int i = 0; i < NumWrites; i++)
+		vpData[i] = vpWrites[i].get();
+
+	// commit all writes at once, execute them one by one if the transaction fails
+	// to know which of them failed
+	const bool SkipToBackup = m_pWriteBackup != nullptr && (m_pShared->m_Shutdown || FailMode);
+	bool BatchSuccess = false;
+	if(NumWrites > 1 && !SkipToBackup)
 	{
-		for(auto &pReadConnection : m_vpReadConnections)
-			pReadConnection->Print(pConsole, "Read");
-		if(m_vpReadConnections.empty())
-			pConsole->Print(IConsole::OUTPUT_LEVEL_STANDARD, "server", "There are no read databases");
+		BatchSuccess = CDbConnectionPool::ExecSqlBatch(m_pWriteConnection.get(), vpData.data(), vWrites.data(), NumWrites);
+		if(!BatchSuccess)
+			dbg_msg("sql", "[%i] transaction of %d writes failed, executing them one by one", FirstJobNum, NumWrites);
+		else if(m_DebugSql)
+			dbg_msg("sql", "[%i] %d writes done on write database in one transaction", FirstJobNum, NumWrites);
+	}
+
+	for(int i = 0; i < NumWrites; i++)
+	{
+		const int JobNum = FirstJobNum + i;
+		CSqlExecData *pThreadData = vpData[i];
+		bool Success = BatchSuccess;
+		if(BatchSuccess)
+		{
+		}
+		else if(m_pShared->m_Shutdown && m_pWriteBackup != nullptr)
+		{
+			dbg_msg("sql", "[%i] %s skipped to backup database during shutdown", JobNum, pThreadData->m_pName);
+		}
+		else if(FailMode && m_pWriteBackup != nullptr)
+		{
+			dbg_msg("sql", "[%i] %s skipped to backup database during FailMode", JobNum, pThreadData->m_pName);
+		}
+		else if(CDbConnectionPool::ExecSqlFunc(m_pWriteConnection.get(), pThreadData, Write::NORMAL))
+		{
+			if(m_DebugSql)
+				dbg_msg("sql", "[%i] %s done on write database", JobNum, pThreadData->m_pName);
+			Success = true;
+		}
+		// enter fail mode if not successful
+		FailMode = FailMode || !Success;
+		vWrites[i] = Success ? Write::NORMAL_SUCCEEDED : Write::NORMAL_FAILED;
+		vSuccess[i] = Success;
+	}
+
+	// remove the writes from the backup database, or move them to its
+	// non-backup tables if they failed
+	if(m_pWriteBackup)
+	{
+		const bool BackupBatchSuccess = NumWrites > 1 && CDbConnectionPool::ExecSqlBatch(m_pWriteBackup.get(), vpData.data(), vWrites.data(), NumWrites);
+		for(int i = 0; i < NumWrites; i++)
+		{
+			if(BackupBatchSuccess || CDbConnectionPool::ExecSqlFunc(m_pWriteBackup.get(), vpData[i], vWrites[i]))
+			{
+				if(m_DebugSql)
+					dbg_msg("sql", "[%i] %s done move write on backup database to non-backup table", FirstJobNum + i, vpData[i]->m_pName);
+				vSuccess[i] = true;
+			}
+		}
 	}
-	else if(DatabaseMode == CDbConnectionPool::Mode::WRITE)
+
+	for(int i = 0; i < NumWrites; i++)
+	{
+		CSqlExecData *pThreadData = vpData[i];
+		m_pShared->m_aLaneStats[CDbConnectionPool::LANE_WRITE].OnCompleted(QueryLatencyUs(pThreadData));
+		if(!vSuccess[i])
+			dbg_msg("sql", "[%i] %s failed on all databases", FirstJobNum + i, pThreadData->m_pName);
+		if(pThreadData->m_pThreadData != nullptr && pThreadData->m_pThreadData->m_pResult != nullptr)
+		{
+			pThreadData->m_pThreadData->m_pResult->m_Success = vSuccess[i];
+			pThreadData->m_pThreadData->m_pResult->m_Completed.store(true);
+		}
+	}
+}
+
+void CWorker::Print(IConsole *pConsole, CDbConnectionPool::Mode DatabaseMode)
+{
+	if(DatabaseMode == CDbConnectionPool::Mode::WRITE)
 	{
 		if(m_pWriteConnection)
 			m_pWriteConnection->Print(pConsole, "Write");
@@ -439,6 +637,132 @@ void CWorker::Print(IConsole *pConsole, CDbConnectionPool::Mode DatabaseMode)
 	}
 }
 
+// The read workers execute read queries in parallel on their own connections
+// to the read servers. Read queries are not ordered with respect to each
+// other or to write queries.
+class CReadWorker
+{
+public:
+	CReadWorker(std::shared_ptr<CDbConnectionPool::CSharedData> pShared, int WorkerId, int DebugSql) :
+		m_WorkerId(WorkerId), m_DebugSql(DebugSql), m_pShared(std::move(pShared)) {}
+	static void Start(void *pUser);
+	void ProcessQueries();
+
+private:
+	void UpdateConnections();
+
+	int m_WorkerId;
+	bool m_DebugSql;
+
+	std::vector<std::unique_ptr<IDbConnection>> m_vpReadConnections;
+
+	std::shared_ptr<CDbConnectionPool::CSharedData> m_pShared;
+};
+
+/* static */
+void CReadWorker::Start(void *pUser)
+{
+	CReadWorker *pThis = (CReadWorker *)pUser;
+	pThis->ProcessQueries();
+	pThis->m_pShared->m_NumReadWorkers.fetch_sub(1);
+	delete pThis;
+}
+
+void CReadWorker::UpdateConnections()
+{
+	CLockScope LockScope(m_pShared->m_ReadLock);
+	while(m_vpReadConnections.size() < m_pShared->m_vpReadServers.size())
+	{
+		const CSqlExecData *pServer = m_pShared->m_vpReadServers[m_vpReadConnections.size()].get();
+		if(pServer->m_Mode == CSqlExecData::ADD_MYSQL)
+			m_vpReadConnections.push_back(CreateMysqlConnection(pServer->m_Ptr.m_Mysql.m_Config));
+		else
+			m_vpReadConnections.push_back(CreateSqliteConnection(pServer->m_Ptr.m_Sqlite.m_FileName, true));
+	}
+}
+
+void CReadWorker::ProcessQueries()
+{
+	// remember last working server and try to connect to it first
+	int ReadServer = 0;
+	// enter fail mode when a sql request fails, skip read requests during it
+	// until all queued requests are handled
+	bool FailMode = false;
+	for(int JobNum = 0;; JobNum++)
+	{
+		m_pShared->m_NumRead.Wait();
+		std::unique_ptr<CSqlExecData> pThreadData;
+		bool QueueEmpty;
+		{
+			CLockScope LockScope(m_pShared->m_ReadLock);
+			pThreadData = std::move(m_pShared->m_ReadQueries.front());
+			m_pShared->m_ReadQueries.pop_front();
+			QueueEmpty = m_pShared->m_ReadQueries.empty();
+		}
+		if(pThreadData == nullptr)
+			return;
+
+		UpdateConnections();
+		bool Success = false;
+		if(pThreadData->m_Mode == CSqlExecData::PRINT)
+		{
+			for(auto &pReadConnection : m_vpReadConnections)
+				pReadConnection->Print(pThreadData->m_Ptr.m_Print.m_pConsole, "Read");
+			continue;
+		}
+
+		dbg_assert(pThreadData->m_Mode == CSqlExecData::READ_ACCESS, "only read queries are handled by the read workers");
+		for(size_t i = 0; i < m_vpReadConnections.size(); i++)
+		{
+			if(m_pShared->m_Shutdown)
+			{
+				dbg_msg("sql", "[r%d:%i] %s dismissed read request during shutdown", m_WorkerId, JobNum, pThreadData->m_pName);
+				break;
+			}
+			if(FailMode)
+			{
+				dbg_msg("sql", "[r%d:%i] %s dismissed read request during FailMode", m_WorkerId, JobNum, pThreadData->m_pName);
+				break;
+			}
+			int CurServer = (ReadServer + i) % (int)m_vpReadConnections.size();
+			if(CDbConnectionPool::ExecSqlFunc(m_vpReadConnections[CurServer].get(), pThreadData.get(), Write::NORMAL))
+			{
+				ReadServer = CurServer;
+				if(m_DebugSql)
+					dbg_msg("sql", "[r%d:%i] %s done on read database %d", m_WorkerId, JobNum, pThreadData->m_pName, CurServer);
+				Success = true;
+				break;
+			}
+		}
+		if(!Success)
+		{
+			dbg_msg("sql", "[r%d:%i] %s failed on all databases", m_WorkerId, JobNum, pThreadData->m_pName);
+			FailMode = true;
+		}
+		if(FailMode && QueueEmpty)
+		{
+			FailMode = false;
+		}
+		m_pShared->m_aLaneStats[CDbConnectionPool::LANE_READ].OnCompleted(QueryLatencyUs(pThreadData.get()));
+		if(pThreadData->m_pThreadData != nullptr && pThreadData->m_pThreadData->m_pResult != nullptr)
+		{
+			pThreadData->m_pThreadData->m_pResult->m_Success = Success;
+			pThreadData->m_pThreadData->m_pResult->m_Completed.store(true);
+		}
+	}
+}
+
+void CDbConnectionPool::StartReadWorkers()
+{
+	if(!m_vpReadWorkerThreads.empty())
+		return;
+	for(int i = 0; i < g_Config.m_SvSqlReadWorkers; i++)
+	{
+		m_pShared->m_NumReadWorkers.fetch_add(1);
+		m_vpReadWorkerThreads.push_back(thread_init(CReadWorker::Start, new CReadWorker(m_pShared, i, g_Config.m_DbgSql), "database read worker thread"));
+	}
+}
+
 /* static */
 bool CDbConnectionPool::ExecSqlFunc(IDbConnection *pConnection, CSqlExecData *pData, Write w)
 {
@@ -473,6 +797,50 @@ bool CDbConnectionPool::ExecSqlFunc(IDbConnection *pConnection, CSqlExecData *pD
 	return Success;
 }
 
+/* static */
+bool CDbConnectionPool::ExecSqlBatch(IDbConnection *pConnection, CSqlExecData *const *ppData, const Write *pWrites, int NumData)
+{
+	if(pConnection == nullptr)
+	{
+		dbg_msg("sql", "No database given");
+		return false;
+	}
+	char aError[256] = "unknown error";
+	if(!pConnection->Connect(aError, sizeof(aError)))
+	{
+		dbg_msg("sql", "failed connecting to db: %s", aError);
+		return false;
+	}
+	bool Success = false;
+	if(pConnection->BeginTransaction(aError, sizeof(aError)))
+	{
+		Success = true;
+		for(int i = 0; i < NumData && Success; i++)
+		{
+			dbg_assert(ppData[i]->m_Mode == CSqlExecData::WRITE_ACCESS, "only write queries can be batched");
+			Success = ppData[i]->m_Ptr.m_pWriteFunc(pConnection, ppData[i]->m_pThreadData.get(), pWrites[i], aError, sizeof(aError));
+			if(!Success)
+				dbg_msg("sql", "%s failed in transaction: %s", ppData[i]->m_pName, aError);
+		}
+		if(Success)
+		{
+			Success = pConnection->CommitTransaction(aError, sizeof(aError));
+			if(!Success)
+				dbg_msg("sql", "failed committing transaction: %s", aError);
+		}
+		if(!Success && !pConnection->RollbackTransaction(aError, sizeof(aError)))
+		{
+			dbg_msg("sql", "failed rolling back transaction: %s", aError);
+		}
+	}
+	else
+	{
+		dbg_msg("sql", "failed starting transaction: %s", aError);
+	}
+	pConnection->Disconnect();
+	return Success;
+}
+
 CDbConnectionPool::CDbConnectionPool()
 {
 	m_pShared = std::make_shared<CSharedData>();
@@ -487,4 +855,6 @@ CDbConnectionPool::~CDbConnectionPool()
 		thread_wait(m_pWorkerThread);
 	if(m_pBackupThread)
 		thread_wait(m_pBackupThread);
+	for(void *pReadWorkerThread : m_vpReadWorkerThreads)
+		thread_wait(pReadWorkerThread);
 }
@@ -2,7 +2,10 @@
 #define ENGINE_SERVER_DATABASES_CONNECTION_POOL_H
 
 #include <atomic>
+#include <base/lock.h>
 #include <base/tl/threading.h>
+#include <cstdint>
+#include <deque>
 #include <memory>
 #include <vector>
 
@@ -96,9 +99,16 @@ public:
 
 	friend class CWorker;
 	friend class CBackup;
+	friend class CReadWorker;
 
 private:
 	static bool ExecSqlFunc(IDbConnection *pConnection, struct CSqlExecData *pData, Write w);
+	// executes the write queries in one transaction, nothing is written if
+	// one of them fails
+	static bool ExecSqlBatch(IDbConnection *pConnection, struct CSqlExecData *const *ppData, const Write *pWrites, int NumData);
+
+	void AddReadQuery(std::unique_ptr<struct CSqlExecData> pQuery);
+	void StartReadWorkers();
 
 	// Only the main thread accesses this variable. It points to the index,
 	// where the next query is added to the queue.
@@ -106,6 +116,27 @@ private:
 
 	bool m_Shutdown = false;
 
+	enum
+	{
+		LANE_READ,
+		LANE_WRITE,
+		NUM_LANES,
+	};
+
+	// Queue depth and latency of the queries of one lane, the latency is
+	// measured from adding the query to the queue until it is completed.
+	struct CLaneStats
+	{
+		std::atomic_int m_NumQueued{0};
+		std::atomic_int m_MaxQueued{0};
+		std::atomic<uint64_t> m_NumCompleted{0};
+		std::atomic<uint64_t> m_TotalLatencyUs{0};
+		std::atomic<uint64_t> m_MaxLatencyUs{0};
+
+		void OnQueued();
+		void OnCompleted(int64_t LatencyUs);
+	};
+
 	struct CSharedData
 	{
 		// Used as signal that shutdown is in progress from main thread to
@@ -122,12 +153,29 @@ private:
 		CSemaphore m_NumWorker;
 
 		// spsc queue with additional backup worker to look at queries first.
+		// Only write queries and write server registrations use this queue to
+		// keep their order.
 		std::unique_ptr<struct CSqlExecData> m_aQueries[512];
+
+		// Read queries are executed by multiple read workers in parallel.
+		// A nullptr query stops one read worker.
+		CLock m_ReadLock;
+		std::deque<std::unique_ptr<struct CSqlExecData>> m_ReadQueries GUARDED_BY(m_ReadLock);
+		CSemaphore m_NumRead;
+		// Registered read servers, each read worker creates its own connections
+		// to them. Entries are only appended.
+		std::vector<std::unique_ptr<struct CSqlExecData>> m_vpReadServers GUARDED_BY(m_ReadLock);
+		// Number of read workers that did not exit yet
+		std::atomic_int m_NumReadWorkers{0};
+
+		CLaneStats m_aLaneStats[NUM_LANES];
 	};
 
 	std::shared_ptr<CSharedData> m_pShared;
 	void *m_pWorkerThread = nullptr;
 	void *m_pBackupThread = nullptr;
+	// Read workers are started when the first read server is registered
+	std::vector<void *> m_vpReadWorkerThreads;
 };
 
 #endif // ENGINE_SERVER_DATABASES_CONNECTION_POOL_H
@@ -1,4 +1,5 @@
 #include "connection.h"
+#include "statement_cache.h"
 
 #include <sqlite3.h>
 
@@ -10,7 +11,7 @@
 class CSqliteConnection : public IDbConnection
 {
 public:
-	CSqliteConnection(const char *pFilename, bool Setup);
+	CSqliteConnection(const char *pFilename, bool Setup, int StatementCacheSize);
 	~CSqliteConnection() override;
 	void Print(IConsole *pConsole, const char *pMode) override;
 
@@ -30,6 +31,10 @@ public:
 	bool Connect(char *pError, int ErrorSize) override;
 	void Disconnect() override;
 
+	bool BeginTransaction(char *pError, int ErrorSize) override;
+	bool CommitTransaction(char *pError, int ErrorSize) override;
+	bool RollbackTransaction(char *pError, int ErrorSize) override;
+
 	bool PrepareStatement(const char *pStmt, char *pError, int ErrorSize) override;
 
 	void BindString(int Idx, const char *pString) override;
@@ -61,10 +66,18 @@ private:
 	char m_aFilename[IO_MAX_PATH_LENGTH];
 	bool m_Setup;
 
+	class CStmtDeleter
+	{
+	public:
+		void operator()(sqlite3_stmt *pStmt) const { sqlite3_finalize(pStmt); }
+	};
+
 	sqlite3 *m_pDb;
+	// current statement, owned by m_StatementCache
 	sqlite3_stmt *m_pStmt;
+	CStatementCache<sqlite3_stmt, CStmtDeleter> m_StatementCache;
 	bool m_Done; // no more rows available for Step
-	// returns false, if the query succeeded
+	// returns true, if the query succeeded
 	bool Execute(const char *pQuery, char *pError, int ErrorSize);
 	// returns true on failure
 	bool ConnectImpl(char *pError, int ErrorSize);
@@ -76,11 +89,12 @@ private:
 	std::atomic_bool m_InUse;
 };
 
-CSqliteConnection::CSqliteConnection(const char *pFilename, bool Setup) :
+CSqliteConnection::CSqliteConnection(const char *pFilename, bool Setup, int StatementCacheSize) :
 	IDbConnection("record"),
 	m_Setup(Setup),
 	m_pDb(nullptr),
 	m_pStmt(nullptr),
+	m_StatementCache(StatementCacheSize),
 	m_Done(true),
 	m_InUse(false)
 {
@@ -89,8 +103,8 @@ CSqliteConnection::CSqliteConnection(const char *pFilename, bool Setup) :
 
 CSqliteConnection::~CSqliteConnection()
 {
-	if(m_pStmt != nullptr)
-		sqlite3_finalize(m_pStmt);
+	m_pStmt = nullptr;
+	m_StatementCache.Clear();
 	sqlite3_close(m_pDb);
 	m_pDb = nullptr;
 }
@@ -99,8 +113,8 @@ void CSqliteConnection::Print(IConsole *pConsole, const char *pMode)
 {
 	char aBuf[512];
 	str_format(aBuf, sizeof(aBuf),
-		"SQLite-%s: DB: '%s'",
-		pMode, m_aFilename);
+		"SQLite-%s: DB: '%s' Cached statements: %d (%d hits, %d misses)",
+		pMode, m_aFilename, (int)m_StatementCache.Size(), (int)m_StatementCache.NumHits(), (int)m_StatementCache.NumMisses());
 	pConsole->Print(IConsole::OUTPUT_LEVEL_STANDARD, "server", aBuf);
 }
 
@@ -135,6 +149,10 @@ bool CSqliteConnection::ConnectImpl(char *pError, int ErrorSize)
 		dbg_msg("sql", "SQLite version %s is not supported, use at least version 3.25.0", sqlite3_libversion());
 	}
 
+	// statements belong to the previous database handle
+	m_pStmt = nullptr;
+	m_StatementCache.Clear();
+
 	int Result = sqlite3_open(m_aFilename, &m_pDb);
 	if(Result != SQLITE_OK)
 	{
@@ -182,27 +200,61 @@ bool CSqliteConnection::ConnectImpl(char *pError, int ErrorSize)
 
 void CSqliteConnection::Disconnect()
 {
+	// keep the statement cached, but release its locks
 	if(m_pStmt != nullptr)
-		sqlite3_finalize(m_pStmt);
+		sqlite3_reset(m_pStmt);
 	m_pStmt = nullptr;
 	m_InUse.store(false);
 }
 
+bool CSqliteConnection::BeginTransaction(char *pError, int ErrorSize)
+{
+	// take the write lock right away, the transaction is used for writes
+	return Execute("BEGIN IMMEDIATE", pError, ErrorSize);
+}
+
+bool CSqliteConnection::CommitTransaction(char *pError, int ErrorSize)
+{
+	if(m_pStmt != nullptr)
+		sqlite3_reset(m_pStmt);
+	return Execute("COMMIT", pError, ErrorSize);
+}
+
+bool CSqliteConnection::RollbackTransaction(char *pError, int ErrorSize)
+{
+	if(m_pStmt != nullptr)
+		sqlite3_reset(m_pStmt);
+	return Execute("ROLLBACK", pError, ErrorSize);
+}
+
 bool CSqliteConnection::PrepareStatement(const char *pStmt, char *pError, int ErrorSize)
 {
 	if(m_pStmt != nullptr)
-		sqlite3_finalize(m_pStmt);
-	m_pStmt = nullptr;
+		sqlite3_reset(m_pStmt);
+	m_pStmt = m_StatementCache.Find(pStmt);
+	if(m_pStmt != nullptr)
+	{
+		// bound strings and blobs are not copied, don't keep pointers to them
+		sqlite3_clear_bindings(m_pStmt);
+		m_Done = false;
+		return true;
+	}
+
+	sqlite3_stmt *pNewStmt = nullptr;
 	int Result = sqlite3_prepare_v2(
 		m_pDb,
 		pStmt,
 		-1, // pStmt can be any length
-		&m_pStmt,
+		&pNewStmt,
 		nullptr);
 	if(FormatError(Result, pError, ErrorSize))
 	{
+		sqlite3_finalize(pNewStmt);
 		return false;
 	}
+	// empty statements don't create a statement object
+	if(pNewStmt != nullptr)
+		m_pStmt = m_StatementCache.Add(pStmt, std::unique_ptr<sqlite3_stmt, CStmtDeleter>(pNewStmt));
 	m_Done = false;
 	return true;
 }
@@ -412,7 +464,7 @@ bool CSqliteConnection::AddPoints(const char *pPlayer, int Points, char *pError,
 	return Step(&End, pError, ErrorSize);
 }
 
-std::unique_ptr<IDbConnection> CreateSqliteConnection(const char *pFilename, bool Setup)
+std::unique_ptr<IDbConnection> CreateSqliteConnection(const char *pFilename, bool Setup, int StatementCacheSize)
 {
-	return std::make_unique<CSqliteConnection>(pFilename, Setup);
+	return std::make_unique<CSqliteConnection>(pFilename, Setup, StatementCacheSize);
 }
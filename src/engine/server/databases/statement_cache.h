@@ -0,0 +1,87 @@
+#ifndef ENGINE_SERVER_DATABASES_STATEMENT_CACHE_H
+#define ENGINE_SERVER_DATABASES_STATEMENT_CACHE_H
+
+#include <cstddef>
+#include <list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+// Least recently used cache of prepared statements of one connection, keyed
+// by the SQL text. The cache owns the statements, evicted statements are
+// destroyed with TDeleter. Has to be cleared before the connection is closed.
+template<typename TStmt, typename TDeleter>
+class CStatementCache
+{
+public:
+	typedef std::unique_ptr<TStmt, TDeleter> CStmtPtr;
+
+	explicit CStatementCache(size_t Capacity) :
+		m_Capacity(Capacity) {}
+
+	// returns the statement prepared for pSql and marks it as most recently
+	// used, or nullptr if it is not cached
+	TStmt *Find(const char *pSql)
+	{
+		auto It = m_Index.find(pSql);
+		if(It == m_Index.end())
+		{
+			m_NumMisses++;
+			return nullptr;
+		}
+		m_NumHits++;
+		m_Entries.splice(m_Entries.begin(), m_Entries, It->second);
+		return It->second->second.get();
+	}
+
+	// adds a newly prepared statement, evicting the least recently used one
+	// if the cache is full
+	TStmt *Add(const char *pSql, CStmtPtr pStmt)
+	{
+		if(m_Entries.size() >= m_Capacity && !m_Entries.empty())
+		{
+			m_Index.erase(m_Entries.back().first);
+			m_Entries.pop_back();
+		}
+		m_Entries.emplace_front(pSql, std::move(pStmt));
+		m_Index[m_Entries.front().first] = m_Entries.begin();
+		return m_Entries.front().second.get();
+	}
+
+	// drops a statement that can no longer be used, e.g. after an error
+	void Remove(TStmt *pStmt)
+	{
+		for(auto It = m_Entries.begin(); It != m_Entries.end(); ++It)
+		{
+			if(It->second.get() == pStmt)
+			{
+				m_Index.erase(It->first);
+				m_Entries.erase(It);
+				return;
+			}
+		}
+	}
+
+	void Clear()
+	{
+		m_Index.clear();
+		m_Entries.clear();
+	}
+
+	size_t Size() const { return m_Entries.size(); }
+	size_t NumHits() const { return m_NumHits; }
+	size_t NumMisses() const { return m_NumMisses; }
+
+private:
+	typedef std::list<std::pair<std::string, CStmtPtr>> CEntryList;
+
+	size_t m_Capacity;
+	// most recently used statement first
+	CEntryList m_Entries;
+	std::unordered_map<std::string, typename CEntryList::iterator> m_Index;
+	size_t m_NumHits = 0;
+	size_t m_NumMisses = 0;
+};
+
+#endif // ENGINE_SERVER_DATABASES_STATEMENT_CACHE_H
@@ -216,7 +216,10 @@ void CServer::CClient::Reset()
 	mem_zero(&m_LatestInput, sizeof(m_LatestInput));
 
 	m_Snapshots.PurgeAll();
+	m_SnapBudget.Reset();
 	m_LastAckedSnapshot = -1;
+	m_NumAckedSnapshots = 0;
+	m_LastDeltaTick = -1;
 	m_LastInputTick = -1;
 	m_SnapRate = CClient::SNAPRATE_INIT;
 	m_Score = -1;
@@ -225,6 +228,39 @@ void CServer::CClient::Reset()
 	m_RedirectDropTime = 0;
 }
 
+void CServer::CClient::AckSnapshot(int Tick)
+{
+	m_LastAckedSnapshot = Tick;
+	if(Tick <= 0)
+	{
+		// the client lost track of the snapshots and wants a full one
+		m_NumAckedSnapshots = 0;
+		m_LastDeltaTick = -1;
+		return;
+	}
+	m_SnapRate = CClient::SNAPRATE_FULL;
+
+	// acks can arrive out of order, keep the newest ones sorted
+	int i = m_NumAckedSnapshots;
+	while(i > 0 && m_aAckedSnapshots[i - 1] > Tick)
+		i--;
+	if(i > 0 && m_aAckedSnapshots[i - 1] == Tick)
+		return;
+	if(m_NumAckedSnapshots == MAX_ACKED_SNAPSHOTS)
+	{
+		if(i == 0)
+			return;
+		mem_move(&m_aAckedSnapshots[0], &m_aAckedSnapshots[1], (i - 1) * sizeof(int));
+		i--;
+	}
+	else
+	{
+		mem_move(&m_aAckedSnapshots[i + 1], &m_aAckedSnapshots[i], (m_NumAckedSnapshots - i) * sizeof(int));
+		m_NumAckedSnapshots++;
+	}
+	m_aAckedSnapshots[i] = Tick;
+}
+
 CServer::CServer()
 {
 	m_pConfig = &g_Config;
@@ -778,6 +814,13 @@ int CServer::GetClientVersion(int ClientId) const
 	return VERSION_NONE;
 }
 
+float CServer::SnapViewScale(int ClientId) const
+{
+	if(ClientId == SERVER_DEMO_CLIENT || !Config()->m_SvSnapBudget)
+		return 1.0f;
+	return m_aClients[ClientId].m_SnapBudget.ViewScale();
+}
+
 static inline bool RepackMsg(const CMsgPacker *pMsg, CPacker &Packer, bool Sixup)
 {
 	int MsgId = pMsg->m_MsgId;
@@ -961,6 +1004,10 @@ void CServer::DoSnapshot()
 		if(m_aClients[i].m_SnapRate == CClient::SNAPRATE_INIT && (Tick() % 10) != 0)
 			continue;
 
+		// this client's link is congested, send fewer snapshots
+		if(Config()->m_SvSnapBudget && m_aClients[i].m_SnapRate == CClient::SNAPRATE_FULL && !m_aClients[i].m_SnapBudget.ShouldSnap())
+			continue;
+
 		{
 			m_SnapshotBuilder.Init(m_aClients[i].m_Sixup);
 
@@ -986,26 +1033,43 @@ void CServer::DoSnapshot()
 			// save the snapshot
 			m_aClients[i].m_Snapshots.Add(m_CurrentGameTick, time_get(), SnapshotSize, pData, 0, nullptr);
 
-			// find snapshot that we can perform delta against
+			m_SnapshotDelta.SetStaticsize(protocol7::NETEVENTTYPE_SOUNDWORLD, m_aClients[i].m_Sixup);
+			m_SnapshotDelta.SetStaticsize(protocol7::NETEVENTTYPE_DAMAGE, m_aClients[i].m_Sixup);
+
+			// create deltas against the newest acked snapshots and keep the
+			// smallest one. the client purges its snapshots only up to the
+			// delta base of the newest snapshot it got, so it still has all
+			// acked snapshots that are not older than the last delta base.
 			int DeltaTick = -1;
-			const CSnapshot *pDeltashot = CSnapshot::EmptySnapshot();
+			int DeltaSize = 0;
+			char aaDeltaData[2][CSnapshot::MAX_SIZE];
+			int BestDelta = 0;
+			for(int Acked = m_aClients[i].m_NumAckedSnapshots - 1, NumBases = 0; Acked >= 0 && NumBases < Config()->m_SvSnapDeltaBases; Acked--, NumBases++)
 			{
-				int DeltashotSize = m_aClients[i].m_Snapshots.Get(m_aClients[i].m_LastAckedSnapshot, nullptr, &pDeltashot, nullptr);
-				if(DeltashotSize >= 0)
-					DeltaTick = m_aClients[i].m_LastAckedSnapshot;
-				else
+				const int BaseTick = m_aClients[i].m_aAckedSnapshots[Acked];
+				const CSnapshot *pDeltashot;
+				if(BaseTick < m_aClients[i].m_LastDeltaTick || m_aClients[i].m_Snapshots.Get(BaseTick, nullptr, &pDeltashot, nullptr) < 0)
+					break;
+				const int Delta = DeltaTick < 0 ? BestDelta : 1 - BestDelta;
+				const int Size = m_SnapshotDelta.CreateDelta(pDeltashot, pData, aaDeltaData[Delta]);
+				if(DeltaTick < 0 || Size < DeltaSize)
 				{
-					// no acked package found, force client to recover rate
-					if(m_aClients[i].m_SnapRate == CClient::SNAPRATE_FULL)
-						m_aClients[i].m_SnapRate = CClient::SNAPRATE_RECOVER;
+					DeltaTick = BaseTick;
+					DeltaSize = Size;
+					BestDelta = Delta;
 				}
 			}
 
-			// create delta
-			m_SnapshotDelta.SetStaticsize(protocol7::NETEVENTTYPE_SOUNDWORLD, m_aClients[i].m_Sixup);
-			m_SnapshotDelta.SetStaticsize(protocol7::NETEVENTTYPE_DAMAGE, m_aClients[i].m_Sixup);
-			char aDeltaData[CSnapshot::MAX_SIZE];
-			int DeltaSize = m_SnapshotDelta.CreateDelta(pDeltashot, pData, aDeltaData);
+			if(DeltaTick >= 0)
+				m_aClients[i].m_LastDeltaTick = DeltaTick;
+			else
+			{
+				// no acked package found, force client to recover rate
+				if(m_aClients[i].m_SnapRate == CClient::SNAPRATE_FULL)
+					m_aClients[i].m_SnapRate = CClient::SNAPRATE_RECOVER;
+				DeltaSize = m_SnapshotDelta.CreateDelta(CSnapshot::EmptySnapshot(), pData, aaDeltaData[BestDelta]);
+			}
+			const char *pDeltaData = aaDeltaData[BestDelta];
 
 			if(DeltaSize)
 			{
@@ -1013,8 +1077,9 @@ void CServer::DoSnapshot()
 				const int MaxSize = MAX_SNAPSHOT_PACKSIZE;
 
 				char aCompData[CSnapshot::MAX_SIZE];
-				SnapshotSize = CVariableInt::Compress(aDeltaData, DeltaSize, aCompData, sizeof(aCompData));
+				SnapshotSize = CVariableInt::Compress(pDeltaData, DeltaSize, aCompData, sizeof(aCompData));
 				int NumPackets = (SnapshotSize + MaxSize - 1) / MaxSize;
+				m_aClients[i].m_SnapBudget.OnSnap(m_CurrentGameTick, SnapshotSize, NumPackets);
 
 				for(int n = 0, Left = SnapshotSize; Left > 0; n++)
 				{
@@ -1051,7 +1116,11 @@ void CServer::DoSnapshot()
 				Msg.AddInt(m_CurrentGameTick);
 				Msg.AddInt(m_CurrentGameTick - DeltaTick);
 				SendMsg(&Msg, MSGFLAG_FLUSH, i);
+				m_aClients[i].m_SnapBudget.OnSnap(m_CurrentGameTick, 0, 1);
 			}
+
+			if(Config()->m_SvSnapBudget)
+				m_aClients[i].m_SnapBudget.Adapt(m_CurrentGameTick, TickSpeed());
 		}
 	}
 
@@ -1792,13 +1861,14 @@ void CServer::ProcessClientPacket(CNetChunk *pPacket)
 				return;
 			}
 
-			m_aClients[ClientId].m_LastAckedSnapshot = LastAckedSnapshot;
-			if(m_aClients[ClientId].m_LastAckedSnapshot > 0)
-				m_aClients[ClientId].m_SnapRate = CClient::SNAPRATE_FULL;
+			m_aClients[ClientId].AckSnapshot(LastAckedSnapshot);
 
 			int64_t TagTime;
 			if(m_aClients[ClientId].m_Snapshots.Get(m_aClients[ClientId].m_LastAckedSnapshot, &TagTime, nullptr, nullptr) >= 0)
+			{
 				m_aClients[ClientId].m_Latency = (int)(((time_get() - TagTime) * 1000) / time_freq());
+				m_aClients[ClientId].m_SnapBudget.OnAck(m_aClients[ClientId].m_LastAckedSnapshot, m_aClients[ClientId].m_Latency);
+			}
 
 			// add message to report the input timing
 			// skip packets that are old
@@ -2067,29 +2137,104 @@ static inline int GetCacheIndex(int Type, bool SendClient)
 	return Type * 2 + SendClient;
 }
 
-CServer::CCache::CCache()
+void CServer::CCache::AddChunk(const void *pData, int Size)
 {
-	m_vCache.clear();
+	if(m_NumChunks == (int)m_vCache.size())
+		m_vCache.emplace_back();
+	m_vCache[m_NumChunks].m_vData.assign((const uint8_t *)pData, (const uint8_t *)pData + Size);
+	m_NumChunks++;
 }
 
-CServer::CCache::~CCache()
+void CServer::CCache::Clear()
 {
-	Clear();
+	m_NumChunks = 0;
 }
 
-CServer::CCache::CCacheChunk::CCacheChunk(const void *pData, int Size)
+const CServer::CServerInfoClient &CServer::ServerInfoClient(int ClientId)
 {
-	m_vData.assign((const uint8_t *)pData, (const uint8_t *)pData + Size);
+	CServerInfoClient &Info = m_aServerInfoClients[ClientId];
+	const char *pName = ClientName(ClientId);
+	const char *pClan = ClientClan(ClientId);
+	const int Country = m_aClients[ClientId].m_Country;
+	const std::optional<int> Score = m_aClients[ClientId].m_Score;
+	const bool IsPlayer = GameServer()->IsClientPlayer(ClientId);
+	if(Info.m_Valid && Info.m_Country == Country && Info.m_Score == Score && Info.m_IsPlayer == IsPlayer &&
+		str_comp(Info.m_aName, pName) == 0 && str_comp(Info.m_aClan, pClan) == 0)
+	{
+		return Info;
+	}
+
+	Info.m_Valid = true;
+	str_copy(Info.m_aName, pName);
+	str_copy(Info.m_aClan, pClan);
+	Info.m_Country = Country;
+	Info.m_Score = Score;
+	Info.m_IsPlayer = IsPlayer;
+
+	CPacker p;
+	char aBuf[16];
+	p.Reset();
+	p.AddString(pName, MAX_NAME_LENGTH); // client name
+	p.AddString(pClan, MAX_CLAN_LENGTH); // client clan
+	str_format(aBuf, sizeof(aBuf), "%d", Country);
+	p.AddString(aBuf, 0); // client country (ISO 3166-1 numeric)
+
+	int ScoreValue;
+	if(Score.has_value())
+	{
+		ScoreValue = Score.value();
+		if(ScoreValue == 9999)
+			ScoreValue = -10000;
+		else if(ScoreValue == 0) // 0 time isn't displayed otherwise.
+			ScoreValue = -1;
+		else
+			ScoreValue = -ScoreValue;
+	}
+	else
+	{
+		ScoreValue = -9999;
+	}
+	str_format(aBuf, sizeof(aBuf), "%d", ScoreValue);
+	p.AddString(aBuf, 0); // client score
+	p.AddString(IsPlayer ? "1" : "0", 0); // is player?
+	dbg_assert(!p.Error() && p.Size() <= (int)sizeof(Info.m_aData), "server info client entry too large");
+	mem_copy(Info.m_aData, p.Data(), p.Size());
+	Info.m_DataSize = p.Size();
+
+	p.Reset();
+	p.AddString(pName, MAX_NAME_LENGTH); // client name
+	p.AddString(pClan, MAX_CLAN_LENGTH); // client clan
+	p.AddInt(Country); // client country (ISO 3166-1 numeric)
+	p.AddInt(Score.value_or(-1)); // client score
+	p.AddInt(IsPlayer ? 0 : 1); // flag spectator=1, bot=2 (player=0)
+	dbg_assert(!p.Error() && p.Size() <= (int)sizeof(Info.m_aDataSixup), "server info client entry too large");
+	mem_copy(Info.m_aDataSixup, p.Data(), p.Size());
+	Info.m_DataSizeSixup = p.Size();
+
+	return Info;
 }
 
-void CServer::CCache::AddChunk(const void *pData, int Size)
+CServer::CCache *CServer::ServerInfoCache(int Type, bool SendClients)
 {
-	m_vCache.emplace_back(pData, Size);
+	const int Index = GetCacheIndex(Type, SendClients);
+	CCache *pCache = &m_aServerInfoCache[Index];
+	if(pCache->m_Dirty)
+	{
+		CacheServerInfo(pCache, Index / 2, SendClients);
+		pCache->m_Dirty = false;
+	}
+	return pCache;
 }
 
-void CServer::CCache::Clear()
+CServer::CCache *CServer::ServerInfoCacheSixup(bool SendClients)
 {
-	m_vCache.clear();
+	CCache *pCache = &m_aSixupServerInfoCache[SendClients];
+	if(pCache->m_Dirty)
+	{
+		CacheServerInfoSixup(pCache, SendClients, MAX_CLIENTS);
+		pCache->m_Dirty = false;
+	}
+	return pCache;
 }
 
 void CServer::CacheServerInfo(CCache *pCache, int Type, bool SendClients)
@@ -2256,29 +2401,8 @@ void CServer::CacheServerInfo(CCache *pCache, int Type, bool SendClients)
 
 			int PreviousSize = q.Size();
 
-			q.AddString(ClientName(i), MAX_NAME_LENGTH); // client name
-			q.AddString(ClientClan(i), MAX_CLAN_LENGTH); // client clan
-
-			ADD_INT(q, m_aClients[i].m_Country); // client country (ISO 3166-1 numeric)
-
-			int Score;
-			if(m_aClients[i].m_Score.has_value())
-			{
-				Score = m_aClients[i].m_Score.value();
-				if(Score == 9999)
-					Score = -10000;
-				else if(Score == 0) // 0 time isn't displayed otherwise.
-					Score = -1;
-				else
-					Score = -Score;
-			}
-			else
-			{
-				Score = -9999;
-			}
-
-			ADD_INT(q, Score); // client score
-			ADD_INT(q, GameServer()->IsClientPlayer(i) ? 1 : 0); // is player?
+			const CServerInfoClient &Info = ServerInfoClient(i);
+			q.AddRaw(Info.m_aData, Info.m_DataSize);
 			if(Type == SERVERINFO_EXTENDED)
 				q.AddString("", 0); // extra info, reserved
 
@@ -2369,11 +2493,8 @@ void CServer::CacheServerInfoSixup(CCache *pCache, bool SendClients, int MaxCons
 		{
 			if(m_aClients[i].IncludedInServerInfo())
 			{
-				Packer.AddString(ClientName(i), MAX_NAME_LENGTH); // client name
-				Packer.AddString(ClientClan(i), MAX_CLAN_LENGTH); // client clan
-				Packer.AddInt(m_aClients[i].m_Country); // client country (ISO 3166-1 numeric)
-				Packer.AddInt(m_aClients[i].m_Score.value_or(-1)); // client score
-				Packer.AddInt(GameServer()->IsClientPlayer(i) ? 0 : 1); // flag spectator=1, bot=2 (player=0)
+				const CServerInfoClient &Info = ServerInfoClient(i);
+				Packer.AddRaw(Info.m_aDataSixup, Info.m_DataSizeSixup);
 
 				const int MaxPacketSize = NET_MAX_PAYLOAD - 128;
 				if(MaxConsideredClients == MAX_CLIENTS)
@@ -2404,7 +2525,7 @@ void CServer::SendServerInfo(const NETADDR *pAddr, int Token, int Type, bool Sen
 	char aBuf[128];
 	p.Reset();
 
-	CCache *pCache = &m_aServerInfoCache[GetCacheIndex(Type, SendClients)];
+	const CCache *pCache = ServerInfoCache(Type, SendClients);
 
 #define ADD_RAW(p, x) (p).AddRaw(x, sizeof(x))
 #define ADD_INT(p, x) \
@@ -2419,12 +2540,13 @@ void CServer::SendServerInfo(const NETADDR *pAddr, int Token, int Type, bool Sen
 	Packet.m_Address = *pAddr;
 	Packet.m_Flags = NETSENDFLAG_CONNLESS;
 
-	for(const auto &Chunk : pCache->m_vCache)
+	for(int i = 0; i < pCache->m_NumChunks; i++)
 	{
+		const CCache::CCacheChunk &Chunk = pCache->m_vCache[i];
 		p.Reset();
 		if(Type == SERVERINFO_EXTENDED)
 		{
-			if(&Chunk == &pCache->m_vCache.front())
+			if(i == 0)
 				p.AddRaw(SERVERBROWSE_INFO_EXTENDED, sizeof(SERVERBROWSE_INFO_EXTENDED));
 			else
 				p.AddRaw(SERVERBROWSE_INFO_EXTENDED_MORE, sizeof(SERVERBROWSE_INFO_EXTENDED_MORE));
@@ -2463,7 +2585,7 @@ void CServer::GetServerInfoSixup(CPacker *pPacker, int Token, bool SendClients)
 
 	SendClients = SendClients && Token != -1;
 
-	CCache::CCacheChunk &FirstChunk = m_aSixupServerInfoCache[SendClients].m_vCache.front();
+	const CCache::CCacheChunk &FirstChunk = ServerInfoCacheSixup(SendClients)->m_vCache.front();
 	pPacker->AddRaw(FirstChunk.m_vData.data(), FirstChunk.m_vData.size());
 }
 
@@ -2598,12 +2720,12 @@ void CServer::UpdateServerInfo(bool Resend)
 
 	UpdateRegisterServerInfo();
 
-	for(int i = 0; i < 3; i++)
-		for(int j = 0; j < 2; j++)
-			CacheServerInfo(&m_aServerInfoCache[i * 2 + j], i, j);
-
-	for(int i = 0; i < 2; i++)
-		CacheServerInfoSixup(&m_aSixupServerInfoCache[i], i, MAX_CLIENTS);
+	// the caches are rebuilt when they are requested the next time, most
+	// of them are not needed between two updates
+	for(auto &Cache : m_aServerInfoCache)
+		Cache.m_Dirty = true;
+	for(auto &Cache : m_aSixupServerInfoCache)
+		Cache.m_Dirty = true;
 
 	if(Resend)
 	{
@@ -2741,45 +2863,111 @@ void CServer::ReloadMap()
 	m_SameMapReload = true;
 }
 
-int CServer::LoadMap(const char *pMapName)
+CServer::CMapLoad::~CMapLoad()
 {
-	m_MapReload = false;
-	m_SameMapReload = false;
+	for(auto &pData : m_apData)
+		free(pData);
+}
 
-	char aBuf[IO_MAX_PATH_LENGTH];
-	str_format(aBuf, sizeof(aBuf), "maps/%s.map", pMapName);
-	GameServer()->OnMapChange(aBuf, sizeof(aBuf));
+class CServer::CMapLoadJob : public IJob
+{
+	CServer *m_pServer;
+	bool m_Success = false;
 
-	if(!m_pMap->Load(aBuf))
-		return 0;
+	void Run() override
+	{
+		m_Success = m_pServer->PrepareMap(&m_Load);
+	}
+
+public:
+	CMapLoad m_Load;
+
+	CMapLoadJob(CServer *pServer, const char *pMapName, bool SameMapReload, bool Sixup) :
+		m_pServer(pServer)
+	{
+		str_copy(m_Load.m_aName, pMapName);
+		m_Load.m_SameMapReload = SameMapReload;
+		m_Load.m_Sixup = Sixup;
+	}
+
+	bool Success() const { return m_Success; }
+};
+
+bool CServer::PrepareMap(CMapLoad *pLoad)
+{
+	str_format(pLoad->m_aPath, sizeof(pLoad->m_aPath), "maps/%s.map", pLoad->m_aName);
+	// the map config is merged into a temporary copy of the map, which is
+	// not needed anymore once the map is read
+	const bool Tempfile = GameServer()->OnMapChange(pLoad->m_aName, pLoad->m_aPath, sizeof(pLoad->m_aPath));
+	const bool Success = ReadMap(pLoad);
+	if(Tempfile)
+		Storage()->RemoveFile(pLoad->m_aPath, IStorage::TYPE_SAVE);
+	return Success;
+}
+
+bool CServer::ReadMap(CMapLoad *pLoad)
+{
+	// the file is read once, the data is sent to clients that download the
+	// map and the map is loaded from it, so it does not read the file again
+	void *pData;
+	if(!Storage()->ReadFile(pLoad->m_aPath, IStorage::TYPE_ALL, &pData, &pLoad->m_aSize[MAP_TYPE_SIX]))
+		return false;
+	pLoad->m_apData[MAP_TYPE_SIX] = (unsigned char *)pData;
+	pLoad->m_aSha256[MAP_TYPE_SIX] = sha256(pData, pLoad->m_aSize[MAP_TYPE_SIX]);
+	pLoad->m_aCrc[MAP_TYPE_SIX] = crc32(0, pLoad->m_apData[MAP_TYPE_SIX], pLoad->m_aSize[MAP_TYPE_SIX]);
+
+	if(!m_pMap->Prepare(pLoad->m_aPath, pLoad->m_apData[MAP_TYPE_SIX], pLoad->m_aSize[MAP_TYPE_SIX], &pLoad->m_aSha256[MAP_TYPE_SIX], pLoad->m_aCrc[MAP_TYPE_SIX]))
+		return false;
+
+	// load sixup version of the map
+	if(pLoad->m_Sixup)
+	{
+		char aBuf[IO_MAX_PATH_LENGTH];
+		str_format(aBuf, sizeof(aBuf), "maps7/%s.map", pLoad->m_aName);
+		if(!Storage()->ReadFile(aBuf, IStorage::TYPE_ALL, &pData, &pLoad->m_aSize[MAP_TYPE_SIXUP]))
+		{
+			pLoad->m_SixupFailed = true;
+		}
+		else
+		{
+			pLoad->m_apData[MAP_TYPE_SIXUP] = (unsigned char *)pData;
+			pLoad->m_aSha256[MAP_TYPE_SIXUP] = sha256(pData, pLoad->m_aSize[MAP_TYPE_SIXUP]);
+			pLoad->m_aCrc[MAP_TYPE_SIXUP] = crc32(0, pLoad->m_apData[MAP_TYPE_SIXUP], pLoad->m_aSize[MAP_TYPE_SIXUP]);
+		}
+	}
+	return true;
+}
+
+void CServer::ApplyMap(CMapLoad *pLoad)
+{
+	m_pMap->SwapPrepared();
 
 	// reinit snapshot ids
 	m_IdPool.TimeoutIds();
 
 	// get the crc of the map
-	m_aCurrentMapSha256[MAP_TYPE_SIX] = m_pMap->Sha256();
-	m_aCurrentMapCrc[MAP_TYPE_SIX] = m_pMap->Crc();
+	m_aCurrentMapSha256[MAP_TYPE_SIX] = pLoad->m_aSha256[MAP_TYPE_SIX];
+	m_aCurrentMapCrc[MAP_TYPE_SIX] = pLoad->m_aCrc[MAP_TYPE_SIX];
 	char aBufMsg[256];
 	char aSha256[SHA256_MAXSTRSIZE];
 	sha256_str(m_aCurrentMapSha256[MAP_TYPE_SIX], aSha256, sizeof(aSha256));
-	str_format(aBufMsg, sizeof(aBufMsg), "%s sha256 is %s", aBuf, aSha256);
+	str_format(aBufMsg, sizeof(aBufMsg), "%s sha256 is %s", pLoad->m_aPath, aSha256);
 	Console()->Print(IConsole::OUTPUT_LEVEL_ADDINFO, "server", aBufMsg);
 
-	str_copy(m_aCurrentMap, pMapName);
+	str_copy(m_aCurrentMap, pLoad->m_aName);
 	m_pCurrentMapName = fs_filename(m_aCurrentMap);
 
-	// load complete map into memory for download
-	{
-		free(m_apCurrentMapData[MAP_TYPE_SIX]);
-		void *pData;
-		Storage()->ReadFile(aBuf, IStorage::TYPE_ALL, &pData, &m_aCurrentMapSize[MAP_TYPE_SIX]);
-		m_apCurrentMapData[MAP_TYPE_SIX] = (unsigned char *)pData;
-	}
+	// complete map in memory for download
+	free(m_apCurrentMapData[MAP_TYPE_SIX]);
+	m_apCurrentMapData[MAP_TYPE_SIX] = pLoad->m_apData[MAP_TYPE_SIX];
+	m_aCurrentMapSize[MAP_TYPE_SIX] = pLoad->m_aSize[MAP_TYPE_SIX];
+	pLoad->m_apData[MAP_TYPE_SIX] = nullptr;
 
 	if(Config()->m_SvMapsBaseUrl[0])
 	{
+		char aBuf[256];
 		char aEscaped[256];
-		str_format(aBuf, sizeof(aBuf), "%s_%s.map", pMapName, aSha256);
+		str_format(aBuf, sizeof(aBuf), "%s_%s.map", pLoad->m_aName, aSha256);
 		EscapeUrl(aEscaped, aBuf);
 		str_format(m_aMapDownloadUrl, sizeof(m_aMapDownloadUrl), "%s%s", Config()->m_SvMapsBaseUrl, aEscaped);
 	}
@@ -2788,33 +2976,38 @@ int CServer::LoadMap(const char *pMapName)
 		m_aMapDownloadUrl[0] = '\0';
 	}
 
-	// load sixup version of the map
-	if(Config()->m_SvSixup)
+	// sixup version of the map
+	if(pLoad->m_Sixup && Config()->m_SvSixup)
 	{
-		str_format(aBuf, sizeof(aBuf), "maps7/%s.map", pMapName);
-		void *pData;
-		if(!Storage()->ReadFile(aBuf, IStorage::TYPE_ALL, &pData, &m_aCurrentMapSize[MAP_TYPE_SIXUP]))
+		if(pLoad->m_SixupFailed)
 		{
 			Config()->m_SvSixup = 0;
 			if(m_pRegister)
 			{
 				m_pRegister->OnConfigChange();
 			}
-			log_error("sixup", "couldn't load map %s", aBuf);
+			log_error("sixup", "couldn't load map maps7/%s.map", pLoad->m_aName);
 			log_info("sixup", "disabling 0.7 compatibility");
 		}
 		else
 		{
 			free(m_apCurrentMapData[MAP_TYPE_SIXUP]);
-			m_apCurrentMapData[MAP_TYPE_SIXUP] = (unsigned char *)pData;
+			m_apCurrentMapData[MAP_TYPE_SIXUP] = pLoad->m_apData[MAP_TYPE_SIXUP];
+			m_aCurrentMapSize[MAP_TYPE_SIXUP] = pLoad->m_aSize[MAP_TYPE_SIXUP];
+			pLoad->m_apData[MAP_TYPE_SIXUP] = nullptr;
 
-			m_aCurrentMapSha256[MAP_TYPE_SIXUP] = sha256(m_apCurrentMapData[MAP_TYPE_SIXUP], m_aCurrentMapSize[MAP_TYPE_SIXUP]);
-			m_aCurrentMapCrc[MAP_TYPE_SIXUP] = crc32(0, m_apCurrentMapData[MAP_TYPE_SIXUP], m_aCurrentMapSize[MAP_TYPE_SIXUP]);
+			m_aCurrentMapSha256[MAP_TYPE_SIXUP] = pLoad->m_aSha256[MAP_TYPE_SIXUP];
+			m_aCurrentMapCrc[MAP_TYPE_SIXUP] = pLoad->m_aCrc[MAP_TYPE_SIXUP];
 			sha256_str(m_aCurrentMapSha256[MAP_TYPE_SIXUP], aSha256, sizeof(aSha256));
-			str_format(aBufMsg, sizeof(aBufMsg), "%s sha256 is %s", aBuf, aSha256);
+			str_format(aBufMsg, sizeof(aBufMsg), "maps7/%s.map sha256 is %s", pLoad->m_aName, aSha256);
 			Console()->Print(IConsole::OUTPUT_LEVEL_ADDINFO, "sixup", aBufMsg);
 		}
 	}
+	else if(Config()->m_SvSixup)
+	{
+		// sv_sixup was enabled while the map was loading
+		m_MapReload = true;
+	}
 	if(!Config()->m_SvSixup)
 	{
 		free(m_apCurrentMapData[MAP_TYPE_SIXUP]);
@@ -2823,7 +3016,19 @@ int CServer::LoadMap(const char *pMapName)
 
 	for(int i = 0; i < MAX_CLIENTS; i++)
 		m_aPrevStates[i] = m_aClients[i].m_State;
+}
 
+int CServer::LoadMap(const char *pMapName)
+{
+	m_MapReload = false;
+	m_SameMapReload = false;
+
+	CMapLoad Load;
+	str_copy(Load.m_aName, pMapName);
+	Load.m_Sixup = Config()->m_SvSixup;
+	if(!PrepareMap(&Load))
+		return 0;
+	ApplyMap(&Load);
 	return 1;
 }
 
@@ -2840,32 +3045,9 @@ void CServer::UpdateDebugDummies(bool ForceDisconnect)
 		CClient &Client = m_aClients[ClientId];
 		if(AddDummy && m_aClients[ClientId].m_State == CClient::STATE_EMPTY)
 		{
-			NewClientCallback(ClientId, this, false);
-			Client.m_DebugDummy = true;
-
-			// See https://en.wikipedia.org/wiki/Unique_local_address
-			Client.m_DebugDummyAddr.type = NETTYPE_IPV6;
-			Client.m_DebugDummyAddr.ip[0] = 0xfd;
-			// Global ID (40 bits): random
-			secure_random_fill(&Client.m_DebugDummyAddr.ip[1], 5);
-			// Subnet ID (16 bits): constant
-			Client.m_DebugDummyAddr.ip[6] = 0xc0;
-			Client.m_DebugDummyAddr.ip[7] = 0xde;
-			// Interface ID (64 bits): set to client ID
-			Client.m_DebugDummyAddr.ip[8] = 0x00;
-			Client.m_DebugDummyAddr.ip[9] = 0x00;
-			Client.m_DebugDummyAddr.ip[10] = 0x00;
-			Client.m_DebugDummyAddr.ip[11] = 0x00;
-			uint_to_bytes_be(&Client.m_DebugDummyAddr.ip[12], ClientId);
-			// Port: random like normal clients
-			Client.m_DebugDummyAddr.port = (secure_rand() % (65535 - 1024)) + 1024;
-			net_addr_str(&Client.m_DebugDummyAddr, Client.m_aDebugDummyAddrString.data(), Client.m_aDebugDummyAddrString.size(), true);
-			net_addr_str(&Client.m_DebugDummyAddr, Client.m_aDebugDummyAddrStringNoPort.data(), Client.m_aDebugDummyAddrStringNoPort.size(), false);
-
-			GameServer()->OnClientConnected(ClientId, nullptr);
-			Client.m_State = CClient::STATE_INGAME;
-			str_format(Client.m_aName, sizeof(Client.m_aName), "Debug dummy %d", DummyIndex + 1);
-			GameServer()->OnClientEnter(ClientId);
+			char aName[MAX_NAME_LENGTH];
+			str_format(aName, sizeof(aName), "Debug dummy %d", DummyIndex + 1);
+			AddDebugDummy(ClientId, aName);
 		}
 		else if(!AddDummy && Client.m_DebugDummy)
 		{
@@ -2876,16 +3058,100 @@ void CServer::UpdateDebugDummies(bool ForceDisconnect)
 		{
 			CNetObj_PlayerInput Input = {0};
 			Input.m_Direction = (ClientId & 1) ? -1 : 1;
-			Client.m_aInputs[0].m_GameTick = Tick() + 1;
-			mem_copy(Client.m_aInputs[0].m_aData, &Input, minimum(sizeof(Input), sizeof(Client.m_aInputs[0].m_aData)));
-			Client.m_LatestInput = Client.m_aInputs[0];
-			Client.m_CurrentInput = 0;
+			SetDebugDummyInput(ClientId, &Input);
 		}
 	}
 
 	m_PreviousDebugDummies = ForceDisconnect ? 0 : g_Config.m_DbgDummies;
 }
 
+void CServer::AddDebugDummy(int ClientId, const char *pName)
+{
+	CClient &Client = m_aClients[ClientId];
+	NewClientCallback(ClientId, this, false);
+	Client.m_DebugDummy = true;
+
+	// See https://en.wikipedia.org/wiki/Unique_local_address
+	Client.m_DebugDummyAddr.type = NETTYPE_IPV6;
+	Client.m_DebugDummyAddr.ip[0] = 0xfd;
+	// Global ID (40 bits): random
+	secure_random_fill(&Client.m_DebugDummyAddr.ip[1], 5);
+	// Subnet ID (16 bits): constant
+	Client.m_DebugDummyAddr.ip[6] = 0xc0;
+	Client.m_DebugDummyAddr.ip[7] = 0xde;
+	// Interface ID (64 bits): set to client ID
+	Client.m_DebugDummyAddr.ip[8] = 0x00;
+	Client.m_DebugDummyAddr.ip[9] = 0x00;
+	Client.m_DebugDummyAddr.ip[10] = 0x00;
+	Client.m_DebugDummyAddr.ip[11] = 0x00;
+	uint_to_bytes_be(&Client.m_DebugDummyAddr.ip[12], ClientId);
+	// Port: random like normal clients
+	Client.m_DebugDummyAddr.port = (secure_rand() % (65535 - 1024)) + 1024;
+	net_addr_str(&Client.m_DebugDummyAddr, Client.m_aDebugDummyAddrString.data(), Client.m_aDebugDummyAddrString.size(), true);
+	net_addr_str(&Client.m_DebugDummyAddr, Client.m_aDebugDummyAddrStringNoPort.data(), Client.m_aDebugDummyAddrStringNoPort.size(), false);
+
+	GameServer()->OnClientConnected(ClientId, nullptr);
+	Client.m_State = CClient::STATE_INGAME;
+	str_copy(Client.m_aName, pName);
+	GameServer()->OnClientEnter(ClientId);
+}
+
+void CServer::SetDebugDummyInput(int ClientId, const CNetObj_PlayerInput *pInput)
+{
+	CClient &Client = m_aClients[ClientId];
+	Client.m_aInputs[0].m_GameTick = Tick() + 1;
+	mem_copy(Client.m_aInputs[0].m_aData, pInput, minimum(sizeof(*pInput), sizeof(Client.m_aInputs[0].m_aData)));
+	Client.m_LatestInput = Client.m_aInputs[0];
+	Client.m_CurrentInput = 0;
+}
+
+void CServer::GameTick()
+{
+	GameServer()->OnPreTickTeehistorian();
+
+	UpdateDebugDummies(false);
+
+	for(int c = 0; c < MAX_CLIENTS; c++)
+	{
+		if(m_aClients[c].m_State != CClient::STATE_INGAME)
+			continue;
+		bool ClientHadInput = false;
+		for(auto &Input : m_aClients[c].m_aInputs)
+		{
+			if(Input.m_GameTick == Tick() + 1)
+			{
+				GameServer()->OnClientPredictedEarlyInput(c, Input.m_aData);
+				ClientHadInput = true;
+			}
+		}
+		if(!ClientHadInput)
+			GameServer()->OnClientPredictedEarlyInput(c, nullptr);
+	}
+
+	m_CurrentGameTick++;
+
+	// apply new input
+	for(int c = 0; c < MAX_CLIENTS; c++)
+	{
+		if(m_aClients[c].m_State != CClient::STATE_INGAME)
+			continue;
+		bool ClientHadInput = false;
+		for(auto &Input : m_aClients[c].m_aInputs)
+		{
+			if(Input.m_GameTick == Tick())
+			{
+				GameServer()->OnClientPredictedInput(c, Input.m_aData);
+				ClientHadInput = true;
+				break;
+			}
+		}
+		if(!ClientHadInput)
+			GameServer()->OnClientPredictedInput(c, nullptr);
+	}
+
+	GameServer()->OnTick();
+}
+
 int CServer::Run()
 {
 	if(m_RunServer == UNINITIALIZED)
@@ -3025,14 +3291,28 @@ int CServer::Run()
 			int64_t t = time_get();
 			int NewTicks = 0;
 
-			// load new map
-			if(m_MapReload || m_SameMapReload || m_CurrentGameTick >= MAX_TICK) // force reload to make sure the ticks stay within a valid range
+			// load new map on a worker thread, the game continues until it is ready
+			if((m_MapReload || m_SameMapReload || m_CurrentGameTick >= MAX_TICK) && !m_pMapLoadJob) // force reload to make sure the ticks stay within a valid range
 			{
-				const bool SameMapReload = m_SameMapReload;
-				// load map
-				if(LoadMap(Config()->m_SvMap))
+				m_pMapLoadJob = std::make_shared<CMapLoadJob>(this, Config()->m_SvMap, m_SameMapReload, Config()->m_SvSixup);
+				m_pMapLoadJob->SetPriority(IJob::PRIORITY_INTERACTIVE);
+				m_MapReload = false;
+				m_SameMapReload = false;
+				Engine()->AddJob(m_pMapLoadJob);
+			}
+
+			// switch to the new map
+			if(m_pMapLoadJob && m_pMapLoadJob->Done())
+			{
+				const std::shared_ptr<CMapLoadJob> pMapLoadJob = std::move(m_pMapLoadJob);
+				m_pMapLoadJob = nullptr;
+				const bool SameMapReload = pMapLoadJob->m_Load.m_SameMapReload;
+				if(pMapLoadJob->Success())
 				{
 					// new map loaded
+					ApplyMap(&pMapLoadJob->m_Load);
+					// sv_map might have been changed while loading
+					m_MapReload |= str_comp(Config()->m_SvMap, m_aCurrentMap) != 0;
 
 					// ask the game for the data it wants to persist past a map change
 					for(int i = 0; i < MAX_CLIENTS; i++)
@@ -3086,58 +3366,17 @@ int CServer::Run()
 				}
 				else
 				{
-					str_format(aBuf, sizeof(aBuf), "failed to load map. mapname='%s'", Config()->m_SvMap);
+					str_format(aBuf, sizeof(aBuf), "failed to load map. mapname='%s'", pMapLoadJob->m_Load.m_aName);
 					Console()->Print(IConsole::OUTPUT_LEVEL_STANDARD, "server", aBuf);
-					str_copy(Config()->m_SvMap, m_aCurrentMap);
+					if(str_comp(Config()->m_SvMap, pMapLoadJob->m_Load.m_aName) == 0)
+						str_copy(Config()->m_SvMap, m_aCurrentMap);
 				}
 			}
 
 			while(t > TickStartTime(m_CurrentGameTick + 1))
 			{
-				GameServer()->OnPreTickTeehistorian();
-
-				UpdateDebugDummies(false);
-
-				for(int c = 0; c < MAX_CLIENTS; c++)
-				{
-					if(m_aClients[c].m_State != CClient::STATE_INGAME)
-						continue;
-					bool ClientHadInput = false;
-					for(auto &Input : m_aClients[c].m_aInputs)
-					{
-						if(Input.m_GameTick == Tick() + 1)
-						{
-							GameServer()->OnClientPredictedEarlyInput(c, Input.m_aData);
-							ClientHadInput = true;
-						}
-					}
-					if(!ClientHadInput)
-						GameServer()->OnClientPredictedEarlyInput(c, nullptr);
-				}
-
-				m_CurrentGameTick++;
+				GameTick();
 				NewTicks++;
-
-				// apply new input
-				for(int c = 0; c < MAX_CLIENTS; c++)
-				{
-					if(m_aClients[c].m_State != CClient::STATE_INGAME)
-						continue;
-					bool ClientHadInput = false;
-					for(auto &Input : m_aClients[c].m_aInputs)
-					{
-						if(Input.m_GameTick == Tick())
-						{
-							GameServer()->OnClientPredictedInput(c, Input.m_aData);
-							ClientHadInput = true;
-							break;
-						}
-					}
-					if(!ClientHadInput)
-						GameServer()->OnClientPredictedInput(c, nullptr);
-				}
-
-				GameServer()->OnTick();
 				if(ErrorShutdown())
 				{
 					break;
@@ -3302,6 +3541,14 @@ int CServer::Run()
 	m_Fifo.Shutdown();
 	Engine()->ShutdownJobs();
 
+	// the map load job is not abortable, so it completed before the job pool
+	// shut down, drop the map that it prepared
+	if(m_pMapLoadJob)
+	{
+		dbg_assert(m_pMapLoadJob->Done(), "map load job still running");
+		m_pMapLoadJob = nullptr;
+	}
+
 	GameServer()->OnShutdown(nullptr);
 	m_pMap->Unload();
 	DbPool()->OnShutdown();
@@ -3369,9 +3616,11 @@ void CServer::ConStatus(IConsole::IResult *pResult, void *pUser)
 			{
 				pClientPrefix = "0.7:";
 			}
-			str_format(aBuf, sizeof(aBuf), "id=%d addr=<{%s}> name='%s' client=%s%d secure=%s flags=%d%s%s",
+			const CSnapBudget &SnapBudget = pThis->m_aClients[i].m_SnapBudget;
+			str_format(aBuf, sizeof(aBuf), "id=%d addr=<{%s}> name='%s' client=%s%d secure=%s flags=%d%s%s snap=%dB fragmented=%d%% lost=%d%% interval=%d view=%d%%",
 				i, pThis->ClientAddrString(i, true), pThis->m_aClients[i].m_aName, pClientPrefix, pThis->m_aClients[i].m_DDNetVersion,
-				pThis->m_NetServer.HasSecurityToken(i) ? "yes" : "no", pThis->m_aClients[i].m_Flags, aDnsblStr, aAuthStr);
+				pThis->m_NetServer.HasSecurityToken(i) ? "yes" : "no", pThis->m_aClients[i].m_Flags, aDnsblStr, aAuthStr,
+				SnapBudget.AverageSize(), SnapBudget.FragmentedPercent(), SnapBudget.LossPercent(), SnapBudget.Interval(), round_to_int(pThis->SnapViewScale(i) * 100.0f));
 		}
 		else
 		{
@@ -25,6 +25,7 @@
 #include "antibot.h"
 #include "authmanager.h"
 #include "name_ban.h"
+#include "snap_budget.h"
 #include "snap_id_pool.h"
 
 #if defined(CONF_UPNP)
@@ -39,6 +40,7 @@ class CPacker;
 class IEngine;
 class IEngineMap;
 class ILogger;
+struct CNetObj_PlayerInput;
 
 class CServerBan : public CNetBan
 {
@@ -97,6 +99,13 @@ public:
 	class CDbConnectionPool *DbPool() { return m_pConnectionPool; }
 	IEngine *Engine() { return m_pEngine; }
 
+	// clients without connection that play with the inputs they are given,
+	// for the debug dummies and headless replays
+	void AddDebugDummy(int ClientId, const char *pName);
+	void SetDebugDummyInput(int ClientId, const CNetObj_PlayerInput *pInput);
+	// advances the game by one tick with the latest inputs of the clients
+	void GameTick();
+
 	enum
 	{
 		MAX_RCONCMD_SEND = 16,
@@ -123,6 +132,8 @@ public:
 			DNSBL_STATE_PENDING,
 			DNSBL_STATE_BLACKLISTED,
 			DNSBL_STATE_WHITELISTED,
+
+			MAX_ACKED_SNAPSHOTS = 8,
 		};
 
 		class CInput
@@ -143,6 +154,13 @@ public:
 		int m_LastAckedSnapshot;
 		int m_LastInputTick;
 		CSnapshotStorage m_Snapshots;
+		CSnapBudget m_SnapBudget;
+
+		// ticks of the newest snapshots the client acknowledged, ascending
+		int m_aAckedSnapshots[MAX_ACKED_SNAPSHOTS];
+		int m_NumAckedSnapshots;
+		// newest delta base used, the client keeps all snapshots from there
+		int m_LastDeltaTick;
 
 		CInput m_LatestInput;
 		CInput m_aInputs[200]; // TODO: handle input better
@@ -177,6 +195,7 @@ public:
 		void *m_pPersistentData;
 
 		void Reset();
+		void AckSnapshot(int Tick);
 
 		// DDRace
 
@@ -262,6 +281,26 @@ public:
 	unsigned int m_aCurrentMapSize[NUM_MAP_TYPES];
 	char m_aMapDownloadUrl[256];
 
+	// A map that was read and hashed on a worker thread, it replaces the
+	// current map at the start of a tick.
+	class CMapLoad
+	{
+	public:
+		~CMapLoad();
+
+		char m_aName[IO_MAX_PATH_LENGTH];
+		char m_aPath[IO_MAX_PATH_LENGTH];
+		bool m_SameMapReload = false;
+		bool m_Sixup = false;
+		bool m_SixupFailed = false;
+		SHA256_DIGEST m_aSha256[NUM_MAP_TYPES];
+		unsigned m_aCrc[NUM_MAP_TYPES] = {0};
+		unsigned char *m_apData[NUM_MAP_TYPES] = {nullptr};
+		unsigned int m_aSize[NUM_MAP_TYPES] = {0};
+	};
+	class CMapLoadJob;
+	std::shared_ptr<CMapLoadJob> m_pMapLoadJob;
+
 	CDemoRecorder m_aDemoRecorder[NUM_RECORDERS];
 	CAuthManager m_AuthManager;
 
@@ -377,17 +416,16 @@ public:
 		class CCacheChunk
 		{
 		public:
-			CCacheChunk(const void *pData, int Size);
-			CCacheChunk(const CCacheChunk &) = delete;
-			CCacheChunk(CCacheChunk &&) = default;
-
 			std::vector<uint8_t> m_vData;
 		};
 
+		// Cleared chunks keep their memory for the next rebuild, only the
+		// first m_NumChunks chunks are part of the cached info.
 		std::vector<CCacheChunk> m_vCache;
-
-		CCache();
-		~CCache();
+		int m_NumChunks = 0;
+		// The info changed since the last rebuild, the cache is rebuilt
+		// the next time it is requested.
+		bool m_Dirty = true;
 
 		void AddChunk(const void *pData, int Size);
 		void Clear();
@@ -396,11 +434,40 @@ public:
 	CCache m_aSixupServerInfoCache[2];
 	bool m_ServerInfoNeedsUpdate;
 
+	// Packed client entry of the server info, only repacked when the
+	// client's info differs from the one it was packed from.
+	class CServerInfoClient
+	{
+	public:
+		enum
+		{
+			MAX_DATA_SIZE = 128,
+		};
+
+		bool m_Valid = false;
+		char m_aName[MAX_NAME_LENGTH];
+		char m_aClan[MAX_CLAN_LENGTH];
+		int m_Country;
+		std::optional<int> m_Score;
+		bool m_IsPlayer;
+
+		// name, clan, country, score and player flag as strings (0.6)
+		unsigned char m_aData[MAX_DATA_SIZE];
+		int m_DataSize;
+		// the same entry with integers (0.7)
+		unsigned char m_aDataSixup[MAX_DATA_SIZE];
+		int m_DataSizeSixup;
+	};
+	CServerInfoClient m_aServerInfoClients[MAX_CLIENTS];
+	const CServerInfoClient &ServerInfoClient(int ClientId);
+
 	void FillAntibot(CAntibotRoundData *pData) override;
 
 	void ExpireServerInfo() override;
 	void CacheServerInfo(CCache *pCache, int Type, bool SendClients);
 	void CacheServerInfoSixup(CCache *pCache, bool SendClients, int MaxConsideredClients);
+	CCache *ServerInfoCache(int Type, bool SendClients);
+	CCache *ServerInfoCacheSixup(bool SendClients);
 	void SendServerInfo(const NETADDR *pAddr, int Token, int Type, bool SendClients);
 	void GetServerInfoSixup(CPacker *pPacker, int Token, bool SendClients);
 	bool RateLimitServerInfoConnless();
@@ -414,6 +481,10 @@ public:
 	const char *GetMapName() const override;
 	void ReloadMap() override;
 	int LoadMap(const char *pMapName);
+	// reads the map files, can be called from any thread
+	bool PrepareMap(CMapLoad *pLoad);
+	bool ReadMap(CMapLoad *pLoad);
+	void ApplyMap(CMapLoad *pLoad);
 
 	void SaveDemo(int ClientId, float Time) override;
 	void StartRecord(int ClientId) override;
@@ -515,6 +586,7 @@ public:
 	void SetErrorShutdown(const char *pReason) override;
 
 	bool IsSixup(int ClientId) const override { return ClientId != SERVER_DEMO_CLIENT && m_aClients[ClientId].m_Sixup; }
+	float SnapViewScale(int ClientId) const override;
 
 	void SetLoggers(std::shared_ptr<ILogger> &&pFileLogger, std::shared_ptr<ILogger> &&pStdoutLogger);
 
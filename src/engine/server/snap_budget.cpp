@@ -0,0 +1,118 @@
+#include "snap_budget.h"
+
+#include <base/math.h>
+
+#include <engine/shared/protocol.h>
+
+// weight of a new sample in the running averages
+static constexpr float SAMPLE_WEIGHT = 1.0f / 16.0f;
+static constexpr float LOSS_HIGH = 0.15f;
+static constexpr float LOSS_LOW = 0.03f;
+// latency above the lowest seen one that counts as queued packets
+static constexpr float QUEUE_LATENCY = 100.0f;
+static constexpr float MIN_VIEW_SCALE = 0.25f;
+// snapshots that are not acknowledged, directly or by a newer one, within this time are lost
+static constexpr int LOSS_TIMEOUT = SERVER_TICK_SPEED / 2;
+
+CSnapBudget::CSnapBudget()
+{
+	Reset();
+}
+
+void CSnapBudget::Reset()
+{
+	m_FirstPending = 0;
+	m_NumPending = 0;
+
+	m_AverageSize = 0.0f;
+	m_Fragmented = 0.0f;
+	m_Loss = 0.0f;
+	m_Latency = 0.0f;
+	m_MinLatency = -1.0f;
+	m_LastNumPackets = 0;
+	m_LastSize = 0;
+	m_NumSnaps = 0;
+	m_TotalSize = 0;
+
+	m_Interval = 1;
+	m_Skipped = 0;
+	m_LastIntervalChange = 0;
+	m_ViewScale = 1.0f;
+}
+
+bool CSnapBudget::ShouldSnap()
+{
+	if(++m_Skipped < m_Interval)
+		return false;
+	m_Skipped = 0;
+	return true;
+}
+
+void CSnapBudget::OnSnap(int Tick, int Size, int NumPackets)
+{
+	while(m_NumPending > 0 && (m_NumPending == MAX_PENDING || m_aPendingTicks[m_FirstPending] < Tick - LOSS_TIMEOUT))
+	{
+		m_Loss = mix(m_Loss, 1.0f, SAMPLE_WEIGHT);
+		m_FirstPending = (m_FirstPending + 1) % MAX_PENDING;
+		m_NumPending--;
+	}
+	m_aPendingTicks[(m_FirstPending + m_NumPending) % MAX_PENDING] = Tick;
+	m_NumPending++;
+
+	m_AverageSize = m_AverageSize == 0.0f ? Size : mix(m_AverageSize, (float)Size, SAMPLE_WEIGHT);
+	m_Fragmented = mix(m_Fragmented, NumPackets > 1 ? 1.0f : 0.0f, SAMPLE_WEIGHT);
+	m_LastNumPackets = NumPackets;
+	m_LastSize = Size;
+	m_NumSnaps++;
+	m_TotalSize += Size;
+}
+
+void CSnapBudget::OnAck(int Tick, int Latency)
+{
+	// the client acknowledges the newest snapshot it has, it does not need
+	// older ones anymore even if they never arrived. Acknowledgements of
+	// snapshots that were already covered by a newer one are ignored.
+	bool Found = false;
+	while(m_NumPending > 0 && m_aPendingTicks[m_FirstPending] <= Tick)
+	{
+		m_Loss = mix(m_Loss, 0.0f, SAMPLE_WEIGHT);
+		Found |= m_aPendingTicks[m_FirstPending] == Tick;
+		m_FirstPending = (m_FirstPending + 1) % MAX_PENDING;
+		m_NumPending--;
+	}
+	if(!Found)
+		return;
+
+	m_Latency = m_MinLatency < 0.0f ? Latency : mix(m_Latency, (float)Latency, SAMPLE_WEIGHT);
+	m_MinLatency = m_MinLatency < 0.0f ? Latency : minimum(m_MinLatency, (float)Latency);
+}
+
+bool CSnapBudget::Congested() const
+{
+	return m_Loss > LOSS_HIGH || (m_MinLatency >= 0.0f && m_Latency > m_MinLatency + QUEUE_LATENCY);
+}
+
+void CSnapBudget::Adapt(int Tick, int TickSpeed)
+{
+	// change the interval at most once a second to see its effect first
+	if(Tick - m_LastIntervalChange >= TickSpeed)
+	{
+		if(Congested() && m_Interval < MAX_INTERVAL)
+		{
+			m_Interval++;
+			m_LastIntervalChange = Tick;
+		}
+		else if(!Congested() && m_Loss < LOSS_LOW && m_Interval > 1)
+		{
+			m_Interval--;
+			m_LastIntervalChange = Tick;
+		}
+	}
+
+	// shrink the view quickly while snapshots are split, grow it slowly
+	// while they fit with some room to spare
+	if(m_LastNumPackets > 1)
+		m_ViewScale = maximum(MIN_VIEW_SCALE, m_ViewScale * 0.85f);
+	else if(m_LastSize < MAX_SNAPSHOT_PACKSIZE * 3 / 4)
+		m_ViewScale = minimum(1.0f, m_ViewScale + 0.02f);
+}
@@ -0,0 +1,78 @@
+#ifndef ENGINE_SERVER_SNAP_BUDGET_H
+#define ENGINE_SERVER_SNAP_BUDGET_H
+
+#include <cstdint>
+
+/**
+ * Tracks the snapshots sent to one client and how they are acknowledged.
+ *
+ * Snapshots that are not acknowledged within half a second, neither directly nor
+ * by the acknowledgement of a newer snapshot, are counted as lost. While the link
+ * of the client is congested, snapshots are sent less often. While the
+ * snapshots do not fit into a single packet, the view of the client is
+ * shrunk so that distant entities are left out first.
+ */
+class CSnapBudget
+{
+public:
+	enum
+	{
+		MAX_INTERVAL = 4,
+	};
+
+	CSnapBudget();
+	void Reset();
+
+	/**
+	 * Called for every snapshot that the client could get.
+	 *
+	 * @return Whether the client gets this snapshot.
+	 */
+	bool ShouldSnap();
+	void OnSnap(int Tick, int Size, int NumPackets);
+	void OnAck(int Tick, int Latency);
+	/**
+	 * Adjusts the interval and the view to the tracked snapshots.
+	 */
+	void Adapt(int Tick, int TickSpeed);
+
+	int Interval() const { return m_Interval; }
+	float ViewScale() const { return m_ViewScale; }
+
+	int AverageSize() const { return (int)m_AverageSize; }
+	int FragmentedPercent() const { return (int)(m_Fragmented * 100.0f + 0.5f); }
+	int LossPercent() const { return (int)(m_Loss * 100.0f + 0.5f); }
+	int Latency() const { return (int)m_Latency; }
+	int NumSnaps() const { return m_NumSnaps; }
+	int64_t TotalSize() const { return m_TotalSize; }
+
+private:
+	enum
+	{
+		MAX_PENDING = 64,
+	};
+
+	bool Congested() const;
+
+	// sent snapshots that were not acknowledged yet
+	int m_aPendingTicks[MAX_PENDING];
+	int m_FirstPending;
+	int m_NumPending;
+
+	float m_AverageSize;
+	float m_Fragmented;
+	float m_Loss;
+	float m_Latency;
+	float m_MinLatency;
+	int m_LastNumPackets;
+	int m_LastSize;
+	int m_NumSnaps;
+	int64_t m_TotalSize;
+
+	int m_Interval;
+	int m_Skipped;
+	int m_LastIntervalChange;
+	float m_ViewScale;
+};
+
+#endif
@@ -125,10 +125,27 @@ public:
 	char *m_pDataStart;
 };
 
+// Reads from the file or from its contents in memory, if the datafile was opened from memory
+static unsigned ReadFileData(IOHANDLE File, const unsigned char *pFileData, int64_t FileSize, int64_t Offset, void *pDest, unsigned Size)
+{
+	if(pFileData != nullptr)
+	{
+		if(Offset < 0 || Offset > FileSize)
+			return 0;
+		const unsigned ReadSize = minimum<int64_t>(Size, FileSize - Offset);
+		mem_copy(pDest, pFileData + Offset, ReadSize);
+		return ReadSize;
+	}
+	if(io_seek(File, Offset, IOSEEK_START) != 0)
+		return 0;
+	return io_read(File, pDest, Size);
+}
+
 class CDatafile
 {
 public:
 	IOHANDLE m_File;
+	const unsigned char *m_pFileData;
 	unsigned m_FileSize;
 	SHA256_DIGEST m_Sha256;
 	unsigned m_Crc;
@@ -222,11 +239,7 @@ public:
 				m_pDataSizes[Index] = -1;
 				return nullptr;
 			}
-			unsigned ActualDataSize = 0;
-			if(io_seek(m_File, m_DataStartOffset + m_Info.m_pDataOffsets[Index], IOSEEK_START) == 0)
-			{
-				ActualDataSize = io_read(m_File, pCompressedData, DataSize);
-			}
+			const unsigned ActualDataSize = ReadFileData(m_File, m_pFileData, m_FileSize, m_DataStartOffset + m_Info.m_pDataOffsets[Index], pCompressedData, DataSize);
 			if(DataSize != ActualDataSize)
 			{
 				log_error("datafile", "truncation error. could not read all compressed data. index=%d wanted=%d got=%d", Index, DataSize, ActualDataSize);
@@ -268,11 +281,7 @@ public:
 				m_pDataSizes[Index] = -1;
 				return nullptr;
 			}
-			unsigned ActualDataSize = 0;
-			if(io_seek(m_File, m_DataStartOffset + m_Info.m_pDataOffsets[Index], IOSEEK_START) == 0)
-			{
-				ActualDataSize = io_read(m_File, m_ppDataPtrs[Index], DataSize);
-			}
+			const unsigned ActualDataSize = ReadFileData(m_File, m_pFileData, m_FileSize, m_DataStartOffset + m_Info.m_pDataOffsets[Index], m_ppDataPtrs[Index], DataSize);
 			if(DataSize != ActualDataSize)
 			{
 				log_error("datafile", "truncation error. could not read all uncompressed data. index=%d wanted=%d got=%d", Index, DataSize, ActualDataSize);
@@ -442,7 +451,7 @@ CDataFileReader &CDataFileReader::operator=(CDataFileReader &&Other)
 	return *this;
 }
 
-bool CDataFileReader::Open(class IStorage *pStorage, const char *pFilename, int StorageType)
+bool CDataFileReader::Open(class IStorage *pStorage, const char *pFilename, int StorageType, const SHA256_DIGEST *pKnownSha256, unsigned KnownCrc)
 {
 	dbg_assert(m_pDataFile == nullptr, "File already open");
 
@@ -459,6 +468,19 @@ bool CDataFileReader::Open(class IStorage *pStorage, const char *pFilename, int
 	int64_t FileSize = 0;
 	unsigned Crc = 0;
 	SHA256_DIGEST Sha256;
+	if(pKnownSha256)
+	{
+		FileSize = io_length(File);
+		Crc = KnownCrc;
+		Sha256 = *pKnownSha256;
+		if(FileSize < 0)
+		{
+			io_close(File);
+			log_error("datafile", "could not determine size of file");
+			return false;
+		}
+	}
+	else
 	{
 		SHA256_CTX Sha256Ctxt;
 		sha256_init(&Sha256Ctxt);
@@ -473,19 +495,33 @@ bool CDataFileReader::Open(class IStorage *pStorage, const char *pFilename, int
 			sha256_update(&Sha256Ctxt, aBuffer, Bytes);
 		}
 		Sha256 = sha256_finish(&Sha256Ctxt);
-		if(io_seek(File, 0, IOSEEK_START) != 0)
-		{
-			io_close(File);
-			log_error("datafile", "could not seek to start after calculating hashes");
-			return false;
-		}
 	}
 
+	if(!OpenImpl(pFilename, File, nullptr, FileSize, Sha256, Crc))
+	{
+		io_close(File);
+		return false;
+	}
+	return true;
+}
+
+bool CDataFileReader::Open(const char *pFilename, const unsigned char *pFileData, size_t FileSize, const SHA256_DIGEST *pKnownSha256, unsigned KnownCrc)
+{
+	dbg_assert(m_pDataFile == nullptr, "File already open");
+
+	log_trace("datafile", "loading '%s' from memory", pFilename);
+
+	const SHA256_DIGEST Sha256 = pKnownSha256 ? *pKnownSha256 : sha256(pFileData, FileSize);
+	const unsigned Crc = pKnownSha256 ? KnownCrc : crc32(0, pFileData, FileSize);
+	return OpenImpl(pFilename, nullptr, pFileData, FileSize, Sha256, Crc);
+}
+
+bool CDataFileReader::OpenImpl(const char *pFilename, IOHANDLE File, const unsigned char *pFileData, int64_t FileSize, const SHA256_DIGEST &Sha256, unsigned Crc)
+{
 	// read header
 	CDatafileHeader Header;
-	if(io_read(File, &Header, sizeof(Header)) != sizeof(Header))
+	if(ReadFileData(File, pFileData, FileSize, 0, &Header, sizeof(Header)) != sizeof(Header))
 	{
-		io_close(File);
 		log_error("datafile", "could not read file header. file truncated or not a datafile.");
 		return false;
 	}
@@ -494,7 +530,6 @@ bool CDataFileReader::Open(class IStorage *pStorage, const char *pFilename, int
 	if((Header.m_aId[0] != 'A' || Header.m_aId[1] != 'T' || Header.m_aId[2] != 'A' || Header.m_aId[3] != 'D') &&
 		(Header.m_aId[0] != 'D' || Header.m_aId[1] != 'A' || Header.m_aId[2] != 'T' || Header.m_aId[3] != 'A'))
 	{
-		io_close(File);
 		log_error("datafile", "wrong header magic. magic=%x%x%x%x", Header.m_aId[0], Header.m_aId[1], Header.m_aId[2], Header.m_aId[3]);
 		return false;
 	}
@@ -504,7 +539,6 @@ bool CDataFileReader::Open(class IStorage *pStorage, const char *pFilename, int
 	// check header version
 	if(Header.m_Version != 3 && Header.m_Version != 4)
 	{
-		io_close(File);
 		log_error("datafile", "unsupported header version. version=%d", Header.m_Version);
 		return false;
 	}
@@ -518,7 +552,6 @@ bool CDataFileReader::Open(class IStorage *pStorage, const char *pFilename, int
 		Header.m_ItemSize % sizeof(int) != 0 ||
 		Header.m_DataSize < 0)
 	{
-		io_close(File);
 		log_error("datafile", "invalid header information. num_types=%d num_items=%d num_data=%d item_size=%d data_size=%d",
 			Header.m_NumItemTypes, Header.m_NumItems, Header.m_NumRawData, Header.m_ItemSize, Header.m_DataSize);
 		return false;
@@ -544,7 +577,6 @@ bool CDataFileReader::Open(class IStorage *pStorage, const char *pFilename, int
 
 	if((int64_t)sizeof(Header) + Size + (int64_t)Header.m_DataSize != FileSize)
 	{
-		io_close(File);
 		log_error("datafile", "invalid header data size or truncated file. data_size=%" PRId64 " file_size=%" PRId64, Header.m_DataSize, FileSize);
 		return false;
 	}
@@ -559,7 +591,6 @@ bool CDataFileReader::Open(class IStorage *pStorage, const char *pFilename, int
 		}
 		else
 		{
-			io_close(File);
 			log_error("datafile", "invalid header size or truncated file. size=%" PRId64 " actual=%" PRId64, HeaderFileSize, FileSize);
 			return false;
 		}
@@ -576,7 +607,6 @@ bool CDataFileReader::Open(class IStorage *pStorage, const char *pFilename, int
 		}
 		else
 		{
-			io_close(File);
 			log_error("datafile", "invalid header swaplen or truncated file. swaplen=%" PRId64 " actual=%" PRId64, HeaderSwaplen, FileSizeSwaplen);
 			return false;
 		}
@@ -589,7 +619,6 @@ bool CDataFileReader::Open(class IStorage *pStorage, const char *pFilename, int
 	AllocSize += (int64_t)Header.m_NumRawData * sizeof(int); // add space for data sizes
 	if(AllocSize > MaxAllocSize)
 	{
-		io_close(File);
 		log_error("datafile", "file too large. alloc_size=%" PRId64 " max=%" PRId64, AllocSize, MaxAllocSize);
 		return false;
 	}
@@ -597,7 +626,6 @@ bool CDataFileReader::Open(class IStorage *pStorage, const char *pFilename, int
 	CDatafile *pTmpDataFile = static_cast<CDatafile *>(malloc(AllocSize));
 	if(pTmpDataFile == nullptr)
 	{
-		io_close(File);
 		log_error("datafile", "out of memory. could not allocate memory for datafile. alloc_size=%" PRId64, AllocSize);
 		return false;
 	}
@@ -607,6 +635,7 @@ bool CDataFileReader::Open(class IStorage *pStorage, const char *pFilename, int
 	pTmpDataFile->m_pDataSizes = (int *)(pTmpDataFile->m_ppDataPtrs + Header.m_NumRawData);
 	pTmpDataFile->m_pData = (char *)(pTmpDataFile->m_pDataSizes + Header.m_NumRawData);
 	pTmpDataFile->m_File = File;
+	pTmpDataFile->m_pFileData = pFileData;
 	pTmpDataFile->m_FileSize = FileSize;
 	pTmpDataFile->m_Sha256 = Sha256;
 	pTmpDataFile->m_Crc = Crc;
@@ -616,10 +645,9 @@ bool CDataFileReader::Open(class IStorage *pStorage, const char *pFilename, int
 	mem_zero(pTmpDataFile->m_pDataSizes, Header.m_NumRawData * sizeof(int));
 
 	// read types, offsets, sizes and item data
-	const unsigned ReadSize = io_read(pTmpDataFile->m_File, pTmpDataFile->m_pData, Size);
+	const unsigned ReadSize = ReadFileData(File, pFileData, FileSize, sizeof(CDatafileHeader), pTmpDataFile->m_pData, Size);
 	if((int64_t)ReadSize != Size)
 	{
-		io_close(pTmpDataFile->m_File);
 		free(pTmpDataFile);
 		log_error("datafile", "truncation error. could not read all item data. wanted=%" PRIzu " got=%d", Size, ReadSize);
 		return false;
@@ -644,7 +672,6 @@ bool CDataFileReader::Open(class IStorage *pStorage, const char *pFilename, int
 
 	if(!pTmpDataFile->Validate())
 	{
-		io_close(pTmpDataFile->m_File);
 		free(pTmpDataFile);
 		return false;
 	}
@@ -667,7 +694,8 @@ void CDataFileReader::Close()
 		free(m_pDataFile->m_ppDataPtrs[i]);
 	}
 
-	io_close(m_pDataFile->m_File);
+	if(m_pDataFile->m_File)
+		io_close(m_pDataFile->m_File);
 	free(m_pDataFile);
 	m_pDataFile = nullptr;
 }
@@ -26,15 +26,35 @@ class CDataFileReader
 
 	int GetExternalItemType(int InternalType, CUuid *pUuid);
 	int GetInternalItemType(int ExternalType);
+	bool OpenImpl(const char *pFilename, IOHANDLE File, const unsigned char *pFileData, int64_t FileSize, const SHA256_DIGEST &Sha256, unsigned Crc);
 
 public:
 	~CDataFileReader();
 	CDataFileReader &operator=(CDataFileReader &&Other);
 
-	bool Open(class IStorage *pStorage, const char *pFilename, int StorageType);
+	/**
+	 * Opens a datafile for reading.
+	 *
+	 * @param pKnownSha256 The SHA256 of the file, if it is already known,
+	 * e.g. because it was calculated while downloading the file. The file is
+	 * only read completely to calculate the hashes if this is `nullptr`.
+	 * @param KnownCrc The CRC32 of the file, if `pKnownSha256` is set.
+	 */
+	bool Open(class IStorage *pStorage, const char *pFilename, int StorageType, const SHA256_DIGEST *pKnownSha256 = nullptr, unsigned KnownCrc = 0);
+	/**
+	 * Opens a datafile that was already read into memory.
+	 *
+	 * @param pFilename The name of the file, only used for logging.
+	 * @param pFileData The contents of the file. They are not copied and must
+	 * stay valid until the datafile is closed.
+	 * @param pKnownSha256 The SHA256 of the contents, if it is already known.
+	 * The hashes are calculated from the contents if this is `nullptr`.
+	 * @param KnownCrc The CRC32 of the contents, if `pKnownSha256` is set.
+	 */
+	bool Open(const char *pFilename, const unsigned char *pFileData, size_t FileSize, const SHA256_DIGEST *pKnownSha256 = nullptr, unsigned KnownCrc = 0);
 	void Close();
 	bool IsOpen() const;
-	IOHANDLE File() const;
+	IOHANDLE File() const; // `nullptr` if the datafile was opened from memory
 
 	int GetDataSize(int Index) const;
 	void *GetData(int Index);
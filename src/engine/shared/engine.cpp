@@ -106,6 +106,11 @@ public:
 		m_JobPool.Shutdown();
 	}
 
+	void ParallelFor(int Count, int GrainSize, const std::function<void(int Begin, int End)> &Function) override
+	{
+		m_JobPool.ParallelFor(Count, GrainSize, Function);
+	}
+
 	void SetAdditionalLogger(std::shared_ptr<ILogger> &&pLogger) override
 	{
 		m_pFutureLogger->Set(pLogger);
@@ -16,6 +16,7 @@
 #endif
 
 #include <curl/curl.h>
+#include <zlib.h>
 
 // There is a stray constant on Windows/MSVC...
 #ifdef ERROR
@@ -323,6 +324,7 @@ size_t CHttpRequest::OnData(char *pData, size_t DataSize)
 	}
 
 	sha256_update(&m_ActualSha256Ctx, pData, DataSize);
+	m_ActualCrc = crc32(m_ActualCrc, (const Bytef *)pData, DataSize);
 
 	size_t Result = DataSize;
 
@@ -562,6 +564,12 @@ const SHA256_DIGEST &CHttpRequest::ResultSha256() const
 	return m_ActualSha256;
 }
 
+unsigned CHttpRequest::ResultCrc() const
+{
+	dbg_assert(State() == EHttpState::DONE, "Request not done");
+	return m_ActualCrc;
+}
+
 int CHttpRequest::StatusCode() const
 {
 	dbg_assert(State() == EHttpState::DONE, "Request not done");
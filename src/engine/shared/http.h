@@ -96,6 +96,7 @@ class CHttpRequest : public IHttpRequest
 	SHA256_DIGEST m_ActualSha256 = SHA256_ZEROED;
 	SHA256_CTX m_ActualSha256Ctx;
 	SHA256_DIGEST m_ExpectedSha256 = SHA256_ZEROED;
+	unsigned m_ActualCrc = 0;
 
 	bool m_WriteToMemory = true;
 	bool m_WriteToFile = false;
@@ -243,7 +244,11 @@ public:
 
 	void Result(unsigned char **ppResult, size_t *pResultLength) const;
 	json_value *ResultJson() const;
+	// SHA256 of the response body, calculated while receiving it. Zeroed if
+	// the request was skipped because the file already existed.
 	const SHA256_DIGEST &ResultSha256() const;
+	// CRC32 of the response body, calculated while receiving it
+	unsigned ResultCrc() const;
 
 	int StatusCode() const;
 	std::optional<int64_t> ResultAgeSeconds() const;
@@ -1,12 +1,20 @@
 /* (c) Magnus Auvinen. See licence.txt in the root of the distribution for more information. */
 /* If you are missing that file, acquire a complete release at teeworlds.com.                */
 #include "jobs.h"
+
+#include <base/math.h>
+#include <base/tl/threading.h>
+
 #include <algorithm>
 
+// the pool and the worker index of the current thread, if it is a worker thread
+static thread_local CJobPool *gs_pCurrentPool = nullptr;
+static thread_local int gs_CurrentWorker = -1;
+
 IJob::IJob() :
-	m_pNext(nullptr),
 	m_State(STATE_QUEUED),
-	m_Abortable(false)
+	m_Abortable(false),
+	m_Priority(PRIORITY_BACKGROUND)
 {
 }
 
@@ -42,6 +50,16 @@ bool IJob::IsAbortable() const
 	return m_Abortable;
 }
 
+void IJob::SetPriority(EJobPriority Priority)
+{
+	m_Priority = Priority;
+}
+
+IJob::EJobPriority IJob::Priority() const
+{
+	return m_Priority;
+}
+
 CJobPool::CJobPool()
 {
 	m_Shutdown = true;
@@ -57,66 +75,100 @@ CJobPool::~CJobPool()
 
 void CJobPool::WorkerThread(void *pUser)
 {
-	static_cast<CJobPool *>(pUser)->RunLoop();
+	CWorker *pWorker = static_cast<CWorker *>(pUser);
+	gs_pCurrentPool = pWorker->m_pPool;
+	gs_CurrentWorker = pWorker->m_Index;
+	pWorker->m_pPool->RunLoop(pWorker->m_Index);
+}
+
+std::shared_ptr<IJob> CJobPool::PopJobFrom(CWorker *pWorker, int Priority)
+{
+	if(pWorker->m_aNumQueued[Priority].load() == 0)
+		return nullptr;
+
+	const CLockScope LockScope(pWorker->m_Lock);
+	std::deque<std::shared_ptr<IJob>> &Queue = pWorker->m_aQueues[Priority];
+	if(Queue.empty())
+		return nullptr;
+	// take the oldest job, so jobs start in the order they were added
+	std::shared_ptr<IJob> pJob = std::move(Queue.front());
+	Queue.pop_front();
+	pWorker->m_aNumQueued[Priority].fetch_sub(1);
+	pWorker->m_pPool->m_NumQueued.fetch_sub(1);
+	return pJob;
+}
+
+std::shared_ptr<IJob> CJobPool::PopJob(int WorkerIndex)
+{
+	const int NumWorkers = m_vpWorkers.size();
+	for(int Priority = 0; Priority < IJob::NUM_PRIORITIES; Priority++)
+	{
+		// check the own queue first, then steal from the other workers
+		for(int i = 0; i < NumWorkers; i++)
+		{
+			std::shared_ptr<IJob> pJob = PopJobFrom(m_vpWorkers[(WorkerIndex + i) % NumWorkers].get(), Priority);
+			if(pJob)
+				return pJob;
+		}
+	}
+	return nullptr;
+}
+
+void CJobPool::RunJob(CWorker *pWorker, const std::shared_ptr<IJob> &pJob)
+{
+	IJob::EJobState OldStateQueued = IJob::STATE_QUEUED;
+	if(!pJob->m_State.compare_exchange_strong(OldStateQueued, IJob::STATE_RUNNING))
+	{
+		if(OldStateQueued == IJob::STATE_ABORTED)
+		{
+			// job was aborted before it was started
+			pJob->m_State = IJob::STATE_ABORTED;
+			return;
+		}
+		dbg_assert(false, "Job state invalid. Job was reused or uninitialized.");
+		dbg_break();
+	}
+
+	// remember running jobs so we can abort them
+	{
+		const CLockScope LockScope(pWorker->m_Lock);
+		pWorker->m_pRunningJob = pJob;
+	}
+	pJob->Run();
+	{
+		const CLockScope LockScope(pWorker->m_Lock);
+		pWorker->m_pRunningJob = nullptr;
+	}
+
+	// do not change state to done if job was not completed successfully
+	IJob::EJobState OldStateRunning = IJob::STATE_RUNNING;
+	if(!pJob->m_State.compare_exchange_strong(OldStateRunning, IJob::STATE_DONE))
+	{
+		if(OldStateRunning != IJob::STATE_ABORTED)
+		{
+			dbg_assert(false, "Job state invalid, must be either running or aborted");
+		}
+	}
 }
 
-void CJobPool::RunLoop()
+void CJobPool::RunLoop(int WorkerIndex)
 {
+	CWorker *pWorker = m_vpWorkers[WorkerIndex].get();
 	while(true)
 	{
 		// wait for job to become available
 		sphore_wait(&m_Semaphore);
 
-		// fetch job from queue
-		std::shared_ptr<IJob> pJob = nullptr;
+		// every queued job has its own signal, but another worker can take
+		// this one while we look through the queues, then we take its job
+		std::shared_ptr<IJob> pJob = PopJob(WorkerIndex);
+		while(!pJob && m_NumQueued.load() > 0)
 		{
-			const CLockScope LockScope(m_Lock);
-			if(m_pFirstJob)
-			{
-				pJob = m_pFirstJob;
-				m_pFirstJob = m_pFirstJob->m_pNext;
-				// allow remaining objects in list to destruct, even when current object stays alive
-				pJob->m_pNext = nullptr;
-				if(!m_pFirstJob)
-					m_pLastJob = nullptr;
-			}
+			pJob = PopJob(WorkerIndex);
 		}
-
 		if(pJob)
 		{
-			IJob::EJobState OldStateQueued = IJob::STATE_QUEUED;
-			if(!pJob->m_State.compare_exchange_strong(OldStateQueued, IJob::STATE_RUNNING))
-			{
-				if(OldStateQueued == IJob::STATE_ABORTED)
-				{
-					// job was aborted before it was started
-					pJob->m_State = IJob::STATE_ABORTED;
-					continue;
-				}
-				dbg_assert(false, "Job state invalid. Job was reused or uninitialized.");
-				dbg_break();
-			}
-
-			// remember running jobs so we can abort them
-			{
-				const CLockScope LockScope(m_LockRunning);
-				m_RunningJobs.push_back(pJob);
-			}
-			pJob->Run();
-			{
-				const CLockScope LockScope(m_LockRunning);
-				m_RunningJobs.erase(std::find(m_RunningJobs.begin(), m_RunningJobs.end(), pJob));
-			}
-
-			// do not change state to done if job was not completed successfully
-			IJob::EJobState OldStateRunning = IJob::STATE_RUNNING;
-			if(!pJob->m_State.compare_exchange_strong(OldStateRunning, IJob::STATE_DONE))
-			{
-				if(OldStateRunning != IJob::STATE_ABORTED)
-				{
-					dbg_assert(false, "Job state invalid, must be either running or aborted");
-				}
-			}
+			RunJob(pWorker, pJob);
 		}
 		else if(m_Shutdown)
 		{
@@ -129,20 +181,28 @@ void CJobPool::RunLoop()
 void CJobPool::Init(int NumThreads)
 {
 	dbg_assert(m_Shutdown, "Job pool already running");
+	dbg_assert(NumThreads > 0, "Job pool needs at least one worker thread");
 	m_Shutdown = false;
+	m_NextWorker = 0;
+	m_NumQueued = 0;
 
-	const CLockScope LockScope(m_Lock);
 	sphore_init(&m_Semaphore);
-	m_pFirstJob = nullptr;
-	m_pLastJob = nullptr;
+
+	// all workers must exist before the first one starts stealing
+	m_vpWorkers.reserve(NumThreads);
+	for(int i = 0; i < NumThreads; i++)
+	{
+		m_vpWorkers.push_back(std::make_unique<CWorker>());
+		m_vpWorkers.back()->m_pPool = this;
+		m_vpWorkers.back()->m_Index = i;
+	}
 
 	// start worker threads
 	char aName[16]; // unix kernel length limit
-	m_vpThreads.reserve(NumThreads);
 	for(int i = 0; i < NumThreads; i++)
 	{
 		str_format(aName, sizeof(aName), "CJobPool W%d", i);
-		m_vpThreads.push_back(thread_init(WorkerThread, this, aName));
+		m_vpWorkers[i]->m_pThread = thread_init(WorkerThread, m_vpWorkers[i].get(), aName);
 	}
 }
 
@@ -151,58 +211,42 @@ void CJobPool::Shutdown()
 	dbg_assert(!m_Shutdown, "Job pool already shut down");
 	m_Shutdown = true;
 
-	// abort queued jobs
+	for(auto &pWorker : m_vpWorkers)
 	{
-		const CLockScope LockScope(m_Lock);
-		std::shared_ptr<IJob> pJob = m_pFirstJob;
-		std::shared_ptr<IJob> pPrev = nullptr;
-		while(pJob != nullptr)
+		const CLockScope LockScope(pWorker->m_Lock);
+
+		// abort queued jobs, only abortable jobs are removed from the queues
+		for(int Priority = 0; Priority < IJob::NUM_PRIORITIES; Priority++)
 		{
-			std::shared_ptr<IJob> pNext = pJob->m_pNext;
-			if(pJob->Abort())
-			{
-				// only remove abortable jobs from queue
-				pJob->m_pNext = nullptr;
-				if(pPrev)
-				{
-					pPrev->m_pNext = pNext;
-				}
-				else
-				{
-					m_pFirstJob = pNext;
-				}
-			}
-			else
-			{
-				pPrev = pJob;
-			}
-			pJob = pNext;
+			std::deque<std::shared_ptr<IJob>> &Queue = pWorker->m_aQueues[Priority];
+			Queue.erase(std::remove_if(Queue.begin(), Queue.end(), [](const std::shared_ptr<IJob> &pJob) {
+				return pJob->Abort();
+			}),
+				Queue.end());
+			m_NumQueued.fetch_sub(pWorker->m_aNumQueued[Priority].load() - Queue.size());
+			pWorker->m_aNumQueued[Priority].store(Queue.size());
 		}
-		m_pLastJob = pPrev;
-	}
 
-	// abort running jobs
-	{
-		const CLockScope LockScope(m_LockRunning);
-		for(const std::shared_ptr<IJob> &pJob : m_RunningJobs)
+		// abort running job
+		if(pWorker->m_pRunningJob)
 		{
-			pJob->Abort();
+			pWorker->m_pRunningJob->Abort();
 		}
 	}
 
 	// wake up all worker threads
-	for(size_t i = 0; i < m_vpThreads.size(); i++)
+	for(size_t i = 0; i < m_vpWorkers.size(); i++)
 	{
 		sphore_signal(&m_Semaphore);
 	}
 
 	// wait for all worker threads to finish
-	for(void *pThread : m_vpThreads)
+	for(auto &pWorker : m_vpWorkers)
 	{
-		thread_wait(pThread);
+		thread_wait(pWorker->m_pThread);
 	}
 
-	m_vpThreads.clear();
+	m_vpWorkers.clear();
 	sphore_destroy(&m_Semaphore);
 }
 
@@ -215,16 +259,96 @@ void CJobPool::Add(std::shared_ptr<IJob> pJob)
 		return;
 	}
 
+	// jobs added by a job stay on the same worker, other jobs are distributed
+	const int Priority = pJob->Priority();
+	CWorker *pWorker;
+	if(gs_pCurrentPool == this)
+		pWorker = m_vpWorkers[gs_CurrentWorker].get();
+	else
+		pWorker = m_vpWorkers[m_NextWorker.fetch_add(1) % m_vpWorkers.size()].get();
+
 	// add job to queue
 	{
-		const CLockScope LockScope(m_Lock);
-		if(m_pLastJob)
-			m_pLastJob->m_pNext = pJob;
-		m_pLastJob = std::move(pJob);
-		if(!m_pFirstJob)
-			m_pFirstJob = m_pLastJob;
+		const CLockScope LockScope(pWorker->m_Lock);
+		pWorker->m_aQueues[Priority].push_back(std::move(pJob));
+		pWorker->m_aNumQueued[Priority].fetch_add(1);
+		m_NumQueued.fetch_add(1);
 	}
 
 	// signal a worker thread that a job is available
 	sphore_signal(&m_Semaphore);
 }
+
+class CParallelFor
+{
+public:
+	// only called while ranges are left, ParallelFor waits for all of them
+	const std::function<void(int Begin, int End)> *m_pFunction;
+	int m_Count;
+	int m_GrainSize;
+	int m_NumRanges;
+	std::atomic<int> m_NextRange{0};
+	std::atomic<int> m_NumDone{0};
+	CSemaphore m_Finished;
+
+	// processes ranges until all of them were taken
+	void Work()
+	{
+		while(true)
+		{
+			const int Range = m_NextRange.fetch_add(1);
+			if(Range >= m_NumRanges)
+				return;
+			const int Begin = Range * m_GrainSize;
+			(*m_pFunction)(Begin, minimum(Begin + m_GrainSize, m_Count));
+			if(m_NumDone.fetch_add(1) + 1 == m_NumRanges)
+				m_Finished.Signal();
+		}
+	}
+};
+
+class CParallelForJob : public IJob
+{
+	std::shared_ptr<CParallelFor> m_pParallelFor;
+
+	void Run() override
+	{
+		m_pParallelFor->Work();
+	}
+
+public:
+	CParallelForJob(std::shared_ptr<CParallelFor> pParallelFor) :
+		m_pParallelFor(std::move(pParallelFor))
+	{
+		// the thread that called ParallelFor is waiting
+		SetPriority(PRIORITY_INTERACTIVE);
+	}
+};
+
+void CJobPool::ParallelFor(int Count, int GrainSize, const std::function<void(int Begin, int End)> &Function)
+{
+	if(Count <= 0)
+		return;
+	GrainSize = maximum(GrainSize, 1);
+	const int NumRanges = (Count - 1) / GrainSize + 1;
+	if(NumRanges == 1 || m_Shutdown)
+	{
+		for(int Begin = 0; Begin < Count; Begin += GrainSize)
+			Function(Begin, minimum(Begin + GrainSize, Count));
+		return;
+	}
+
+	auto pParallelFor = std::make_shared<CParallelFor>();
+	pParallelFor->m_pFunction = &Function;
+	pParallelFor->m_Count = Count;
+	pParallelFor->m_GrainSize = GrainSize;
+	pParallelFor->m_NumRanges = NumRanges;
+
+	// the calling thread works as well, so it never waits for jobs that did
+	// not start yet, which also makes calling this from a job safe
+	const int NumHelpers = minimum(NumRanges - 1, NumThreads());
+	for(int i = 0; i < NumHelpers; i++)
+		Add(std::make_shared<CParallelForJob>(pParallelFor));
+	pParallelFor->Work();
+	pParallelFor->m_Finished.Wait();
+}
@@ -8,6 +8,7 @@
 
 #include <atomic>
 #include <deque>
+#include <functional>
 #include <memory>
 #include <vector>
 
@@ -50,10 +51,29 @@ public:
 		STATE_ABORTED,
 	};
 
+	/**
+	 * The priority of a job in the job pool. Queued jobs with a higher
+	 * priority are started before all queued jobs with a lower priority.
+	 */
+	enum EJobPriority
+	{
+		/**
+		 * Job that the user is waiting for, e.g. loading the current map.
+		 */
+		PRIORITY_INTERACTIVE = 0,
+
+		/**
+		 * Job that can be delayed, e.g. loading skins. This is the default.
+		 */
+		PRIORITY_BACKGROUND,
+
+		NUM_PRIORITIES,
+	};
+
 private:
-	std::shared_ptr<IJob> m_pNext;
 	std::atomic<EJobState> m_State;
 	std::atomic<bool> m_Abortable;
+	EJobPriority m_Priority;
 
 protected:
 	/**
@@ -117,28 +137,64 @@ public:
 	 * @return `true` if the job can be aborted, `false` otherwise.
 	 */
 	bool IsAbortable() const;
+
+	/**
+	 * Sets the priority of this job.
+	 *
+	 * @remark Must be called before the job is added to the job pool.
+	 */
+	void SetPriority(EJobPriority Priority);
+
+	/**
+	 * Returns the priority of this job.
+	 *
+	 * @return Priority of the job.
+	 */
+	EJobPriority Priority() const;
 };
 
 /**
  * A job pool which runs jobs in one or more worker threads.
  *
+ * Every worker thread has its own queues, one per priority. Jobs added from
+ * a worker thread are queued on that worker, other jobs are distributed
+ * among the workers. A worker without queued jobs steals jobs from the
+ * other workers, so the workers only contend for a queue when one of them
+ * runs out of work.
+ *
  * @see IJob
  */
 class CJobPool
 {
-	std::vector<void *> m_vpThreads;
+	class CWorker
+	{
+	public:
+		CJobPool *m_pPool;
+		int m_Index;
+		void *m_pThread = nullptr;
+
+		CLock m_Lock;
+		std::deque<std::shared_ptr<IJob>> m_aQueues[IJob::NUM_PRIORITIES] GUARDED_BY(m_Lock);
+		// number of jobs in m_aQueues, allows checking for jobs without locking
+		std::atomic<int> m_aNumQueued[IJob::NUM_PRIORITIES] = {};
+		// the job that is currently running on this worker, so it can be aborted
+		std::shared_ptr<IJob> m_pRunningJob GUARDED_BY(m_Lock);
+	};
+
+	std::vector<std::unique_ptr<CWorker>> m_vpWorkers;
 	std::atomic<bool> m_Shutdown;
+	// the worker that receives the next job added from outside of the pool
+	std::atomic<unsigned> m_NextWorker;
+	// number of jobs in all queues
+	std::atomic<int> m_NumQueued;
 
-	CLock m_Lock;
 	SEMAPHORE m_Semaphore;
-	std::shared_ptr<IJob> m_pFirstJob GUARDED_BY(m_Lock);
-	std::shared_ptr<IJob> m_pLastJob GUARDED_BY(m_Lock);
-
-	CLock m_LockRunning;
-	std::deque<std::shared_ptr<IJob>> m_RunningJobs GUARDED_BY(m_LockRunning);
 
 	static void WorkerThread(void *pUser) NO_THREAD_SAFETY_ANALYSIS;
-	void RunLoop() NO_THREAD_SAFETY_ANALYSIS;
+	void RunLoop(int WorkerIndex) NO_THREAD_SAFETY_ANALYSIS;
+	std::shared_ptr<IJob> PopJob(int WorkerIndex);
+	static std::shared_ptr<IJob> PopJobFrom(CWorker *pWorker, int Priority);
+	void RunJob(CWorker *pWorker, const std::shared_ptr<IJob> &pJob);
 
 public:
 	CJobPool();
@@ -151,7 +207,7 @@ public:
 	 *
 	 * @remark Must be called on the main thread.
 	 */
-	void Init(int NumThreads) REQUIRES(!m_Lock);
+	void Init(int NumThreads);
 
 	/**
 	 * Shuts down the job pool. Aborts all abortable jobs. Then waits for all
@@ -159,7 +215,7 @@ public:
 	 *
 	 * @remark Must be called on the main thread.
 	 */
-	void Shutdown() REQUIRES(!m_Lock) REQUIRES(!m_LockRunning);
+	void Shutdown();
 
 	/**
 	 * Adds a job to the queue of the job pool.
@@ -169,6 +225,24 @@ public:
 	 * @remark If the job pool is already shutting down, no additional jobs
 	 * will be enqueue anymore. Abortable jobs will immediately be aborted.
 	 */
-	void Add(std::shared_ptr<IJob> pJob) REQUIRES(!m_Lock);
+	void Add(std::shared_ptr<IJob> pJob);
+
+	/**
+	 * Calls `Function` for consecutive ranges of `[0, Count)` and returns
+	 * after all of them were processed. The ranges are processed by the
+	 * calling thread and the worker threads in parallel.
+	 *
+	 * @param Count The number of items.
+	 * @param GrainSize The maximum number of items per call of `Function`.
+	 * @param Function Called with the begin and end of a range.
+	 *
+	 * @remark May be called from any thread, including the worker threads.
+	 */
+	void ParallelFor(int Count, int GrainSize, const std::function<void(int Begin, int End)> &Function);
+
+	/**
+	 * Returns the number of worker threads.
+	 */
+	int NumThreads() const { return m_vpWorkers.size(); }
 };
 #endif
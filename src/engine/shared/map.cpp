@@ -3,11 +3,14 @@
 #include "map.h"
 
 #include <base/log.h>
+#include <base/system.h>
 
 #include <engine/storage.h>
 
 #include <game/mapitems.h>
 
+#include <vector>
+
 CMap::CMap() = default;
 
 int CMap::GetDataSize(int Index) const
@@ -71,17 +74,79 @@ int CMap::NumItems() const
 }
 
 bool CMap::Load(const char *pMapName)
+{
+	return Load(pMapName, nullptr, 0);
+}
+
+bool CMap::Load(const char *pMapName, const SHA256_DIGEST *pKnownSha256, unsigned KnownCrc)
 {
 	IStorage *pStorage = Kernel()->RequestInterface<IStorage>();
 	if(!pStorage)
 		return false;
 
 	// Ensure current datafile is not left in an inconsistent state if loading fails,
-	// by loading the new datafile separately first.
+	// by loading the new datafile separately first. Known hashes belong to the
+	// file in the save directory, so a file with the same name elsewhere must
+	// not be used.
 	CDataFileReader NewDataFile;
-	if(!NewDataFile.Open(pStorage, pMapName, IStorage::TYPE_ALL))
+	if(!LoadDataFile(pStorage, pMapName, pKnownSha256 ? IStorage::TYPE_SAVE : IStorage::TYPE_ALL, pKnownSha256, KnownCrc, &NewDataFile))
 		return false;
 
+	// Replace existing datafile with new datafile
+	m_DataFile.Close();
+	m_DataFile = std::move(NewDataFile);
+	return true;
+}
+
+bool CMap::Prepare(const char *pMapName, const unsigned char *pMapData, size_t MapSize, const SHA256_DIGEST *pKnownSha256, unsigned KnownCrc)
+{
+	m_PreparedDataFile.Close();
+	if(!m_PreparedDataFile.Open(pMapName, pMapData, MapSize, pKnownSha256, KnownCrc) || !InitDataFile(&m_PreparedDataFile))
+		return false;
+
+	// images and sounds are not needed by the server
+	std::vector<bool> vClientOnly(m_PreparedDataFile.NumData(), false);
+	int Start, Num;
+	m_PreparedDataFile.GetType(MAPITEMTYPE_IMAGE, &Start, &Num);
+	for(int i = 0; i < Num; i++)
+	{
+		const CMapItemImage *pImage = static_cast<CMapItemImage *>(m_PreparedDataFile.GetItem(Start + i));
+		if(pImage->m_ImageData >= 0 && pImage->m_ImageData < (int)vClientOnly.size())
+			vClientOnly[pImage->m_ImageData] = true;
+	}
+	m_PreparedDataFile.GetType(MAPITEMTYPE_SOUND, &Start, &Num);
+	for(int i = 0; i < Num; i++)
+	{
+		const CMapItemSound *pSound = static_cast<CMapItemSound *>(m_PreparedDataFile.GetItem(Start + i));
+		if(pSound->m_SoundData >= 0 && pSound->m_SoundData < (int)vClientOnly.size())
+			vClientOnly[pSound->m_SoundData] = true;
+	}
+	for(int i = 0; i < m_PreparedDataFile.NumData(); i++)
+	{
+		if(!vClientOnly[i])
+			m_PreparedDataFile.GetData(i);
+	}
+	return true;
+}
+
+void CMap::SwapPrepared()
+{
+	dbg_assert(m_PreparedDataFile.IsOpen(), "no map prepared");
+	m_DataFile.Close();
+	m_DataFile = std::move(m_PreparedDataFile);
+}
+
+bool CMap::LoadDataFile(IStorage *pStorage, const char *pMapName, int StorageType, const SHA256_DIGEST *pKnownSha256, unsigned KnownCrc, CDataFileReader *pDataFile)
+{
+	if(!pDataFile->Open(pStorage, pMapName, StorageType, pKnownSha256, KnownCrc))
+		return false;
+	return InitDataFile(pDataFile);
+}
+
+bool CMap::InitDataFile(CDataFileReader *pDataFile)
+{
+	CDataFileReader &NewDataFile = *pDataFile;
+
 	// Check version
 	const CMapItemVersion *pItem = (CMapItemVersion *)NewDataFile.FindItem(MAPITEMTYPE_VERSION, 0);
 	if(pItem == nullptr || pItem->m_Version != 1)
@@ -112,11 +177,15 @@ bool CMap::Load(const char *pMapName)
 					if(((int)TilemapCount / pTilemap->m_Width != pTilemap->m_Height) || (TilemapSize / sizeof(CTile) != TilemapCount))
 					{
 						log_error("map/load", "map layer too big (%d * %d * %d causes an integer overflow)", pTilemap->m_Width, pTilemap->m_Height, (int)sizeof(CTile));
+						NewDataFile.Close();
 						return false;
 					}
 					CTile *pTiles = static_cast<CTile *>(malloc(TilemapSize));
 					if(!pTiles)
+					{
+						NewDataFile.Close();
 						return false;
+					}
 					ExtractTiles(pTiles, (size_t)pTilemap->m_Width * pTilemap->m_Height, static_cast<CTile *>(NewDataFile.GetData(pTilemap->m_Data)), NewDataFile.GetDataSize(pTilemap->m_Data) / sizeof(CTile));
 					NewDataFile.ReplaceData(pTilemap->m_Data, reinterpret_cast<char *>(pTiles), TilemapSize);
 				}
@@ -124,14 +193,12 @@ bool CMap::Load(const char *pMapName)
 		}
 	}
 
-	// Replace existing datafile with new datafile
-	m_DataFile.Close();
-	m_DataFile = std::move(NewDataFile);
 	return true;
 }
 
 void CMap::Unload()
 {
+	m_PreparedDataFile.Close();
 	m_DataFile.Close();
 }
 
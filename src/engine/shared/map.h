@@ -11,6 +11,10 @@
 class CMap : public IEngineMap
 {
 	CDataFileReader m_DataFile;
+	CDataFileReader m_PreparedDataFile;
+
+	static bool LoadDataFile(class IStorage *pStorage, const char *pMapName, int StorageType, const SHA256_DIGEST *pKnownSha256, unsigned KnownCrc, CDataFileReader *pDataFile);
+	static bool InitDataFile(CDataFileReader *pDataFile);
 
 public:
 	CMap();
@@ -32,6 +36,9 @@ public:
 	int NumItems() const override;
 
 	bool Load(const char *pMapName) override;
+	bool Load(const char *pMapName, const SHA256_DIGEST *pKnownSha256, unsigned KnownCrc) override;
+	bool Prepare(const char *pMapName, const unsigned char *pMapData, size_t MapSize, const SHA256_DIGEST *pKnownSha256, unsigned KnownCrc) override;
+	void SwapPrepared() override;
 	void Unload() override;
 	bool IsLoaded() const override;
 	IOHANDLE File() const override;
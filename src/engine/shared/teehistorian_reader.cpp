@@ -0,0 +1,383 @@
+#include "teehistorian_reader.h"
+
+#include "compression.h"
+#include "teehistorian_ex.h"
+
+#include <engine/uuid.h>
+
+#include <algorithm>
+
+#include <zlib.h>
+
+static const CUuid TEEHISTORIAN_UUID = CalculateUuid("teehistorian@ddnet.tw");
+
+static bool Inflate(const unsigned char *pData, size_t DataSize, std::vector<unsigned char> &vOutput)
+{
+	z_stream Stream;
+	mem_zero(&Stream, sizeof(Stream));
+	// window bits + 32 detects the gzip header
+	if(inflateInit2(&Stream, MAX_WBITS + 32) != Z_OK)
+		return false;
+
+	vOutput.resize(std::max<size_t>(DataSize * 4, 64 * 1024));
+	Stream.next_in = const_cast<Bytef *>(pData);
+	Stream.avail_in = DataSize;
+	int Result = Z_OK;
+	while(Result == Z_OK)
+	{
+		if(Stream.total_out == vOutput.size())
+			vOutput.resize(vOutput.size() * 2);
+		Stream.next_out = vOutput.data() + Stream.total_out;
+		Stream.avail_out = vOutput.size() - Stream.total_out;
+		Result = inflate(&Stream, Z_NO_FLUSH);
+		// files of crashed servers end after the last sync point
+		if(Result == Z_BUF_ERROR && Stream.avail_in == 0)
+			Result = Z_STREAM_END;
+	}
+	vOutput.resize(Stream.total_out);
+	inflateEnd(&Stream);
+	return Result == Z_STREAM_END;
+}
+
+bool CTeeHistorianReader::Load(IOHANDLE File)
+{
+	m_pError = nullptr;
+	m_vIndex.clear();
+	const int64_t Length = io_length(File);
+	if(Length < 0)
+		return Fail("failed to read file");
+	// read uncompressed files directly into the chunk buffer
+	m_vData.resize(Length);
+	if(io_read(File, m_vData.data(), m_vData.size()) != m_vData.size())
+		return Fail("failed to read file");
+	if(m_vData.size() >= 2 && m_vData[0] == 0x1f && m_vData[1] == 0x8b)
+	{
+		std::vector<unsigned char> vCompressed;
+		std::swap(vCompressed, m_vData);
+		if(!Inflate(vCompressed.data(), vCompressed.size(), m_vData))
+			return Fail("failed to decompress file");
+	}
+	return Init();
+}
+
+bool CTeeHistorianReader::Load(const void *pData, size_t DataSize)
+{
+	m_pError = nullptr;
+	m_vIndex.clear();
+	const unsigned char *pBytes = static_cast<const unsigned char *>(pData);
+	if(DataSize >= 2 && pBytes[0] == 0x1f && pBytes[1] == 0x8b)
+	{
+		if(!Inflate(pBytes, DataSize, m_vData))
+			return Fail("failed to decompress file");
+	}
+	else
+	{
+		m_vData.assign(pBytes, pBytes + DataSize);
+	}
+	return Init();
+}
+
+bool CTeeHistorianReader::Init()
+{
+	if(!ParseHeader())
+		return false;
+	Rewind();
+	return true;
+}
+
+bool CTeeHistorianReader::ParseHeader()
+{
+	if(m_vData.size() < sizeof(CUuid) || mem_comp(m_vData.data(), &TEEHISTORIAN_UUID, sizeof(CUuid)) != 0)
+		return Fail("not a teehistorian file");
+	const unsigned char *pJson = m_vData.data() + sizeof(CUuid);
+	const unsigned char *pEnd = static_cast<const unsigned char *>(memchr(pJson, 0, m_vData.size() - sizeof(CUuid)));
+	if(pEnd == nullptr)
+		return Fail("header is not terminated");
+	m_pHeaderJson = reinterpret_cast<const char *>(pJson);
+	m_FirstChunk = pEnd + 1 - m_vData.data();
+	return true;
+}
+
+void CTeeHistorianReader::Rewind()
+{
+	m_Offset = m_FirstChunk;
+	m_Finished = false;
+	m_HavePending = false;
+	m_Tick = 0;
+	m_LastPlayerId = MAX_CLIENTS;
+	mem_zero(m_aPlayers, sizeof(m_aPlayers));
+}
+
+bool CTeeHistorianReader::Fail(const char *pError)
+{
+	if(m_pError == nullptr)
+		m_pError = pError;
+	return false;
+}
+
+bool CTeeHistorianReader::ReadInt(int *pValue)
+{
+	const unsigned char *pCur = m_vData.data() + m_Offset;
+	// most values of the stream are small diffs that fit into one byte
+	if(m_Offset < m_vData.size() && !(*pCur & 0x80))
+	{
+		*pValue = (*pCur & 0x3F) ^ -((*pCur >> 6) & 1);
+		m_Offset++;
+		return true;
+	}
+	const unsigned char *pNext = CVariableInt::Unpack(pCur, pValue, m_vData.size() - m_Offset);
+	if(pNext == nullptr)
+		return Fail("unexpected end of file");
+	m_Offset += pNext - pCur;
+	return true;
+}
+
+bool CTeeHistorianReader::ReadString(const char **ppStr)
+{
+	const unsigned char *pCur = m_vData.data() + m_Offset;
+	const void *pEnd = memchr(pCur, 0, m_vData.size() - m_Offset);
+	if(pEnd == nullptr)
+		return Fail("unexpected end of file");
+	*ppStr = reinterpret_cast<const char *>(pCur);
+	m_Offset = static_cast<const unsigned char *>(pEnd) + 1 - m_vData.data();
+	return true;
+}
+
+bool CTeeHistorianReader::ReadRaw(int Size, const unsigned char **ppData)
+{
+	if(Size < 0 || (size_t)Size > m_vData.size() - m_Offset)
+		return Fail("unexpected end of file");
+	*ppData = m_vData.data() + m_Offset;
+	m_Offset += Size;
+	return true;
+}
+
+void CTeeHistorianReader::AdvanceTick(int NewTick, size_t ChunkOffset)
+{
+	if(m_BuildingIndex && NewTick >= m_NextIndexTick)
+	{
+		CState &State = m_vIndex.emplace_back();
+		State.m_Offset = ChunkOffset;
+		State.m_ChunkTick = NewTick;
+		State.m_Tick = m_Tick;
+		State.m_LastPlayerId = m_LastPlayerId;
+		mem_copy(State.m_aPlayers, m_aPlayers, sizeof(m_aPlayers));
+		m_NextIndexTick = NewTick + m_IndexInterval;
+	}
+	m_Tick = NewTick;
+}
+
+void CTeeHistorianReader::RestoreState(const CState *pState)
+{
+	m_Offset = pState->m_Offset;
+	m_Finished = false;
+	m_HavePending = false;
+	m_Tick = pState->m_Tick;
+	m_LastPlayerId = pState->m_LastPlayerId;
+	mem_copy(m_aPlayers, pState->m_aPlayers, sizeof(m_aPlayers));
+}
+
+bool CTeeHistorianReader::ParseChunk(CChunk *pChunk)
+{
+	const size_t ChunkOffset = m_Offset;
+	int Type;
+	if(!ReadInt(&Type))
+		return false;
+
+	pChunk->m_ClientId = -1;
+	pChunk->m_pData = nullptr;
+	pChunk->m_DataSize = 0;
+	pChunk->m_pString = nullptr;
+	pChunk->m_pArgs = nullptr;
+	pChunk->m_NumArgs = 0;
+	pChunk->m_ExType = UUID_UNKNOWN;
+
+	if(Type >= 0)
+	{
+		// position diff, the type is the client id
+		int ClientId = Type;
+		int Dx, Dy;
+		if(ClientId >= MAX_CLIENTS || !ReadInt(&Dx) || !ReadInt(&Dy))
+			return Fail("invalid player diff");
+		if(ClientId <= m_LastPlayerId)
+			AdvanceTick(m_Tick + 1, ChunkOffset);
+		m_LastPlayerId = ClientId;
+		m_aPlayers[ClientId].m_X += Dx;
+		m_aPlayers[ClientId].m_Y += Dy;
+		pChunk->m_Type = CHUNK_PLAYER_DIFF;
+		pChunk->m_ClientId = ClientId;
+		pChunk->m_Tick = m_Tick;
+		return true;
+	}
+
+	switch(-Type)
+	{
+	case TEEHISTORIAN_FINISH:
+		pChunk->m_Type = CHUNK_FINISH;
+		m_Finished = true;
+		break;
+	case TEEHISTORIAN_TICK_SKIP:
+	{
+		int Dt;
+		if(!ReadInt(&Dt) || Dt < 0)
+			return Fail("invalid tick skip");
+		AdvanceTick(m_Tick + Dt + 1, ChunkOffset);
+		m_LastPlayerId = -1;
+		// tick skips are not passed on, the following chunks carry the tick
+		return ParseChunk(pChunk);
+	}
+	case TEEHISTORIAN_PLAYER_NEW:
+	case TEEHISTORIAN_PLAYER_OLD:
+	{
+		int ClientId;
+		if(!ReadInt(&ClientId) || ClientId < 0 || ClientId >= MAX_CLIENTS)
+			return Fail("invalid player chunk");
+		int X = 0, Y = 0;
+		if(-Type == TEEHISTORIAN_PLAYER_NEW && (!ReadInt(&X) || !ReadInt(&Y)))
+			return false;
+		if(ClientId <= m_LastPlayerId)
+			AdvanceTick(m_Tick + 1, ChunkOffset);
+		m_LastPlayerId = ClientId;
+		CPlayer &Player = m_aPlayers[ClientId];
+		Player.m_Alive = -Type == TEEHISTORIAN_PLAYER_NEW;
+		Player.m_X = X;
+		Player.m_Y = Y;
+		pChunk->m_Type = Player.m_Alive ? CHUNK_PLAYER_NEW : CHUNK_PLAYER_OLD;
+		pChunk->m_ClientId = ClientId;
+		break;
+	}
+	case TEEHISTORIAN_INPUT_DIFF:
+	case TEEHISTORIAN_INPUT_NEW:
+	{
+		int ClientId;
+		int aInput[NUM_INPUT_INTS];
+		if(!ReadInt(&ClientId) || ClientId < 0 || ClientId >= MAX_CLIENTS)
+			return Fail("invalid input chunk");
+		for(int &Value : aInput)
+		{
+			if(!ReadInt(&Value))
+				return false;
+		}
+		CPlayer &Player = m_aPlayers[ClientId];
+		const bool Diff = -Type == TEEHISTORIAN_INPUT_DIFF;
+		for(int i = 0; i < NUM_INPUT_INTS; i++)
+			Player.m_aInput[i] = Diff ? Player.m_aInput[i] + aInput[i] : aInput[i];
+		Player.m_HaveInput = true;
+		pChunk->m_Type = Diff ? CHUNK_INPUT_DIFF : CHUNK_INPUT_NEW;
+		pChunk->m_ClientId = ClientId;
+		break;
+	}
+	case TEEHISTORIAN_MESSAGE:
+		pChunk->m_Type = CHUNK_MESSAGE;
+		if(!ReadInt(&pChunk->m_ClientId) || !ReadInt(&pChunk->m_DataSize) || !ReadRaw(pChunk->m_DataSize, &pChunk->m_pData))
+			return false;
+		break;
+	case TEEHISTORIAN_JOIN:
+	case TEEHISTORIAN_DROP:
+	{
+		int ClientId;
+		if(!ReadInt(&ClientId) || ClientId < 0 || ClientId >= MAX_CLIENTS)
+			return Fail("invalid join or drop chunk");
+		if(-Type == TEEHISTORIAN_DROP && !ReadString(&pChunk->m_pString))
+			return false;
+		m_aPlayers[ClientId].m_aName[0] = '\0';
+		pChunk->m_Type = -Type == TEEHISTORIAN_JOIN ? CHUNK_JOIN : CHUNK_DROP;
+		pChunk->m_ClientId = ClientId;
+		break;
+	}
+	case TEEHISTORIAN_CONSOLE_COMMAND:
+	{
+		pChunk->m_Type = CHUNK_CONSOLE_COMMAND;
+		if(!ReadInt(&pChunk->m_ClientId) || !ReadInt(&pChunk->m_FlagMask) || !ReadString(&pChunk->m_pString) || !ReadInt(&pChunk->m_NumArgs))
+			return false;
+		pChunk->m_pArgs = reinterpret_cast<const char *>(m_vData.data() + m_Offset);
+		for(int i = 0; i < pChunk->m_NumArgs; i++)
+		{
+			const char *pArg;
+			if(!ReadString(&pArg))
+				return false;
+		}
+		break;
+	}
+	case TEEHISTORIAN_EX:
+	{
+		const unsigned char *pUuid;
+		pChunk->m_Type = CHUNK_EX;
+		if(!ReadRaw(sizeof(CUuid), &pUuid) || !ReadInt(&pChunk->m_DataSize) || !ReadRaw(pChunk->m_DataSize, &pChunk->m_pData))
+			return false;
+		mem_copy(&pChunk->m_ExUuid, pUuid, sizeof(CUuid));
+		pChunk->m_ExType = g_UuidManager.LookupUuid(pChunk->m_ExUuid);
+		OnEx(pChunk);
+		break;
+	}
+	default:
+		return Fail("unknown chunk type");
+	}
+	pChunk->m_Tick = m_Tick;
+	return true;
+}
+
+void CTeeHistorianReader::OnEx(const CChunk *pChunk)
+{
+	if(pChunk->m_ExType != TEEHISTORIAN_PLAYER_NAME)
+		return;
+	int ClientId;
+	const unsigned char *pName = CVariableInt::Unpack(pChunk->m_pData, &ClientId, pChunk->m_DataSize);
+	if(pName == nullptr || ClientId < 0 || ClientId >= MAX_CLIENTS)
+		return;
+	const int NameSize = pChunk->m_pData + pChunk->m_DataSize - pName;
+	str_truncate(m_aPlayers[ClientId].m_aName, sizeof(m_aPlayers[ClientId].m_aName), reinterpret_cast<const char *>(pName), NameSize);
+}
+
+bool CTeeHistorianReader::Next(CChunk *pChunk)
+{
+	if(m_HavePending)
+	{
+		*pChunk = m_PendingChunk;
+		m_HavePending = false;
+		return true;
+	}
+	if(m_Finished || m_pError != nullptr || m_Offset >= m_vData.size())
+		return false;
+	return ParseChunk(pChunk);
+}
+
+bool CTeeHistorianReader::BuildIndex(int Interval)
+{
+	dbg_assert(Interval > 0, "invalid index interval");
+	m_vIndex.clear();
+	m_IndexInterval = Interval;
+	m_NextIndexTick = 0;
+	Rewind();
+	m_BuildingIndex = true;
+	CChunk Chunk;
+	while(Next(&Chunk))
+	{
+	}
+	m_BuildingIndex = false;
+	Rewind();
+	return m_pError == nullptr;
+}
+
+bool CTeeHistorianReader::Seek(int Tick)
+{
+	auto It = std::upper_bound(m_vIndex.begin(), m_vIndex.end(), Tick, [](int Value, const CState &State) {
+		return Value < State.m_ChunkTick;
+	});
+	if(It == m_vIndex.begin())
+		Rewind();
+	else
+		RestoreState(&*(It - 1));
+
+	CChunk Chunk;
+	while(Next(&Chunk))
+	{
+		if(Chunk.m_Tick >= Tick)
+		{
+			m_PendingChunk = Chunk;
+			m_HavePending = true;
+			return true;
+		}
+	}
+	return false;
+}
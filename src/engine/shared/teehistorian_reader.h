@@ -0,0 +1,170 @@
+#ifndef ENGINE_SHARED_TEEHISTORIAN_READER_H
+#define ENGINE_SHARED_TEEHISTORIAN_READER_H
+
+#include <base/system.h>
+
+#include <engine/shared/protocol.h>
+#include <engine/shared/uuid_manager.h>
+
+#include <cstddef>
+#include <vector>
+
+/**
+ * Reads teehistorian files, plain or gzip compressed, chunk by chunk.
+ *
+ * The reader keeps the state that is needed to undo the diff encoding of the
+ * stream, so the chunks contain absolute player positions and inputs. An
+ * optional seek index stores this state in regular tick intervals, so reading
+ * can start at any tick without decoding the file from the start.
+ */
+class CTeeHistorianReader
+{
+public:
+	enum
+	{
+		NUM_INPUT_INTS = 10,
+	};
+
+	enum EChunkType
+	{
+		CHUNK_FINISH,
+		CHUNK_PLAYER_DIFF,
+		CHUNK_PLAYER_NEW,
+		CHUNK_PLAYER_OLD,
+		CHUNK_INPUT_DIFF,
+		CHUNK_INPUT_NEW,
+		CHUNK_MESSAGE,
+		CHUNK_JOIN,
+		CHUNK_DROP,
+		CHUNK_CONSOLE_COMMAND,
+		CHUNK_EX,
+	};
+
+	class CPlayer
+	{
+	public:
+		bool m_Alive;
+		int m_X;
+		int m_Y;
+		bool m_HaveInput;
+		int m_aInput[NUM_INPUT_INTS];
+		// from the last player name chunk, empty after the player dropped
+		char m_aName[MAX_NAME_LENGTH];
+	};
+
+	class CChunk
+	{
+	public:
+		int m_Type;
+		int m_Tick;
+		// -1 for chunks that do not belong to a player
+		int m_ClientId;
+		// payload of CHUNK_MESSAGE and CHUNK_EX, pointing into the file data
+		const unsigned char *m_pData;
+		int m_DataSize;
+		// drop reason or console command
+		const char *m_pString;
+		// console command arguments, stored after each other with null termination
+		const char *m_pArgs;
+		int m_NumArgs;
+		int m_FlagMask;
+		CUuid m_ExUuid;
+		// id of m_ExUuid in g_UuidManager, UUID_UNKNOWN if it is not registered
+		int m_ExType;
+	};
+
+	/**
+	 * Reads and, if necessary, decompresses the whole file.
+	 *
+	 * @return `false` if the file could not be read or is not a teehistorian file.
+	 */
+	bool Load(IOHANDLE File);
+	bool Load(const void *pData, size_t DataSize);
+
+	/**
+	 * Returns the null-terminated JSON header of the file.
+	 */
+	const char *HeaderJson() const { return m_pHeaderJson; }
+	/**
+	 * Returns a description of the error if reading failed, `nullptr` otherwise.
+	 */
+	const char *Error() const { return m_pError; }
+	size_t DataSize() const { return m_vData.size(); }
+
+	/**
+	 * Reads the next chunk.
+	 *
+	 * @return `false` at the end of the file, after the finish chunk or on errors.
+	 */
+	bool Next(CChunk *pChunk);
+	int Tick() const { return m_Tick; }
+	const CPlayer &Player(int ClientId) const { return m_aPlayers[ClientId]; }
+
+	/**
+	 * Reads the file once and remembers the reader state about every `Interval`
+	 * ticks. Reading continues at the start of the file afterwards.
+	 */
+	bool BuildIndex(int Interval);
+	int NumIndexEntries() const { return m_vIndex.size(); }
+	int IndexTick(int Index) const { return m_vIndex[Index].m_ChunkTick; }
+
+	/**
+	 * Continues reading at the first chunk of `Tick` or the first chunk after it.
+	 * Uses the seek index if it was built, otherwise reads from the start.
+	 *
+	 * @return `false` if the file ends before `Tick`.
+	 */
+	bool Seek(int Tick);
+
+	/**
+	 * Rewinds to the first chunk after the header.
+	 */
+	void Rewind();
+
+private:
+	class CState
+	{
+	public:
+		size_t m_Offset;
+		// tick of the chunk at m_Offset
+		int m_ChunkTick;
+		int m_Tick;
+		int m_LastPlayerId;
+		CPlayer m_aPlayers[MAX_CLIENTS];
+	};
+
+	bool Init();
+	bool ParseHeader();
+	bool ReadInt(int *pValue);
+	bool ReadString(const char **ppStr);
+	bool ReadRaw(int Size, const unsigned char **ppData);
+	bool Fail(const char *pError);
+	bool ParseChunk(CChunk *pChunk);
+	// called before the chunk at ChunkOffset changes the tick or the player state
+	void AdvanceTick(int NewTick, size_t ChunkOffset);
+	void OnEx(const CChunk *pChunk);
+	void RestoreState(const CState *pState);
+
+	std::vector<unsigned char> m_vData;
+	const char *m_pHeaderJson = nullptr;
+	const char *m_pError = nullptr;
+	size_t m_FirstChunk = 0;
+	size_t m_Offset = 0;
+	bool m_Finished = false;
+
+	int m_Tick = 0;
+	// last player with a position chunk in the current tick, a position chunk
+	// with a lower or equal id starts a new tick
+	int m_LastPlayerId = MAX_CLIENTS;
+	CPlayer m_aPlayers[MAX_CLIENTS];
+
+	std::vector<CState> m_vIndex;
+	int m_IndexInterval = 0;
+	int m_NextIndexTick = 0;
+	bool m_BuildingIndex = false;
+
+	bool m_HavePending = false;
+	CChunk m_PendingChunk;
+};
+
+#endif // ENGINE_SHARED_TEEHISTORIAN_READER_H
@@ -329,6 +329,10 @@ public:
 	virtual bool LoadFonts() = 0;
 	virtual void SetFontPreset(EFontPreset FontPreset) = 0;
 	virtual void SetFontLanguageVariant(const char *pLanguageFile) = 0;
+	/**
+	 * Renders the printable ASCII glyphs for the given font size in the current screen mapping ahead of time.
+	 */
+	virtual void PrewarmGlyphs(float FontSize) = 0;
 
 	virtual void SetRenderFlags(unsigned Flags) = 0;
 	virtual unsigned GetRenderFlags() const = 0;
@@ -385,6 +389,11 @@ class IEngineTextRender : public ITextRender
 public:
 	virtual void Init() = 0;
 	virtual void Shutdown() override = 0;
+
+	/**
+	 * Uploads the glyphs that were added during the frame, must be called once per frame before swapping.
+	 */
+	virtual void OnFrameEnd() = 0;
 };
 
 extern IEngineTextRender *CreateEngineTextRender();
@@ -121,19 +121,36 @@ protected:
 	IGraphics::CTextureHandle m_Texture;
 	float m_Rotation = 0.0f;
 	ColorRGBA m_Color = ColorRGBA(1.0f, 1.0f, 1.0f, 1.0f);
+	int m_QuadContainerIndex = -1;
+	vec2 m_QuadSize = vec2(0.0f, 0.0f);
 	CNamePlatePartIcon(CGameClient &This) :
 		CNamePlatePart(This) {}
+	// Recreates the centered quad if the size changed, call after setting m_Size
+	void UpdateQuad(CGameClient &This)
+	{
+		if(m_QuadContainerIndex != -1 && m_QuadSize == m_Size)
+			return;
+		This.Graphics()->DeleteQuadContainer(m_QuadContainerIndex);
+		m_QuadContainerIndex = This.Graphics()->CreateQuadContainer(false);
+		This.Graphics()->QuadsSetSubset(0.0f, 0.0f, 1.0f, 1.0f);
+		This.RenderTools()->QuadContainerAddSprite(m_QuadContainerIndex, m_Size.x, m_Size.y);
+		This.Graphics()->QuadContainerUpload(m_QuadContainerIndex);
+		m_QuadSize = m_Size;
+	}
 
 public:
+	void Reset(CGameClient &This) override
+	{
+		This.Graphics()->DeleteQuadContainer(m_QuadContainerIndex);
+	}
 	void Render(CGameClient &This, vec2 Pos) const override
 	{
-		IGraphics::CQuadItem QuadItem(Pos.x - Size().x / 2.0f, Pos.y - Size().y / 2.0f, Size().x, Size().y);
+		if(m_QuadContainerIndex == -1)
+			return;
 		This.Graphics()->TextureSet(m_Texture);
-		This.Graphics()->QuadsBegin();
 		This.Graphics()->SetColor(m_Color);
 		This.Graphics()->QuadsSetRotation(m_Rotation);
-		This.Graphics()->QuadsDrawTL(&QuadItem, 1);
-		This.Graphics()->QuadsEnd();
+		This.Graphics()->RenderQuadContainerAsSprite(m_QuadContainerIndex, 0, Pos.x, Pos.y);
 		This.Graphics()->QuadsSetRotation(0.0f);
 	}
 };
@@ -146,19 +163,41 @@ protected:
 	int m_SpriteFlags = 0;
 	float m_Rotation = 0.0f;
 	ColorRGBA m_Color = ColorRGBA(1.0f, 1.0f, 1.0f, 1.0f);
+	int m_QuadContainerIndex = -1;
+	vec2 m_QuadSize = vec2(0.0f, 0.0f);
+	int m_QuadSprite = -1;
+	int m_QuadSpriteFlags = 0;
 	CNamePlatePartSprite(CGameClient &This) :
 		CNamePlatePart(This) {}
+	// Recreates the centered quad if the size or sprite changed, call after setting m_Size and m_Sprite
+	void UpdateQuad(CGameClient &This)
+	{
+		if(m_QuadContainerIndex != -1 && m_QuadSize == m_Size && m_QuadSprite == m_Sprite && m_QuadSpriteFlags == m_SpriteFlags)
+			return;
+		This.Graphics()->DeleteQuadContainer(m_QuadContainerIndex);
+		m_QuadContainerIndex = This.Graphics()->CreateQuadContainer(false);
+		This.RenderTools()->SelectSprite(m_Sprite, m_SpriteFlags);
+		This.RenderTools()->QuadContainerAddSprite(m_QuadContainerIndex, m_Size.x, m_Size.y);
+		This.Graphics()->QuadsSetSubset(0.0f, 0.0f, 1.0f, 1.0f);
+		This.Graphics()->QuadContainerUpload(m_QuadContainerIndex);
+		m_QuadSize = m_Size;
+		m_QuadSprite = m_Sprite;
+		m_QuadSpriteFlags = m_SpriteFlags;
+	}
 
 public:
+	void Reset(CGameClient &This) override
+	{
+		This.Graphics()->DeleteQuadContainer(m_QuadContainerIndex);
+	}
 	void Render(CGameClient &This, vec2 Pos) const override
 	{
+		if(m_QuadContainerIndex == -1)
+			return;
 		This.Graphics()->TextureSet(m_Texture);
-		This.Graphics()->QuadsSetRotation(m_Rotation);
-		This.Graphics()->QuadsBegin();
 		This.Graphics()->SetColor(m_Color);
-		This.RenderTools()->SelectSprite(m_Sprite, m_SpriteFlags);
-		This.RenderTools()->DrawSprite(Pos.x, Pos.y, Size().x, Size().y);
-		This.Graphics()->QuadsEnd();
+		This.Graphics()->QuadsSetRotation(m_Rotation);
+		This.Graphics()->RenderQuadContainerAsSprite(m_QuadContainerIndex, 0, Pos.x, Pos.y);
 		This.Graphics()->QuadsSetRotation(0.0f);
 	}
 };
@@ -230,6 +269,8 @@ public:
 			break;
 		}
 		m_Color.a = Data.m_Color.a;
+		if(m_Visible)
+			UpdateQuad(This);
 	}
 };
 
@@ -398,6 +439,7 @@ protected:
 			break;
 		}
 		m_Color.a = Data.m_Color.a;
+		UpdateQuad(This);
 	}
 
 public:
@@ -612,27 +654,91 @@ public:
 class CNamePlate
 {
 private:
+	// Layout relevant state of a part together with its position relative to the bottom middle of the name plate
+	class CPartLayout
+	{
+	public:
+		bool m_Visible = false;
+		bool m_ShiftOnInvis = false;
+		vec2 m_Size = vec2(0.0f, 0.0f);
+		vec2 m_Padding = vec2(0.0f, 0.0f);
+		vec2 m_Offset = vec2(0.0f, 0.0f);
+	};
+
 	bool m_Inited = false;
 	bool m_InGame = false;
 	PartsVector m_vpParts;
-	void RenderLine(CGameClient &This,
-		vec2 Pos, vec2 Size,
-		PartsVector::iterator Start, PartsVector::iterator End)
+	std::vector<CPartLayout> m_vPartLayouts;
+	vec2 m_Size = vec2(0.0f, 0.0f);
+	void LayoutLine(vec2 Pos, vec2 Size, size_t Start, size_t End)
 	{
 		Pos.x -= Size.x / 2.0f;
-		for(auto PartIt = Start; PartIt != End; ++PartIt)
+		for(size_t Index = Start; Index < End; ++Index)
 		{
-			const CNamePlatePart &Part = **PartIt;
-			if(Part.Visible())
-			{
-				Part.Render(This, vec2(
-							  Pos.x + (Part.Padding().x + Part.Size().x) / 2.0f,
-							  Pos.y - std::max(Size.y, Part.Padding().y + Part.Size().y) / 2.0f));
-			}
+			const CNamePlatePart &Part = *m_vpParts[Index];
+			m_vPartLayouts[Index].m_Offset = vec2(
+				Pos.x + (Part.Padding().x + Part.Size().x) / 2.0f,
+				Pos.y - std::max(Size.y, Part.Padding().y + Part.Size().y) / 2.0f);
 			if(Part.Visible() || Part.ShiftOnInvis())
 				Pos.x += Part.Size().x + Part.Padding().x;
 		}
 	}
+	// Returns whether the visibility or size of any part changed since the last layout
+	bool LayoutChanged() const
+	{
+		for(size_t Index = 0; Index < m_vpParts.size(); ++Index)
+		{
+			const CNamePlatePart &Part = *m_vpParts[Index];
+			const CPartLayout &Layout = m_vPartLayouts[Index];
+			if(Layout.m_Visible != Part.Visible() || Layout.m_ShiftOnInvis != Part.ShiftOnInvis() ||
+				Layout.m_Size != Part.Size() || Layout.m_Padding != Part.Padding())
+				return true;
+		}
+		return false;
+	}
+	void Layout()
+	{
+		for(size_t Index = 0; Index < m_vpParts.size(); ++Index)
+		{
+			const CNamePlatePart &Part = *m_vpParts[Index];
+			CPartLayout &Layout = m_vPartLayouts[Index];
+			Layout.m_Visible = Part.Visible();
+			Layout.m_ShiftOnInvis = Part.ShiftOnInvis();
+			Layout.m_Size = Part.Size();
+			Layout.m_Padding = Part.Padding();
+		}
+
+		vec2 Position = vec2(0.0f, 0.0f);
+		// X: Total width including padding of line, Y: Max height of line parts
+		vec2 LineSize = vec2(0.0f, 0.0f);
+		float WMax = 0.0f;
+		bool Empty = true;
+		size_t Start = 0;
+		for(size_t Index = 0; Index < m_vpParts.size(); ++Index)
+		{
+			const CNamePlatePart &Part = *m_vpParts[Index];
+			if(Part.NewLine())
+			{
+				if(!Empty)
+				{
+					LayoutLine(Position, LineSize, Start, Index + 1);
+					Position.y -= LineSize.y;
+					WMax = std::max(WMax, LineSize.x);
+				}
+				Start = Index + 1;
+				LineSize = vec2(0.0f, 0.0f);
+			}
+			else if(Part.Visible() || Part.ShiftOnInvis())
+			{
+				Empty = false;
+				LineSize.x += Part.Size().x + Part.Padding().x;
+				LineSize.y = std::max(LineSize.y, Part.Size().y + Part.Padding().y);
+			}
+		}
+		LayoutLine(Position, LineSize, Start, m_vpParts.size());
+		WMax = std::max(WMax, LineSize.x);
+		m_Size = vec2(WMax, LineSize.y - Position.y);
+	}
 	template<typename PartType, typename... ArgsType>
 	void AddPart(CGameClient &This, ArgsType &&... Args)
 	{
@@ -669,6 +775,9 @@ private:
 
 		AddPart<CNamePlatePartHookStrongWeak>(This);
 		AddPart<CNamePlatePartHookStrongWeakId>(This);
+
+		m_vPartLayouts.resize(m_vpParts.size());
+		Layout();
 	}
 
 public:
@@ -689,70 +798,25 @@ public:
 		m_InGame = Data.m_InGame;
 		for(auto &Part : m_vpParts)
 			Part->Update(This, Data);
+		// The parts keep their text containers and quads, only redo the layout when any of them changed
+		if(LayoutChanged())
+			Layout();
 	}
 	void Render(CGameClient &This, const vec2 &PositionBottomMiddle)
 	{
 		dbg_assert(m_Inited, "Tried to render uninited nameplate");
-		vec2 Position = PositionBottomMiddle;
-		// X: Total width including padding of line, Y: Max height of line parts
-		vec2 LineSize = vec2(0.0f, 0.0f);
-		bool Empty = true;
-		auto Start = m_vpParts.begin();
-		for(auto PartIt = m_vpParts.begin(); PartIt != m_vpParts.end(); ++PartIt)
+		for(size_t Index = 0; Index < m_vpParts.size(); ++Index)
 		{
-			CNamePlatePart &Part = **PartIt;
-			if(Part.NewLine())
-			{
-				if(!Empty)
-				{
-					RenderLine(This, Position, LineSize, Start, std::next(PartIt));
-					Position.y -= LineSize.y;
-				}
-				Start = std::next(PartIt);
-				LineSize = vec2(0.0f, 0.0f);
-			}
-			else if(Part.Visible() || Part.ShiftOnInvis())
-			{
-				Empty = false;
-				LineSize.x += Part.Size().x + Part.Padding().x;
-				LineSize.y = std::max(LineSize.y, Part.Size().y + Part.Padding().y);
-			}
+			const CNamePlatePart &Part = *m_vpParts[Index];
+			if(Part.Visible())
+				Part.Render(This, PositionBottomMiddle + m_vPartLayouts[Index].m_Offset);
 		}
-		RenderLine(This, Position, LineSize, Start, m_vpParts.end());
 		This.Graphics()->SetColor(1.0f, 1.0f, 1.0f, 1.0f);
 	}
 	vec2 Size() const
 	{
 		dbg_assert(m_Inited, "Tried to get size of uninited nameplate");
-		// X: Total width including padding of line, Y: Max height of line parts
-		vec2 LineSize = vec2(0.0f, 0.0f);
-		float WMax = 0.0f;
-		float HTotal = 0.0f;
-		bool Empty = true;
-		for(auto PartIt = m_vpParts.begin(); PartIt != m_vpParts.end(); ++PartIt) // NOLINT(modernize-loop-convert) For consistency with Render
-		{
-			CNamePlatePart &Part = **PartIt;
-			if(Part.NewLine())
-			{
-				if(!Empty)
-				{
-					if(LineSize.x > WMax)
-						WMax = LineSize.x;
-					HTotal += LineSize.y;
-				}
-				LineSize = vec2(0.0f, 0.0f);
-			}
-			else if(Part.Visible() || Part.ShiftOnInvis())
-			{
-				Empty = false;
-				LineSize.x += Part.Size().x + Part.Padding().x;
-				LineSize.y = std::max(LineSize.y, Part.Size().y + Part.Padding().y);
-			}
-		}
-		if(LineSize.x > WMax)
-			WMax = LineSize.x;
-		HTotal += LineSize.y;
-		return vec2(WMax, HTotal);
+		return m_Size;
 	}
 };
 
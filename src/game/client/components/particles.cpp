@@ -20,21 +20,97 @@ CParticles::CParticles()
 	m_RenderGeneral.m_pParts = this;
 }
 
-void CParticles::OnReset()
+void CParticles::CParticleGroup::Clear()
 {
-	// reset particles
-	for(int i = 0; i < MAX_PARTICLES; i++)
+	Resize(0);
+}
+
+void CParticles::CParticleGroup::Resize(size_t Size)
+{
+	m_vPosX.resize(Size);
+	m_vPosY.resize(Size);
+	m_vVelX.resize(Size);
+	m_vVelY.resize(Size);
+	m_vLife.resize(Size);
+	m_vLifeSpan.resize(Size);
+	m_vStartSize.resize(Size);
+	m_vEndSize.resize(Size);
+	m_vStartAlpha.resize(Size);
+	m_vEndAlpha.resize(Size);
+	m_vRot.resize(Size);
+	m_vRotspeed.resize(Size);
+	m_vGravity.resize(Size);
+	m_vFriction.resize(Size);
+	m_vColor.resize(Size);
+	m_vSpr.resize(Size);
+	m_vUseAlphaFading.resize(Size);
+	m_vCollides.resize(Size);
+}
+
+void CParticles::CParticleGroup::Add(const CParticle &Part, float Life)
+{
+	m_vPosX.push_back(Part.m_Pos.x);
+	m_vPosY.push_back(Part.m_Pos.y);
+	m_vVelX.push_back(Part.m_Vel.x);
+	m_vVelY.push_back(Part.m_Vel.y);
+	m_vLife.push_back(Life);
+	m_vLifeSpan.push_back(Part.m_LifeSpan);
+	m_vStartSize.push_back(Part.m_StartSize);
+	m_vEndSize.push_back(Part.m_EndSize);
+	m_vStartAlpha.push_back(Part.m_StartAlpha);
+	m_vEndAlpha.push_back(Part.m_EndAlpha);
+	m_vRot.push_back(Part.m_Rot);
+	m_vRotspeed.push_back(Part.m_Rotspeed);
+	m_vGravity.push_back(Part.m_Gravity);
+	m_vFriction.push_back(Part.m_Friction);
+	m_vColor.push_back(Part.m_Color);
+	m_vSpr.push_back(Part.m_Spr);
+	m_vUseAlphaFading.push_back(Part.m_UseAlphaFading);
+	m_vCollides.push_back(Part.m_Collides);
+}
+
+size_t CParticles::CParticleGroup::RemoveDead()
+{
+	const size_t OldSize = Size();
+	size_t NewSize = 0;
+	for(size_t i = 0; i < OldSize; i++)
 	{
-		m_aParticles[i].m_PrevPart = i - 1;
-		m_aParticles[i].m_NextPart = i + 1;
-	}
+		if(m_vLife[i] > m_vLifeSpan[i])
+			continue;
 
-	m_aParticles[0].m_PrevPart = 0;
-	m_aParticles[MAX_PARTICLES - 1].m_NextPart = -1;
-	m_FirstFree = 0;
+		if(NewSize != i)
+		{
+			m_vPosX[NewSize] = m_vPosX[i];
+			m_vPosY[NewSize] = m_vPosY[i];
+			m_vVelX[NewSize] = m_vVelX[i];
+			m_vVelY[NewSize] = m_vVelY[i];
+			m_vLife[NewSize] = m_vLife[i];
+			m_vLifeSpan[NewSize] = m_vLifeSpan[i];
+			m_vStartSize[NewSize] = m_vStartSize[i];
+			m_vEndSize[NewSize] = m_vEndSize[i];
+			m_vStartAlpha[NewSize] = m_vStartAlpha[i];
+			m_vEndAlpha[NewSize] = m_vEndAlpha[i];
+			m_vRot[NewSize] = m_vRot[i];
+			m_vRotspeed[NewSize] = m_vRotspeed[i];
+			m_vGravity[NewSize] = m_vGravity[i];
+			m_vFriction[NewSize] = m_vFriction[i];
+			m_vColor[NewSize] = m_vColor[i];
+			m_vSpr[NewSize] = m_vSpr[i];
+			m_vUseAlphaFading[NewSize] = m_vUseAlphaFading[i];
+			m_vCollides[NewSize] = m_vCollides[i];
+		}
+		NewSize++;
+	}
+	Resize(NewSize);
+	return OldSize - NewSize;
+}
 
-	for(int &FirstPart : m_aFirstPart)
-		FirstPart = -1;
+void CParticles::OnReset()
+{
+	// reset particles
+	for(CParticleGroup &Group : m_aGroups)
+		Group.Clear();
+	m_NumParticles = 0;
 }
 
 void CParticles::Add(int Group, CParticle *pPart, float TimePassed)
@@ -51,27 +127,11 @@ void CParticles::Add(int Group, CParticle *pPart, float TimePassed)
 			return;
 	}
 
-	if(m_FirstFree == -1)
+	if(m_NumParticles >= MAX_PARTICLES)
 		return;
 
-	// remove from the free list
-	int Id = m_FirstFree;
-	m_FirstFree = m_aParticles[Id].m_NextPart;
-	if(m_FirstFree != -1)
-		m_aParticles[m_FirstFree].m_PrevPart = -1;
-
-	// copy data
-	m_aParticles[Id] = *pPart;
-
-	// insert to the group list
-	m_aParticles[Id].m_PrevPart = -1;
-	m_aParticles[Id].m_NextPart = m_aFirstPart[Group];
-	if(m_aFirstPart[Group] != -1)
-		m_aParticles[m_aFirstPart[Group]].m_PrevPart = Id;
-	m_aFirstPart[Group] = Id;
-
-	// set some parameters
-	m_aParticles[Id].m_Life = TimePassed;
+	m_aGroups[Group].Add(*pPart, TimePassed);
+	m_NumParticles++;
 }
 
 void CParticles::Update(float TimePassed)
@@ -91,56 +151,93 @@ void CParticles::Update(float TimePassed)
 		m_FrictionFraction -= 0.05f;
 	}
 
-	for(int &FirstPart : m_aFirstPart)
+	for(CParticleGroup &Group : m_aGroups)
 	{
-		int i = FirstPart;
-		while(i != -1)
-		{
-			int Next = m_aParticles[i].m_NextPart;
-			//m_aParticles[i].vel += flow_get(m_aParticles[i].pos)*time_passed * m_aParticles[i].flow_affected;
-			m_aParticles[i].m_Vel.y += m_aParticles[i].m_Gravity * TimePassed;
+		UpdateGroup(Group, TimePassed, FrictionCount);
+		m_NumParticles -= Group.RemoveDead();
+	}
+}
 
-			for(int f = 0; f < FrictionCount; f++) // apply friction
-				m_aParticles[i].m_Vel *= m_aParticles[i].m_Friction;
+void CParticles::UpdateGroup(CParticleGroup &Group, float TimePassed, int FrictionCount)
+{
+	const size_t Num = Group.Size();
+	if(Num == 0)
+		return;
 
-			// move the point
-			vec2 Vel = m_aParticles[i].m_Vel * TimePassed;
-			if(m_aParticles[i].m_Collides)
-			{
-				Collision()->MovePoint(&m_aParticles[i].m_Pos, &Vel, random_float(0.1f, 1.0f), nullptr);
-			}
-			else
-			{
-				m_aParticles[i].m_Pos += Vel;
-			}
-			m_aParticles[i].m_Vel = Vel * (1.0f / TimePassed);
+	// The loops only work on plain arrays, so the compiler can vectorize them
+	float *pPosX = Group.m_vPosX.data();
+	float *pPosY = Group.m_vPosY.data();
+	float *pVelX = Group.m_vVelX.data();
+	float *pVelY = Group.m_vVelY.data();
+	const float *pGravity = Group.m_vGravity.data();
+	const float *pFriction = Group.m_vFriction.data();
+	const uint8_t *pCollides = Group.m_vCollides.data();
 
-			m_aParticles[i].m_Life += TimePassed;
-			m_aParticles[i].m_Rot += TimePassed * m_aParticles[i].m_Rotspeed;
+	for(size_t i = 0; i < Num; i++)
+		pVelY[i] += pGravity[i] * TimePassed;
 
-			// check particle death
-			if(m_aParticles[i].m_Life > m_aParticles[i].m_LifeSpan)
-			{
-				// remove it from the group list
-				if(m_aParticles[i].m_PrevPart != -1)
-					m_aParticles[m_aParticles[i].m_PrevPart].m_NextPart = m_aParticles[i].m_NextPart;
-				else
-					FirstPart = m_aParticles[i].m_NextPart;
-
-				if(m_aParticles[i].m_NextPart != -1)
-					m_aParticles[m_aParticles[i].m_NextPart].m_PrevPart = m_aParticles[i].m_PrevPart;
-
-				// insert to the free list
-				if(m_FirstFree != -1)
-					m_aParticles[m_FirstFree].m_PrevPart = i;
-				m_aParticles[i].m_PrevPart = -1;
-				m_aParticles[i].m_NextPart = m_FirstFree;
-				m_FirstFree = i;
-			}
+	for(int f = 0; f < FrictionCount; f++) // apply friction
+	{
+		for(size_t i = 0; i < Num; i++)
+		{
+			pVelX[i] *= pFriction[i];
+			pVelY[i] *= pFriction[i];
+		}
+	}
+
+	// velocity becomes the movement of this update
+	for(size_t i = 0; i < Num; i++)
+	{
+		pVelX[i] *= TimePassed;
+		pVelY[i] *= TimePassed;
+	}
 
-			i = Next;
+	// move the points that don't collide and collect the others for a separate collision pass
+	m_vCollisionIndices.clear();
+	for(size_t i = 0; i < Num; i++)
+	{
+		if(pCollides[i])
+		{
+			m_vCollisionIndices.push_back(i);
+		}
+		else
+		{
+			pPosX[i] += pVelX[i];
+			pPosY[i] += pVelY[i];
 		}
 	}
+
+	// most colliding particles move through empty space, only bounce the ones that hit something
+	for(int i : m_vCollisionIndices)
+	{
+		if(Collision()->CheckPoint(pPosX[i] + pVelX[i], pPosY[i] + pVelY[i]))
+		{
+			vec2 Pos = vec2(pPosX[i], pPosY[i]);
+			vec2 Vel = vec2(pVelX[i], pVelY[i]);
+			Collision()->MovePoint(&Pos, &Vel, random_float(0.1f, 1.0f), nullptr);
+			pPosX[i] = Pos.x;
+			pPosY[i] = Pos.y;
+			pVelX[i] = Vel.x;
+			pVelY[i] = Vel.y;
+		}
+		else
+		{
+			pPosX[i] += pVelX[i];
+			pPosY[i] += pVelY[i];
+		}
+	}
+
+	const float InvTimePassed = 1.0f / TimePassed;
+	float *pLife = Group.m_vLife.data();
+	float *pRot = Group.m_vRot.data();
+	const float *pRotspeed = Group.m_vRotspeed.data();
+	for(size_t i = 0; i < Num; i++)
+	{
+		pVelX[i] *= InvTimePassed;
+		pVelY[i] *= InvTimePassed;
+		pLife[i] += TimePassed;
+		pRot[i] += TimePassed * pRotspeed[i];
+	}
 }
 
 void CParticles::OnRender()
@@ -218,84 +315,66 @@ void CParticles::RenderGroup(int Group)
 		ParticleQuadContainerIndex = m_ExtraParticleQuadContainerIndex;
 	}
 
+	const CParticleGroup &Parts = m_aGroups[Group];
+	if(Parts.Size() == 0)
+		return;
+
+	const auto &&ParticleAlpha = [&](size_t i, float a) {
+		if(Parts.m_vUseAlphaFading[i])
+			return mix(Parts.m_vStartAlpha[i], Parts.m_vEndAlpha[i], a);
+		return Parts.m_vColor[i].a;
+	};
+
+	// newest particles are rendered first
 	// don't use the buffer methods here, else the old renderer gets many draw calls
 	if(Graphics()->IsQuadContainerBufferingEnabled())
 	{
-		int i = m_aFirstPart[Group];
-
 		static IGraphics::SRenderSpriteInfo s_aParticleRenderInfo[MAX_PARTICLES];
 
 		int CurParticleRenderCount = 0;
 
 		// batching makes sense for stuff like ninja particles
 		ColorRGBA LastColor;
-		int LastQuadOffset = 0;
-
-		if(i != -1)
+		int LastQuadOffset;
 		{
-			float Alpha = m_aParticles[i].m_Color.a;
-			if(m_aParticles[i].m_UseAlphaFading)
-			{
-				float a = m_aParticles[i].m_Life / m_aParticles[i].m_LifeSpan;
-				Alpha = mix(m_aParticles[i].m_StartAlpha, m_aParticles[i].m_EndAlpha, a);
-			}
-			LastColor.r = m_aParticles[i].m_Color.r;
-			LastColor.g = m_aParticles[i].m_Color.g;
-			LastColor.b = m_aParticles[i].m_Color.b;
-			LastColor.a = Alpha;
-
-			Graphics()->SetColor(
-				m_aParticles[i].m_Color.r,
-				m_aParticles[i].m_Color.g,
-				m_aParticles[i].m_Color.b,
-				Alpha);
-
-			LastQuadOffset = m_aParticles[i].m_Spr;
+			const size_t i = Parts.Size() - 1;
+			LastColor = Parts.m_vColor[i];
+			LastColor.a = ParticleAlpha(i, Parts.m_vLife[i] / Parts.m_vLifeSpan[i]);
+			Graphics()->SetColor(LastColor);
+			LastQuadOffset = Parts.m_vSpr[i];
 		}
 
-		while(i != -1)
+		for(size_t i = Parts.Size(); i-- > 0;)
 		{
-			int QuadOffset = m_aParticles[i].m_Spr;
-			float a = m_aParticles[i].m_Life / m_aParticles[i].m_LifeSpan;
-			vec2 p = m_aParticles[i].m_Pos;
-			float Size = mix(m_aParticles[i].m_StartSize, m_aParticles[i].m_EndSize, a);
-			float Alpha = m_aParticles[i].m_Color.a;
-			if(m_aParticles[i].m_UseAlphaFading)
-			{
-				Alpha = mix(m_aParticles[i].m_StartAlpha, m_aParticles[i].m_EndAlpha, a);
-			}
+			int QuadOffset = Parts.m_vSpr[i];
+			float a = Parts.m_vLife[i] / Parts.m_vLifeSpan[i];
+			vec2 p = vec2(Parts.m_vPosX[i], Parts.m_vPosY[i]);
+			float Size = mix(Parts.m_vStartSize[i], Parts.m_vEndSize[i], a);
+			float Alpha = ParticleAlpha(i, a);
+			const ColorRGBA &Color = Parts.m_vColor[i];
 
 			// the current position, respecting the size, is inside the viewport, render it, else ignore
 			if(ParticleIsVisibleOnScreen(p, Size))
 			{
-				if((size_t)CurParticleRenderCount == gs_GraphicsMaxParticlesRenderCount || LastColor.r != m_aParticles[i].m_Color.r || LastColor.g != m_aParticles[i].m_Color.g || LastColor.b != m_aParticles[i].m_Color.b || LastColor.a != Alpha || LastQuadOffset != QuadOffset)
+				if((size_t)CurParticleRenderCount == gs_GraphicsMaxParticlesRenderCount || LastColor.r != Color.r || LastColor.g != Color.g || LastColor.b != Color.b || LastColor.a != Alpha || LastQuadOffset != QuadOffset)
 				{
 					Graphics()->TextureSet(aParticles[LastQuadOffset - FirstParticleOffset]);
 					Graphics()->RenderQuadContainerAsSpriteMultiple(ParticleQuadContainerIndex, LastQuadOffset - FirstParticleOffset, CurParticleRenderCount, s_aParticleRenderInfo);
 					CurParticleRenderCount = 0;
 					LastQuadOffset = QuadOffset;
 
-					Graphics()->SetColor(
-						m_aParticles[i].m_Color.r,
-						m_aParticles[i].m_Color.g,
-						m_aParticles[i].m_Color.b,
-						Alpha);
-
-					LastColor.r = m_aParticles[i].m_Color.r;
-					LastColor.g = m_aParticles[i].m_Color.g;
-					LastColor.b = m_aParticles[i].m_Color.b;
+					LastColor = Color;
 					LastColor.a = Alpha;
+					Graphics()->SetColor(LastColor);
 				}
 
 				s_aParticleRenderInfo[CurParticleRenderCount].m_Pos[0] = p.x;
 				s_aParticleRenderInfo[CurParticleRenderCount].m_Pos[1] = p.y;
 				s_aParticleRenderInfo[CurParticleRenderCount].m_Scale = Size;
-				s_aParticleRenderInfo[CurParticleRenderCount].m_Rotation = m_aParticles[i].m_Rot;
+				s_aParticleRenderInfo[CurParticleRenderCount].m_Rotation = Parts.m_vRot[i];
 
 				++CurParticleRenderCount;
 			}
-
-			i = m_aParticles[i].m_NextPart;
 		}
 
 		Graphics()->TextureSet(aParticles[LastQuadOffset - FirstParticleOffset]);
@@ -303,42 +382,34 @@ void CParticles::RenderGroup(int Group)
 	}
 	else
 	{
-		int i = m_aFirstPart[Group];
-
 		Graphics()->BlendNormal();
 		Graphics()->WrapClamp();
 
-		while(i != -1)
+		for(size_t i = Parts.Size(); i-- > 0;)
 		{
-			float a = m_aParticles[i].m_Life / m_aParticles[i].m_LifeSpan;
-			vec2 p = m_aParticles[i].m_Pos;
-			float Size = mix(m_aParticles[i].m_StartSize, m_aParticles[i].m_EndSize, a);
-			float Alpha = m_aParticles[i].m_Color.a;
-			if(m_aParticles[i].m_UseAlphaFading)
-			{
-				Alpha = mix(m_aParticles[i].m_StartAlpha, m_aParticles[i].m_EndAlpha, a);
-			}
+			float a = Parts.m_vLife[i] / Parts.m_vLifeSpan[i];
+			vec2 p = vec2(Parts.m_vPosX[i], Parts.m_vPosY[i]);
+			float Size = mix(Parts.m_vStartSize[i], Parts.m_vEndSize[i], a);
+			float Alpha = ParticleAlpha(i, a);
 
 			// the current position, respecting the size, is inside the viewport, render it, else ignore
 			if(ParticleIsVisibleOnScreen(p, Size))
 			{
-				Graphics()->TextureSet(aParticles[m_aParticles[i].m_Spr - FirstParticleOffset]);
+				Graphics()->TextureSet(aParticles[Parts.m_vSpr[i] - FirstParticleOffset]);
 				Graphics()->QuadsBegin();
 
-				Graphics()->QuadsSetRotation(m_aParticles[i].m_Rot);
+				Graphics()->QuadsSetRotation(Parts.m_vRot[i]);
 
 				Graphics()->SetColor(
-					m_aParticles[i].m_Color.r,
-					m_aParticles[i].m_Color.g,
-					m_aParticles[i].m_Color.b,
+					Parts.m_vColor[i].r,
+					Parts.m_vColor[i].g,
+					Parts.m_vColor[i].b,
 					Alpha);
 
 				IGraphics::CQuadItem QuadItem(p.x, p.y, Size, Size);
 				Graphics()->QuadsDraw(&QuadItem, 1);
 				Graphics()->QuadsEnd();
 			}
-
-			i = m_aParticles[i].m_NextPart;
 		}
 		Graphics()->WrapNormal();
 		Graphics()->BlendNormal();
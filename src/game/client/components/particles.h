@@ -6,6 +6,9 @@
 #include <base/vmath.h>
 #include <game/client/component.h>
 
+#include <cstdint>
+#include <vector>
+
 // particles
 struct CParticle
 {
@@ -53,11 +56,6 @@ struct CParticle
 	ColorRGBA m_Color;
 
 	bool m_Collides;
-
-	// set by the particle system
-	float m_Life;
-	int m_PrevPart;
-	int m_NextPart;
 };
 
 class CParticles : public CComponent
@@ -93,15 +91,60 @@ private:
 		MAX_PARTICLES = 1024 * 8,
 	};
 
-	CParticle m_aParticles[MAX_PARTICLES];
-	int m_FirstFree;
-	int m_aFirstPart[NUM_GROUPS];
+	/**
+	 * Particles of one group stored as structure of arrays, so the update loops can be vectorized.
+	 * Alive particles are stored compactly in the order they were added.
+	 */
+	class CParticleGroup
+	{
+	public:
+		std::vector<float> m_vPosX;
+		std::vector<float> m_vPosY;
+		std::vector<float> m_vVelX;
+		std::vector<float> m_vVelY;
+		std::vector<float> m_vLife;
+		std::vector<float> m_vLifeSpan;
+		std::vector<float> m_vStartSize;
+		std::vector<float> m_vEndSize;
+		std::vector<float> m_vStartAlpha;
+		std::vector<float> m_vEndAlpha;
+		std::vector<float> m_vRot;
+		std::vector<float> m_vRotspeed;
+		std::vector<float> m_vGravity;
+		std::vector<float> m_vFriction;
+		std::vector<ColorRGBA> m_vColor;
+		std::vector<int> m_vSpr;
+		std::vector<uint8_t> m_vUseAlphaFading;
+		std::vector<uint8_t> m_vCollides;
+
+		size_t Size() const { return m_vLife.size(); }
+		void Clear();
+		void Add(const CParticle &Part, float Life);
+		/**
+		 * Removes all particles that exceeded their life span while keeping the order of the remaining ones.
+		 *
+		 * @return Number of removed particles.
+		 */
+		size_t RemoveDead();
+
+	private:
+		void Resize(size_t Size);
+	};
+
+	CParticleGroup m_aGroups[NUM_GROUPS];
+	size_t m_NumParticles;
+
+	/**
+	 * Indices of colliding particles that need a collision check, reused between updates.
+	 */
+	std::vector<int> m_vCollisionIndices;
 
 	float m_FrictionFraction = 0.0f;
 	int64_t m_LastRenderTime = 0;
 
 	void RenderGroup(int Group);
 	void Update(float TimePassed);
+	void UpdateGroup(CParticleGroup &Group, float TimePassed, int FrictionCount);
 
 	template<int TGROUP>
 	class CRenderGroup : public CComponent
@@ -1408,7 +1408,8 @@ void CPlayers::OnRender()
 		RenderHook(&pLocalClientData->m_RenderPrev, &pLocalClientData->m_RenderCur, &aRenderInfo[LocalClientId], LocalClientId);
 	}
 
-	// render spectating players
+	// render spectating players, they all use the same skin so they can be batched
+	RenderTools()->BeginTeeBatch();
 	for(const auto &Client : m_pClient->m_aClients)
 	{
 		if(!Client.m_SpecCharPresent)
@@ -1424,8 +1425,11 @@ void CPlayers::OnRender()
 		}
 		RenderTools()->RenderTee(CAnimState::GetIdle(), &RenderInfoSpec, EMOTE_BLINK, vec2(1, 0), Client.m_SpecChar, Alpha);
 	}
+	RenderTools()->EndTeeBatch();
 
 	// render everyone else's tee, then either our own or the tee we are spectating.
+	// These tees are not batched, the weapons, hands and emotes rendered between them would end up below
+	// the batched tees.
 	const int RenderLastId = (m_pClient->m_Snap.m_SpecInfo.m_SpectatorId != SPEC_FREEVIEW && m_pClient->m_Snap.m_SpecInfo.m_Active) ? m_pClient->m_Snap.m_SpecInfo.m_SpectatorId : LocalClientId;
 
 	for(int ClientId = 0; ClientId < MAX_CLIENTS; ClientId++)
@@ -440,6 +440,10 @@ void CSkins::LoadSkinFinish(CSkinContainer *pSkinContainer, const CSkinLoadData
 		Skin.m_ColorableSkin.m_aEyes[i] = Graphics()->LoadSpriteTexture(Data.m_InfoGrayscale, &g_pData->m_aSprites[SPRITE_TEE_EYE_NORMAL + i]);
 	}
 
+	// Skins with the standard resolution are additionally packed into the atlas for batched rendering
+	m_Atlas.Add(Data.m_Info, Skin.m_OriginalSkin);
+	m_Atlas.Add(Data.m_InfoGrayscale, Skin.m_ColorableSkin);
+
 	Skin.m_Metrics = Data.m_Metrics;
 	Skin.m_BloodColor = Data.m_BloodColor;
 
@@ -483,6 +487,14 @@ void CSkins::LoadSkinDirect(const char *pName)
 	DefaultSkinData.m_InfoGrayscale.Free();
 }
 
+void CSkins::UnloadSkin(CSkin *pSkin)
+{
+	m_Atlas.Remove(pSkin->m_OriginalSkin);
+	m_Atlas.Remove(pSkin->m_ColorableSkin);
+	pSkin->m_OriginalSkin.Unload(Graphics());
+	pSkin->m_ColorableSkin.Unload(Graphics());
+}
+
 void CSkins::OnConsoleInit()
 {
 	ConfigManager()->RegisterCallback(CSkins::ConfigSaveCallback, this);
@@ -505,6 +517,8 @@ void CSkins::OnInit()
 		}
 	}
 
+	m_Atlas.Init(Graphics());
+
 	// load skins
 	Refresh([this]() {
 		GameClient()->m_Menus.RenderLoading(Localize("Loading DDNet Client"), Localize("Loading skin files"), 0);
@@ -521,6 +535,7 @@ void CSkins::OnShutdown()
 		}
 	}
 	m_Skins.clear();
+	m_Atlas.Shutdown();
 }
 
 void CSkins::OnUpdate()
@@ -547,6 +562,7 @@ void CSkins::OnUpdate()
 	UpdateUnloadSkins(Stats);
 	UpdateStartLoading(Stats);
 	UpdateFinishLoading(Stats, StartTime, MaxTime);
+	m_Atlas.Update();
 }
 
 void CSkins::UpdateUnloadSkins(CSkinLoadingStats &Stats)
@@ -581,8 +597,7 @@ void CSkins::UpdateUnloadSkins(CSkinLoadingStats &Stats)
 		}
 		if(pSkinContainer->m_State == CSkinContainer::EState::LOADED)
 		{
-			pSkinContainer->m_pSkin->m_OriginalSkin.Unload(Graphics());
-			pSkinContainer->m_pSkin->m_ColorableSkin.Unload(Graphics());
+			UnloadSkin(pSkinContainer->m_pSkin.get());
 			pSkinContainer->m_pSkin = nullptr;
 			Stats.m_NumLoaded--;
 		}
@@ -684,12 +699,12 @@ void CSkins::Refresh(TSkinLoadedCallback &&SkinLoadedCallback)
 		}
 		if(pSkinContainer->m_pSkin)
 		{
-			pSkinContainer->m_pSkin->m_OriginalSkin.Unload(Graphics());
-			pSkinContainer->m_pSkin->m_ColorableSkin.Unload(Graphics());
+			UnloadSkin(pSkinContainer->m_pSkin.get());
 		}
 	}
 	m_Skins.clear();
 	m_SkinsUsageList.clear();
+	m_Atlas.Clear();
 
 	LoadSkinDirect("default");
 	SkinLoadedCallback();
@@ -698,6 +713,7 @@ void CSkins::Refresh(TSkinLoadedCallback &&SkinLoadedCallback)
 	SkinScanUser.m_pThis = this;
 	SkinScanUser.m_SkinLoadedCallback = SkinLoadedCallback;
 	Storage()->ListDirectory(IStorage::TYPE_ALL, "skins", SkinScan, &SkinScanUser);
+	m_Atlas.Update();
 }
 
 CSkins::CSkinLoadingStats CSkins::LoadingStats() const
@@ -10,6 +10,7 @@
 
 #include <game/client/component.h>
 #include <game/client/skin.h>
+#include <game/client/skin_atlas.h>
 
 #include <chrono>
 #include <list>
@@ -255,6 +256,8 @@ public:
 
 	void RandomizeSkin(int Dummy);
 
+	const CSkinAtlas &Atlas() const { return m_Atlas; }
+
 	static bool IsVanillaSkin(const char *pName);
 	static bool IsSpecialSkin(const char *pName);
 
@@ -303,11 +306,13 @@ private:
 	std::set<std::string> m_Favorites;
 
 	CSkin m_PlaceholderSkin;
+	CSkinAtlas m_Atlas;
 	char m_aEventSkinPrefix[MAX_SKIN_LENGTH];
 
 	bool LoadSkinData(const char *pName, CSkinLoadData &Data) const;
 	void LoadSkinFinish(CSkinContainer *pSkinContainer, const CSkinLoadData &Data);
 	void LoadSkinDirect(const char *pName);
+	void UnloadSkin(CSkin *pSkin);
 	const CSkin *FindImpl(const char *pName);
 	static int SkinScan(const char *pName, int IsDir, int StorageType, void *pUser);
 
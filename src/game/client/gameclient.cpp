@@ -373,6 +373,11 @@ void CGameClient::OnInit()
 	}
 	TextRender()->SetFontLanguageVariant(g_Config.m_ClLanguagefile);
 
+	// render the glyphs of the most common UI font sizes while the components are loading
+	Ui()->MapScreen();
+	for(const float FontSize : {10.0f, 12.0f, 14.0f})
+		TextRender()->PrewarmGlyphs(FontSize);
+
 	// update and swap after font loading, they are quite huge
 	Client()->UpdateAndSwap();
 
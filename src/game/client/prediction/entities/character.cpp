@@ -1188,9 +1188,9 @@ void CCharacter::DDRacePostCoreTick()
 	HandleSkippableTiles(CurrentIndex);
 
 	// handle Anti-Skip tiles
-	std::vector<int> vIndices = Collision()->GetMapIndices(m_PrevPos, m_Pos);
-	if(!vIndices.empty())
-		for(int Index : vIndices)
+	CCollision::CMapIndices Indices = Collision()->IterateMapIndices(m_PrevPos, m_Pos);
+	if(!Indices.empty())
+		for(int Index : Indices)
 			HandleTiles(Index);
 	else
 	{
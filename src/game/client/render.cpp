@@ -359,6 +359,9 @@ void CRenderTools::RenderTee(const CAnimState *pAnim, const CTeeRenderInfo *pInf
 
 void CRenderTools::RenderTee7(const CAnimState *pAnim, const CTeeRenderInfo *pInfo, int Emote, vec2 Dir, vec2 Pos, float Alpha)
 {
+	// 0.7 tees are never batched, pending tees must be rendered below them
+	FlushTeeBatch();
+
 	vec2 Direction = Dir;
 	vec2 Position = Pos;
 	const bool IsBot = pInfo->m_aSixup[g_Config.m_ClDummy].m_BotTexture.IsValid();
@@ -576,7 +579,44 @@ void CRenderTools::RenderTee7(const CAnimState *pAnim, const CTeeRenderInfo *pIn
 	}
 }
 
-void CRenderTools::RenderTee6(const CAnimState *pAnim, const CTeeRenderInfo *pInfo, int Emote, vec2 Dir, vec2 Pos, float Alpha) const
+void CRenderTools::BeginTeeBatch()
+{
+	++m_TeeBatchDepth;
+}
+
+void CRenderTools::EndTeeBatch()
+{
+	dbg_assert(m_TeeBatchDepth > 0, "EndTeeBatch called without BeginTeeBatch");
+	if(--m_TeeBatchDepth == 0)
+	{
+		FlushTeeBatch();
+	}
+}
+
+void CRenderTools::FlushTeeBatch()
+{
+	if(m_vTeeBatchQuads.empty())
+	{
+		return;
+	}
+
+	Graphics()->TextureSet(GameClient()->m_Skins.Atlas().PageTexture(m_TeeBatchPage));
+	Graphics()->QuadsBegin();
+	for(const CTeeBatchQuad &Quad : m_vTeeBatchQuads)
+	{
+		Graphics()->QuadsSetRotation(Quad.m_Rotation);
+		Graphics()->SetColor(Quad.m_Color);
+		Graphics()->QuadsSetSubset(Quad.m_Uv.m_U0, Quad.m_Uv.m_V0, Quad.m_Uv.m_U1, Quad.m_Uv.m_V1);
+		IGraphics::CQuadItem QuadItem(Quad.m_Pos.x, Quad.m_Pos.y, Quad.m_Size.x, Quad.m_Size.y);
+		Graphics()->QuadsDraw(&QuadItem, 1);
+	}
+	Graphics()->QuadsEnd();
+
+	m_vTeeBatchQuads.clear();
+	m_TeeBatchPage = -1;
+}
+
+void CRenderTools::RenderTee6(const CAnimState *pAnim, const CTeeRenderInfo *pInfo, int Emote, vec2 Dir, vec2 Pos, float Alpha)
 {
 	vec2 Direction = Dir;
 	vec2 Position = Pos;
@@ -588,6 +628,52 @@ void CRenderTools::RenderTee6(const CAnimState *pAnim, const CTeeRenderInfo *pIn
 		TinyTee = false;
 
 	const CSkin::CSkinTextures *pSkinTextures = pInfo->m_CustomColoredSkin ? &pInfo->m_ColorableRenderSkin : &pInfo->m_OriginalRenderSkin;
+	const CSkin::CSkinTextures *pFeetTextures = pSkinTextures;
+	if(g_Config.m_ClWhiteFeet && pInfo->m_CustomColoredSkin)
+	{
+		pFeetTextures = &GameClient()->m_Skins.Find(g_Config.m_ClWhiteFeetSkin)->m_OriginalSkin;
+	}
+
+	// All parts must be on the same atlas page to render the tee from the atlas. The render info
+	// holds copies of the skin textures, their cells might have been reused for other skins.
+	const CSkinAtlas &Atlas = GameClient()->m_Skins.Atlas();
+	const bool UseAtlas = pFeetTextures->m_AtlasPage == pSkinTextures->m_AtlasPage &&
+			      Atlas.Contains(*pSkinTextures) &&
+			      Atlas.Contains(*pFeetTextures);
+	if(!UseAtlas || pSkinTextures->m_AtlasPage != m_TeeBatchPage)
+	{
+		FlushTeeBatch();
+	}
+	if(UseAtlas)
+	{
+		m_TeeBatchPage = pSkinTextures->m_AtlasPage;
+	}
+
+	float Rotation = 0.0f;
+	ColorRGBA Color;
+	// Renders one part of the tee centered at the given position. Negative scales mirror the part.
+	const auto RenderPart = [&](const CSkin::CSkinTextures *pTextures, IGraphics::CTextureHandle Texture, int AtlasPart, int QuadOffset, vec2 PartPos, float ScaleX, float ScaleY, float Width, float Height) {
+		if(UseAtlas)
+		{
+			CTeeBatchQuad &Quad = m_vTeeBatchQuads.emplace_back();
+			Quad.m_Pos = PartPos;
+			Quad.m_Size = vec2(Width * absolute(ScaleX), Height * absolute(ScaleY));
+			Quad.m_Rotation = Rotation;
+			Quad.m_Color = Color;
+			Quad.m_Uv = Atlas.PartUv(pTextures->m_AtlasCell, AtlasPart);
+			if(ScaleX < 0.0f)
+				std::swap(Quad.m_Uv.m_U0, Quad.m_Uv.m_U1);
+			if(ScaleY < 0.0f)
+				std::swap(Quad.m_Uv.m_V0, Quad.m_Uv.m_V1);
+		}
+		else
+		{
+			Graphics()->QuadsSetRotation(Rotation);
+			Graphics()->SetColor(Color);
+			Graphics()->TextureSet(Texture);
+			Graphics()->RenderQuadContainerAsSprite(m_TeeQuadContainerIndex, QuadOffset, PartPos.x, PartPos.y, ScaleX, ScaleY);
+		}
+	};
 
 	// first pass we draw the outline
 	// second pass we draw the filling
@@ -608,15 +694,15 @@ void CRenderTools::RenderTee6(const CAnimState *pAnim, const CTeeRenderInfo *pIn
 
 			if(Filling == 1)
 			{
-				Graphics()->QuadsSetRotation(pAnim->GetBody()->m_Angle * pi * 2);
+				Rotation = pAnim->GetBody()->m_Angle * pi * 2;
 
 				// draw body
-				Graphics()->SetColor(pInfo->m_ColorBody.r, pInfo->m_ColorBody.g, pInfo->m_ColorBody.b, Alpha);
+				Color = ColorRGBA(pInfo->m_ColorBody.r, pInfo->m_ColorBody.g, pInfo->m_ColorBody.b, Alpha);
 				vec2 BodyPos = Position + vec2(pAnim->GetBody()->m_X, pAnim->GetBody()->m_Y) * AnimScale;
 				float BodyScale;
 				GetRenderTeeBodyScale(BaseSize, BodyScale);
-				Graphics()->TextureSet(OutLine == 1 ? pSkinTextures->m_BodyOutline : pSkinTextures->m_Body);
-				Graphics()->RenderQuadContainerAsSprite(m_TeeQuadContainerIndex, OutLine, BodyPos.x, BodyPos.y, BodyScale, BodyScale);
+				RenderPart(pSkinTextures, OutLine == 1 ? pSkinTextures->m_BodyOutline : pSkinTextures->m_Body, OutLine == 1 ? CSkinAtlas::PART_BODY_OUTLINE : CSkinAtlas::PART_BODY,
+					OutLine, BodyPos, BodyScale, BodyScale, 64.f, 64.f);
 
 				// draw eyes
 				if(Pass == 1)
@@ -653,9 +739,10 @@ void CRenderTools::RenderTee6(const CAnimState *pAnim, const CTeeRenderInfo *pIn
 					float EyeSeparation = (0.075f - 0.010f * absolute(Direction.x)) * BaseSize;
 					vec2 Offset = vec2(Direction.x * 0.125f, -0.05f + Direction.y * 0.10f) * BaseSize;
 
-					Graphics()->TextureSet(pSkinTextures->m_aEyes[TeeEye]);
-					Graphics()->RenderQuadContainerAsSprite(m_TeeQuadContainerIndex, QuadOffset + EyeQuadOffset, BodyPos.x - EyeSeparation + Offset.x, BodyPos.y + Offset.y, EyeScale / (64.f * 0.4f), h / (64.f * 0.4f));
-					Graphics()->RenderQuadContainerAsSprite(m_TeeQuadContainerIndex, QuadOffset + EyeQuadOffset, BodyPos.x + EyeSeparation + Offset.x, BodyPos.y + Offset.y, -EyeScale / (64.f * 0.4f), h / (64.f * 0.4f));
+					RenderPart(pSkinTextures, pSkinTextures->m_aEyes[TeeEye], CSkinAtlas::PART_EYE_NORMAL + TeeEye, QuadOffset + EyeQuadOffset,
+						vec2(BodyPos.x - EyeSeparation + Offset.x, BodyPos.y + Offset.y), EyeScale / (64.f * 0.4f), h / (64.f * 0.4f), 64.f * 0.4f, 64.f * 0.4f);
+					RenderPart(pSkinTextures, pSkinTextures->m_aEyes[TeeEye], CSkinAtlas::PART_EYE_NORMAL + TeeEye, QuadOffset + EyeQuadOffset,
+						vec2(BodyPos.x + EyeSeparation + Offset.x, BodyPos.y + Offset.y), -EyeScale / (64.f * 0.4f), h / (64.f * 0.4f), 64.f * 0.4f, 64.f * 0.4f);
 				}
 			}
 
@@ -678,12 +765,13 @@ void CRenderTools::RenderTee6(const CAnimState *pAnim, const CTeeRenderInfo *pIn
 			}
 
 			int QuadOffset = 7;
-			if(Dir.x < 0 && pInfo->m_FeetFlipped)
+			const bool Mirrored = Dir.x < 0 && pInfo->m_FeetFlipped;
+			if(Mirrored)
 			{
 				QuadOffset += 2;
 			}
 
-			Graphics()->QuadsSetRotation(pFoot->m_Angle * pi * 2);
+			Rotation = pFoot->m_Angle * pi * 2;
 
 			bool Indicate = !pInfo->m_GotAirJump && g_Config.m_ClAirjumpindicator;
 			float ColorScale = 1.0f;
@@ -695,23 +783,19 @@ void CRenderTools::RenderTee6(const CAnimState *pAnim, const CTeeRenderInfo *pIn
 					ColorScale = 0.5f;
 			}
 
-			Graphics()->SetColor(pInfo->m_ColorFeet.r * ColorScale, pInfo->m_ColorFeet.g * ColorScale, pInfo->m_ColorFeet.b * ColorScale, Alpha);
-
-			if(g_Config.m_ClWhiteFeet && pInfo->m_CustomColoredSkin)
-			{
-				CTeeRenderInfo WhiteFeetInfo;
-				const CSkin *pSkin = GameClient()->m_Skins.Find(g_Config.m_ClWhiteFeetSkin);
-				WhiteFeetInfo.m_OriginalRenderSkin = pSkin->m_OriginalSkin;
-				WhiteFeetInfo.m_ColorFeet = ColorRGBA(1, 1, 1);
-				const CSkin::CSkinTextures *pWhiteFeetTextures = &WhiteFeetInfo.m_OriginalRenderSkin;
-				Graphics()->TextureSet(OutLine == 1 ? pWhiteFeetTextures->m_FeetOutline : pWhiteFeetTextures->m_Feet);
-			}
-			else
-				Graphics()->TextureSet(OutLine == 1 ? pSkinTextures->m_FeetOutline : pSkinTextures->m_Feet);
+			Color = ColorRGBA(pInfo->m_ColorFeet.r * ColorScale, pInfo->m_ColorFeet.g * ColorScale, pInfo->m_ColorFeet.b * ColorScale, Alpha);
 
-			Graphics()->RenderQuadContainerAsSprite(m_TeeQuadContainerIndex, QuadOffset, Position.x + pFoot->m_X * AnimScale, Position.y + pFoot->m_Y * AnimScale, w / 64.f, h / 32.f);
+			// The quad container already mirrors the feet, the atlas quad is mirrored with a negative scale instead
+			const float FeetScaleX = UseAtlas && Mirrored ? -w / 64.f : w / 64.f;
+			RenderPart(pFeetTextures, OutLine == 1 ? pFeetTextures->m_FeetOutline : pFeetTextures->m_Feet, OutLine == 1 ? CSkinAtlas::PART_FEET_OUTLINE : CSkinAtlas::PART_FEET,
+				QuadOffset, vec2(Position.x + pFoot->m_X * AnimScale, Position.y + pFoot->m_Y * AnimScale), FeetScaleX, h / 32.f, 64.f, 32.f);
 		}
 	}
+
+	if(m_TeeBatchDepth == 0)
+	{
+		FlushTeeBatch();
+	}
 }
 
 void CRenderTools::CalcScreenParams(float Aspect, float Zoom, float *pWidth, float *pHeight)
@@ -9,11 +9,13 @@
 #include <base/vmath.h>
 
 #include <game/client/skin.h>
+#include <game/client/skin_atlas.h>
 #include <game/client/ui_rect.h>
 #include <game/generated/protocol7.h>
 
 #include <functional>
 #include <memory>
+#include <vector>
 
 class CAnimState;
 class CSpeedupTile;
@@ -260,12 +262,27 @@ class CRenderTools
 
 	vec2 m_SpriteScale = vec2(-1.0f, -1.0f);
 
+	class CTeeBatchQuad
+	{
+	public:
+		vec2 m_Pos;
+		vec2 m_Size;
+		float m_Rotation;
+		ColorRGBA m_Color;
+		CSkinAtlas::CUvRect m_Uv;
+	};
+	std::vector<CTeeBatchQuad> m_vTeeBatchQuads;
+	int m_TeeBatchPage = -1;
+	int m_TeeBatchDepth = 0;
+
+	void FlushTeeBatch();
+
 	static void GetRenderTeeBodyScale(float BaseSize, float &BodyScale);
 	static void GetRenderTeeFeetScale(float BaseSize, float &FeetScaleWidth, float &FeetScaleHeight);
 
 	void SelectSprite(const CDataSprite *pSprite, int Flags);
 
-	void RenderTee6(const CAnimState *pAnim, const CTeeRenderInfo *pInfo, int Emote, vec2 Dir, vec2 Pos, float Alpha = 1.0f) const;
+	void RenderTee6(const CAnimState *pAnim, const CTeeRenderInfo *pInfo, int Emote, vec2 Dir, vec2 Pos, float Alpha = 1.0f);
 	void RenderTee7(const CAnimState *pAnim, const CTeeRenderInfo *pInfo, int Emote, vec2 Dir, vec2 Pos, float Alpha = 1.0f);
 
 public:
@@ -303,6 +320,16 @@ public:
 	// object render methods
 	void RenderTee(const CAnimState *pAnim, const CTeeRenderInfo *pInfo, int Emote, vec2 Dir, vec2 Pos, float Alpha = 1.0f);
 
+	/**
+	 * Defers rendering of tees whose skins are packed into the skin atlas until @link EndTeeBatch @endlink,
+	 * so consecutive tees on the same atlas page are rendered with a single draw call.
+	 * Tees that cannot be batched, including all 0.7 tees, flush the pending tees first, so their order
+	 * is preserved, but other things rendered in between are drawn below the batched tees. Only use it
+	 * for loops that render nothing but tees.
+	 */
+	void BeginTeeBatch();
+	void EndTeeBatch();
+
 	// map render methods (render_map.cpp)
 	static void RenderEvalEnvelope(const IEnvelopePointAccess *pPoints, std::chrono::nanoseconds TimeNanos, ColorRGBA &Result, size_t Channels);
 	void RenderQuads(CQuad *pQuads, int NumQuads, int Flags, ENVELOPE_EVAL pfnEval, void *pUser) const;
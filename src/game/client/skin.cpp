@@ -17,6 +17,9 @@ void CSkin::CSkinTextures::Reset()
 	{
 		Eye = IGraphics::CTextureHandle();
 	}
+	m_AtlasPage = -1;
+	m_AtlasCell = -1;
+	m_AtlasGeneration = 0;
 }
 
 void CSkin::CSkinTextures::Unload(IGraphics *pGraphics)
@@ -26,6 +26,13 @@ public:
 
 		IGraphics::CTextureHandle m_aEyes[6];
 
+		/**
+		 * Page and cell in the skin atlas containing all parts, or -1 if the skin is not packed into the atlas.
+		 */
+		int m_AtlasPage = -1;
+		int m_AtlasCell = -1;
+		unsigned m_AtlasGeneration = 0;
+
 		void Reset();
 		void Unload(IGraphics *pGraphics);
 	};
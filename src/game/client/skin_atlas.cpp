@@ -0,0 +1,214 @@
+#include "skin_atlas.h"
+
+#include <base/system.h>
+
+#include <engine/shared/config.h>
+
+#include <game/generated/client_data.h>
+
+#include <algorithm>
+#include <numeric>
+
+void CSkinAtlas::Init(IGraphics *pGraphics)
+{
+	m_pGraphics = pGraphics;
+
+	// Place the parts in shelves sorted by height, all cells share this layout
+	int aOrder[NUM_PARTS];
+	std::iota(std::begin(aOrder), std::end(aOrder), 0);
+	for(int Part = 0; Part < NUM_PARTS; ++Part)
+	{
+		const CDataSprite &Sprite = g_pData->m_aSprites[SPRITE_TEE_BODY + Part];
+		const size_t GridWidth = SKIN_WIDTH / Sprite.m_pSet->m_Gridx;
+		const size_t GridHeight = SKIN_HEIGHT / Sprite.m_pSet->m_Gridy;
+		m_aParts[Part].m_SrcX = Sprite.m_X * GridWidth;
+		m_aParts[Part].m_SrcY = Sprite.m_Y * GridHeight;
+		m_aParts[Part].m_Width = Sprite.m_W * GridWidth;
+		m_aParts[Part].m_Height = Sprite.m_H * GridHeight;
+	}
+	std::stable_sort(std::begin(aOrder), std::end(aOrder), [&](int Lhs, int Rhs) {
+		return m_aParts[Lhs].m_Height > m_aParts[Rhs].m_Height;
+	});
+
+	m_CellWidth = SKIN_WIDTH;
+	size_t ShelfX = 0;
+	size_t ShelfY = 0;
+	size_t ShelfHeight = 0;
+	for(int Part : aOrder)
+	{
+		CPartLayout &Layout = m_aParts[Part];
+		const size_t PaddedWidth = Layout.m_Width + 2 * PART_PADDING;
+		const size_t PaddedHeight = Layout.m_Height + 2 * PART_PADDING;
+		dbg_assert(PaddedWidth <= m_CellWidth, "Skin part does not fit into atlas cell");
+		if(ShelfX + PaddedWidth > m_CellWidth)
+		{
+			ShelfX = 0;
+			ShelfY += ShelfHeight;
+			ShelfHeight = 0;
+		}
+		Layout.m_CellX = ShelfX + PART_PADDING;
+		Layout.m_CellY = ShelfY + PART_PADDING;
+		ShelfX += PaddedWidth;
+		ShelfHeight = std::max(ShelfHeight, PaddedHeight);
+	}
+	m_CellHeight = ShelfY + ShelfHeight;
+
+	m_CellsPerRow = PAGE_DIMENSION / m_CellWidth;
+	m_CellsPerPage = m_CellsPerRow * (PAGE_DIMENSION / m_CellHeight);
+}
+
+void CSkinAtlas::Shutdown()
+{
+	Clear();
+	m_pGraphics = nullptr;
+}
+
+void CSkinAtlas::Clear()
+{
+	for(CPage &Page : m_vPages)
+	{
+		Page.m_Image.Free();
+		if(m_pGraphics != nullptr)
+		{
+			m_pGraphics->UnloadTexture(&Page.m_Texture);
+		}
+	}
+	m_vPages.clear();
+}
+
+bool CSkinAtlas::AddPage()
+{
+	if(m_CellsPerPage == 0 || m_vPages.size() >= (size_t)g_Config.m_ClSkinAtlasPages)
+	{
+		return false;
+	}
+
+	CPage &Page = m_vPages.emplace_back();
+	Page.m_Image.m_Width = PAGE_DIMENSION;
+	Page.m_Image.m_Height = PAGE_DIMENSION;
+	Page.m_Image.m_Format = CImageInfo::FORMAT_RGBA;
+	Page.m_Image.m_pData = static_cast<uint8_t *>(calloc(Page.m_Image.DataSize(), 1));
+	// Hand out cells with low indices first
+	Page.m_vFreeCells.resize(m_CellsPerPage);
+	std::iota(Page.m_vFreeCells.rbegin(), Page.m_vFreeCells.rend(), 0);
+	Page.m_vCellGenerations.resize(m_CellsPerPage, 0);
+	Page.m_DirtyX0 = Page.m_DirtyY0 = 0;
+	Page.m_DirtyX1 = Page.m_DirtyY1 = PAGE_DIMENSION;
+	return true;
+}
+
+bool CSkinAtlas::Add(const CImageInfo &Image, CSkin::CSkinTextures &Textures)
+{
+	dbg_assert(Textures.m_AtlasPage == -1, "Skin textures are already in the atlas");
+	if(m_pGraphics == nullptr || Image.m_Width != SKIN_WIDTH || Image.m_Height != SKIN_HEIGHT || Image.m_Format != CImageInfo::FORMAT_RGBA)
+	{
+		return false;
+	}
+
+	auto PageIt = std::find_if(m_vPages.begin(), m_vPages.end(), [](const CPage &Page) {
+		return !Page.m_vFreeCells.empty();
+	});
+	if(PageIt == m_vPages.end())
+	{
+		if(!AddPage())
+		{
+			return false;
+		}
+		PageIt = m_vPages.end() - 1;
+	}
+
+	CPage &Page = *PageIt;
+	const int Cell = Page.m_vFreeCells.back();
+	Page.m_vFreeCells.pop_back();
+
+	const size_t CellX = (Cell % m_CellsPerRow) * m_CellWidth;
+	const size_t CellY = (Cell / m_CellsPerRow) * m_CellHeight;
+	for(const CPartLayout &Layout : m_aParts)
+	{
+		Page.m_Image.CopyRectFrom(Image, Layout.m_SrcX, Layout.m_SrcY, Layout.m_Width, Layout.m_Height, CellX + Layout.m_CellX, CellY + Layout.m_CellY);
+	}
+	Page.m_DirtyX0 = std::min(Page.m_DirtyX0, CellX);
+	Page.m_DirtyY0 = std::min(Page.m_DirtyY0, CellY);
+	Page.m_DirtyX1 = std::max(Page.m_DirtyX1, CellX + m_CellWidth);
+	Page.m_DirtyY1 = std::max(Page.m_DirtyY1, CellY + m_CellHeight);
+
+	Textures.m_AtlasPage = PageIt - m_vPages.begin();
+	Textures.m_AtlasCell = Cell;
+	Textures.m_AtlasGeneration = m_NextGeneration++;
+	Page.m_vCellGenerations[Cell] = Textures.m_AtlasGeneration;
+	return true;
+}
+
+void CSkinAtlas::Remove(CSkin::CSkinTextures &Textures)
+{
+	if(Textures.m_AtlasPage < 0)
+	{
+		return;
+	}
+	dbg_assert((size_t)Textures.m_AtlasPage < m_vPages.size(), "Skin atlas page out of range");
+
+	// The cell contents are kept until the cell is reused, the page does not need to be uploaded again
+	CPage &Page = m_vPages[Textures.m_AtlasPage];
+	Page.m_vFreeCells.push_back(Textures.m_AtlasCell);
+	Page.m_vCellGenerations[Textures.m_AtlasCell] = 0;
+	Textures.m_AtlasPage = -1;
+	Textures.m_AtlasCell = -1;
+	Textures.m_AtlasGeneration = 0;
+}
+
+bool CSkinAtlas::Contains(const CSkin::CSkinTextures &Textures) const
+{
+	if(Textures.m_AtlasPage < 0 || (size_t)Textures.m_AtlasPage >= m_vPages.size())
+	{
+		return false;
+	}
+	const CPage &Page = m_vPages[Textures.m_AtlasPage];
+	return Page.m_Texture.IsValid() && Page.m_vCellGenerations[Textures.m_AtlasCell] == Textures.m_AtlasGeneration;
+}
+
+void CSkinAtlas::Update()
+{
+	for(CPage &Page : m_vPages)
+	{
+		if(Page.m_DirtyX1 <= Page.m_DirtyX0 || Page.m_DirtyY1 <= Page.m_DirtyY0)
+		{
+			continue;
+		}
+		// The mipmaps are generated again by the backend after every update
+		if(!Page.m_Texture.IsValid())
+		{
+			Page.m_Texture = m_pGraphics->LoadTextureRaw(Page.m_Image, 0, "skin_atlas");
+		}
+		else
+		{
+			const size_t Width = Page.m_DirtyX1 - Page.m_DirtyX0;
+			const size_t Height = Page.m_DirtyY1 - Page.m_DirtyY0;
+			const size_t PixelSize = Page.m_Image.PixelSize();
+			uint8_t *pData = static_cast<uint8_t *>(malloc(Width * Height * PixelSize));
+			for(size_t y = 0; y < Height; ++y)
+			{
+				mem_copy(&pData[y * Width * PixelSize], &Page.m_Image.m_pData[(Page.m_DirtyX0 + (y + Page.m_DirtyY0) * PAGE_DIMENSION) * PixelSize], Width * PixelSize);
+			}
+			m_pGraphics->UpdateTexture(Page.m_Texture, Page.m_DirtyX0, Page.m_DirtyY0, Width, Height, pData, true);
+		}
+		Page.m_DirtyX0 = Page.m_DirtyY0 = PAGE_DIMENSION;
+		Page.m_DirtyX1 = Page.m_DirtyY1 = 0;
+	}
+}
+
+IGraphics::CTextureHandle CSkinAtlas::PageTexture(int Page) const
+{
+	if(Page < 0 || (size_t)Page >= m_vPages.size())
+	{
+		return IGraphics::CTextureHandle();
+	}
+	return m_vPages[Page].m_Texture;
+}
+
+CSkinAtlas::CUvRect CSkinAtlas::PartUv(int Cell, int Part) const
+{
+	const CPartLayout &Layout = m_aParts[Part];
+	const float X = (Cell % m_CellsPerRow) * m_CellWidth + Layout.m_CellX;
+	const float Y = (Cell / m_CellsPerRow) * m_CellHeight + Layout.m_CellY;
+	return {X / PAGE_DIMENSION, Y / PAGE_DIMENSION, (X + Layout.m_Width) / PAGE_DIMENSION, (Y + Layout.m_Height) / PAGE_DIMENSION};
+}
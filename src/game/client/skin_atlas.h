@@ -0,0 +1,143 @@
+#ifndef GAME_CLIENT_SKIN_ATLAS_H
+#define GAME_CLIENT_SKIN_ATLAS_H
+
+#include <engine/graphics.h>
+#include <engine/image.h>
+
+#include <game/client/skin.h>
+
+#include <vector>
+
+/**
+ * Packs the parts of loaded skins into shared atlas textures, so tees using skins
+ * on the same page can be rendered with a single texture and batched draw calls.
+ *
+ * Every skin variant (original or colorable) occupies one fixed-size cell of a page.
+ * The parts are placed at the same offsets inside every cell, so only the page and
+ * cell index need to be stored in @link CSkin::CSkinTextures @endlink. Every skin
+ * that is added gets a new generation, so copies of skin textures whose cell was
+ * reused for another skin are not rendered from the atlas anymore.
+ * Only skins with the standard resolution are packed, all other skins keep using
+ * their individual part textures.
+ */
+class CSkinAtlas
+{
+public:
+	/**
+	 * Parts of a skin in the same order as the tee sprites starting with `SPRITE_TEE_BODY`.
+	 */
+	enum EPart
+	{
+		PART_BODY = 0,
+		PART_BODY_OUTLINE,
+		PART_FEET,
+		PART_FEET_OUTLINE,
+		PART_HANDS,
+		PART_HANDS_OUTLINE,
+		PART_EYE_NORMAL,
+		NUM_PARTS = PART_EYE_NORMAL + 6,
+	};
+
+	/**
+	 * Normalized texture coordinates of a part inside an atlas page.
+	 */
+	class CUvRect
+	{
+	public:
+		float m_U0;
+		float m_V0;
+		float m_U1;
+		float m_V1;
+	};
+
+	void Init(IGraphics *pGraphics);
+	void Shutdown();
+
+	/**
+	 * Removes all skins and frees all pages.
+	 */
+	void Clear();
+
+	/**
+	 * Adds the parts of a skin image to the atlas.
+	 *
+	 * @param Image The complete skin image in RGBA format.
+	 * @param Textures The skin textures that will reference the allocated cell on success.
+	 *
+	 * @return `true` if the skin was added, `false` if it is not eligible or all pages are full.
+	 */
+	bool Add(const CImageInfo &Image, CSkin::CSkinTextures &Textures);
+
+	/**
+	 * Frees the atlas cell used by the skin textures, if any, so it can be reused for another skin.
+	 */
+	void Remove(CSkin::CSkinTextures &Textures);
+
+	/**
+	 * Returns whether the skin textures still reference their cell and the cell was uploaded,
+	 * so the skin can be rendered from the atlas.
+	 */
+	bool Contains(const CSkin::CSkinTextures &Textures) const;
+
+	/**
+	 * Uploads the parts of all pages that were changed since the last update. This should be called
+	 * once per frame after skins were added so multiple new skins cause at most one upload per page.
+	 */
+	void Update();
+
+	/**
+	 * Returns the texture of an atlas page or an invalid handle if the page does not exist or was not uploaded yet.
+	 */
+	IGraphics::CTextureHandle PageTexture(int Page) const;
+	CUvRect PartUv(int Cell, int Part) const;
+
+private:
+	static constexpr size_t SKIN_WIDTH = 256;
+	static constexpr size_t SKIN_HEIGHT = 128;
+	static constexpr size_t PAGE_DIMENSION = 1024;
+	/**
+	 * Transparent border around every part to avoid sampling neighboring parts with linear filtering.
+	 * All part sizes are multiples of it, so parts don't share texels in the first three mipmap levels.
+	 */
+	static constexpr size_t PART_PADDING = 8;
+
+	class CPartLayout
+	{
+	public:
+		size_t m_SrcX;
+		size_t m_SrcY;
+		size_t m_Width;
+		size_t m_Height;
+		size_t m_CellX;
+		size_t m_CellY;
+	};
+
+	class CPage
+	{
+	public:
+		CImageInfo m_Image;
+		IGraphics::CTextureHandle m_Texture;
+		std::vector<int> m_vFreeCells;
+		// Generation of the skin in every cell, 0 for free cells
+		std::vector<unsigned> m_vCellGenerations;
+		// Rectangle of the image that changed since the last upload
+		size_t m_DirtyX0 = PAGE_DIMENSION;
+		size_t m_DirtyY0 = PAGE_DIMENSION;
+		size_t m_DirtyX1 = 0;
+		size_t m_DirtyY1 = 0;
+	};
+
+	IGraphics *m_pGraphics = nullptr;
+	CPartLayout m_aParts[NUM_PARTS];
+	size_t m_CellWidth = 0;
+	size_t m_CellHeight = 0;
+	size_t m_CellsPerRow = 0;
+	size_t m_CellsPerPage = 0;
+	std::vector<CPage> m_vPages;
+	// Not reset when the pages are cleared, so generations are never reused
+	unsigned m_NextGeneration = 1;
+
+	bool AddPage();
+};
+
+#endif
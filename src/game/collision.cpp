@@ -36,9 +36,39 @@ vec2 ClampVel(int MoveRestriction, vec2 Vel)
 	return Vel;
 }
 
+enum
+{
+	// IsSolid
+	COLFLAG_SOLID = 1 << 0,
+	// TileExists, without doors and the tiles next to it
+	COLFLAG_EXISTS = 1 << 1,
+	// TileExistsNext
+	COLFLAG_EXISTS_NEXT = 1 << 2,
+	// door tile set by SetDoorCollisionAt
+	COLFLAG_DOOR = 1 << 3,
+	// stopper in the game or front layer
+	COLFLAG_STOPPER = 1 << 4,
+	// IsThrough, tile itself
+	COLFLAG_THROUGH = 1 << 5,
+	// IsThrough, tile in front of it
+	COLFLAG_THROUGH_OFFSET = 1 << 6,
+	// IsHookBlocker
+	COLFLAG_HOOK_BLOCKER = 1 << 7,
+	COLFLAG_TELE = 1 << 8,
+	COLFLAG_SPEEDUP = 1 << 9,
+	COLFLAG_SWITCH = 1 << 10,
+	COLFLAG_TUNE = 1 << 11,
+};
+
+static bool IsStopper(int Tile)
+{
+	return Tile == TILE_STOP || Tile == TILE_STOPS || Tile == TILE_STOPA;
+}
+
 CCollision::CCollision()
 {
 	m_pDoor = nullptr;
+	m_LineSkipping = true;
 	Unload();
 }
 
@@ -146,6 +176,21 @@ void CCollision::Init(class CLayers *pLayers)
 			}
 		}
 	}
+
+	m_vTileFlags.resize((size_t)m_Width * m_Height);
+	for(int i = 0; i < m_Width * m_Height; i++)
+		m_vTileFlags[i] = TileFlags(i);
+	m_pTileFlags = m_vTileFlags.data();
+
+	m_vLineSkip.resize((size_t)m_Width * m_Height);
+	for(int i = 0; i < m_Width * m_Height; i++)
+		m_vLineSkip[i] = LineSkipFlags(i);
+	m_LineSkipBlocksWidth = (m_Width + (1 << LINESKIP_BLOCK_SHIFT) - 1) >> LINESKIP_BLOCK_SHIFT;
+	const int BlocksHeight = (m_Height + (1 << LINESKIP_BLOCK_SHIFT) - 1) >> LINESKIP_BLOCK_SHIFT;
+	m_vLineSkipBlocks.resize((size_t)m_LineSkipBlocksWidth * BlocksHeight);
+	for(int BlockY = 0; BlockY < BlocksHeight; BlockY++)
+		for(int BlockX = 0; BlockX < m_LineSkipBlocksWidth; BlockX++)
+			UpdateLineSkipBlock(BlockX, BlockY);
 }
 
 void CCollision::Unload()
@@ -162,6 +207,13 @@ void CCollision::Unload()
 	m_TeleCheckOuts.clear();
 	m_TeleOthers.clear();
 
+	m_vTileFlags.clear();
+	m_pTileFlags = nullptr;
+
+	m_vLineSkip.clear();
+	m_vLineSkipBlocks.clear();
+	m_LineSkipBlocksWidth = 0;
+
 	m_pTele = nullptr;
 	m_pSpeedup = nullptr;
 	m_pFront = nullptr;
@@ -282,6 +334,10 @@ int CCollision::GetMoveRestrictions(CALLBACK_SWITCHACTIVE pfnSwitchActive, void
 		{
 			ModMapIndex = OverrideCenterTileIndex;
 		}
+		if(m_pTileFlags && !(m_pTileFlags[ModMapIndex] & (COLFLAG_STOPPER | COLFLAG_DOOR)))
+		{
+			continue;
+		}
 		for(int Front = 0; Front < 2; Front++)
 		{
 			int Tile;
@@ -325,6 +381,157 @@ int CCollision::GetTile(int x, int y) const
 	return 0;
 }
 
+uint16_t CCollision::TileFlags(int Index) const
+{
+	const int Tile = m_pTiles[Index].m_Index;
+	const int Front = m_pFront ? m_pFront[Index].m_Index : 0;
+
+	uint16_t Flags = 0;
+	if(Tile == TILE_SOLID || Tile == TILE_NOHOOK)
+		Flags |= COLFLAG_SOLID;
+	if(TileExistsHere(Index))
+		Flags |= COLFLAG_EXISTS;
+	if(TileExistsNextRaw(Index))
+		Flags |= COLFLAG_EXISTS_NEXT;
+	if(m_pDoor && m_pDoor[Index].m_Index)
+		Flags |= COLFLAG_DOOR;
+	if(IsStopper(Tile) || IsStopper(Front))
+		Flags |= COLFLAG_STOPPER;
+	if(Front == TILE_THROUGH_ALL || Front == TILE_THROUGH_CUT || Front == TILE_THROUGH_DIR)
+		Flags |= COLFLAG_THROUGH;
+	if(Tile == TILE_THROUGH || Front == TILE_THROUGH)
+		Flags |= COLFLAG_THROUGH_OFFSET;
+	if(Tile == TILE_THROUGH_ALL || Tile == TILE_THROUGH_DIR || Front == TILE_THROUGH_ALL || Front == TILE_THROUGH_DIR)
+		Flags |= COLFLAG_HOOK_BLOCKER;
+	if(m_pTele && m_pTele[Index].m_Type)
+		Flags |= COLFLAG_TELE;
+	if(m_pSpeedup && m_pSpeedup[Index].m_Force > 0)
+		Flags |= COLFLAG_SPEEDUP;
+	if(m_pSwitch && m_pSwitch[Index].m_Type)
+		Flags |= COLFLAG_SWITCH;
+	if(m_pTune && m_pTune[Index].m_Type)
+		Flags |= COLFLAG_TUNE;
+	return Flags;
+}
+
+void CCollision::UpdateTileFlags(int Index)
+{
+	if(m_vTileFlags.empty())
+		return;
+	// TileExistsNext looks at the tiles in the same order, wrapping around
+	// at the ends of the rows
+	const int aIndices[] = {Index, Index - 1, Index + 1, Index - m_Width, Index + m_Width};
+	for(int Other : aIndices)
+	{
+		if(Other >= 0 && Other < m_Width * m_Height)
+			m_vTileFlags[Other] = TileFlags(Other);
+	}
+}
+
+enum
+{
+	// IntersectLine
+	LINESKIP_SOLID = 1 << 0,
+	// IntersectLineTeleWeapon
+	LINESKIP_WEAPON = 1 << 1,
+	// IntersectLineTeleHook
+	LINESKIP_HOOK = 1 << 2,
+	// IntersectNoLaser
+	LINESKIP_NOLASER = 1 << 3,
+	// IntersectNoLaserNoWalls
+	LINESKIP_NOLASER_NOWALLS = 1 << 4,
+	// IntersectAir
+	LINESKIP_AIR = 1 << 5,
+};
+
+uint8_t CCollision::LineSkipFlags(int Index) const
+{
+	const int Tile = m_pTiles[Index].m_Index;
+	const int Front = m_pFront ? m_pFront[Index].m_Index : 0;
+	const bool Solid = Tile == TILE_SOLID || Tile == TILE_NOHOOK;
+	const bool NoLaser = Tile == TILE_NOLASER || Front == TILE_NOLASER;
+	// the tele number is only checked for some tele types, but every
+	// tele tile is checked like a wall to keep this simple
+	const bool Tele = m_pTele && m_pTele[Index].m_Type != 0;
+	const bool HookBlocker = Tile == TILE_THROUGH_ALL || Tile == TILE_THROUGH_DIR || Front == TILE_THROUGH_ALL || Front == TILE_THROUGH_DIR;
+	// IntersectAir stops at solid tiles and at tiles without any of the
+	// tiles returned by GetTile and GetFrontTile
+	const bool Air = Solid || ((Tile < TILE_SOLID || Tile > TILE_NOLASER) && Front != TILE_DEATH && Front != TILE_NOLASER);
+
+	uint8_t Flags = 0;
+	if(!Solid)
+		Flags |= LINESKIP_SOLID;
+	if(!Solid && !Tele)
+		Flags |= LINESKIP_WEAPON;
+	if(!Solid && !Tele && !HookBlocker)
+		Flags |= LINESKIP_HOOK;
+	if(!Solid && !NoLaser)
+		Flags |= LINESKIP_NOLASER;
+	if(!NoLaser)
+		Flags |= LINESKIP_NOLASER_NOWALLS;
+	if(!Air)
+		Flags |= LINESKIP_AIR;
+	return Flags;
+}
+
+void CCollision::UpdateLineSkipBlock(int BlockX, int BlockY)
+{
+	uint8_t Flags = 0xff;
+	const int EndX = minimum((BlockX + 1) << LINESKIP_BLOCK_SHIFT, m_Width);
+	const int EndY = minimum((BlockY + 1) << LINESKIP_BLOCK_SHIFT, m_Height);
+	for(int y = BlockY << LINESKIP_BLOCK_SHIFT; y < EndY; y++)
+		for(int x = BlockX << LINESKIP_BLOCK_SHIFT; x < EndX; x++)
+			Flags &= m_vLineSkip[y * m_Width + x];
+	m_vLineSkipBlocks[BlockY * m_LineSkipBlocksWidth + BlockX] = Flags;
+}
+
+// Returns the last sample of a line query that lies in the same tile as
+// the sample at Pos, or in the same block if the whole block can be
+// skipped. Returns -1 if the query can stop in this tile. The sample
+// positions change monotonically along both axes, so all samples up to the
+// returned one lie in this tile or block, too.
+template<typename FSamplePos>
+int CCollision::SkipEmpty(int Flag, vec2 Pos, int Sample, int LastSample, FSamplePos &&SamplePos) const
+{
+	if(!m_LineSkipping || m_vLineSkip.empty())
+		return -1;
+	const int Nx = clamp(round_to_int(Pos.x) / 32, 0, m_Width - 1);
+	const int Ny = clamp(round_to_int(Pos.y) / 32, 0, m_Height - 1);
+	if(!(m_vLineSkip[Ny * m_Width + Nx] & Flag))
+		return -1;
+
+	const int Shift = (m_vLineSkipBlocks[(Ny >> LINESKIP_BLOCK_SHIFT) * m_LineSkipBlocksWidth + (Nx >> LINESKIP_BLOCK_SHIFT)] & Flag) ? LINESKIP_BLOCK_SHIFT : 0;
+	const int CellX = Nx >> Shift;
+	const int CellY = Ny >> Shift;
+	auto &&InCell = [&](int Other) {
+		const vec2 OtherPos = SamplePos(Other);
+		return (clamp(round_to_int(OtherPos.x) / 32, 0, m_Width - 1) >> Shift) == CellX && (clamp(round_to_int(OtherPos.y) / 32, 0, m_Height - 1) >> Shift) == CellY;
+	};
+
+	// find a sample outside of the cell with growing steps, then search
+	// the last sample inside of it between both
+	int Inside = Sample;
+	int Outside = LastSample + 1;
+	for(int Step = 1; Inside + Step <= LastSample; Step *= 2)
+	{
+		if(!InCell(Inside + Step))
+		{
+			Outside = Inside + Step;
+			break;
+		}
+		Inside += Step;
+	}
+	while(Outside - Inside > 1)
+	{
+		const int Middle = Inside + (Outside - Inside) / 2;
+		if(InCell(Middle))
+			Inside = Middle;
+		else
+			Outside = Middle;
+	}
+	return Inside;
+}
+
 // TODO: rewrite this smarter!
 int CCollision::IntersectLine(vec2 Pos0, vec2 Pos1, vec2 *pOutCollision, vec2 *pOutBeforeCollision) const
 {
@@ -335,6 +542,13 @@ int CCollision::IntersectLine(vec2 Pos0, vec2 Pos1, vec2 *pOutCollision, vec2 *p
 	{
 		float a = i / (float)End;
 		vec2 Pos = mix(Pos0, Pos1, a);
+		const int Skip = SkipEmpty(LINESKIP_SOLID, Pos, i, End, [&](int Sample) { return mix(Pos0, Pos1, Sample / (float)End); });
+		if(Skip >= 0)
+		{
+			i = Skip;
+			Last = mix(Pos0, Pos1, i / (float)End);
+			continue;
+		}
 		// Temporary position for checking collision
 		int ix = round_to_int(Pos.x);
 		int iy = round_to_int(Pos.y);
@@ -368,6 +582,15 @@ int CCollision::IntersectLineTeleHook(vec2 Pos0, vec2 Pos1, vec2 *pOutCollision,
 	{
 		float a = i / (float)End;
 		vec2 Pos = mix(Pos0, Pos1, a);
+		const int Skip = SkipEmpty(LINESKIP_HOOK, Pos, i, End, [&](int Sample) { return mix(Pos0, Pos1, Sample / (float)End); });
+		if(Skip >= 0)
+		{
+			if(pTeleNr)
+				*pTeleNr = 0;
+			i = Skip;
+			Last = mix(Pos0, Pos1, i / (float)End);
+			continue;
+		}
 		// Temporary position for checking collision
 		int ix = round_to_int(Pos.x);
 		int iy = round_to_int(Pos.y);
@@ -426,6 +649,15 @@ int CCollision::IntersectLineTeleWeapon(vec2 Pos0, vec2 Pos1, vec2 *pOutCollisio
 	{
 		float a = i / (float)End;
 		vec2 Pos = mix(Pos0, Pos1, a);
+		const int Skip = SkipEmpty(LINESKIP_WEAPON, Pos, i, End, [&](int Sample) { return mix(Pos0, Pos1, Sample / (float)End); });
+		if(Skip >= 0)
+		{
+			if(pTeleNr)
+				*pTeleNr = 0;
+			i = Skip;
+			Last = mix(Pos0, Pos1, i / (float)End);
+			continue;
+		}
 		// Temporary position for checking collision
 		int ix = round_to_int(Pos.x);
 		int iy = round_to_int(Pos.y);
@@ -597,6 +829,12 @@ void CCollision::MoveBox(vec2 *pInoutPos, vec2 *pInoutVel, vec2 Size, vec2 Elast
 
 int CCollision::IsSolid(int x, int y) const
 {
+	if(m_pTileFlags)
+	{
+		int Nx = clamp(x / 32, 0, m_Width - 1);
+		int Ny = clamp(y / 32, 0, m_Height - 1);
+		return (m_pTileFlags[Ny * m_Width + Nx] & COLFLAG_SOLID) != 0;
+	}
 	int index = GetTile(x, y);
 	return index == TILE_SOLID || index == TILE_NOHOOK;
 }
@@ -604,17 +842,21 @@ int CCollision::IsSolid(int x, int y) const
 bool CCollision::IsThrough(int x, int y, int OffsetX, int OffsetY, vec2 Pos0, vec2 Pos1) const
 {
 	int pos = GetPureMapIndex(x, y);
+	int offpos = GetPureMapIndex(x + OffsetX, y + OffsetY);
+	if(m_pTileFlags && !(m_pTileFlags[pos] & COLFLAG_THROUGH) && !(m_pTileFlags[offpos] & COLFLAG_THROUGH_OFFSET))
+		return false;
 	if(m_pFront && (m_pFront[pos].m_Index == TILE_THROUGH_ALL || m_pFront[pos].m_Index == TILE_THROUGH_CUT))
 		return true;
 	if(m_pFront && m_pFront[pos].m_Index == TILE_THROUGH_DIR && ((m_pFront[pos].m_Flags == ROTATION_0 && Pos0.y > Pos1.y) || (m_pFront[pos].m_Flags == ROTATION_90 && Pos0.x < Pos1.x) || (m_pFront[pos].m_Flags == ROTATION_180 && Pos0.y < Pos1.y) || (m_pFront[pos].m_Flags == ROTATION_270 && Pos0.x > Pos1.x)))
 		return true;
-	int offpos = GetPureMapIndex(x + OffsetX, y + OffsetY);
 	return m_pTiles[offpos].m_Index == TILE_THROUGH || (m_pFront && m_pFront[offpos].m_Index == TILE_THROUGH);
 }
 
 bool CCollision::IsHookBlocker(int x, int y, vec2 Pos0, vec2 Pos1) const
 {
 	int pos = GetPureMapIndex(x, y);
+	if(m_pTileFlags && !(m_pTileFlags[pos] & COLFLAG_HOOK_BLOCKER))
+		return false;
 	if(m_pTiles[pos].m_Index == TILE_THROUGH_ALL || (m_pFront && m_pFront[pos].m_Index == TILE_THROUGH_ALL))
 		return true;
 	if(m_pTiles[pos].m_Index == TILE_THROUGH_DIR && ((m_pTiles[pos].m_Flags == ROTATION_0 && Pos0.y < Pos1.y) ||
@@ -649,6 +891,8 @@ int CCollision::IsTeleport(int Index) const
 {
 	if(Index < 0 || !m_pTele)
 		return 0;
+	if(m_pTileFlags && !(m_pTileFlags[Index] & COLFLAG_TELE))
+		return 0;
 
 	if(m_pTele[Index].m_Type == TILE_TELEIN)
 		return m_pTele[Index].m_Number;
@@ -662,6 +906,8 @@ int CCollision::IsEvilTeleport(int Index) const
 		return 0;
 	if(!m_pTele)
 		return 0;
+	if(m_pTileFlags && !(m_pTileFlags[Index] & COLFLAG_TELE))
+		return 0;
 
 	if(m_pTele[Index].m_Type == TILE_TELEINEVIL)
 		return m_pTele[Index].m_Number;
@@ -673,6 +919,8 @@ bool CCollision::IsCheckTeleport(int Index) const
 {
 	if(Index < 0 || !m_pTele)
 		return false;
+	if(m_pTileFlags && !(m_pTileFlags[Index] & COLFLAG_TELE))
+		return false;
 	return m_pTele[Index].m_Type == TILE_TELECHECKIN;
 }
 
@@ -680,6 +928,8 @@ bool CCollision::IsCheckEvilTeleport(int Index) const
 {
 	if(Index < 0 || !m_pTele)
 		return false;
+	if(m_pTileFlags && !(m_pTileFlags[Index] & COLFLAG_TELE))
+		return false;
 	return m_pTele[Index].m_Type == TILE_TELECHECKINEVIL;
 }
 
@@ -690,6 +940,8 @@ int CCollision::IsTeleCheckpoint(int Index) const
 
 	if(!m_pTele)
 		return 0;
+	if(m_pTileFlags && !(m_pTileFlags[Index] & COLFLAG_TELE))
+		return 0;
 
 	if(m_pTele[Index].m_Type == TILE_TELECHECK)
 		return m_pTele[Index].m_Number;
@@ -701,6 +953,8 @@ int CCollision::IsTeleportWeapon(int Index) const
 {
 	if(Index < 0 || !m_pTele)
 		return 0;
+	if(m_pTileFlags && !(m_pTileFlags[Index] & COLFLAG_TELE))
+		return 0;
 
 	if(m_pTele[Index].m_Type == TILE_TELEINWEAPON)
 		return m_pTele[Index].m_Number;
@@ -712,6 +966,8 @@ int CCollision::IsTeleportHook(int Index) const
 {
 	if(Index < 0 || !m_pTele)
 		return 0;
+	if(m_pTileFlags && !(m_pTileFlags[Index] & COLFLAG_TELE))
+		return 0;
 
 	if(m_pTele[Index].m_Type == TILE_TELEINHOOK)
 		return m_pTele[Index].m_Number;
@@ -723,6 +979,8 @@ int CCollision::IsSpeedup(int Index) const
 {
 	if(Index < 0 || !m_pSpeedup)
 		return 0;
+	if(m_pTileFlags && !(m_pTileFlags[Index] & COLFLAG_SPEEDUP))
+		return 0;
 
 	if(m_pSpeedup[Index].m_Force > 0)
 		return Index;
@@ -734,6 +992,8 @@ int CCollision::IsTune(int Index) const
 {
 	if(Index < 0 || !m_pTune)
 		return 0;
+	if(m_pTileFlags && !(m_pTileFlags[Index] & COLFLAG_TUNE))
+		return 0;
 
 	if(m_pTune[Index].m_Type)
 		return m_pTune[Index].m_Number;
@@ -757,6 +1017,8 @@ int CCollision::GetSwitchType(int Index) const
 {
 	if(Index < 0 || !m_pSwitch)
 		return 0;
+	if(m_pTileFlags && !(m_pTileFlags[Index] & COLFLAG_SWITCH))
+		return 0;
 
 	if(m_pSwitch[Index].m_Type > 0)
 		return m_pSwitch[Index].m_Type;
@@ -768,6 +1030,8 @@ int CCollision::GetSwitchNumber(int Index) const
 {
 	if(Index < 0 || !m_pSwitch)
 		return 0;
+	if(m_pTileFlags && !(m_pTileFlags[Index] & COLFLAG_SWITCH))
+		return 0;
 
 	if(m_pSwitch[Index].m_Type > 0 && m_pSwitch[Index].m_Number > 0)
 		return m_pSwitch[Index].m_Number;
@@ -779,6 +1043,8 @@ int CCollision::GetSwitchDelay(int Index) const
 {
 	if(Index < 0 || !m_pSwitch)
 		return 0;
+	if(m_pTileFlags && !(m_pTileFlags[Index] & COLFLAG_SWITCH))
+		return 0;
 
 	if(m_pSwitch[Index].m_Type > 0)
 		return m_pSwitch[Index].m_Delay;
@@ -840,6 +1106,13 @@ bool CCollision::TileExists(int Index) const
 	if(Index < 0)
 		return false;
 
+	if(m_pTileFlags)
+		return m_pTileFlags[Index] & (COLFLAG_EXISTS | COLFLAG_EXISTS_NEXT | COLFLAG_DOOR);
+	return TileExistsHere(Index) || (m_pDoor && m_pDoor[Index].m_Index) || TileExistsNextRaw(Index);
+}
+
+bool CCollision::TileExistsHere(int Index) const
+{
 	if((m_pTiles[Index].m_Index >= TILE_FREEZE && m_pTiles[Index].m_Index <= TILE_TELE_LASER_DISABLE) || (m_pTiles[Index].m_Index >= TILE_LFREEZE && m_pTiles[Index].m_Index <= TILE_LUNFREEZE))
 		return true;
 	if(m_pFront && ((m_pFront[Index].m_Index >= TILE_FREEZE && m_pFront[Index].m_Index <= TILE_TELE_LASER_DISABLE) || (m_pFront[Index].m_Index >= TILE_LFREEZE && m_pFront[Index].m_Index <= TILE_LUNFREEZE)))
@@ -848,19 +1121,24 @@ bool CCollision::TileExists(int Index) const
 		return true;
 	if(m_pSpeedup && m_pSpeedup[Index].m_Force > 0)
 		return true;
-	if(m_pDoor && m_pDoor[Index].m_Index)
-		return true;
 	if(m_pSwitch && m_pSwitch[Index].m_Type)
 		return true;
 	if(m_pTune && m_pTune[Index].m_Type)
 		return true;
-	return TileExistsNext(Index);
+	return false;
 }
 
 bool CCollision::TileExistsNext(int Index) const
 {
 	if(Index < 0)
 		return false;
+	if(m_pTileFlags)
+		return m_pTileFlags[Index] & COLFLAG_EXISTS_NEXT;
+	return TileExistsNextRaw(Index);
+}
+
+bool CCollision::TileExistsNextRaw(int Index) const
+{
 	int TileOnTheLeft = (Index - 1 > 0) ? Index - 1 : Index;
 	int TileOnTheRight = (Index + 1 < m_Width * m_Height) ? Index + 1 : Index;
 	int TileBelow = (Index + m_Width < m_Width * m_Height) ? Index + m_Width : Index;
@@ -953,6 +1231,51 @@ std::vector<int> CCollision::GetMapIndices(vec2 PrevPos, vec2 Pos, unsigned MaxI
 	}
 }
 
+CCollision::CMapIndices::CMapIndices(const CCollision *pCollision, vec2 PrevPos, vec2 Pos, unsigned MaxIndices) :
+	m_pCollision(pCollision), m_PrevPos(PrevPos), m_Pos(Pos), m_MaxIndices(MaxIndices)
+{
+	m_Distance = distance(PrevPos, Pos);
+	m_End = m_Distance + 1;
+	m_Sample = 0;
+	m_LastIndex = 0;
+	m_NumIndices = 0;
+	if(!m_Distance)
+	{
+		int Nx = clamp((int)Pos.x / 32, 0, pCollision->m_Width - 1);
+		int Ny = clamp((int)Pos.y / 32, 0, pCollision->m_Height - 1);
+		int Index = Ny * pCollision->m_Width + Nx;
+		m_Index = pCollision->TileExists(Index) ? Index : -1;
+		m_End = 0;
+		return;
+	}
+	Next();
+}
+
+void CCollision::CMapIndices::Next()
+{
+	m_Index = -1;
+	// GetMapIndices stops before adding a tile if it has more than
+	// MaxIndices already
+	if(m_MaxIndices && m_NumIndices > m_MaxIndices)
+		return;
+	for(; m_Sample < m_End; m_Sample++)
+	{
+		float a = m_Sample / m_Distance;
+		vec2 Tmp = mix(m_PrevPos, m_Pos, a);
+		int Nx = clamp((int)Tmp.x / 32, 0, m_pCollision->m_Width - 1);
+		int Ny = clamp((int)Tmp.y / 32, 0, m_pCollision->m_Height - 1);
+		int Index = Ny * m_pCollision->m_Width + Nx;
+		if(m_pCollision->TileExists(Index) && m_LastIndex != Index)
+		{
+			m_LastIndex = Index;
+			m_NumIndices++;
+			m_Sample++;
+			m_Index = Index;
+			return;
+		}
+	}
+}
+
 vec2 CCollision::GetPos(int Index) const
 {
 	if(Index < 0)
@@ -1079,6 +1402,12 @@ void CCollision::SetCollisionAt(float x, float y, int Index)
 	int Ny = clamp(round_to_int(y) / 32, 0, m_Height - 1);
 
 	m_pTiles[Ny * m_Width + Nx].m_Index = Index;
+	UpdateTileFlags(Ny * m_Width + Nx);
+	if(!m_vLineSkip.empty())
+	{
+		m_vLineSkip[Ny * m_Width + Nx] = LineSkipFlags(Ny * m_Width + Nx);
+		UpdateLineSkipBlock(Nx >> LINESKIP_BLOCK_SHIFT, Ny >> LINESKIP_BLOCK_SHIFT);
+	}
 }
 
 void CCollision::SetDoorCollisionAt(float x, float y, int Type, int Flags, int Number)
@@ -1091,6 +1420,7 @@ void CCollision::SetDoorCollisionAt(float x, float y, int Type, int Flags, int N
 	m_pDoor[Ny * m_Width + Nx].m_Index = Type;
 	m_pDoor[Ny * m_Width + Nx].m_Flags = Flags;
 	m_pDoor[Ny * m_Width + Nx].m_Number = Number;
+	UpdateTileFlags(Ny * m_Width + Nx);
 }
 
 void CCollision::GetDoorTile(int Index, CDoorTile *pDoorTile) const
@@ -1146,6 +1476,13 @@ int CCollision::IntersectNoLaser(vec2 Pos0, vec2 Pos1, vec2 *pOutCollision, vec2
 	{
 		float a = i / d;
 		vec2 Pos = mix(Pos0, Pos1, a);
+		const int Skip = SkipEmpty(LINESKIP_NOLASER, Pos, i, id - 1, [&](int Sample) { return mix(Pos0, Pos1, Sample / d); });
+		if(Skip >= 0)
+		{
+			i = Skip;
+			Last = mix(Pos0, Pos1, i / d);
+			continue;
+		}
 		int Nx = clamp(round_to_int(Pos.x) / 32, 0, m_Width - 1);
 		int Ny = clamp(round_to_int(Pos.y) / 32, 0, m_Height - 1);
 		if(GetIndex(Nx, Ny) == TILE_SOLID || GetIndex(Nx, Ny) == TILE_NOHOOK || GetIndex(Nx, Ny) == TILE_NOLASER || GetFrontIndex(Nx, Ny) == TILE_NOLASER)
@@ -1177,6 +1514,13 @@ int CCollision::IntersectNoLaserNoWalls(vec2 Pos0, vec2 Pos1, vec2 *pOutCollisio
 	{
 		float a = (float)i / d;
 		vec2 Pos = mix(Pos0, Pos1, a);
+		const int Skip = SkipEmpty(LINESKIP_NOLASER_NOWALLS, Pos, i, id - 1, [&](int Sample) { return mix(Pos0, Pos1, (float)Sample / d); });
+		if(Skip >= 0)
+		{
+			i = Skip;
+			Last = mix(Pos0, Pos1, (float)i / d);
+			continue;
+		}
 		if(IsNoLaser(round_to_int(Pos.x), round_to_int(Pos.y)) || IsFrontNoLaser(round_to_int(Pos.x), round_to_int(Pos.y)))
 		{
 			if(pOutCollision)
@@ -1206,6 +1550,13 @@ int CCollision::IntersectAir(vec2 Pos0, vec2 Pos1, vec2 *pOutCollision, vec2 *pO
 	{
 		float a = (float)i / d;
 		vec2 Pos = mix(Pos0, Pos1, a);
+		const int Skip = SkipEmpty(LINESKIP_AIR, Pos, i, id - 1, [&](int Sample) { return mix(Pos0, Pos1, (float)Sample / d); });
+		if(Skip >= 0)
+		{
+			i = Skip;
+			Last = mix(Pos0, Pos1, (float)i / d);
+			continue;
+		}
 		if(IsSolid(round_to_int(Pos.x), round_to_int(Pos.y)) || (!GetTile(round_to_int(Pos.x), round_to_int(Pos.y)) && !GetFrontTile(round_to_int(Pos.x), round_to_int(Pos.y))))
 		{
 			if(pOutCollision)
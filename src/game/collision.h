@@ -6,6 +6,7 @@
 #include <base/vmath.h>
 #include <engine/shared/protocol.h>
 
+#include <cstdint>
 #include <map>
 #include <vector>
 
@@ -60,6 +61,13 @@ public:
 	int IntersectNoLaser(vec2 Pos0, vec2 Pos1, vec2 *pOutCollision, vec2 *pOutBeforeCollision) const;
 	int IntersectNoLaserNoWalls(vec2 Pos0, vec2 Pos1, vec2 *pOutCollision, vec2 *pOutBeforeCollision) const;
 	int IntersectAir(vec2 Pos0, vec2 Pos1, vec2 *pOutCollision, vec2 *pOutBeforeCollision) const;
+	// the Intersect* functions skip over tiles that cannot stop them, the
+	// results are the same as without skipping, disabling it is only useful
+	// to compare both
+	void SetLineSkipping(bool Enabled) { m_LineSkipping = Enabled; }
+	// tile queries use a packed per-tile flag layer instead of reading the
+	// map layers, disabling it is only useful to compare both
+	void SetUseTileFlags(bool Use) { m_pTileFlags = Use && !m_vTileFlags.empty() ? m_vTileFlags.data() : nullptr; }
 	int GetIndex(int x, int y) const;
 	int GetIndex(vec2 PrevPos, vec2 Pos) const;
 	int GetFrontIndex(int x, int y) const;
@@ -76,6 +84,55 @@ public:
 	int GetPureMapIndex(float x, float y) const;
 	int GetPureMapIndex(vec2 Pos) const { return GetPureMapIndex(Pos.x, Pos.y); }
 	std::vector<int> GetMapIndices(vec2 PrevPos, vec2 Pos, unsigned MaxIndices = 0) const;
+
+	/**
+	 * Visits the same tiles in the same order as GetMapIndices, but finds
+	 * them one after another while iterating instead of allocating a vector.
+	 * Can only be iterated once.
+	 */
+	class CMapIndices
+	{
+		friend class CCollision;
+
+		const CCollision *m_pCollision;
+		vec2 m_PrevPos;
+		vec2 m_Pos;
+		float m_Distance;
+		int m_End;
+		int m_Sample;
+		int m_LastIndex;
+		unsigned m_MaxIndices;
+		unsigned m_NumIndices;
+		// -1 after the last tile
+		int m_Index;
+
+		CMapIndices(const CCollision *pCollision, vec2 PrevPos, vec2 Pos, unsigned MaxIndices);
+		void Next();
+
+	public:
+		class CIterator
+		{
+			CMapIndices *m_pIndices;
+
+		public:
+			CIterator(CMapIndices *pIndices) :
+				m_pIndices(pIndices) {}
+			int operator*() const { return m_pIndices->m_Index; }
+			CIterator &operator++()
+			{
+				m_pIndices->Next();
+				if(m_pIndices->m_Index < 0)
+					m_pIndices = nullptr;
+				return *this;
+			}
+			bool operator!=(const CIterator &Other) const { return m_pIndices != Other.m_pIndices; }
+		};
+
+		bool empty() const { return m_Index < 0; }
+		CIterator begin() { return CIterator(empty() ? nullptr : this); }
+		CIterator end() { return CIterator(nullptr); }
+	};
+	CMapIndices IterateMapIndices(vec2 PrevPos, vec2 Pos, unsigned MaxIndices = 0) const { return CMapIndices(this, PrevPos, Pos, MaxIndices); }
 	int GetMapIndex(vec2 Pos) const;
 	bool TileExists(int Index) const;
 	bool TileExistsNext(int Index) const;
@@ -157,6 +214,33 @@ private:
 	CTuneTile *m_pTune;
 	CDoorTile *m_pDoor;
 
+	enum
+	{
+		LINESKIP_BLOCK_SHIFT = 3,
+	};
+	// per tile and per block of 8x8 tiles, which line queries cannot stop
+	// in this tile, see LINESKIP_* in collision.cpp
+	std::vector<uint8_t> m_vLineSkip;
+	std::vector<uint8_t> m_vLineSkipBlocks;
+	int m_LineSkipBlocksWidth;
+	bool m_LineSkipping;
+
+	// per tile, which of the common tile predicates are true, see COLFLAG_*
+	// in collision.cpp
+	std::vector<uint16_t> m_vTileFlags;
+	const uint16_t *m_pTileFlags;
+
+	uint16_t TileFlags(int Index) const;
+	// updates the flags of the tile and of the tiles next to it
+	void UpdateTileFlags(int Index);
+	bool TileExistsHere(int Index) const;
+	bool TileExistsNextRaw(int Index) const;
+
+	uint8_t LineSkipFlags(int Index) const;
+	void UpdateLineSkipBlock(int BlockX, int BlockY);
+	template<typename FSamplePos>
+	int SkipEmpty(int Flag, vec2 Pos, int Sample, int LastSample, FSamplePos &&SamplePos) const;
+
 	// TILE_TELEIN
 	std::map<int, std::vector<vec2>> m_TeleIns;
 	// TILE_TELEOUT
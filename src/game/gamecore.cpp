@@ -568,25 +568,34 @@ void CCharacterCore::Move()
 		float Distance = distance(m_Pos, NewPos);
 		if(Distance > 0)
 		{
+			// the other characters don't move while this one does, so find the
+			// ones it can collide with once instead of for every sample
+			vec2 aOtherPos[MAX_CLIENTS];
+			int NumOthers = 0;
+			for(int p = 0; p < MAX_CLIENTS; p++)
+			{
+				CCharacterCore *pCharCore = m_pWorld->m_apCharacters[p];
+				if(!pCharCore || pCharCore == this)
+					continue;
+				if((!(pCharCore->m_Super || m_Super) && (m_Solo || pCharCore->m_Solo || pCharCore->m_CollisionDisabled || (m_Id != -1 && !m_pTeams->CanCollide(m_Id, p)))))
+					continue;
+				aOtherPos[NumOthers++] = pCharCore->m_Pos;
+			}
+
 			int End = Distance + 1;
 			vec2 LastPos = m_Pos;
-			for(int i = 0; i < End; i++)
+			for(int i = 0; i < End && NumOthers > 0; i++)
 			{
 				float a = i / Distance;
 				vec2 Pos = mix(m_Pos, NewPos, a);
-				for(int p = 0; p < MAX_CLIENTS; p++)
+				for(int o = 0; o < NumOthers; o++)
 				{
-					CCharacterCore *pCharCore = m_pWorld->m_apCharacters[p];
-					if(!pCharCore || pCharCore == this)
-						continue;
-					if((!(pCharCore->m_Super || m_Super) && (m_Solo || pCharCore->m_Solo || pCharCore->m_CollisionDisabled || (m_Id != -1 && !m_pTeams->CanCollide(m_Id, p)))))
-						continue;
-					float D = distance(Pos, pCharCore->m_Pos);
+					float D = distance(Pos, aOtherPos[o]);
 					if(D < PhysicalSize())
 					{
 						if(a > 0.0f)
 							m_Pos = LastPos;
-						else if(distance(NewPos, pCharCore->m_Pos) > D)
+						else if(distance(NewPos, aOtherPos[o]) > D)
 							m_Pos = NewPos;
 						return;
 					}
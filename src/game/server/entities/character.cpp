@@ -86,6 +86,7 @@ bool CCharacter::Spawn(CPlayer *pPlayer, vec2 Pos)
 	m_ReckoningTick = 0;
 	m_SendCore = CCharacterCore();
 	m_ReckoningCore = CCharacterCore();
+	m_aStuckMessage[0] = '\0';
 
 	GameServer()->m_World.InsertEntity(this);
 	m_Alive = true;
@@ -806,6 +807,12 @@ void CCharacter::Tick()
 }
 
 void CCharacter::TickDeferred()
+{
+	TickDeferredCore();
+	TickDeferredEvents();
+}
+
+void CCharacter::TickDeferredCore()
 {
 	// advance the dummy
 	{
@@ -829,6 +836,7 @@ void CCharacter::TickDeferred()
 	bool StuckAfterQuant = Collision()->TestBox(m_Core.m_Pos, CCharacterCore::PhysicalSizeVec2());
 	m_Pos = m_Core.m_Pos;
 
+	m_aStuckMessage[0] = '\0';
 	if(!StuckBefore && (StuckAfterMove || StuckAfterQuant))
 	{
 		// Hackish solution to get rid of strict-aliasing warning
@@ -843,8 +851,7 @@ void CCharacter::TickDeferred()
 		StartVelX.f = StartVel.x;
 		StartVelY.f = StartVel.y;
 
-		char aBuf[256];
-		str_format(aBuf, sizeof(aBuf), "STUCK!!! %d %d %d %f %f %f %f %x %x %x %x",
+		str_format(m_aStuckMessage, sizeof(m_aStuckMessage), "STUCK!!! %d %d %d %f %f %f %f %x %x %x %x",
 			StuckBefore,
 			StuckAfterMove,
 			StuckAfterQuant,
@@ -852,8 +859,13 @@ void CCharacter::TickDeferred()
 			StartVel.x, StartVel.y,
 			StartPosX.u, StartPosY.u,
 			StartVelX.u, StartVelY.u);
-		GameServer()->Console()->Print(IConsole::OUTPUT_LEVEL_DEBUG, "game", aBuf);
 	}
+}
+
+void CCharacter::TickDeferredEvents()
+{
+	if(m_aStuckMessage[0] != '\0')
+		GameServer()->Console()->Print(IConsole::OUTPUT_LEVEL_DEBUG, "game", m_aStuckMessage);
 
 	{
 		int Events = m_Core.m_TriggeredEvents;
@@ -1189,7 +1201,11 @@ bool CCharacter::IsSnappingCharacterInView(int SnappingClientId)
 	int Id = m_pPlayer->GetCid();
 
 	// A player may not be clipped away if his hook or a hook attached to him is in the field of view
-	bool PlayerAndHookNotInView = NetworkClippedLine(SnappingClientId, m_Pos, m_Core.m_HookPos);
+	bool PlayerAndHookNotInView;
+	if(SnappingClientId != SERVER_DEMO_CLIENT && GameServer()->m_SnapViews.Active())
+		PlayerAndHookNotInView = !m_HookVisibleMask.test(SnappingClientId);
+	else
+		PlayerAndHookNotInView = NetworkClippedLine(SnappingClientId, m_Pos, m_Core.m_HookPos);
 	bool AttachedHookInView = false;
 	if(PlayerAndHookNotInView)
 	{
@@ -1312,6 +1328,11 @@ void CCharacter::Snap(int SnappingClient)
 	pDDNetCharacter->m_TuneZoneOverride = -1;
 }
 
+void CCharacter::PreSnap()
+{
+	m_HookVisibleMask = GameServer()->m_SnapViews.VisibleLineMask(m_Pos, m_Core.m_HookPos);
+}
+
 void CCharacter::PostSnap()
 {
 	m_TriggeredEvents7 = 0;
@@ -2257,10 +2278,10 @@ void CCharacter::DDRacePostCoreTick()
 		return;
 
 	// handle Anti-Skip tiles
-	std::vector<int> vIndices = Collision()->GetMapIndices(m_PrevPos, m_Pos);
-	if(!vIndices.empty())
+	CCollision::CMapIndices Indices = Collision()->IterateMapIndices(m_PrevPos, m_Pos);
+	if(!Indices.empty())
 	{
-		for(int &Index : vIndices)
+		for(int Index : Indices)
 		{
 			HandleTiles(Index);
 			if(!m_Alive)
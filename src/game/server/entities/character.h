@@ -40,8 +40,14 @@ public:
 	void PreTick();
 	void Tick() override;
 	void TickDeferred() override;
+	// TickDeferred() is split into the physics, that only change this
+	// character and read the characters it can collide with, and the events
+	// for the rest of the game
+	void TickDeferredCore();
+	void TickDeferredEvents();
 	void TickPaused() override;
 	void Snap(int SnappingClient) override;
+	void PreSnap() override;
 	void PostSnap() override;
 	void SwapClients(int Client1, int Client2) override;
 
@@ -162,6 +168,10 @@ private:
 	int m_ReckoningTick; // tick that we are performing dead reckoning From
 	CCharacterCore m_SendCore; // core that we should send
 	CCharacterCore m_ReckoningCore; // the dead reckoning core
+	char m_aStuckMessage[256]; // set by TickDeferredCore(), printed by TickDeferredEvents()
+
+	// clients that the line from the character to its hook is not clipped for
+	CClientMask m_HookVisibleMask;
 
 	// DDRace
 
@@ -32,6 +32,8 @@ CEntity::~CEntity()
 
 bool CEntity::NetworkClipped(int SnappingClient) const
 {
+	if(SnappingClient != SERVER_DEMO_CLIENT && m_pGameWorld->GameServer()->m_SnapViews.Active())
+		return !m_NetworkVisibleMask.test(SnappingClient);
 	return ::NetworkClipped(m_pGameWorld->GameServer(), SnappingClient, m_Pos);
 }
 
@@ -89,7 +91,11 @@ bool CEntity::GetNearestAirPosPlayer(vec2 PlayerPos, vec2 *pOutPos)
 
 bool NetworkClipped(const CGameContext *pGameServer, int SnappingClient, vec2 CheckPos)
 {
-	if(SnappingClient == SERVER_DEMO_CLIENT || pGameServer->m_apPlayers[SnappingClient]->m_ShowAll)
+	if(SnappingClient == SERVER_DEMO_CLIENT)
+		return false;
+	if(pGameServer->m_SnapViews.Active())
+		return pGameServer->m_SnapViews.Clipped(SnappingClient, CheckPos);
+	if(pGameServer->m_apPlayers[SnappingClient]->m_ShowAll)
 		return false;
 
 	float dx = pGameServer->m_apPlayers[SnappingClient]->m_ViewPos.x - CheckPos.x;
@@ -102,7 +108,11 @@ bool NetworkClipped(const CGameContext *pGameServer, int SnappingClient, vec2 Ch
 
 bool NetworkClippedLine(const CGameContext *pGameServer, int SnappingClient, vec2 StartPos, vec2 EndPos)
 {
-	if(SnappingClient == SERVER_DEMO_CLIENT || pGameServer->m_apPlayers[SnappingClient]->m_ShowAll)
+	if(SnappingClient == SERVER_DEMO_CLIENT)
+		return false;
+	if(pGameServer->m_SnapViews.Active())
+		return pGameServer->m_SnapViews.ClippedLine(SnappingClient, StartPos, EndPos);
+	if(pGameServer->m_apPlayers[SnappingClient]->m_ShowAll)
 		return false;
 
 	vec2 &ViewPos = pGameServer->m_apPlayers[SnappingClient]->m_ViewPos;
@@ -39,6 +39,9 @@ private:
 	*/
 	float m_ProximityRadius;
 
+	// clients that m_Pos is not clipped for, while a snapshot is created
+	CClientMask m_NetworkVisibleMask;
+
 protected:
 	/* State */
 	bool m_MarkedForDestroy;
@@ -123,6 +126,13 @@ public: // TODO: Maybe make protected
 	*/
 	virtual void Snap(int SnappingClient) {}
 
+	/*
+		Function: PreSnap
+			Called before the clients receive their snapshot, after
+			the views of the clients are known.
+	*/
+	virtual void PreSnap() {}
+
 	/*
 		Function: PostSnap
 			Called after all clients received their snapshot.
@@ -45,26 +45,45 @@ void CEventHandler::Clear()
 	m_CurrentOffset = 0;
 }
 
+void CEventHandler::PreSnap()
+{
+	for(int i = 0; i < m_NumEvents; i++)
+	{
+		const CNetEvent_Common *pEvent = (CNetEvent_Common *)&m_aData[m_aOffsets[i]];
+		m_aVisibleMasks[i] = m_aClientMasks[i] & GameServer()->m_SnapViews.VisibleMask(vec2(pEvent->m_X, pEvent->m_Y));
+	}
+}
+
 void CEventHandler::Snap(int SnappingClient)
 {
+	const bool HaveVisibleMasks = GameServer()->m_SnapViews.Active();
 	for(int i = 0; i < m_NumEvents; i++)
 	{
-		if(SnappingClient == SERVER_DEMO_CLIENT || m_aClientMasks[i].test(SnappingClient))
+		bool Visible = true;
+		if(SnappingClient != SERVER_DEMO_CLIENT)
 		{
-			CNetEvent_Common *pEvent = (CNetEvent_Common *)&m_aData[m_aOffsets[i]];
-			if(!NetworkClipped(GameServer(), SnappingClient, vec2(pEvent->m_X, pEvent->m_Y)))
+			if(HaveVisibleMasks)
+			{
+				Visible = m_aVisibleMasks[i].test(SnappingClient);
+			}
+			else
 			{
-				int Type = m_aTypes[i];
-				int Size = m_aSizes[i];
-				const char *pData = &m_aData[m_aOffsets[i]];
-				if(GameServer()->Server()->IsSixup(SnappingClient))
-					EventToSixup(&Type, &Size, &pData);
-
-				void *pItem = GameServer()->Server()->SnapNewItem(Type, i, Size);
-				if(pItem)
-					mem_copy(pItem, pData, Size);
+				const CNetEvent_Common *pEvent = (CNetEvent_Common *)&m_aData[m_aOffsets[i]];
+				Visible = m_aClientMasks[i].test(SnappingClient) && !NetworkClipped(GameServer(), SnappingClient, vec2(pEvent->m_X, pEvent->m_Y));
 			}
 		}
+		if(!Visible)
+			continue;
+
+		int Type = m_aTypes[i];
+		int Size = m_aSizes[i];
+		const char *pData = &m_aData[m_aOffsets[i]];
+		if(GameServer()->Server()->IsSixup(SnappingClient))
+			EventToSixup(&Type, &Size, &pData);
+
+		void *pItem = GameServer()->Server()->SnapNewItem(Type, i, Size);
+		if(pItem)
+			mem_copy(pItem, pData, Size);
 	}
 }
 
@@ -19,6 +19,8 @@ class CEventHandler
 	int m_aOffsets[MAX_EVENTS];
 	int m_aSizes[MAX_EVENTS];
 	CClientMask m_aClientMasks[MAX_EVENTS];
+	// clients that receive the event and can see it, set by PreSnap()
+	CClientMask m_aVisibleMasks[MAX_EVENTS];
 	char m_aData[MAX_DATASIZE];
 
 	class CGameContext *m_pGameServer;
@@ -40,6 +42,7 @@ public:
 	}
 
 	void Clear();
+	void PreSnap();
 	void Snap(int SnappingClient);
 
 	void EventToSixup(int *pType, int *pSize, const char **ppData);
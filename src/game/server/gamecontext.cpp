@@ -17,7 +17,6 @@
 #include <engine/shared/datafile.h>
 #include <engine/shared/json.h>
 #include <engine/shared/linereader.h>
-#include <engine/shared/memheap.h>
 #include <engine/shared/protocolglue.h>
 #include <engine/storage.h>
 
@@ -87,8 +86,6 @@ void CGameContext::Construct(int Resetting)
 
 	m_pController = nullptr;
 
-	m_pVoteOptionFirst = nullptr;
-	m_pVoteOptionLast = nullptr;
 	m_LastMapVote = 0;
 
 	m_SqlRandomMapResult = nullptr;
@@ -106,7 +103,6 @@ void CGameContext::Construct(int Resetting)
 	m_aSixupVoteDescription[0] = '\0';
 	m_aVoteCommand[0] = '\0';
 	m_aVoteReason[0] = '\0';
-	m_NumVoteOptions = 0;
 	m_VoteEnforce = VOTE_ENFORCE_UNKNOWN;
 
 	m_LatestLog = 0;
@@ -123,10 +119,9 @@ void CGameContext::Construct(int Resetting)
 		std::fill(std::begin(m_aTeamMapping), std::end(m_aTeamMapping), -1);
 
 		m_NonEmptySince = 0;
-		m_pVoteOptionHeap = new CHeap();
+		m_pVoteOptions = new CVoteOptions();
 	}
 
-	m_aDeleteTempfile[0] = 0;
 	m_TeeHistorianActive = false;
 }
 
@@ -143,7 +138,7 @@ void CGameContext::Destruct(int Resetting)
 		for(auto &pSavedTeam : m_apSavedTeams)
 			delete pSavedTeam;
 
-		delete m_pVoteOptionHeap;
+		delete m_pVoteOptions;
 	}
 
 	if(m_pScore)
@@ -170,29 +165,17 @@ CGameContext::~CGameContext()
 
 void CGameContext::Clear()
 {
-	CHeap *pVoteOptionHeap = m_pVoteOptionHeap;
-	CVoteOptionServer *pVoteOptionFirst = m_pVoteOptionFirst;
-	CVoteOptionServer *pVoteOptionLast = m_pVoteOptionLast;
-	int NumVoteOptions = m_NumVoteOptions;
+	CVoteOptions *pVoteOptions = m_pVoteOptions;
 	CTuningParams Tuning = m_Tuning;
 
 	m_Resetting = true;
 	this->~CGameContext();
 	new(this) CGameContext(RESET);
 
-	m_pVoteOptionHeap = pVoteOptionHeap;
-	m_pVoteOptionFirst = pVoteOptionFirst;
-	m_pVoteOptionLast = pVoteOptionLast;
-	m_NumVoteOptions = NumVoteOptions;
+	m_pVoteOptions = pVoteOptions;
 	m_Tuning = Tuning;
 }
 
-void CGameContext::TeeHistorianWrite(const void *pData, int DataSize, void *pUser)
-{
-	CGameContext *pSelf = (CGameContext *)pUser;
-	aio_write(pSelf->m_pTeeHistorianFile, pData, DataSize);
-}
-
 void CGameContext::CommandCallback(int ClientId, int FlagMask, const char *pCmd, IConsole::IResult *pResult, void *pUser)
 {
 	CGameContext *pSelf = (CGameContext *)pUser;
@@ -1030,7 +1013,7 @@ void CGameContext::OnTick()
 
 	if(m_TeeHistorianActive)
 	{
-		int Error = aio_error(m_pTeeHistorianFile);
+		int Error = m_TeeHistorianWriter.Error();
 		if(Error)
 		{
 			dbg_msg("teehistorian", "error writing to file, err=%d", Error);
@@ -1042,6 +1025,10 @@ void CGameContext::OnTick()
 			m_TeeHistorian.EndInputs();
 			m_TeeHistorian.EndTick();
 		}
+		if(g_Config.m_SvTeeHistorianSync > 0 && Server()->Tick() % (g_Config.m_SvTeeHistorianSync * Server()->TickSpeed()) == 0)
+		{
+			m_TeeHistorianWriter.Sync();
+		}
 		m_TeeHistorian.BeginTick(Server()->Tick());
 		m_TeeHistorian.BeginPlayers();
 	}
@@ -1407,15 +1394,7 @@ void CGameContext::OnClientPredictedEarlyInput(int ClientId, void *pInput)
 
 const CVoteOptionServer *CGameContext::GetVoteOption(int Index) const
 {
-	const CVoteOptionServer *pCurrent;
-	for(pCurrent = m_pVoteOptionFirst;
-		Index > 0 && pCurrent;
-		Index--, pCurrent = pCurrent->m_pNext)
-		;
-
-	if(Index > 0)
-		return nullptr;
-	return pCurrent;
+	return m_pVoteOptions->Get(Index);
 }
 
 void CGameContext::ProgressVoteOptions(int ClientId)
@@ -1425,11 +1404,11 @@ void CGameContext::ProgressVoteOptions(int ClientId)
 	if(pPl->m_SendVoteIndex == -1)
 		return; // we didn't start sending options yet
 
-	if(pPl->m_SendVoteIndex > m_NumVoteOptions)
+	const int NumVoteOptions = m_pVoteOptions->Num();
+	if(pPl->m_SendVoteIndex > NumVoteOptions)
 		return; // shouldn't happen / fail silently
 
-	int VotesLeft = m_NumVoteOptions - pPl->m_SendVoteIndex;
-	int NumVotesToSend = minimum(g_Config.m_SvSendVotesPerTick, VotesLeft);
+	int VotesLeft = NumVoteOptions - pPl->m_SendVoteIndex;
 
 	if(!VotesLeft)
 	{
@@ -1437,53 +1416,9 @@ void CGameContext::ProgressVoteOptions(int ClientId)
 		return;
 	}
 
-	// build vote option list msg
-	int CurIndex = 0;
-
-	CNetMsg_Sv_VoteOptionListAdd OptionMsg;
-	OptionMsg.m_pDescription0 = "";
-	OptionMsg.m_pDescription1 = "";
-	OptionMsg.m_pDescription2 = "";
-	OptionMsg.m_pDescription3 = "";
-	OptionMsg.m_pDescription4 = "";
-	OptionMsg.m_pDescription5 = "";
-	OptionMsg.m_pDescription6 = "";
-	OptionMsg.m_pDescription7 = "";
-	OptionMsg.m_pDescription8 = "";
-	OptionMsg.m_pDescription9 = "";
-	OptionMsg.m_pDescription10 = "";
-	OptionMsg.m_pDescription11 = "";
-	OptionMsg.m_pDescription12 = "";
-	OptionMsg.m_pDescription13 = "";
-	OptionMsg.m_pDescription14 = "";
-
-	// get current vote option by index
-	const CVoteOptionServer *pCurrent = GetVoteOption(pPl->m_SendVoteIndex);
-
-	while(CurIndex < NumVotesToSend && pCurrent != nullptr)
-	{
-		switch(CurIndex)
-		{
-		case 0: OptionMsg.m_pDescription0 = pCurrent->m_aDescription; break;
-		case 1: OptionMsg.m_pDescription1 = pCurrent->m_aDescription; break;
-		case 2: OptionMsg.m_pDescription2 = pCurrent->m_aDescription; break;
-		case 3: OptionMsg.m_pDescription3 = pCurrent->m_aDescription; break;
-		case 4: OptionMsg.m_pDescription4 = pCurrent->m_aDescription; break;
-		case 5: OptionMsg.m_pDescription5 = pCurrent->m_aDescription; break;
-		case 6: OptionMsg.m_pDescription6 = pCurrent->m_aDescription; break;
-		case 7: OptionMsg.m_pDescription7 = pCurrent->m_aDescription; break;
-		case 8: OptionMsg.m_pDescription8 = pCurrent->m_aDescription; break;
-		case 9: OptionMsg.m_pDescription9 = pCurrent->m_aDescription; break;
-		case 10: OptionMsg.m_pDescription10 = pCurrent->m_aDescription; break;
-		case 11: OptionMsg.m_pDescription11 = pCurrent->m_aDescription; break;
-		case 12: OptionMsg.m_pDescription12 = pCurrent->m_aDescription; break;
-		case 13: OptionMsg.m_pDescription13 = pCurrent->m_aDescription; break;
-		case 14: OptionMsg.m_pDescription14 = pCurrent->m_aDescription; break;
-		}
-
-		CurIndex++;
-		pCurrent = pCurrent->m_pNext;
-	}
+	// the vote option list msg is shared by all players receiving it
+	CMsgPacker OptionMsg(NETMSGTYPE_SV_VOTEOPTIONLISTADD, false);
+	int NumVotesToSend = m_pVoteOptions->PackListAdd(pPl->m_SendVoteIndex, g_Config.m_SvSendVotesPerTick, &OptionMsg);
 
 	// send msg
 	if(pPl->m_SendVoteIndex == 0)
@@ -1492,12 +1427,11 @@ void CGameContext::ProgressVoteOptions(int ClientId)
 		Server()->SendPackMsg(&StartMsg, MSGFLAG_VITAL, ClientId);
 	}
 
-	OptionMsg.m_NumOptions = NumVotesToSend;
-	Server()->SendPackMsg(&OptionMsg, MSGFLAG_VITAL, ClientId);
+	Server()->SendMsg(&OptionMsg, MSGFLAG_VITAL, ClientId);
 
 	pPl->m_SendVoteIndex += NumVotesToSend;
 
-	if(pPl->m_SendVoteIndex == m_NumVoteOptions)
+	if(pPl->m_SendVoteIndex == NumVoteOptions)
 	{
 		CNetMsg_Sv_VoteOptionGroupEnd EndMsg;
 		Server()->SendPackMsg(&EndMsg, MSGFLAG_VITAL, ClientId);
@@ -2267,43 +2201,36 @@ void CGameContext::OnCallVoteNetMessage(const CNetMsg_Cl_CallVote *pMsg, int Cli
 
 	if(str_comp_nocase(pMsg->m_pType, "option") == 0)
 	{
-		CVoteOptionServer *pOption = m_pVoteOptionFirst;
-		while(pOption)
+		const CVoteOptionServer *pOption = m_pVoteOptions->Find(pMsg->m_pValue);
+		if(pOption)
 		{
-			if(str_comp_nocase(pMsg->m_pValue, pOption->m_aDescription) == 0)
+			if(!Console()->LineIsValid(pOption->m_aCommand))
 			{
-				if(!Console()->LineIsValid(pOption->m_aCommand))
-				{
-					SendChatTarget(ClientId, "Invalid option");
-					return;
-				}
-				if((str_find(pOption->m_aCommand, "sv_map ") != nullptr || str_find(pOption->m_aCommand, "change_map ") != nullptr || str_find(pOption->m_aCommand, "random_map") != nullptr || str_find(pOption->m_aCommand, "random_unfinished_map") != nullptr) && RateLimitPlayerMapVote(ClientId))
-				{
-					return;
-				}
-
-				str_format(aChatmsg, sizeof(aChatmsg), "'%s' called vote to change server option '%s' (%s)", Server()->ClientName(ClientId),
-					pOption->m_aDescription, aReason);
-				str_copy(aDesc, pOption->m_aDescription);
+				SendChatTarget(ClientId, "Invalid option");
+				return;
+			}
+			if((str_find(pOption->m_aCommand, "sv_map ") != nullptr || str_find(pOption->m_aCommand, "change_map ") != nullptr || str_find(pOption->m_aCommand, "random_map") != nullptr || str_find(pOption->m_aCommand, "random_unfinished_map") != nullptr) && RateLimitPlayerMapVote(ClientId))
+			{
+				return;
+			}
 
-				if((str_endswith(pOption->m_aCommand, "random_map") || str_endswith(pOption->m_aCommand, "random_unfinished_map")) && str_length(aReason) == 1 && aReason[0] >= '0' && aReason[0] <= '5')
-				{
-					int Stars = aReason[0] - '0';
-					str_format(aCmd, sizeof(aCmd), "%s %d", pOption->m_aCommand, Stars);
-				}
-				else
-				{
-					str_copy(aCmd, pOption->m_aCommand);
-				}
+			str_format(aChatmsg, sizeof(aChatmsg), "'%s' called vote to change server option '%s' (%s)", Server()->ClientName(ClientId),
+				pOption->m_aDescription, aReason);
+			str_copy(aDesc, pOption->m_aDescription);
 
-				m_LastMapVote = time_get();
-				break;
+			if((str_endswith(pOption->m_aCommand, "random_map") || str_endswith(pOption->m_aCommand, "random_unfinished_map")) && str_length(aReason) == 1 && aReason[0] >= '0' && aReason[0] <= '5')
+			{
+				int Stars = aReason[0] - '0';
+				str_format(aCmd, sizeof(aCmd), "%s %d", pOption->m_aCommand, Stars);
+			}
+			else
+			{
+				str_copy(aCmd, pOption->m_aCommand);
 			}
 
-			pOption = pOption->m_pNext;
+			m_LastMapVote = time_get();
 		}
-
-		if(!pOption)
+		else
 		{
 			if(Authed != AUTHED_ADMIN) // allow admins to call any vote they want
 			{
@@ -3280,7 +3207,7 @@ void CGameContext::ConAddVote(IConsole::IResult *pResult, void *pUserData)
 
 void CGameContext::AddVote(const char *pDescription, const char *pCommand)
 {
-	if(m_NumVoteOptions == MAX_VOTE_OPTIONS)
+	if(m_pVoteOptions->Num() == MAX_VOTE_OPTIONS)
 	{
 		Console()->Print(IConsole::OUTPUT_LEVEL_STANDARD, "server", "maximum number of vote options reached");
 		return;
@@ -3305,34 +3232,16 @@ void CGameContext::AddVote(const char *pDescription, const char *pCommand)
 	}
 
 	// check for duplicate entry
-	CVoteOptionServer *pOption = m_pVoteOptionFirst;
-	while(pOption)
+	if(m_pVoteOptions->Find(pDescription))
 	{
-		if(str_comp_nocase(pDescription, pOption->m_aDescription) == 0)
-		{
-			char aBuf[256];
-			str_format(aBuf, sizeof(aBuf), "option '%s' already exists", pDescription);
-			Console()->Print(IConsole::OUTPUT_LEVEL_STANDARD, "server", aBuf);
-			return;
-		}
-		pOption = pOption->m_pNext;
+		char aBuf[256];
+		str_format(aBuf, sizeof(aBuf), "option '%s' already exists", pDescription);
+		Console()->Print(IConsole::OUTPUT_LEVEL_STANDARD, "server", aBuf);
+		return;
 	}
 
 	// add the option
-	++m_NumVoteOptions;
-	int Len = str_length(pCommand);
-
-	pOption = (CVoteOptionServer *)m_pVoteOptionHeap->Allocate(sizeof(CVoteOptionServer) + Len, alignof(CVoteOptionServer));
-	pOption->m_pNext = nullptr;
-	pOption->m_pPrev = m_pVoteOptionLast;
-	if(pOption->m_pPrev)
-		pOption->m_pPrev->m_pNext = pOption;
-	m_pVoteOptionLast = pOption;
-	if(!m_pVoteOptionFirst)
-		m_pVoteOptionFirst = pOption;
-
-	str_copy(pOption->m_aDescription, pDescription, sizeof(pOption->m_aDescription));
-	str_copy(pOption->m_aCommand, pCommand, Len + 1);
+	m_pVoteOptions->Add(pDescription, pCommand);
 }
 
 void CGameContext::ConRemoveVote(IConsole::IResult *pResult, void *pUserData)
@@ -3340,15 +3249,8 @@ void CGameContext::ConRemoveVote(IConsole::IResult *pResult, void *pUserData)
 	CGameContext *pSelf = (CGameContext *)pUserData;
 	const char *pDescription = pResult->GetString(0);
 
-	// check for valid option
-	CVoteOptionServer *pOption = pSelf->m_pVoteOptionFirst;
-	while(pOption)
-	{
-		if(str_comp_nocase(pDescription, pOption->m_aDescription) == 0)
-			break;
-		pOption = pOption->m_pNext;
-	}
-	if(!pOption)
+	// remove the option
+	if(!pSelf->m_pVoteOptions->Remove(pDescription))
 	{
 		char aBuf[256];
 		str_format(aBuf, sizeof(aBuf), "option '%s' does not exist", pDescription);
@@ -3367,41 +3269,6 @@ void CGameContext::ConRemoveVote(IConsole::IResult *pResult, void *pUserData)
 		if(pPlayer)
 			pPlayer->m_SendVoteIndex = 0;
 	}
-
-	// TODO: improve this
-	// remove the option
-	--pSelf->m_NumVoteOptions;
-
-	CHeap *pVoteOptionHeap = new CHeap();
-	CVoteOptionServer *pVoteOptionFirst = nullptr;
-	CVoteOptionServer *pVoteOptionLast = nullptr;
-	int NumVoteOptions = pSelf->m_NumVoteOptions;
-	for(CVoteOptionServer *pSrc = pSelf->m_pVoteOptionFirst; pSrc; pSrc = pSrc->m_pNext)
-	{
-		if(pSrc == pOption)
-			continue;
-
-		// copy option
-		int Len = str_length(pSrc->m_aCommand);
-		CVoteOptionServer *pDst = (CVoteOptionServer *)pVoteOptionHeap->Allocate(sizeof(CVoteOptionServer) + Len, alignof(CVoteOptionServer));
-		pDst->m_pNext = nullptr;
-		pDst->m_pPrev = pVoteOptionLast;
-		if(pDst->m_pPrev)
-			pDst->m_pPrev->m_pNext = pDst;
-		pVoteOptionLast = pDst;
-		if(!pVoteOptionFirst)
-			pVoteOptionFirst = pDst;
-
-		str_copy(pDst->m_aDescription, pSrc->m_aDescription, sizeof(pDst->m_aDescription));
-		str_copy(pDst->m_aCommand, pSrc->m_aCommand, Len + 1);
-	}
-
-	// clean up
-	delete pSelf->m_pVoteOptionHeap;
-	pSelf->m_pVoteOptionHeap = pVoteOptionHeap;
-	pSelf->m_pVoteOptionFirst = pVoteOptionFirst;
-	pSelf->m_pVoteOptionLast = pVoteOptionLast;
-	pSelf->m_NumVoteOptions = NumVoteOptions;
 }
 
 void CGameContext::ConForceVote(IConsole::IResult *pResult, void *pUserData)
@@ -3414,27 +3281,18 @@ void CGameContext::ConForceVote(IConsole::IResult *pResult, void *pUserData)
 
 	if(str_comp_nocase(pType, "option") == 0)
 	{
-		CVoteOptionServer *pOption = pSelf->m_pVoteOptionFirst;
-		while(pOption)
-		{
-			if(str_comp_nocase(pValue, pOption->m_aDescription) == 0)
-			{
-				str_format(aBuf, sizeof(aBuf), "authorized player forced server option '%s' (%s)", pValue, pReason);
-				pSelf->SendChatTarget(-1, aBuf, FLAG_SIX);
-				pSelf->m_VoteCreator = pResult->m_ClientId;
-				pSelf->Console()->ExecuteLine(pOption->m_aCommand);
-				break;
-			}
-
-			pOption = pOption->m_pNext;
-		}
-
+		const CVoteOptionServer *pOption = pSelf->m_pVoteOptions->Find(pValue);
 		if(!pOption)
 		{
 			str_format(aBuf, sizeof(aBuf), "'%s' isn't an option on this server", pValue);
 			pSelf->Console()->Print(IConsole::OUTPUT_LEVEL_STANDARD, "server", aBuf);
 			return;
 		}
+
+		str_format(aBuf, sizeof(aBuf), "authorized player forced server option '%s' (%s)", pValue, pReason);
+		pSelf->SendChatTarget(-1, aBuf, FLAG_SIX);
+		pSelf->m_VoteCreator = pResult->m_ClientId;
+		pSelf->Console()->ExecuteLine(pOption->m_aCommand);
 	}
 	else if(str_comp_nocase(pType, "kick") == 0)
 	{
@@ -3478,10 +3336,7 @@ void CGameContext::ConClearVotes(IConsole::IResult *pResult, void *pUserData)
 
 	CNetMsg_Sv_VoteClearOptions VoteClearOptionsMsg;
 	pSelf->Server()->SendPackMsg(&VoteClearOptionsMsg, MSGFLAG_VITAL, -1);
-	pSelf->m_pVoteOptionHeap->Reset();
-	pSelf->m_pVoteOptionFirst = nullptr;
-	pSelf->m_pVoteOptionLast = nullptr;
-	pSelf->m_NumVoteOptions = 0;
+	pSelf->m_pVoteOptions->Clear();
 
 	// reset sending of vote options
 	for(auto &pPlayer : pSelf->m_apPlayers)
@@ -3598,14 +3453,10 @@ void CGameContext::ConVotes(IConsole::IResult *pResult, void *pUserData)
 	const int End = (Page + 1) * s_EntriesPerPage;
 
 	char aBuf[512];
-	int Count = 0;
-	for(CVoteOptionServer *pOption = pSelf->m_pVoteOptionFirst; pOption; pOption = pOption->m_pNext, Count++)
+	const int Count = pSelf->m_pVoteOptions->Num();
+	for(int i = maximum(Start, 0); i < minimum(End, Count); i++)
 	{
-		if(Count < Start || Count >= End)
-		{
-			continue;
-		}
-
+		const CVoteOptionServer *pOption = pSelf->m_pVoteOptions->Get(i);
 		str_copy(aBuf, "add_vote \"");
 		char *pDst = aBuf + str_length(aBuf);
 		str_escape(&pDst, pOption->m_aDescription, aBuf + sizeof(aBuf));
@@ -3883,8 +3734,6 @@ void CGameContext::OnInit(const void *pPersistentData)
 	m_Prng.Seed(aSeed);
 	m_World.m_Core.m_pPrng = &m_Prng;
 
-	DeleteTempfile();
-
 	for(int i = 0; i < NUM_NETOBJTYPES; i++)
 		Server()->SnapSetStaticsize(i, m_NetObjHandler.GetObjSize(i));
 
@@ -3982,7 +3831,7 @@ void CGameContext::OnInit(const void *pPersistentData)
 		FormatUuid(m_GameUuid, aGameUuid, sizeof(aGameUuid));
 
 		char aFilename[IO_MAX_PATH_LENGTH];
-		str_format(aFilename, sizeof(aFilename), "teehistorian/%s.teehistorian", aGameUuid);
+		str_format(aFilename, sizeof(aFilename), "teehistorian/%s.teehistorian%s", aGameUuid, g_Config.m_SvTeeHistorianCompression > 0 ? ".gz" : "");
 
 		IOHANDLE THFile = Storage()->OpenFile(aFilename, IOFLAG_WRITE, IStorage::TYPE_SAVE);
 		if(!THFile)
@@ -3995,7 +3844,7 @@ void CGameContext::OnInit(const void *pPersistentData)
 		{
 			dbg_msg("teehistorian", "recording to '%s'", aFilename);
 		}
-		m_pTeeHistorianFile = aio_new(THFile);
+		m_TeeHistorianWriter.Open(THFile, g_Config.m_SvTeeHistorianCompression);
 
 		char aVersion[128];
 		if(GIT_SHORTREV_HASH)
@@ -4036,7 +3885,7 @@ void CGameContext::OnInit(const void *pPersistentData)
 			mem_zero(&GameInfo.m_PrevGameUuid, sizeof(GameInfo.m_PrevGameUuid));
 		}
 
-		m_TeeHistorian.Reset(&GameInfo, TeeHistorianWrite, this);
+		m_TeeHistorian.Reset(&GameInfo, CTeeHistorianWriter::WriteCallback, &m_TeeHistorianWriter);
 
 		for(int i = 0; i < MAX_CLIENTS; i++)
 		{
@@ -4167,25 +4016,16 @@ void CGameContext::CreateAllEntities(bool Initial)
 	}
 }
 
-void CGameContext::DeleteTempfile()
-{
-	if(m_aDeleteTempfile[0] != 0)
-	{
-		Storage()->RemoveFile(m_aDeleteTempfile, IStorage::TYPE_SAVE);
-		m_aDeleteTempfile[0] = 0;
-	}
-}
-
-void CGameContext::OnMapChange(char *pNewMapName, int MapNameSize)
+bool CGameContext::OnMapChange(const char *pMapName, char *pNewMapName, int MapNameSize)
 {
 	char aConfig[IO_MAX_PATH_LENGTH];
-	str_format(aConfig, sizeof(aConfig), "maps/%s.cfg", g_Config.m_SvMap);
+	str_format(aConfig, sizeof(aConfig), "maps/%s.cfg", pMapName);
 
 	CLineReader LineReader;
 	if(!LineReader.OpenFile(Storage()->OpenFile(aConfig, IOFLAG_READ, IStorage::TYPE_ALL)))
 	{
 		// No map-specific config, just return.
-		return;
+		return false;
 	}
 
 	std::vector<const char *> vpLines;
@@ -4234,7 +4074,7 @@ void CGameContext::OnMapChange(char *pNewMapName, int MapNameSize)
 					{
 						// Configs coincide, no need to update map.
 						free(pSettings);
-						return;
+						return false;
 					}
 					Reader.UnloadData(pInfo->m_Settings);
 				}
@@ -4290,7 +4130,7 @@ void CGameContext::OnMapChange(char *pNewMapName, int MapNameSize)
 	Writer.Finish();
 
 	str_copy(pNewMapName, aTemp, MapNameSize);
-	str_copy(m_aDeleteTempfile, aTemp, sizeof(m_aDeleteTempfile));
+	return true;
 }
 
 void CGameContext::OnShutdown(void *pPersistentData)
@@ -4307,21 +4147,17 @@ void CGameContext::OnShutdown(void *pPersistentData)
 	if(m_TeeHistorianActive)
 	{
 		m_TeeHistorian.Finish();
-		aio_close(m_pTeeHistorianFile);
-		aio_wait(m_pTeeHistorianFile);
-		int Error = aio_error(m_pTeeHistorianFile);
+		int Error = m_TeeHistorianWriter.Close();
 		if(Error)
 		{
 			dbg_msg("teehistorian", "error closing file, err=%d", Error);
 			Server()->SetErrorShutdown("teehistorian close error");
 		}
-		aio_free(m_pTeeHistorianFile);
 	}
 
 	// Stop any demos being recorded.
 	Server()->StopDemos();
 
-	DeleteTempfile();
 	ConfigManager()->ResetGameSettings();
 	Collision()->Unload();
 	Layers()->Unload();
@@ -4393,11 +4229,18 @@ void CGameContext::OnSnap(int ClientId)
 	m_World.Snap(ClientId);
 	m_Events.Snap(ClientId);
 }
-void CGameContext::OnPreSnap() {}
+void CGameContext::OnPreSnap()
+{
+	m_SnapViews.Update(this);
+	m_World.PreSnap();
+	m_Events.PreSnap();
+}
+
 void CGameContext::OnPostSnap()
 {
 	m_World.PostSnap();
 	m_Events.Clear();
+	m_SnapViews.Clear();
 }
 
 void CGameContext::UpdatePlayerMaps()
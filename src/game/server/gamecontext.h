@@ -14,7 +14,10 @@
 
 #include "eventhandler.h"
 #include "gameworld.h"
+#include "snapviews.h"
 #include "teehistorian.h"
+#include "teehistorian_writer.h"
+#include "voteoptions.h"
 
 #include <memory>
 #include <string>
@@ -44,7 +47,6 @@
 class CCharacter;
 class IConfigManager;
 class CConfig;
-class CHeap;
 class CPlayer;
 class CScore;
 class CUnpacker;
@@ -89,7 +91,7 @@ class CGameContext : public IGameServer
 
 	bool m_TeeHistorianActive;
 	CTeeHistorian m_TeeHistorian;
-	ASYNCIO *m_pTeeHistorianFile;
+	CTeeHistorianWriter m_TeeHistorianWriter;
 	CUuid m_GameUuid;
 	CMapBugs m_MapBugs;
 	CPrng m_Prng;
@@ -97,7 +99,6 @@ class CGameContext : public IGameServer
 	bool m_Resetting;
 
 	static void CommandCallback(int ClientId, int FlagMask, const char *pCmd, IConsole::IResult *pResult, void *pUser);
-	static void TeeHistorianWrite(const void *pData, int DataSize, void *pUser);
 
 	static void ConTuneParam(IConsole::IResult *pResult, void *pUserData);
 	static void ConToggleTuneParam(IConsole::IResult *pResult, void *pUserData);
@@ -173,6 +174,8 @@ public:
 	void Clear();
 
 	CEventHandler m_Events;
+	// views of the clients, only while a snapshot is created
+	CSnapViews m_SnapViews;
 	CPlayer *m_apPlayers[MAX_CLIENTS];
 	// keep last input to always apply when none is sent
 	CNetObj_PlayerInput m_aLastPlayerInput[MAX_CLIENTS];
@@ -209,16 +212,12 @@ public:
 	char m_aSixupVoteDescription[VOTE_DESC_LENGTH];
 	char m_aVoteCommand[VOTE_CMD_LENGTH];
 	char m_aVoteReason[VOTE_REASON_LENGTH];
-	int m_NumVoteOptions;
 	int m_VoteEnforce;
 	char m_aaZoneEnterMsg[NUM_TUNEZONES][256]; // 0 is used for switching from or to area without tunings
 	char m_aaZoneLeaveMsg[NUM_TUNEZONES][256];
 
 	void CreateAllEntities(bool Initial);
 
-	char m_aDeleteTempfile[128];
-	void DeleteTempfile();
-
 	enum
 	{
 		VOTE_ENFORCE_UNKNOWN = 0,
@@ -229,9 +228,7 @@ public:
 		VOTE_ENFORCE_ABORT,
 		VOTE_ENFORCE_CANCEL,
 	};
-	CHeap *m_pVoteOptionHeap;
-	CVoteOptionServer *m_pVoteOptionFirst;
-	CVoteOptionServer *m_pVoteOptionLast;
+	CVoteOptions *m_pVoteOptions;
 
 	// helper functions
 	void CreateDamageInd(vec2 Pos, float AngleMod, int Amount, CClientMask Mask = CClientMask().set());
@@ -283,7 +280,7 @@ public:
 	void OnConsoleInit() override;
 	void RegisterDDRaceCommands();
 	void RegisterChatCommands();
-	void OnMapChange(char *pNewMapName, int MapNameSize) override;
+	bool OnMapChange(const char *pMapName, char *pNewMapName, int MapNameSize) override;
 	void OnShutdown(void *pPersistentData) override;
 
 	void OnTick() override;
@@ -7,6 +7,7 @@
 #include "gamecontext.h"
 #include "gamecontroller.h"
 
+#include <engine/engine.h>
 #include <engine/shared/config.h>
 
 #include <algorithm>
@@ -25,6 +26,10 @@ CGameWorld::CGameWorld()
 	m_ResetRequested = false;
 	for(auto &pFirstEntityType : m_apFirstEntityTypes)
 		pFirstEntityType = nullptr;
+
+	m_MeasureTickTime = false;
+	for(auto &TickTime : m_aTickTime)
+		TickTime = 0;
 }
 
 CGameWorld::~CGameWorld()
@@ -129,6 +134,19 @@ void CGameWorld::Snap(int SnappingClient)
 	}
 }
 
+void CGameWorld::PreSnap()
+{
+	const CSnapViews &Views = GameServer()->m_SnapViews;
+	for(auto *pEnt : m_apFirstEntityTypes)
+	{
+		for(; pEnt; pEnt = pEnt->m_pNextTypeEntity)
+		{
+			pEnt->m_NetworkVisibleMask = Views.VisibleMask(pEnt->m_Pos);
+			pEnt->PreSnap();
+		}
+	}
+}
+
 void CGameWorld::PostSnap()
 {
 	for(auto *pEnt : m_apFirstEntityTypes)
@@ -204,6 +222,61 @@ void CGameWorld::RemoveEntities()
 		}
 }
 
+// Moves the characters of each team on its own thread. Characters of
+// different teams can't collide, so the result is the same as ticking them
+// one after another. The events are created afterwards in the usual order.
+// Returns false if the teams can't be separated or there is only one.
+bool CGameWorld::TickDeferredCharactersParallel()
+{
+	const CTeamsCore &TeamsCore = GameServer()->m_pController->Teams().m_Core;
+	const int SuperTeam = TeamsCore.m_IsDDRace16 ? (int)VANILLA_TEAM_SUPER : (int)TEAM_SUPER;
+
+	CCharacter *apCharacters[MAX_CLIENTS];
+	int aTeam[MAX_CLIENTS];
+	int aTeamSize[NUM_DDRACE_TEAMS] = {0};
+	int NumCharacters = 0;
+	int NumTeams = 0;
+	for(CCharacter *pChr = (CCharacter *)FindFirst(ENTTYPE_CHARACTER); pChr; pChr = (CCharacter *)pChr->TypeNext())
+	{
+		// super characters collide with everyone
+		const int Team = pChr->Team();
+		if(pChr->IsSuper() || Team == SuperTeam || Team < 0 || Team >= NUM_DDRACE_TEAMS || NumCharacters == MAX_CLIENTS)
+			return false;
+		if(aTeamSize[Team]++ == 0)
+			NumTeams++;
+		apCharacters[NumCharacters] = pChr;
+		aTeam[NumCharacters] = Team;
+		NumCharacters++;
+	}
+	if(NumTeams < 2)
+		return false;
+
+	// sort the characters by team, keeping the world order within each team
+	int aTeamStart[NUM_DDRACE_TEAMS];
+	int aGroupStart[NUM_DDRACE_TEAMS + 1];
+	int NumGroups = 0;
+	int Start = 0;
+	for(int Team = 0; Team < NUM_DDRACE_TEAMS; Team++)
+	{
+		aTeamStart[Team] = Start;
+		if(aTeamSize[Team])
+			aGroupStart[NumGroups++] = Start;
+		Start += aTeamSize[Team];
+	}
+	aGroupStart[NumGroups] = Start;
+	CCharacter *apSorted[MAX_CLIENTS];
+	for(int i = 0; i < NumCharacters; i++)
+		apSorted[aTeamStart[aTeam[i]]++] = apCharacters[i];
+
+	GameServer()->Engine()->ParallelFor(NumGroups, 1, [&](int Begin, int End) {
+		for(int i = aGroupStart[Begin]; i < aGroupStart[End]; i++)
+			apSorted[i]->TickDeferredCore();
+	});
+	for(int i = 0; i < NumCharacters; i++)
+		apCharacters[i]->TickDeferredEvents();
+	return true;
+}
+
 void CGameWorld::Tick()
 {
 	if(m_ResetRequested)
@@ -214,6 +287,8 @@ void CGameWorld::Tick()
 		// update all objects
 		for(int i = 0; i < NUM_ENTTYPES; i++)
 		{
+			const int64_t StartTime = m_MeasureTickTime ? time_get() : 0;
+
 			// It's important to call PreTick() and Tick() after each other.
 			// If we call PreTick() before, and Tick() after other entities have been processed, it causes physics changes such as a stronger shotgun or grenade.
 			if(g_Config.m_SvNoWeakHook && i == ENTTYPE_CHARACTER)
@@ -234,15 +309,29 @@ void CGameWorld::Tick()
 				pEnt->Tick();
 				pEnt = m_pNextTraverseEntity;
 			}
+
+			if(m_MeasureTickTime)
+				m_aTickTime[i] += time_get() - StartTime;
 		}
 
-		for(auto *pEnt : m_apFirstEntityTypes)
-			for(; pEnt;)
+		for(int i = 0; i < NUM_ENTTYPES; i++)
+		{
+			const int64_t StartTime = m_MeasureTickTime ? time_get() : 0;
+
+			if(i != ENTTYPE_CHARACTER || !Config()->m_SvParallelTeams || !TickDeferredCharactersParallel())
 			{
-				m_pNextTraverseEntity = pEnt->m_pNextTypeEntity;
-				pEnt->TickDeferred();
-				pEnt = m_pNextTraverseEntity;
+				auto *pEnt = m_apFirstEntityTypes[i];
+				for(; pEnt;)
+				{
+					m_pNextTraverseEntity = pEnt->m_pNextTypeEntity;
+					pEnt->TickDeferred();
+					pEnt = m_pNextTraverseEntity;
+				}
 			}
+
+			if(m_MeasureTickTime)
+				m_aTickTime[i] += time_get() - StartTime;
+		}
 	}
 	else
 	{
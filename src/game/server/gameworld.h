@@ -33,6 +33,7 @@ public:
 private:
 	void Reset();
 	void RemoveEntities();
+	bool TickDeferredCharactersParallel();
 
 	CEntity *m_pNextTraverseEntity = nullptr;
 	CEntity *m_apFirstEntityTypes[NUM_ENTTYPES];
@@ -50,6 +51,11 @@ public:
 	bool m_Paused;
 	CWorldCore m_Core;
 
+	// time spent ticking the entities of each type, only measured with
+	// m_MeasureTickTime
+	bool m_MeasureTickTime;
+	int64_t m_aTickTime[NUM_ENTTYPES];
+
 	CGameWorld();
 	~CGameWorld();
 
@@ -155,6 +161,13 @@ public:
 	*/
 	void Snap(int SnappingClient);
 
+	/*
+		Function: PreSnap
+			Finds the clients that can see each entity, before
+			the clients receive their snapshot.
+	*/
+	void PreSnap();
+
 	/*
 		Function: PostSnap
 			Called after all clients received their snapshot.
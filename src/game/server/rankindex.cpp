@@ -0,0 +1,98 @@
+#include "rankindex.h"
+
+#include <base/math.h>
+#include <base/system.h>
+
+#include <algorithm>
+
+static bool CompareTime(const CRankIndex::CEntry &Entry, float Time)
+{
+	return Entry.m_Time < Time;
+}
+
+void CRankIndex::Load(std::vector<CEntry> &&vEntries)
+{
+	m_vEntries = std::move(vEntries);
+	std::stable_sort(m_vEntries.begin(), m_vEntries.end(), [](const CEntry &Lhs, const CEntry &Rhs) {
+		return Lhs.m_Time < Rhs.m_Time;
+	});
+	m_BestTimes.clear();
+	m_BestTimes.reserve(m_vEntries.size());
+	for(const CEntry &Entry : m_vEntries)
+		m_BestTimes.emplace(Entry.m_aName, Entry.m_Time);
+	m_Loaded = true;
+}
+
+void CRankIndex::Clear()
+{
+	m_vEntries.clear();
+	m_BestTimes.clear();
+	m_Loaded = false;
+}
+
+void CRankIndex::Update(const char *pName, float Time)
+{
+	auto It = m_BestTimes.find(pName);
+	if(It != m_BestTimes.end())
+	{
+		if(It->second <= Time)
+			return;
+		// remove the previous best time
+		auto EntryIt = std::lower_bound(m_vEntries.begin(), m_vEntries.end(), It->second, CompareTime);
+		while(EntryIt != m_vEntries.end() && str_comp(EntryIt->m_aName, pName) != 0)
+			++EntryIt;
+		dbg_assert(EntryIt != m_vEntries.end(), "rank index out of sync");
+		m_vEntries.erase(EntryIt);
+		It->second = Time;
+	}
+	else
+	{
+		m_BestTimes.emplace(pName, Time);
+	}
+
+	CEntry Entry;
+	Entry.m_Time = Time;
+	str_copy(Entry.m_aName, pName);
+	auto InsertIt = std::upper_bound(m_vEntries.begin(), m_vEntries.end(), Time, [](float Value, const CEntry &Other) {
+		return Value < Other.m_Time;
+	});
+	m_vEntries.insert(InsertIt, Entry);
+}
+
+int CRankIndex::RankOf(int Index) const
+{
+	auto It = std::lower_bound(m_vEntries.begin(), m_vEntries.begin() + Index, m_vEntries[Index].m_Time, CompareTime);
+	return (It - m_vEntries.begin()) + 1;
+}
+
+bool CRankIndex::Rank(const char *pName, int *pRank, float *pTime, float *pPercentRank) const
+{
+	auto It = m_BestTimes.find(pName);
+	if(It == m_BestTimes.end())
+		return false;
+	auto EntryIt = std::lower_bound(m_vEntries.begin(), m_vEntries.end(), It->second, CompareTime);
+	*pRank = (EntryIt - m_vEntries.begin()) + 1;
+	*pTime = It->second;
+	*pPercentRank = m_vEntries.size() > 1 ? (*pRank - 1) / (float)(m_vEntries.size() - 1) : 0.0f;
+	return true;
+}
+
+int CRankIndex::Top(int Offset, int Count, const CEntry **ppEntries, int *pRanks) const
+{
+	const int Start = maximum(absolute(Offset) - 1, 0);
+	const int Num = clamp((int)m_vEntries.size() - Start, 0, Count);
+	for(int i = 0; i < Num; i++)
+	{
+		const int Index = Offset >= 0 ? Start + i : (int)m_vEntries.size() - 1 - Start - i;
+		ppEntries[i] = &m_vEntries[Index];
+		pRanks[i] = RankOf(Index);
+	}
+	return Num;
+}
+
+float CRankIndex::RoundTime(float Time)
+{
+	char aBuf[32];
+	str_format(aBuf, sizeof(aBuf), "%.2f", Time);
+	return str_tofloat(aBuf);
+}
@@ -0,0 +1,53 @@
+#ifndef GAME_SERVER_RANKINDEX_H
+#define GAME_SERVER_RANKINDEX_H
+
+#include <engine/shared/protocol.h>
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Best time of every player on the current map sorted by time, used to
+// answer global rank and top queries without the database. The database
+// stays the source of truth, the index is loaded from it and only updated
+// with finishes of this server in between.
+class CRankIndex
+{
+public:
+	struct CEntry
+	{
+		float m_Time;
+		char m_aName[MAX_NAME_LENGTH];
+	};
+
+	// takes the best time of each player, in any order
+	void Load(std::vector<CEntry> &&vEntries);
+	void Clear();
+	bool Loaded() const { return m_Loaded; }
+	int NumRanked() const { return m_vEntries.size(); }
+
+	// updates the best time of the player, if Time improves it
+	void Update(const char *pName, float Time);
+
+	// same as RANK() and PERCENT_RANK() ordered by the best time,
+	// returns false if the player has no finish
+	bool Rank(const char *pName, int *pRank, float *pTime, float *pPercentRank) const;
+
+	// fills up to Count entries starting with the rank Offset like the /top5
+	// command, a negative Offset counts from the slowest player, returns the
+	// number of entries
+	int Top(int Offset, int Count, const CEntry **ppEntries, int *pRanks) const;
+
+	// rounds a time the same way it is stored by the database
+	static float RoundTime(float Time);
+
+private:
+	// rank of the entry at index i, equal times share the rank
+	int RankOf(int Index) const;
+
+	bool m_Loaded = false;
+	std::vector<CEntry> m_vEntries;
+	std::unordered_map<std::string, float> m_BestTimes;
+};
+
+#endif // GAME_SERVER_RANKINDEX_H
@@ -36,13 +36,68 @@ void CScore::ExecPlayerThread(
 	if(pResult == nullptr)
 		return;
 	auto Tmp = std::make_unique<CSqlPlayerRequest>(pResult);
-	str_copy(Tmp->m_aName, pName, sizeof(Tmp->m_aName));
+	FillPlayerRequest(Tmp.get(), ClientId, pName, Offset);
+
+	m_pPool->Execute(pFuncPtr, std::move(Tmp), pThreadName);
+}
+
+void CScore::FillPlayerRequest(CSqlPlayerRequest *pRequest, int ClientId, const char *pName, int Offset)
+{
+	str_copy(pRequest->m_aName, pName, sizeof(pRequest->m_aName));
+	str_copy(pRequest->m_aMap, Server()->GetMapName(), sizeof(pRequest->m_aMap));
+	str_copy(pRequest->m_aServer, g_Config.m_SvSqlServerName, sizeof(pRequest->m_aServer));
+	str_copy(pRequest->m_aRequestingPlayer, Server()->ClientName(ClientId), sizeof(pRequest->m_aRequestingPlayer));
+	pRequest->m_Offset = Offset;
+}
+
+void CScore::LoadRankIndex()
+{
+	if(m_pRankIndexResult != nullptr)
+		return; // already in progress
+
+	m_pRankIndexResult = std::make_shared<CScoreRankIndexResult>();
+	m_vPendingRankUpdates.clear();
+	m_RankIndexLoadTick = Server()->Tick();
+
+	auto Tmp = std::make_unique<CSqlRankIndexRequest>(m_pRankIndexResult);
 	str_copy(Tmp->m_aMap, Server()->GetMapName(), sizeof(Tmp->m_aMap));
 	str_copy(Tmp->m_aServer, g_Config.m_SvSqlServerName, sizeof(Tmp->m_aServer));
-	str_copy(Tmp->m_aRequestingPlayer, Server()->ClientName(ClientId), sizeof(Tmp->m_aRequestingPlayer));
-	Tmp->m_Offset = Offset;
+	m_pPool->Execute(CScoreWorker::LoadRankIndex, std::move(Tmp), "load rank index");
+}
 
-	m_pPool->Execute(pFuncPtr, std::move(Tmp), pThreadName);
+bool CScore::RankIndexReady()
+{
+	if(!g_Config.m_SvRankIndex)
+	{
+		m_GlobalRankIndex.Clear();
+		m_RegionalRankIndex.Clear();
+		return false;
+	}
+
+	if(m_pRankIndexResult != nullptr && m_pRankIndexResult->m_Completed)
+	{
+		if(m_pRankIndexResult->m_Success)
+		{
+			m_GlobalRankIndex.Load(std::move(m_pRankIndexResult->m_vGlobal));
+			m_RegionalRankIndex.Load(std::move(m_pRankIndexResult->m_vRegional));
+			for(const auto &[Name, Time] : m_vPendingRankUpdates)
+			{
+				m_GlobalRankIndex.Update(Name.c_str(), Time);
+				m_RegionalRankIndex.Update(Name.c_str(), Time);
+			}
+		}
+		m_vPendingRankUpdates.clear();
+		m_pRankIndexResult = nullptr;
+	}
+
+	if(m_pRankIndexResult == nullptr &&
+		(!m_GlobalRankIndex.Loaded() ||
+			(g_Config.m_SvRankIndexRefresh > 0 && Server()->Tick() > m_RankIndexLoadTick + (int64_t)g_Config.m_SvRankIndexRefresh * 60 * Server()->TickSpeed())))
+	{
+		// keep answering from the old index until the new one is loaded
+		LoadRankIndex();
+	}
+	return m_GlobalRankIndex.Loaded();
 }
 
 bool CScore::RateLimitPlayer(int ClientId)
@@ -74,6 +129,8 @@ CScore::CScore(CGameContext *pGameServer, CDbConnectionPool *pPool) :
 	m_pServer(pGameServer->Server())
 {
 	LoadBestTime();
+	if(g_Config.m_SvRankIndex)
+		LoadRankIndex();
 
 	uint64_t aSeed[2];
 	secure_random_fill(aSeed, sizeof(aSeed));
@@ -163,6 +220,15 @@ void CScore::SaveScore(int ClientId, int TimeTicks, const char *pTimestamp, cons
 	for(int i = 0; i < NUM_CHECKPOINTS; i++)
 		Tmp->m_aCurrentTimeCp[i] = aTimeCp[i];
 
+	const float RankTime = CRankIndex::RoundTime(Tmp->m_Time);
+	if(m_GlobalRankIndex.Loaded())
+	{
+		m_GlobalRankIndex.Update(Tmp->m_aName, RankTime);
+		m_RegionalRankIndex.Update(Tmp->m_aName, RankTime);
+	}
+	if(m_pRankIndexResult != nullptr)
+		m_vPendingRankUpdates.emplace_back(Tmp->m_aName, RankTime);
+
 	m_pPool->ExecuteWrite(CScoreWorker::SaveScore, std::move(Tmp), "save score");
 }
 
@@ -196,7 +262,39 @@ void CScore::ShowRank(int ClientId, const char *pName)
 {
 	if(RateLimitPlayer(ClientId))
 		return;
-	ExecPlayerThread(CScoreWorker::ShowRank, "show rank", ClientId, pName, 0);
+	if(!RankIndexReady())
+	{
+		ExecPlayerThread(CScoreWorker::ShowRank, "show rank", ClientId, pName, 0);
+		return;
+	}
+
+	auto pResult = NewSqlPlayerResult(ClientId);
+	if(pResult == nullptr)
+		return;
+	CSqlPlayerRequest Request(pResult);
+	FillPlayerRequest(&Request, ClientId, pName, 0);
+
+	int Rank;
+	float Time;
+	float PercentRank;
+	if(m_GlobalRankIndex.Rank(Request.m_aName, &Rank, &Time, &PercentRank))
+	{
+		char aRegionalRank[16];
+		int RegionalRank;
+		float RegionalTime;
+		float RegionalPercentRank;
+		if(m_RegionalRankIndex.Rank(Request.m_aName, &RegionalRank, &RegionalTime, &RegionalPercentRank))
+			str_format(aRegionalRank, sizeof(aRegionalRank), "rank %d", RegionalRank);
+		else
+			str_copy(aRegionalRank, "unranked");
+		CScoreWorker::FormatRank(pResult.get(), &Request, Rank, Time, PercentRank, aRegionalRank);
+	}
+	else
+	{
+		CScoreWorker::FormatNotRanked(pResult.get(), &Request);
+	}
+	pResult->m_Success = true;
+	pResult->m_Completed.store(true);
 }
 
 void CScore::ShowTeamRank(int ClientId, const char *pName)
@@ -210,7 +308,41 @@ void CScore::ShowTop(int ClientId, int Offset)
 {
 	if(RateLimitPlayer(ClientId))
 		return;
-	ExecPlayerThread(CScoreWorker::ShowTop, "show top5", ClientId, "", Offset);
+	if(!RankIndexReady())
+	{
+		ExecPlayerThread(CScoreWorker::ShowTop, "show top5", ClientId, "", Offset);
+		return;
+	}
+
+	auto pResult = NewSqlPlayerResult(ClientId);
+	if(pResult == nullptr)
+		return;
+	auto *paMessages = pResult->m_Data.m_aaMessages;
+	const CRankIndex::CEntry *apEntries[5];
+	int aRanks[5];
+
+	int Line = 0;
+	str_copy(paMessages[Line++], "------------ Global Top ------------", sizeof(paMessages[0]));
+	int Num = m_GlobalRankIndex.Top(Offset, 5, apEntries, aRanks);
+	for(int i = 0; i < Num; i++)
+		CScoreWorker::FormatTopLine(paMessages[Line++], sizeof(paMessages[0]), aRanks[i], apEntries[i]->m_aName, apEntries[i]->m_Time);
+
+	if(!g_Config.m_SvRegionalRankings)
+	{
+		str_copy(paMessages[Line], "-----------------------------------------", sizeof(paMessages[0]));
+	}
+	else
+	{
+		// truncated like the server of database requests
+		char aServer[5];
+		str_copy(aServer, g_Config.m_SvSqlServerName);
+		str_format(paMessages[Line++], sizeof(paMessages[0]), "------------ %s Top ------------", aServer);
+		Num = m_RegionalRankIndex.Top(Offset, 3, apEntries, aRanks);
+		for(int i = 0; i < Num; i++)
+			CScoreWorker::FormatTopLine(paMessages[Line++], sizeof(paMessages[0]), aRanks[i], apEntries[i]->m_aName, apEntries[i]->m_Time);
+	}
+	pResult->m_Success = true;
+	pResult->m_Completed.store(true);
 }
 
 void CScore::ShowTeamTop5(int ClientId, int Offset)
@@ -25,8 +25,21 @@ class CScore
 	CPrng m_Prng;
 	void GeneratePassphrase(char *pBuf, int BufSize);
 
+	// best times on the current map, see CRankIndex
+	CRankIndex m_GlobalRankIndex;
+	CRankIndex m_RegionalRankIndex;
+	std::shared_ptr<CScoreRankIndexResult> m_pRankIndexResult;
+	// finishes of this server while the index is loading, applied afterwards
+	std::vector<std::pair<std::string, float>> m_vPendingRankUpdates;
+	int64_t m_RankIndexLoadTick = 0;
+	void LoadRankIndex();
+	// takes a completed load and starts a refresh if due, returns true if
+	// queries can be answered from the index
+	bool RankIndexReady();
+
 	// returns new SqlResult bound to the player, if no current Thread is active for this player
 	std::shared_ptr<CScorePlayerResult> NewSqlPlayerResult(int ClientId);
+	void FillPlayerRequest(CSqlPlayerRequest *pRequest, int ClientId, const char *pName, int Offset);
 	// Creates for player database requests
 	void ExecPlayerThread(
 		bool (*pFuncPtr)(IDbConnection *, const ISqlData *, char *pError, int ErrorSize),
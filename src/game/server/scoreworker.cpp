@@ -8,6 +8,7 @@
 #include <engine/shared/config.h>
 
 #include <cmath>
+#include <unordered_map>
 
 // "6b407e81-8b77-3e04-a207-8da17f37d000"
 // "save-no-save-id@ddnet.tw"
@@ -170,6 +171,49 @@ bool CScoreWorker::LoadBestTime(IDbConnection *pSqlServer, const ISqlData *pGame
 	return true;
 }
 
+bool CScoreWorker::LoadRankIndex(IDbConnection *pSqlServer, const ISqlData *pGameData, char *pError, int ErrorSize)
+{
+	const auto *pData = dynamic_cast<const CSqlRankIndexRequest *>(pGameData);
+	auto *pResult = dynamic_cast<CScoreRankIndexResult *>(pGameData->m_pResult.get());
+
+	char aBuf[512];
+	str_format(aBuf, sizeof(aBuf),
+		"SELECT Name, Server, MIN(Time) AS Time FROM %s_race WHERE Map = ? GROUP BY Name, Server",
+		pSqlServer->GetPrefix());
+	if(!pSqlServer->PrepareStatement(aBuf, pError, ErrorSize))
+	{
+		return false;
+	}
+	pSqlServer->BindString(1, pData->m_aMap);
+
+	// index into the result vectors by name
+	std::unordered_map<std::string, size_t> GlobalIndex;
+	std::unordered_map<std::string, size_t> RegionalIndex;
+	auto AddBest = [](std::vector<CRankIndex::CEntry> &vEntries, std::unordered_map<std::string, size_t> &Index, const CRankIndex::CEntry &Entry) {
+		auto [It, Inserted] = Index.emplace(Entry.m_aName, vEntries.size());
+		if(Inserted)
+			vEntries.push_back(Entry);
+		else if(Entry.m_Time < vEntries[It->second].m_Time)
+			vEntries[It->second].m_Time = Entry.m_Time;
+	};
+
+	bool End;
+	while(pSqlServer->Step(&End, pError, ErrorSize) && !End)
+	{
+		CRankIndex::CEntry Entry;
+		pSqlServer->GetString(1, Entry.m_aName, sizeof(Entry.m_aName));
+		char aServer[5] = "";
+		if(!pSqlServer->IsNull(2))
+			pSqlServer->GetString(2, aServer, sizeof(aServer));
+		Entry.m_Time = pSqlServer->GetFloat(3);
+		AddBest(pResult->m_vGlobal, GlobalIndex, Entry);
+		// same as `Server LIKE %<server>%`
+		if(str_find_nocase(aServer, pData->m_aServer))
+			AddBest(pResult->m_vRegional, RegionalIndex, Entry);
+	}
+	return End;
+}
+
 // update stuff
 bool CScoreWorker::LoadPlayerData(IDbConnection *pSqlServer, const ISqlData *pGameData, char *pError, int ErrorSize)
 {
@@ -881,52 +925,68 @@ bool CScoreWorker::ShowRank(IDbConnection *pSqlServer, const ISqlData *pGameData
 
 	if(!End)
 	{
-		int Rank = pSqlServer->GetInt(1);
-		float Time = pSqlServer->GetFloat(2);
-		// CEIL and FLOOR are not supported in SQLite
-		int BetterThanPercent = std::floor(100.0f - 100.0f * pSqlServer->GetFloat(3));
-		str_time_float(Time, TIME_HOURS_CENTISECS, aBuf, sizeof(aBuf));
-		if(g_Config.m_SvHideScore)
+		FormatRank(pResult, pData, pSqlServer->GetInt(1), pSqlServer->GetFloat(2), pSqlServer->GetFloat(3), aRegionalRank);
+	}
+	else
+	{
+		FormatNotRanked(pResult, pData);
+	}
+	return true;
+}
+
+void CScoreWorker::FormatRank(CScorePlayerResult *pResult, const CSqlPlayerRequest *pData, int Rank, float Time, float PercentRank, const char *pRegionalRank)
+{
+	char aBuf[64];
+	// CEIL and FLOOR are not supported in SQLite
+	int BetterThanPercent = std::floor(100.0f - 100.0f * PercentRank);
+	str_time_float(Time, TIME_HOURS_CENTISECS, aBuf, sizeof(aBuf));
+	if(g_Config.m_SvHideScore)
+	{
+		str_format(pResult->m_Data.m_aaMessages[0], sizeof(pResult->m_Data.m_aaMessages[0]),
+			"Your time: %s, better than %d%%", aBuf, BetterThanPercent);
+	}
+	else
+	{
+		pResult->m_MessageKind = CScorePlayerResult::ALL;
+
+		if(str_comp_nocase(pData->m_aRequestingPlayer, pData->m_aName) == 0)
 		{
 			str_format(pResult->m_Data.m_aaMessages[0], sizeof(pResult->m_Data.m_aaMessages[0]),
-				"Your time: %s, better than %d%%", aBuf, BetterThanPercent);
+				"%s - %s - better than %d%%",
+				pData->m_aName, aBuf, BetterThanPercent);
 		}
 		else
 		{
-			pResult->m_MessageKind = CScorePlayerResult::ALL;
-
-			if(str_comp_nocase(pData->m_aRequestingPlayer, pData->m_aName) == 0)
-			{
-				str_format(pResult->m_Data.m_aaMessages[0], sizeof(pResult->m_Data.m_aaMessages[0]),
-					"%s - %s - better than %d%%",
-					pData->m_aName, aBuf, BetterThanPercent);
-			}
-			else
-			{
-				str_format(pResult->m_Data.m_aaMessages[0], sizeof(pResult->m_Data.m_aaMessages[0]),
-					"%s - %s - better than %d%% - requested by %s",
-					pData->m_aName, aBuf, BetterThanPercent, pData->m_aRequestingPlayer);
-			}
+			str_format(pResult->m_Data.m_aaMessages[0], sizeof(pResult->m_Data.m_aaMessages[0]),
+				"%s - %s - better than %d%% - requested by %s",
+				pData->m_aName, aBuf, BetterThanPercent, pData->m_aRequestingPlayer);
+		}
 
-			if(g_Config.m_SvRegionalRankings)
-			{
-				str_format(pResult->m_Data.m_aaMessages[1], sizeof(pResult->m_Data.m_aaMessages[1]),
-					"Global rank %d - %s %s",
-					Rank, pData->m_aServer, aRegionalRank);
-			}
-			else
-			{
-				str_format(pResult->m_Data.m_aaMessages[1], sizeof(pResult->m_Data.m_aaMessages[1]),
-					"Global rank %d", Rank);
-			}
+		if(g_Config.m_SvRegionalRankings)
+		{
+			str_format(pResult->m_Data.m_aaMessages[1], sizeof(pResult->m_Data.m_aaMessages[1]),
+				"Global rank %d - %s %s",
+				Rank, pData->m_aServer, pRegionalRank);
+		}
+		else
+		{
+			str_format(pResult->m_Data.m_aaMessages[1], sizeof(pResult->m_Data.m_aaMessages[1]),
+				"Global rank %d", Rank);
 		}
 	}
-	else
-	{
-		str_format(pResult->m_Data.m_aaMessages[0], sizeof(pResult->m_Data.m_aaMessages[0]),
-			"%s is not ranked", pData->m_aName);
-	}
-	return true;
+}
+
+void CScoreWorker::FormatNotRanked(CScorePlayerResult *pResult, const CSqlPlayerRequest *pData)
+{
+	str_format(pResult->m_Data.m_aaMessages[0], sizeof(pResult->m_Data.m_aaMessages[0]),
+		"%s is not ranked", pData->m_aName);
+}
+
+void CScoreWorker::FormatTopLine(char *pBuf, int BufferSize, int Rank, const char *pName, float Time)
+{
+	char aTime[32];
+	str_time_float(Time, TIME_HOURS_CENTISECS, aTime, sizeof(aTime));
+	str_format(pBuf, BufferSize, "%d. %s Time: %s", Rank, pName, aTime);
 }
 
 bool CScoreWorker::ShowTeamRank(IDbConnection *pSqlServer, const ISqlData *pGameData, char *pError, int ErrorSize)
@@ -1052,18 +1112,14 @@ bool CScoreWorker::ShowTop(IDbConnection *pSqlServer, const ISqlData *pGameData,
 	str_copy(pResult->m_Data.m_aaMessages[Line], "------------ Global Top ------------", sizeof(pResult->m_Data.m_aaMessages[Line]));
 	Line++;
 
-	char aTime[32];
 	bool End = false;
 
 	while(pSqlServer->Step(&End, pError, ErrorSize) && !End)
 	{
 		char aName[MAX_NAME_LENGTH];
 		pSqlServer->GetString(1, aName, sizeof(aName));
-		float Time = pSqlServer->GetFloat(2);
-		str_time_float(Time, TIME_HOURS_CENTISECS, aTime, sizeof(aTime));
-		int Rank = pSqlServer->GetInt(3);
-		str_format(pResult->m_Data.m_aaMessages[Line], sizeof(pResult->m_Data.m_aaMessages[Line]),
-			"%d. %s Time: %s", Rank, aName, aTime);
+		FormatTopLine(pResult->m_Data.m_aaMessages[Line], sizeof(pResult->m_Data.m_aaMessages[Line]),
+			pSqlServer->GetInt(3), aName, pSqlServer->GetFloat(2));
 
 		Line++;
 	}
@@ -1094,11 +1150,8 @@ bool CScoreWorker::ShowTop(IDbConnection *pSqlServer, const ISqlData *pGameData,
 	{
 		char aName[MAX_NAME_LENGTH];
 		pSqlServer->GetString(1, aName, sizeof(aName));
-		float Time = pSqlServer->GetFloat(2);
-		str_time_float(Time, TIME_HOURS_CENTISECS, aTime, sizeof(aTime));
-		int Rank = pSqlServer->GetInt(3);
-		str_format(pResult->m_Data.m_aaMessages[Line], sizeof(pResult->m_Data.m_aaMessages[Line]),
-			"%d. %s Time: %s", Rank, aName, aTime);
+		FormatTopLine(pResult->m_Data.m_aaMessages[Line], sizeof(pResult->m_Data.m_aaMessages[Line]),
+			pSqlServer->GetInt(3), aName, pSqlServer->GetFloat(2));
 		Line++;
 	}
 
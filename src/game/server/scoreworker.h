@@ -11,6 +11,7 @@
 #include <engine/server/databases/connection_pool.h>
 #include <engine/shared/protocol.h>
 #include <engine/shared/uuid_manager.h>
+#include <game/server/rankindex.h>
 #include <game/server/save.h>
 #include <game/voting.h>
 
@@ -83,6 +84,26 @@ struct CSqlLoadBestTimeRequest : ISqlData
 	char m_aMap[MAX_MAP_LENGTH];
 };
 
+struct CScoreRankIndexResult : ISqlResult
+{
+	// best time of every player on the map
+	std::vector<CRankIndex::CEntry> m_vGlobal;
+	// best time of every player on the map on servers of the requested region
+	std::vector<CRankIndex::CEntry> m_vRegional;
+};
+
+struct CSqlRankIndexRequest : ISqlData
+{
+	CSqlRankIndexRequest(std::shared_ptr<CScoreRankIndexResult> pResult) :
+		ISqlData(std::move(pResult))
+	{
+	}
+
+	// current map
+	char m_aMap[MAX_MAP_LENGTH];
+	char m_aServer[5];
+};
+
 struct CSqlPlayerRequest : ISqlData
 {
 	CSqlPlayerRequest(std::shared_ptr<CScorePlayerResult> pResult) :
@@ -287,6 +308,7 @@ struct CTeamrank
 struct CScoreWorker
 {
 	static bool LoadBestTime(IDbConnection *pSqlServer, const ISqlData *pGameData, char *pError, int ErrorSize);
+	static bool LoadRankIndex(IDbConnection *pSqlServer, const ISqlData *pGameData, char *pError, int ErrorSize);
 
 	static bool RandomMap(IDbConnection *pSqlServer, const ISqlData *pGameData, char *pError, int ErrorSize);
 	static bool RandomUnfinishedMap(IDbConnection *pSqlServer, const ISqlData *pGameData, char *pError, int ErrorSize);
@@ -310,6 +332,11 @@ struct CScoreWorker
 
 	static bool SaveScore(IDbConnection *pSqlServer, const ISqlData *pGameData, Write w, char *pError, int ErrorSize);
 	static bool SaveTeamScore(IDbConnection *pSqlServer, const ISqlData *pGameData, Write w, char *pError, int ErrorSize);
+
+	// shared with answering from the rank index
+	static void FormatRank(CScorePlayerResult *pResult, const CSqlPlayerRequest *pData, int Rank, float Time, float PercentRank, const char *pRegionalRank);
+	static void FormatNotRanked(CScorePlayerResult *pResult, const CSqlPlayerRequest *pData);
+	static void FormatTopLine(char *pBuf, int BufferSize, int Rank, const char *pName, float Time);
 };
 
 #endif // GAME_SERVER_SCOREWORKER_H
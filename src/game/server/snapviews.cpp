@@ -0,0 +1,149 @@
+#include "snapviews.h"
+
+#include "gamecontext.h"
+#include "player.h"
+
+#include <base/math.h>
+
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define SNAPVIEWS_SSE2 1
+#endif
+
+static_assert(MAX_CLIENTS % 64 == 0);
+
+static CClientMask MaskFromWords(const uint64_t *pWords)
+{
+	CClientMask Mask;
+	for(int i = MAX_CLIENTS / 64 - 1; i >= 0; i--)
+	{
+		Mask <<= 64;
+		Mask |= CClientMask(pWords[i]);
+	}
+	return Mask;
+}
+
+void CSnapViews::Update(const CGameContext *pGameServer)
+{
+	Clear();
+	for(int ClientId = 0; ClientId < MAX_CLIENTS; ClientId++)
+	{
+		const CPlayer *pPlayer = pGameServer->m_apPlayers[ClientId];
+		if(pPlayer)
+		{
+			// clients over their snapshot budget only get what is close to them
+			const float Scale = pGameServer->Server()->SnapViewScale(ClientId);
+			SetView(ClientId, pPlayer->m_ViewPos, pPlayer->m_ShowDistance * Scale, pPlayer->m_ShowAll);
+		}
+	}
+	m_Active = true;
+}
+
+void CSnapViews::Clear()
+{
+	m_Active = false;
+	m_NumViews = 0;
+	for(int i = 0; i < MAX_CLIENTS; i++)
+	{
+		m_aViewX[i] = 0.0f;
+		m_aViewY[i] = 0.0f;
+		m_aShowX[i] = -1.0f;
+		m_aShowY[i] = -1.0f;
+		m_aShowLine[i] = -1.0f;
+	}
+}
+
+void CSnapViews::SetView(int ClientId, vec2 ViewPos, vec2 ShowDistance, bool ShowAll)
+{
+	m_aViewX[ClientId] = ViewPos.x;
+	m_aViewY[ClientId] = ViewPos.y;
+	m_aShowX[ClientId] = ShowAll ? INFINITY : ShowDistance.x;
+	m_aShowY[ClientId] = ShowAll ? INFINITY : ShowDistance.y;
+	m_aShowLine[ClientId] = ShowAll ? INFINITY : maximum(ShowDistance.x, ShowDistance.y);
+	m_NumViews = maximum(m_NumViews, (ClientId + LANES) / LANES * LANES);
+}
+
+bool CSnapViews::Clipped(int ClientId, vec2 CheckPos) const
+{
+	return absolute(m_aViewX[ClientId] - CheckPos.x) > m_aShowX[ClientId] ||
+	       absolute(m_aViewY[ClientId] - CheckPos.y) > m_aShowY[ClientId];
+}
+
+bool CSnapViews::ClippedLine(int ClientId, vec2 StartPos, vec2 EndPos) const
+{
+	const vec2 ViewPos = vec2(m_aViewX[ClientId], m_aViewY[ClientId]);
+	vec2 DistanceToLine, ClosestPoint;
+	if(closest_point_on_line(StartPos, EndPos, ViewPos, ClosestPoint))
+		DistanceToLine = ViewPos - ClosestPoint;
+	else
+		DistanceToLine = ViewPos - StartPos;
+	return absolute(DistanceToLine.x) > m_aShowLine[ClientId] || absolute(DistanceToLine.y) > m_aShowLine[ClientId];
+}
+
+CClientMask CSnapViews::VisibleMask(vec2 CheckPos) const
+{
+	uint64_t aWords[MAX_CLIENTS / 64] = {0};
+#if defined(SNAPVIEWS_SSE2)
+	const __m128 AbsMask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+	const __m128 X = _mm_set1_ps(CheckPos.x);
+	const __m128 Y = _mm_set1_ps(CheckPos.y);
+	for(int i = 0; i < m_NumViews; i += LANES)
+	{
+		const __m128 Dx = _mm_and_ps(_mm_sub_ps(_mm_load_ps(&m_aViewX[i]), X), AbsMask);
+		const __m128 Dy = _mm_and_ps(_mm_sub_ps(_mm_load_ps(&m_aViewY[i]), Y), AbsMask);
+		const __m128 Clip = _mm_or_ps(_mm_cmpgt_ps(Dx, _mm_load_ps(&m_aShowX[i])), _mm_cmpgt_ps(Dy, _mm_load_ps(&m_aShowY[i])));
+		aWords[i / 64] |= (uint64_t)(~_mm_movemask_ps(Clip) & 0xf) << (i % 64);
+	}
+#else
+	for(int i = 0; i < m_NumViews; i++)
+		if(!Clipped(i, CheckPos))
+			aWords[i / 64] |= (uint64_t)1 << (i % 64);
+#endif
+	return MaskFromWords(aWords);
+}
+
+CClientMask CSnapViews::VisibleLineMask(vec2 StartPos, vec2 EndPos) const
+{
+	uint64_t aWords[MAX_CLIENTS / 64] = {0};
+	const vec2 AB = EndPos - StartPos;
+	const float SquaredMagnitudeAB = dot(AB, AB);
+	if(!(SquaredMagnitudeAB > 0))
+	{
+		// the line is a point, tested with the line distance
+		for(int i = 0; i < m_NumViews; i++)
+			if(!ClippedLine(i, StartPos, EndPos))
+				aWords[i / 64] |= (uint64_t)1 << (i % 64);
+		return MaskFromWords(aWords);
+	}
+
+#if defined(SNAPVIEWS_SSE2)
+	// same operations as closest_point_on_line for four views at once
+	const __m128 AbsMask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+	const __m128 StartX = _mm_set1_ps(StartPos.x);
+	const __m128 StartY = _mm_set1_ps(StartPos.y);
+	const __m128 ABx = _mm_set1_ps(AB.x);
+	const __m128 ABy = _mm_set1_ps(AB.y);
+	const __m128 Magnitude = _mm_set1_ps(SquaredMagnitudeAB);
+	const __m128 Zero = _mm_setzero_ps();
+	const __m128 One = _mm_set1_ps(1.0f);
+	for(int i = 0; i < m_NumViews; i += LANES)
+	{
+		const __m128 ViewX = _mm_load_ps(&m_aViewX[i]);
+		const __m128 ViewY = _mm_load_ps(&m_aViewY[i]);
+		const __m128 APdotAB = _mm_add_ps(_mm_mul_ps(_mm_sub_ps(ViewX, StartX), ABx), _mm_mul_ps(_mm_sub_ps(ViewY, StartY), ABy));
+		const __m128 T = _mm_min_ps(One, _mm_max_ps(Zero, _mm_div_ps(APdotAB, Magnitude)));
+		const __m128 Dx = _mm_and_ps(_mm_sub_ps(ViewX, _mm_add_ps(StartX, _mm_mul_ps(ABx, T))), AbsMask);
+		const __m128 Dy = _mm_and_ps(_mm_sub_ps(ViewY, _mm_add_ps(StartY, _mm_mul_ps(ABy, T))), AbsMask);
+		const __m128 Show = _mm_load_ps(&m_aShowLine[i]);
+		const __m128 Clip = _mm_or_ps(_mm_cmpgt_ps(Dx, Show), _mm_cmpgt_ps(Dy, Show));
+		aWords[i / 64] |= (uint64_t)(~_mm_movemask_ps(Clip) & 0xf) << (i % 64);
+	}
+#else
+	for(int i = 0; i < m_NumViews; i++)
+		if(!ClippedLine(i, StartPos, EndPos))
+			aWords[i / 64] |= (uint64_t)1 << (i % 64);
+#endif
+	return MaskFromWords(aWords);
+}
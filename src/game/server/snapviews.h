@@ -0,0 +1,60 @@
+#ifndef GAME_SERVER_SNAPVIEWS_H
+#define GAME_SERVER_SNAPVIEWS_H
+
+#include <base/vmath.h>
+
+#include <engine/shared/protocol.h>
+
+class CGameContext;
+
+/**
+ * The views of all clients while a snapshot is created, stored as arrays so
+ * that a position or a line can be tested against all views at once.
+ *
+ * The results are the same as the checks of `NetworkClipped` and
+ * `NetworkClippedLine` for each client, except that the views of clients
+ * over their snapshot budget are shrunk by `IServer::SnapViewScale`.
+ */
+class CSnapViews
+{
+public:
+	/**
+	 * Takes the views of all players, used until `Clear` is called.
+	 */
+	void Update(const CGameContext *pGameServer);
+	void Clear();
+	bool Active() const { return m_Active; }
+
+	void SetView(int ClientId, vec2 ViewPos, vec2 ShowDistance, bool ShowAll);
+
+	bool Clipped(int ClientId, vec2 CheckPos) const;
+	bool ClippedLine(int ClientId, vec2 StartPos, vec2 EndPos) const;
+
+	/**
+	 * Returns the clients that the position is not clipped for.
+	 */
+	CClientMask VisibleMask(vec2 CheckPos) const;
+	/**
+	 * Returns the clients that the line is not clipped for.
+	 */
+	CClientMask VisibleLineMask(vec2 StartPos, vec2 EndPos) const;
+
+private:
+	enum
+	{
+		LANES = 4,
+	};
+
+	bool m_Active = false;
+	// views up to the highest client with a view, rounded up to whole lanes
+	int m_NumViews = 0;
+	alignas(16) float m_aViewX[MAX_CLIENTS];
+	alignas(16) float m_aViewY[MAX_CLIENTS];
+	// infinite for clients that see everything, negative without a view
+	alignas(16) float m_aShowX[MAX_CLIENTS];
+	alignas(16) float m_aShowY[MAX_CLIENTS];
+	// the distance used for lines, maximum of both show distances
+	alignas(16) float m_aShowLine[MAX_CLIENTS];
+};
+
+#endif
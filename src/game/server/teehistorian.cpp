@@ -6,6 +6,7 @@
 #include <engine/shared/json.h>
 #include <engine/shared/packer.h>
 #include <engine/shared/snapshot.h>
+#include <engine/shared/teehistorian_ex.h>
 
 #include <game/gamecore.h>
 
@@ -30,22 +31,6 @@ static const char TEEHISTORIAN_VERSION_MINOR[] = "9";
 #include <engine/shared/teehistorian_ex_chunks.h>
 #undef UUID
 
-enum
-{
-	TEEHISTORIAN_NONE,
-	TEEHISTORIAN_FINISH,
-	TEEHISTORIAN_TICK_SKIP,
-	TEEHISTORIAN_PLAYER_NEW,
-	TEEHISTORIAN_PLAYER_OLD,
-	TEEHISTORIAN_INPUT_DIFF,
-	TEEHISTORIAN_INPUT_NEW,
-	TEEHISTORIAN_MESSAGE,
-	TEEHISTORIAN_JOIN,
-	TEEHISTORIAN_DROP,
-	TEEHISTORIAN_CONSOLE_COMMAND,
-	TEEHISTORIAN_EX,
-};
-
 CTeeHistorian::CTeeHistorian()
 {
 	m_State = STATE_START;
@@ -80,6 +65,7 @@ void CTeeHistorian::Reset(const CGameInfo *pGameInfo, WRITE_CALLBACK pfnWriteCal
 	m_pfnWriteCallback = pfnWriteCallback;
 	m_pWriteCallbackUserdata = pUser;
 
+	m_vTickBuffer.clear();
 	WriteHeader(pGameInfo);
 
 	m_State = STATE_START;
@@ -393,7 +379,21 @@ void CTeeHistorian::RecordTeamPractice(int Team, bool Practice)
 
 void CTeeHistorian::Write(const void *pData, int DataSize)
 {
-	m_pfnWriteCallback(pData, DataSize, m_pWriteCallbackUserdata);
+	const unsigned char *pBytes = static_cast<const unsigned char *>(pData);
+	m_vTickBuffer.insert(m_vTickBuffer.end(), pBytes, pBytes + DataSize);
+	// records between ticks are not followed by EndTick
+	if(m_State == STATE_START || m_State == STATE_BEFORE_TICK)
+	{
+		Flush();
+	}
+}
+
+void CTeeHistorian::Flush()
+{
+	if(m_vTickBuffer.empty())
+		return;
+	m_pfnWriteCallback(m_vTickBuffer.data(), m_vTickBuffer.size(), m_pWriteCallbackUserdata);
+	m_vTickBuffer.clear();
 }
 
 void CTeeHistorian::EnsureTickWritten()
@@ -733,6 +733,8 @@ void CTeeHistorian::EndTick()
 {
 	dbg_assert(m_State == STATE_BEFORE_ENDTICK, "invalid teehistorian state");
 	m_State = STATE_BEFORE_TICK;
+	// pass the whole tick to the writer at once
+	Flush();
 }
 
 void CTeeHistorian::RecordDDNetVersionOld(int ClientId, int DDNetVersion)
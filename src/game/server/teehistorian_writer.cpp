@@ -0,0 +1,195 @@
+#include "teehistorian_writer.h"
+
+#include <zlib.h>
+
+CTeeHistorianWriter::CTeeHistorianWriter() = default;
+
+CTeeHistorianWriter::~CTeeHistorianWriter()
+{
+	Close();
+}
+
+void CTeeHistorianWriter::Open(IOHANDLE File, int CompressionLevel)
+{
+	dbg_assert(m_File == nullptr && m_pAio == nullptr, "teehistorian writer is already open");
+	m_CompressionLevel = CompressionLevel;
+	m_Error.store(0);
+	if(!Compressed())
+	{
+		m_pAio = aio_new(File);
+		return;
+	}
+
+	m_File = File;
+	m_pStream = new z_stream;
+	mem_zero(m_pStream, sizeof(*m_pStream));
+	// window bits + 16 writes a gzip header, so the files can be read with
+	// the usual tools
+	if(deflateInit2(m_pStream, m_CompressionLevel, Z_DEFLATED, MAX_WBITS + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+	{
+		dbg_msg("teehistorian", "failed to initialize compression");
+		m_Error.store(-1);
+	}
+	m_vOutput.resize(64 * 1024);
+	{
+		const CLockScope LockScope(m_PendingLock);
+		m_vPending.clear();
+		m_SyncRequested = false;
+		m_CloseRequested = false;
+	}
+	m_pThread = thread_init(CompressThread, this, "teehistorian");
+}
+
+int CTeeHistorianWriter::Close()
+{
+	if(m_pAio != nullptr)
+	{
+		aio_close(m_pAio);
+		aio_wait(m_pAio);
+		const int Error = aio_error(m_pAio);
+		aio_free(m_pAio);
+		m_pAio = nullptr;
+		return Error;
+	}
+	if(m_File == nullptr)
+	{
+		return 0;
+	}
+
+	{
+		const CLockScope LockScope(m_PendingLock);
+		m_CloseRequested = true;
+	}
+	m_NumPending.Signal();
+	thread_wait(m_pThread);
+	m_pThread = nullptr;
+
+	deflateEnd(m_pStream);
+	delete m_pStream;
+	m_pStream = nullptr;
+	if(io_close(m_File) != 0 && m_Error.load() == 0)
+	{
+		m_Error.store(-1);
+	}
+	m_File = nullptr;
+	return m_Error.load();
+}
+
+void CTeeHistorianWriter::Write(const void *pData, int DataSize)
+{
+	if(DataSize <= 0)
+	{
+		return;
+	}
+	if(!Compressed())
+	{
+		aio_write(m_pAio, pData, DataSize);
+		return;
+	}
+
+	bool WasEmpty;
+	{
+		const CLockScope LockScope(m_PendingLock);
+		WasEmpty = m_vPending.empty();
+		const unsigned char *pBytes = static_cast<const unsigned char *>(pData);
+		m_vPending.insert(m_vPending.end(), pBytes, pBytes + DataSize);
+	}
+	// the thread takes all pending data at once
+	if(WasEmpty)
+	{
+		m_NumPending.Signal();
+	}
+}
+
+void CTeeHistorianWriter::Sync()
+{
+	if(!Compressed())
+	{
+		return;
+	}
+	{
+		const CLockScope LockScope(m_PendingLock);
+		m_SyncRequested = true;
+	}
+	m_NumPending.Signal();
+}
+
+int CTeeHistorianWriter::Error()
+{
+	if(m_pAio != nullptr)
+	{
+		return aio_error(m_pAio);
+	}
+	return m_Error.load();
+}
+
+void CTeeHistorianWriter::WriteCallback(const void *pData, int DataSize, void *pUser)
+{
+	static_cast<CTeeHistorianWriter *>(pUser)->Write(pData, DataSize);
+}
+
+void CTeeHistorianWriter::CompressThread(void *pUser)
+{
+	static_cast<CTeeHistorianWriter *>(pUser)->RunCompression();
+}
+
+void CTeeHistorianWriter::RunCompression()
+{
+	std::vector<unsigned char> vData;
+	while(true)
+	{
+		m_NumPending.Wait();
+		bool Sync;
+		bool Close;
+		{
+			const CLockScope LockScope(m_PendingLock);
+			vData.clear();
+			std::swap(vData, m_vPending);
+			Sync = m_SyncRequested;
+			Close = m_CloseRequested;
+			m_SyncRequested = false;
+		}
+
+		const int Flush = Close ? Z_FINISH : (Sync ? Z_FULL_FLUSH : Z_NO_FLUSH);
+		if(!vData.empty() || Flush != Z_NO_FLUSH)
+		{
+			Deflate(vData.data(), vData.size(), Flush);
+		}
+		if(Sync || Close)
+		{
+			io_flush(m_File);
+		}
+		if(Close)
+		{
+			return;
+		}
+	}
+}
+
+void CTeeHistorianWriter::Deflate(const unsigned char *pData, int DataSize, int Flush)
+{
+	if(m_Error.load() != 0)
+	{
+		return;
+	}
+	m_pStream->next_in = const_cast<Bytef *>(pData);
+	m_pStream->avail_in = DataSize;
+	do
+	{
+		m_pStream->next_out = m_vOutput.data();
+		m_pStream->avail_out = m_vOutput.size();
+		const int Result = deflate(m_pStream, Flush);
+		if(Result == Z_STREAM_ERROR)
+		{
+			dbg_msg("teehistorian", "compression failed");
+			m_Error.store(-1);
+			return;
+		}
+		const unsigned OutputSize = m_vOutput.size() - m_pStream->avail_out;
+		if(OutputSize > 0 && io_write(m_File, m_vOutput.data(), OutputSize) != OutputSize)
+		{
+			m_Error.store(-1);
+			return;
+		}
+	} while(m_pStream->avail_out == 0);
+}
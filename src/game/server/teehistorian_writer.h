@@ -0,0 +1,64 @@
+#ifndef GAME_SERVER_TEEHISTORIAN_WRITER_H
+#define GAME_SERVER_TEEHISTORIAN_WRITER_H
+
+#include <base/lock.h>
+#include <base/system.h>
+#include <base/tl/threading.h>
+
+#include <atomic>
+#include <vector>
+
+typedef struct z_stream_s z_stream;
+
+// Writes the teehistorian stream to a file in the background. The recorder
+// passes one buffer per tick. Uncompressed output goes through the async io
+// writer, compressed output is deflated into a gzip stream on a dedicated
+// thread. Sync points flush the compressed stream, so everything written
+// before the last sync point can be decompressed after a crash and the
+// stream can be decompressed starting at any of them.
+class CTeeHistorianWriter
+{
+public:
+	CTeeHistorianWriter();
+	~CTeeHistorianWriter();
+
+	// takes ownership of the file, CompressionLevel 0 writes the stream
+	// uncompressed, 1-9 are the zlib compression levels
+	void Open(IOHANDLE File, int CompressionLevel);
+	// writes the remaining data and closes the file, returns the first error
+	// that occurred, 0 if there was none
+	int Close();
+
+	bool Compressed() const { return m_CompressionLevel > 0; }
+
+	void Write(const void *pData, int DataSize);
+	// inserts a sync point after the data written so far
+	void Sync();
+	// returns the first write error, 0 if there was none
+	int Error();
+
+	static void WriteCallback(const void *pData, int DataSize, void *pUser);
+
+private:
+	static void CompressThread(void *pUser);
+	void RunCompression();
+	// deflates the input and writes the output to the file
+	void Deflate(const unsigned char *pData, int DataSize, int Flush);
+
+	int m_CompressionLevel = 0;
+	IOHANDLE m_File = nullptr;
+	ASYNCIO *m_pAio = nullptr;
+
+	void *m_pThread = nullptr;
+	z_stream *m_pStream = nullptr;
+	std::vector<unsigned char> m_vOutput;
+	std::atomic_int m_Error{0};
+
+	CSemaphore m_NumPending;
+	CLock m_PendingLock;
+	std::vector<unsigned char> m_vPending GUARDED_BY(m_PendingLock);
+	bool m_SyncRequested GUARDED_BY(m_PendingLock) = false;
+	bool m_CloseRequested GUARDED_BY(m_PendingLock) = false;
+};
+
+#endif // GAME_SERVER_TEEHISTORIAN_WRITER_H
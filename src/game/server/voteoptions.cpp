@@ -0,0 +1,186 @@
+#include "voteoptions.h"
+
+#include <base/math.h>
+#include <base/system.h>
+
+#include <engine/message.h>
+#include <engine/shared/memheap.h>
+
+#include <game/generated/protocol.h>
+
+#include <algorithm>
+
+CVoteOptions::CVoteOptions() :
+	m_pHeap(std::make_unique<CHeap>())
+{
+}
+
+CVoteOptions::~CVoteOptions() = default;
+
+std::string CVoteOptions::Key(const char *pDescription)
+{
+	// same folding as `str_comp_nocase`, which only ignores the case of ASCII letters
+	std::string Key(pDescription);
+	for(char &c : Key)
+	{
+		if(c >= 'A' && c <= 'Z')
+			c += 'a' - 'A';
+	}
+	return Key;
+}
+
+const CVoteOptionServer *CVoteOptions::Get(int Index) const
+{
+	if(Index < 0 || Index >= Num())
+		return nullptr;
+	return m_vpOptions[Index];
+}
+
+const CVoteOptionServer *CVoteOptions::Find(const char *pDescription) const
+{
+	auto It = m_Index.find(Key(pDescription));
+	if(It == m_Index.end())
+		return nullptr;
+	return It->second;
+}
+
+void CVoteOptions::Link(const char *pDescription, const char *pCommand)
+{
+	int Len = str_length(pCommand);
+	CVoteOptionServer *pOption = (CVoteOptionServer *)m_pHeap->Allocate(sizeof(CVoteOptionServer) + Len, alignof(CVoteOptionServer));
+	pOption->m_pNext = nullptr;
+	pOption->m_pPrev = m_pLast;
+	if(pOption->m_pPrev)
+		pOption->m_pPrev->m_pNext = pOption;
+	m_pLast = pOption;
+	if(!m_pFirst)
+		m_pFirst = pOption;
+
+	str_copy(pOption->m_aDescription, pDescription, sizeof(pOption->m_aDescription));
+	str_copy(pOption->m_aCommand, pCommand, Len + 1);
+
+	m_vpOptions.push_back(pOption);
+	m_Index[Key(pOption->m_aDescription)] = pOption;
+}
+
+void CVoteOptions::Add(const char *pDescription, const char *pCommand)
+{
+	// only the last packed message can change, it then has fewer options
+	// than available and is packed again
+	Link(pDescription, pCommand);
+}
+
+bool CVoteOptions::Remove(const char *pDescription)
+{
+	auto It = m_Index.find(Key(pDescription));
+	if(It == m_Index.end())
+		return false;
+	CVoteOptionServer *pOption = It->second;
+	m_Index.erase(It);
+	m_vpOptions.erase(std::find(m_vpOptions.begin(), m_vpOptions.end(), pOption));
+
+	if(pOption->m_pPrev)
+		pOption->m_pPrev->m_pNext = pOption->m_pNext;
+	else
+		m_pFirst = pOption->m_pNext;
+	if(pOption->m_pNext)
+		pOption->m_pNext->m_pPrev = pOption->m_pPrev;
+	else
+		m_pLast = pOption->m_pPrev;
+
+	m_vPackedMsgs.clear();
+
+	// the heap cannot free single options, copy the remaining ones once
+	// more memory is unused than used
+	m_NumRemoved++;
+	if(m_NumRemoved > Num())
+		Compact();
+	return true;
+}
+
+void CVoteOptions::Compact()
+{
+	std::vector<CVoteOptionServer *> vpOptions;
+	std::swap(vpOptions, m_vpOptions);
+	std::unique_ptr<CHeap> pHeap = std::make_unique<CHeap>();
+	std::swap(pHeap, m_pHeap);
+
+	m_pFirst = nullptr;
+	m_pLast = nullptr;
+	m_Index.clear();
+	m_NumRemoved = 0;
+	for(const CVoteOptionServer *pOption : vpOptions)
+		Link(pOption->m_aDescription, pOption->m_aCommand);
+}
+
+void CVoteOptions::Clear()
+{
+	m_pHeap->Reset();
+	m_pFirst = nullptr;
+	m_pLast = nullptr;
+	m_vpOptions.clear();
+	m_Index.clear();
+	m_NumRemoved = 0;
+	m_vPackedMsgs.clear();
+}
+
+void CVoteOptions::PackOptions(int Index, int Num, CMsgPacker *pPacker) const
+{
+	const char *apDescription[15];
+	for(int i = 0; i < (int)std::size(apDescription); i++)
+		apDescription[i] = i < Num ? m_vpOptions[Index + i]->m_aDescription : "";
+
+	CNetMsg_Sv_VoteOptionListAdd OptionMsg;
+	OptionMsg.m_NumOptions = Num;
+	OptionMsg.m_pDescription0 = apDescription[0];
+	OptionMsg.m_pDescription1 = apDescription[1];
+	OptionMsg.m_pDescription2 = apDescription[2];
+	OptionMsg.m_pDescription3 = apDescription[3];
+	OptionMsg.m_pDescription4 = apDescription[4];
+	OptionMsg.m_pDescription5 = apDescription[5];
+	OptionMsg.m_pDescription6 = apDescription[6];
+	OptionMsg.m_pDescription7 = apDescription[7];
+	OptionMsg.m_pDescription8 = apDescription[8];
+	OptionMsg.m_pDescription9 = apDescription[9];
+	OptionMsg.m_pDescription10 = apDescription[10];
+	OptionMsg.m_pDescription11 = apDescription[11];
+	OptionMsg.m_pDescription12 = apDescription[12];
+	OptionMsg.m_pDescription13 = apDescription[13];
+	OptionMsg.m_pDescription14 = apDescription[14];
+	OptionMsg.Pack(pPacker);
+}
+
+int CVoteOptions::PackListAdd(int Index, int PerMsg, CMsgPacker *pPacker)
+{
+	dbg_assert(PerMsg >= 1 && PerMsg <= 15, "invalid number of vote options per message");
+	dbg_assert(pPacker->m_MsgId == NETMSGTYPE_SV_VOTEOPTIONLISTADD, "packer for wrong message");
+	if(Index < 0 || Index >= Num())
+		return 0;
+	const int NumOptions = minimum(PerMsg, Num() - Index);
+
+	if(Index % PerMsg != 0)
+	{
+		// clients only get here if options were added while sending
+		PackOptions(Index, NumOptions, pPacker);
+		return NumOptions;
+	}
+
+	if(PerMsg != m_PackedPerMsg)
+	{
+		m_vPackedMsgs.clear();
+		m_PackedPerMsg = PerMsg;
+	}
+	const size_t Msg = Index / PerMsg;
+	if(Msg >= m_vPackedMsgs.size())
+		m_vPackedMsgs.resize((Num() + PerMsg - 1) / PerMsg);
+	CPackedMsg &Packed = m_vPackedMsgs[Msg];
+	if(Packed.m_NumOptions != NumOptions)
+	{
+		CMsgPacker Packer(NETMSGTYPE_SV_VOTEOPTIONLISTADD, false);
+		PackOptions(Index, NumOptions, &Packer);
+		Packed.m_vData.assign(Packer.Data(), Packer.Data() + Packer.Size());
+		Packed.m_NumOptions = NumOptions;
+	}
+	pPacker->AddRaw(Packed.m_vData.data(), Packed.m_vData.size());
+	return NumOptions;
+}
@@ -0,0 +1,77 @@
+#ifndef GAME_SERVER_VOTEOPTIONS_H
+#define GAME_SERVER_VOTEOPTIONS_H
+
+#include <game/voting.h>
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class CHeap;
+class CMsgPacker;
+
+/**
+ * The vote options of the server, stored in the order they were added.
+ *
+ * Options can be accessed by index and looked up by their description
+ * without walking the list. Descriptions are compared case-insensitively
+ * like `str_comp_nocase`.
+ */
+class CVoteOptions
+{
+public:
+	CVoteOptions();
+	~CVoteOptions();
+	CVoteOptions(const CVoteOptions &) = delete;
+	CVoteOptions &operator=(const CVoteOptions &) = delete;
+
+	int Num() const { return m_vpOptions.size(); }
+	const CVoteOptionServer *Get(int Index) const;
+	const CVoteOptionServer *First() const { return m_pFirst; }
+	const CVoteOptionServer *Find(const char *pDescription) const;
+
+	/**
+	 * Appends an option, the description must not exist yet.
+	 */
+	void Add(const char *pDescription, const char *pCommand);
+	bool Remove(const char *pDescription);
+	void Clear();
+
+	/**
+	 * Packs the `CNetMsg_Sv_VoteOptionListAdd` message with up to
+	 * `PerMsg` options starting at `Index` into `pPacker`.
+	 *
+	 * Messages starting at a multiple of `PerMsg` are only packed once for
+	 * each set of options and copied for every client that requests them.
+	 *
+	 * @return The number of options in the message.
+	 */
+	int PackListAdd(int Index, int PerMsg, CMsgPacker *pPacker);
+
+private:
+	class CPackedMsg
+	{
+	public:
+		std::vector<unsigned char> m_vData;
+		int m_NumOptions = 0;
+	};
+
+	static std::string Key(const char *pDescription);
+	void Link(const char *pDescription, const char *pCommand);
+	void Compact();
+	void PackOptions(int Index, int Num, CMsgPacker *pPacker) const;
+
+	std::unique_ptr<CHeap> m_pHeap;
+	CVoteOptionServer *m_pFirst = nullptr;
+	CVoteOptionServer *m_pLast = nullptr;
+	std::vector<CVoteOptionServer *> m_vpOptions;
+	std::unordered_map<std::string, CVoteOptionServer *> m_Index;
+	// options that were removed but still take up heap memory
+	int m_NumRemoved = 0;
+
+	int m_PackedPerMsg = 0;
+	std::vector<CPackedMsg> m_vPackedMsgs;
+};
+
+#endif
@@ -0,0 +1,376 @@
+#include <gtest/gtest.h>
+
+#include <base/math.h>
+
+#include <engine/map.h>
+#include <engine/shared/config.h>
+#include <game/collision.h>
+#include <game/layers.h>
+#include <game/mapitems.h>
+#include <game/prng.h>
+
+#include <iterator>
+#include <vector>
+
+// Map with one game group containing a game, a front, a tele and a switch
+// layer, filled with random tiles.
+class CTestMap : public IMap
+{
+	class CLayerItem
+	{
+	public:
+		CMapItemLayerTilemap m_Tilemap;
+		int m_DataIndex;
+	};
+
+	CMapItemGroup m_Group;
+	std::vector<CLayerItem> m_vLayers;
+	std::vector<std::vector<unsigned char>> m_vvData;
+
+	void AddLayer(int Flags, size_t TileSize)
+	{
+		CMapItemLayerTilemap Tilemap = {};
+		Tilemap.m_Layer.m_Type = LAYERTYPE_TILES;
+		Tilemap.m_Version = 3;
+		Tilemap.m_Width = m_Width;
+		Tilemap.m_Height = m_Height;
+		Tilemap.m_Flags = Flags;
+		Tilemap.m_Tele = -1;
+		Tilemap.m_Speedup = -1;
+		Tilemap.m_Front = -1;
+		Tilemap.m_Switch = -1;
+		Tilemap.m_Tune = -1;
+		// special layers have unused game data, too
+		Tilemap.m_Data = m_vvData.size();
+		m_vvData.emplace_back((size_t)m_Width * m_Height * sizeof(CTile));
+		int DataIndex = Tilemap.m_Data;
+		if(Flags != TILESLAYERFLAG_GAME)
+		{
+			DataIndex = m_vvData.size();
+			m_vvData.emplace_back((size_t)m_Width * m_Height * TileSize);
+			if(Flags & TILESLAYERFLAG_TELE)
+				Tilemap.m_Tele = DataIndex;
+			else if(Flags & TILESLAYERFLAG_FRONT)
+				Tilemap.m_Front = DataIndex;
+			else
+				Tilemap.m_Switch = DataIndex;
+		}
+		m_vLayers.push_back({Tilemap, DataIndex});
+	}
+
+public:
+	int m_Width;
+	int m_Height;
+
+	CTestMap(int Width, int Height) :
+		m_Width(Width), m_Height(Height)
+	{
+		m_Group = {};
+		m_Group.m_Version = 3;
+		m_Group.m_ParallaxX = 100;
+		m_Group.m_ParallaxY = 100;
+		m_Group.m_NumLayers = 4;
+		AddLayer(TILESLAYERFLAG_GAME, sizeof(CTile));
+		AddLayer(TILESLAYERFLAG_FRONT, sizeof(CTile));
+		AddLayer(TILESLAYERFLAG_TELE, sizeof(CTeleTile));
+		AddLayer(TILESLAYERFLAG_SWITCH, sizeof(CSwitchTile));
+	}
+
+	CTile *GameTiles() { return reinterpret_cast<CTile *>(m_vvData[m_vLayers[0].m_DataIndex].data()); }
+	CTile *FrontTiles() { return reinterpret_cast<CTile *>(m_vvData[m_vLayers[1].m_DataIndex].data()); }
+	CTeleTile *TeleTiles() { return reinterpret_cast<CTeleTile *>(m_vvData[m_vLayers[2].m_DataIndex].data()); }
+	CSwitchTile *SwitchTiles() { return reinterpret_cast<CSwitchTile *>(m_vvData[m_vLayers[3].m_DataIndex].data()); }
+
+	int GetDataSize(int Index) const override { return m_vvData[Index].size(); }
+	void *GetData(int Index) override { return m_vvData[Index].data(); }
+	void *GetDataSwapped(int Index) override { return GetData(Index); }
+	const char *GetDataString(int Index) override { return nullptr; }
+	void UnloadData(int Index) override {}
+	int NumData() const override { return m_vvData.size(); }
+
+	int GetItemSize(int Index) override { return Index == 0 ? sizeof(m_Group) : sizeof(CMapItemLayerTilemap); }
+	void *GetItem(int Index, int *pType, int *pId) override
+	{
+		if(pType)
+			*pType = Index == 0 ? MAPITEMTYPE_GROUP : MAPITEMTYPE_LAYER;
+		if(pId)
+			*pId = Index == 0 ? 0 : Index - 1;
+		if(Index == 0)
+			return &m_Group;
+		return &m_vLayers[Index - 1].m_Tilemap;
+	}
+	void GetType(int Type, int *pStart, int *pNum) override
+	{
+		*pStart = Type == MAPITEMTYPE_GROUP ? 0 : 1;
+		*pNum = Type == MAPITEMTYPE_GROUP ? 1 : Type == MAPITEMTYPE_LAYER ? m_vLayers.size() : 0;
+	}
+	int FindItemIndex(int Type, int Id) override { return -1; }
+	void *FindItem(int Type, int Id) override { return nullptr; }
+	int NumItems() const override { return 1 + m_vLayers.size(); }
+};
+
+class CRandom
+{
+	CPrng m_Prng;
+
+public:
+	CRandom(uint64_t Seed)
+	{
+		uint64_t aSeed[2] = {Seed, 0};
+		m_Prng.Seed(aSeed);
+	}
+	int Int(int Below) { return m_Prng.RandomBits() % Below; }
+	float Float(float Min, float Max) { return Min + (Max - Min) * (m_Prng.RandomBits() / 4294967296.0f); }
+};
+
+static void FillRandom(CTestMap *pMap, CRandom *pRandom)
+{
+	static const int s_aGameTiles[] = {TILE_SOLID, TILE_NOHOOK, TILE_NOLASER, TILE_DEATH, TILE_THROUGH, TILE_THROUGH_ALL, TILE_THROUGH_DIR, TILE_FREEZE, TILE_STOP, TILE_STOPS, TILE_STOPA, TILE_WALLJUMP};
+	static const int s_aFrontTiles[] = {TILE_NOLASER, TILE_DEATH, TILE_THROUGH, TILE_THROUGH_CUT, TILE_THROUGH_ALL, TILE_THROUGH_DIR, TILE_FREEZE, TILE_STOP, TILE_STOPS, TILE_STOPA};
+	static const int s_aTeleTypes[] = {TILE_TELEIN, TILE_TELEINEVIL, TILE_TELEINHOOK, TILE_TELEINWEAPON, TILE_TELEOUT};
+	CTile *pGame = pMap->GameTiles();
+	CTile *pFront = pMap->FrontTiles();
+	CTeleTile *pTele = pMap->TeleTiles();
+	CSwitchTile *pSwitch = pMap->SwitchTiles();
+	// mostly empty space with a few walls, so both the skipping and the
+	// regular checks are used
+	for(int i = 0; i < pMap->m_Width * pMap->m_Height; i++)
+	{
+		if(pRandom->Int(30) == 0)
+		{
+			pGame[i].m_Index = s_aGameTiles[pRandom->Int(std::size(s_aGameTiles))];
+			pGame[i].m_Flags = pRandom->Int(8) * ROTATION_90;
+		}
+		if(pRandom->Int(60) == 0)
+		{
+			pFront[i].m_Index = s_aFrontTiles[pRandom->Int(std::size(s_aFrontTiles))];
+			pFront[i].m_Flags = pRandom->Int(8) * ROTATION_90;
+		}
+		if(pRandom->Int(100) == 0)
+		{
+			pTele[i].m_Type = s_aTeleTypes[pRandom->Int(std::size(s_aTeleTypes))];
+			pTele[i].m_Number = 1 + pRandom->Int(3);
+		}
+		if(pRandom->Int(100) == 0)
+		{
+			pSwitch[i].m_Type = TILE_JUMP;
+			pSwitch[i].m_Number = 1 + pRandom->Int(3);
+			pSwitch[i].m_Delay = pRandom->Int(5);
+		}
+	}
+}
+
+class CLineResult
+{
+public:
+	int m_Hit;
+	vec2 m_Collision;
+	vec2 m_BeforeCollision;
+	int m_TeleNr;
+};
+
+static bool operator==(const CLineResult &Left, const CLineResult &Right)
+{
+	return Left.m_Hit == Right.m_Hit && Left.m_Collision == Right.m_Collision && Left.m_BeforeCollision == Right.m_BeforeCollision && Left.m_TeleNr == Right.m_TeleNr;
+}
+
+static void PrintTo(const CLineResult &Result, std::ostream *pOutput)
+{
+	*pOutput << Result.m_Hit << " (" << Result.m_Collision.x << ", " << Result.m_Collision.y << ") (" << Result.m_BeforeCollision.x << ", " << Result.m_BeforeCollision.y << ") " << Result.m_TeleNr;
+}
+
+static CLineResult Intersect(const CCollision &Collision, int Query, vec2 Pos0, vec2 Pos1)
+{
+	CLineResult Result;
+	Result.m_TeleNr = -1;
+	switch(Query)
+	{
+	case 0: Result.m_Hit = Collision.IntersectLine(Pos0, Pos1, &Result.m_Collision, &Result.m_BeforeCollision); break;
+	case 1: Result.m_Hit = Collision.IntersectLineTeleHook(Pos0, Pos1, &Result.m_Collision, &Result.m_BeforeCollision, &Result.m_TeleNr); break;
+	case 2: Result.m_Hit = Collision.IntersectLineTeleHook(Pos0, Pos1, &Result.m_Collision, &Result.m_BeforeCollision); break;
+	case 3: Result.m_Hit = Collision.IntersectLineTeleWeapon(Pos0, Pos1, &Result.m_Collision, &Result.m_BeforeCollision, &Result.m_TeleNr); break;
+	case 4: Result.m_Hit = Collision.IntersectNoLaser(Pos0, Pos1, &Result.m_Collision, &Result.m_BeforeCollision); break;
+	case 5: Result.m_Hit = Collision.IntersectNoLaserNoWalls(Pos0, Pos1, &Result.m_Collision, &Result.m_BeforeCollision); break;
+	case 6: Result.m_Hit = Collision.IntersectAir(Pos0, Pos1, &Result.m_Collision, &Result.m_BeforeCollision); break;
+	}
+	return Result;
+}
+static const int NUM_QUERIES = 7;
+
+static void ExpectSameIntersections(CCollision *pCollision, CTestMap *pMap, CRandom *pRandom, int NumLines)
+{
+	const float Width = pMap->m_Width * 32.0f;
+	const float Height = pMap->m_Height * 32.0f;
+	for(int Line = 0; Line < NumLines; Line++)
+	{
+		// lines partially outside of the map, short lines and lines along
+		// the axes
+		vec2 Pos0(pRandom->Float(-100.0f, Width + 100.0f), pRandom->Float(-100.0f, Height + 100.0f));
+		vec2 Pos1;
+		switch(pRandom->Int(4))
+		{
+		case 0: Pos1 = Pos0 + vec2(pRandom->Float(-40.0f, 40.0f), pRandom->Float(-40.0f, 40.0f)); break;
+		case 1: Pos1 = vec2(pRandom->Float(-100.0f, Width + 100.0f), Pos0.y); break;
+		case 2: Pos1 = vec2(Pos0.x, pRandom->Float(-100.0f, Height + 100.0f)); break;
+		default: Pos1 = vec2(pRandom->Float(-100.0f, Width + 100.0f), pRandom->Float(-100.0f, Height + 100.0f)); break;
+		}
+		for(int Query = 0; Query < NUM_QUERIES; Query++)
+		{
+			pCollision->SetLineSkipping(false);
+			const CLineResult Expected = Intersect(*pCollision, Query, Pos0, Pos1);
+			pCollision->SetLineSkipping(true);
+			const CLineResult Actual = Intersect(*pCollision, Query, Pos0, Pos1);
+			ASSERT_EQ(Expected, Actual) << "query " << Query << " from (" << Pos0.x << ", " << Pos0.y << ") to (" << Pos1.x << ", " << Pos1.y << ")";
+		}
+	}
+}
+
+TEST(Collision, LineSkippingEquivalence)
+{
+	for(int Seed = 0; Seed < 8; Seed++)
+	{
+		CRandom Random(Seed);
+		CTestMap Map(20 + Random.Int(100), 20 + Random.Int(100));
+		FillRandom(&Map, &Random);
+		CLayers Layers;
+		Layers.Init(&Map, false);
+		CCollision Collision;
+		Collision.Init(&Layers);
+
+		for(int OldTeleport = 0; OldTeleport < 2; OldTeleport++)
+		{
+			g_Config.m_SvOldTeleportHook = OldTeleport;
+			g_Config.m_SvOldTeleportWeapons = OldTeleport;
+			ExpectSameIntersections(&Collision, &Map, &Random, 2000);
+		}
+		g_Config.m_SvOldTeleportHook = 0;
+		g_Config.m_SvOldTeleportWeapons = 0;
+		if(::testing::Test::HasFatalFailure())
+			return;
+
+		// tiles changed while the map is running
+		for(int i = 0; i < 200; i++)
+		{
+			static const int s_aIndices[] = {TILE_AIR, TILE_SOLID, TILE_NOHOOK, TILE_NOLASER};
+			Collision.SetCollisionAt(Random.Float(0.0f, Map.m_Width * 32.0f), Random.Float(0.0f, Map.m_Height * 32.0f), s_aIndices[Random.Int(std::size(s_aIndices))]);
+		}
+		ExpectSameIntersections(&Collision, &Map, &Random, 2000);
+		if(::testing::Test::HasFatalFailure())
+			return;
+	}
+}
+
+static bool SwitchActive(int Number, void *pUser)
+{
+	return Number % 2;
+}
+
+static void ExpectSameTileQueries(CCollision *pCollision, CTestMap *pMap, CRandom *pRandom)
+{
+	const int NumTiles = pMap->m_Width * pMap->m_Height;
+	for(int Index = -1; Index < NumTiles; Index++)
+	{
+		const vec2 Pos = pCollision->GetPos(maximum(Index, 0)) + vec2(pRandom->Float(-16.0f, 16.0f), pRandom->Float(-16.0f, 16.0f));
+		const vec2 Other = Pos + vec2(pRandom->Float(-64.0f, 64.0f), pRandom->Float(-64.0f, 64.0f));
+		const float Distance = pRandom->Float(0.0f, 32.0f);
+		int OffsetX, OffsetY;
+		ThroughOffset(Pos, Other, &OffsetX, &OffsetY);
+
+		int aResults[2][16];
+		for(int UseFlags = 0; UseFlags < 2; UseFlags++)
+		{
+			pCollision->SetUseTileFlags(UseFlags);
+			int *pResult = aResults[UseFlags];
+			*pResult++ = pCollision->TileExists(Index);
+			*pResult++ = pCollision->TileExistsNext(Index);
+			*pResult++ = pCollision->IsTeleport(Index);
+			*pResult++ = pCollision->IsEvilTeleport(Index);
+			*pResult++ = pCollision->IsCheckTeleport(Index);
+			*pResult++ = pCollision->IsCheckEvilTeleport(Index);
+			*pResult++ = pCollision->IsTeleCheckpoint(Index);
+			*pResult++ = pCollision->IsTeleportWeapon(Index);
+			*pResult++ = pCollision->IsTeleportHook(Index);
+			*pResult++ = pCollision->GetSwitchType(Index);
+			*pResult++ = pCollision->GetSwitchNumber(Index);
+			*pResult++ = pCollision->GetSwitchDelay(Index);
+			if(Index < 0)
+				continue;
+			*pResult++ = pCollision->GetMoveRestrictions(SwitchActive, nullptr, Pos, Distance);
+			*pResult++ = pCollision->IsThrough(round_to_int(Pos.x), round_to_int(Pos.y), OffsetX, OffsetY, Pos, Other);
+			*pResult++ = pCollision->IsHookBlocker(round_to_int(Pos.x), round_to_int(Pos.y), Pos, Other);
+			*pResult++ = pCollision->IsSolid(round_to_int(Pos.x), round_to_int(Pos.y));
+		}
+		for(int Query = 0; Query < (Index < 0 ? 12 : 16); Query++)
+			ASSERT_EQ(aResults[0][Query], aResults[1][Query]) << "query " << Query << " at tile " << Index;
+	}
+}
+
+TEST(Collision, TileFlagsEquivalence)
+{
+	for(int Seed = 0; Seed < 8; Seed++)
+	{
+		CRandom Random(Seed);
+		CTestMap Map(20 + Random.Int(100), 20 + Random.Int(100));
+		FillRandom(&Map, &Random);
+		CLayers Layers;
+		Layers.Init(&Map, false);
+		CCollision Collision;
+		Collision.Init(&Layers);
+		ExpectSameTileQueries(&Collision, &Map, &Random);
+		if(::testing::Test::HasFatalFailure())
+			return;
+
+		// tiles and doors changed while the map is running
+		for(int i = 0; i < 200; i++)
+		{
+			static const int s_aIndices[] = {TILE_AIR, TILE_SOLID, TILE_STOP, TILE_STOPA, TILE_FREEZE};
+			const vec2 Pos(Random.Float(0.0f, Map.m_Width * 32.0f), Random.Float(0.0f, Map.m_Height * 32.0f));
+			if(Random.Int(2))
+				Collision.SetCollisionAt(Pos.x, Pos.y, s_aIndices[Random.Int(std::size(s_aIndices))]);
+			else
+				Collision.SetDoorCollisionAt(Pos.x, Pos.y, Random.Int(2) ? TILE_STOPA : TILE_AIR, Random.Int(4) * ROTATION_90, 1 + Random.Int(3));
+		}
+		ExpectSameTileQueries(&Collision, &Map, &Random);
+		if(::testing::Test::HasFatalFailure())
+			return;
+	}
+}
+
+TEST(Collision, IterateMapIndices)
+{
+	for(int Seed = 0; Seed < 8; Seed++)
+	{
+		CRandom Random(Seed);
+		CTestMap Map(20 + Random.Int(100), 20 + Random.Int(100));
+		FillRandom(&Map, &Random);
+		CLayers Layers;
+		Layers.Init(&Map, false);
+		CCollision Collision;
+		Collision.Init(&Layers);
+
+		const float Width = Map.m_Width * 32.0f;
+		const float Height = Map.m_Height * 32.0f;
+		for(int Line = 0; Line < 2000; Line++)
+		{
+			// characters move a few tiles per tick, but teleports make the
+			// previous position arbitrarily far away
+			const vec2 Pos0(Random.Float(-100.0f, Width + 100.0f), Random.Float(-100.0f, Height + 100.0f));
+			vec2 Pos1;
+			switch(Random.Int(3))
+			{
+			case 0: Pos1 = Pos0; break;
+			case 1: Pos1 = Pos0 + vec2(Random.Float(-100.0f, 100.0f), Random.Float(-100.0f, 100.0f)); break;
+			default: Pos1 = vec2(Random.Float(-100.0f, Width + 100.0f), Random.Float(-100.0f, Height + 100.0f)); break;
+			}
+			const unsigned MaxIndices = Random.Int(2) ? 0 : Random.Int(4);
+
+			const std::vector<int> vExpected = Collision.GetMapIndices(Pos0, Pos1, MaxIndices);
+			std::vector<int> vActual;
+			CCollision::CMapIndices Indices = Collision.IterateMapIndices(Pos0, Pos1, MaxIndices);
+			EXPECT_EQ(Indices.empty(), vExpected.empty());
+			for(int Index : Indices)
+				vActual.push_back(Index);
+			ASSERT_EQ(vExpected, vActual) << "from (" << Pos0.x << ", " << Pos0.y << ") to (" << Pos1.x << ", " << Pos1.y << "), max " << MaxIndices;
+		}
+	}
+}
@@ -109,3 +109,102 @@ TEST(Datafile, StringData)
 		pStorage->RemoveFile(Info.m_aFilename, IStorage::TYPE_SAVE);
 	}
 }
+
+TEST(Datafile, KnownHashes)
+{
+	std::unique_ptr<IStorage> pStorage = CreateLocalStorage();
+	ASSERT_NE(pStorage, nullptr) << "Error creating local storage";
+
+	CTestInfo Info;
+
+	{
+		CDataFileWriter Writer;
+		Writer.Open(pStorage.get(), Info.m_aFilename);
+		EXPECT_EQ(Writer.AddDataString("Abc"), 0);
+		Writer.Finish();
+	}
+
+	SHA256_DIGEST Sha256;
+	unsigned Crc;
+	{
+		CDataFileReader Reader;
+		ASSERT_TRUE(Reader.Open(pStorage.get(), Info.m_aFilename, IStorage::TYPE_ALL));
+		Sha256 = Reader.Sha256();
+		Crc = Reader.Crc();
+		Reader.Close();
+	}
+
+	{
+		CDataFileReader Reader;
+		ASSERT_TRUE(Reader.Open(pStorage.get(), Info.m_aFilename, IStorage::TYPE_ALL, &Sha256, Crc));
+		EXPECT_EQ(Reader.Sha256(), Sha256);
+		EXPECT_EQ(Reader.Crc(), Crc);
+		EXPECT_STREQ(Reader.GetDataString(0), "Abc");
+		Reader.Close();
+	}
+
+	{
+		// known hashes are trusted, the file is not hashed again
+		SHA256_DIGEST OtherSha256 = SHA256_ZEROED;
+		OtherSha256.data[0] = 1;
+		CDataFileReader Reader;
+		ASSERT_TRUE(Reader.Open(pStorage.get(), Info.m_aFilename, IStorage::TYPE_ALL, &OtherSha256, Crc + 1));
+		EXPECT_EQ(Reader.Sha256(), OtherSha256);
+		EXPECT_EQ(Reader.Crc(), Crc + 1);
+		Reader.Close();
+	}
+
+	if(!HasFailure())
+	{
+		pStorage->RemoveFile(Info.m_aFilename, IStorage::TYPE_SAVE);
+	}
+}
+
+TEST(Datafile, OpenFromMemory)
+{
+	std::unique_ptr<IStorage> pStorage = CreateLocalStorage();
+	ASSERT_NE(pStorage, nullptr) << "Error creating local storage";
+
+	CTestInfo Info;
+
+	{
+		CDataFileWriter Writer;
+		Writer.Open(pStorage.get(), Info.m_aFilename);
+		EXPECT_EQ(Writer.AddDataString("Abc"), 0);
+		EXPECT_EQ(Writer.AddDataString("Defgh"), 1);
+		Writer.Finish();
+	}
+
+	void *pData;
+	unsigned Size;
+	ASSERT_TRUE(pStorage->ReadFile(Info.m_aFilename, IStorage::TYPE_ALL, &pData, &Size));
+	const unsigned char *pFileData = static_cast<unsigned char *>(pData);
+
+	{
+		CDataFileReader FileReader;
+		ASSERT_TRUE(FileReader.Open(pStorage.get(), Info.m_aFilename, IStorage::TYPE_ALL));
+		CDataFileReader Reader;
+		ASSERT_TRUE(Reader.Open(Info.m_aFilename, pFileData, Size));
+		EXPECT_EQ(Reader.File(), nullptr);
+		EXPECT_EQ(Reader.Sha256(), FileReader.Sha256());
+		EXPECT_EQ(Reader.Crc(), FileReader.Crc());
+		EXPECT_STREQ(Reader.GetDataString(1), "Defgh");
+		EXPECT_STREQ(Reader.GetDataString(0), "Abc");
+		Reader.Close();
+		FileReader.Close();
+	}
+
+	{
+		// truncated contents are rejected
+		CDataFileReader Reader;
+		EXPECT_FALSE(Reader.Open(Info.m_aFilename, pFileData, Size - 1));
+		EXPECT_FALSE(Reader.IsOpen());
+	}
+
+	free(pData);
+
+	if(!HasFailure())
+	{
+		pStorage->RemoveFile(Info.m_aFilename, IStorage::TYPE_SAVE);
+	}
+}
@@ -0,0 +1,136 @@
+#include "test.h"
+#include <gtest/gtest.h>
+
+#include <base/hash_ctxt.h>
+#include <base/system.h>
+
+#include <engine/kernel.h>
+#include <engine/map.h>
+#include <engine/storage.h>
+#include <game/collision.h>
+#include <game/gamecore.h>
+#include <game/layers.h>
+#include <game/prng.h>
+#include <game/teamscore.h>
+
+#include <iterator>
+#include <memory>
+
+// Hashes the character cores of every tick while random inputs are applied,
+// the characters are ticked the same way CGameWorld::Tick ticks them. The
+// expected hashes were recorded with the character physics before player
+// collision in CCharacterCore::Move was changed to collect the other
+// characters once per move.
+static void ExpectRecordedReplay(bool NoWeakHook, const char *pExpectedHash)
+{
+	CTestInfo Info;
+	Info.m_DeleteTestStorageFilesOnSuccess = true;
+	std::unique_ptr<IStorage> pStorage = Info.CreateTestStorage();
+	ASSERT_NE(pStorage, nullptr);
+	std::unique_ptr<IKernel> pKernel(IKernel::Create());
+	pKernel->RegisterInterface(pStorage.get(), false);
+	IEngineMap *pMap = CreateEngineMap();
+	pKernel->RegisterInterface(pMap);
+	ASSERT_TRUE(pMap->Load("maps/coverage.map"));
+
+	CLayers Layers;
+	Layers.Init(pMap, false);
+	CCollision Collision;
+	Collision.Init(&Layers);
+
+	CPrng Prng;
+	uint64_t aSeed[2] = {1, 2};
+	Prng.Seed(aSeed);
+	auto &&RandomInt = [&](int Below) { return (int)(Prng.RandomBits() % Below); };
+	auto &&RandomFloat = [&](float Min, float Max) { return Min + (Max - Min) * (Prng.RandomBits() / 4294967296.0f); };
+
+	CWorldCore World;
+	World.m_pPrng = &Prng;
+	World.InitSwitchers(Collision.m_HighestSwitchNumber);
+	CTeamsCore Teams;
+	// value-initialized, Reset doesn't set all members
+	CCharacterCore aCores[MAX_CLIENTS] = {};
+
+	// characters close to each other, so they hook and push each other
+	vec2 Center;
+	do
+		Center = vec2(RandomFloat(300.0f, Collision.GetWidth() * 32.0f - 300.0f), RandomFloat(300.0f, Collision.GetHeight() * 32.0f - 300.0f));
+	while(Collision.TestBox(Center, CCharacterCore::PhysicalSizeVec2()));
+	for(int Id = 0; Id < MAX_CLIENTS; Id++)
+	{
+		static const int s_aTeams[] = {TEAM_FLOCK, TEAM_FLOCK, 1, TEAM_SUPER};
+		CCharacterCore &Core = aCores[Id];
+		Core.Init(&World, &Collision, &Teams);
+		Core.Reset();
+		Core.m_Id = Id;
+		do
+			Core.m_Pos = Center + vec2(RandomFloat(-250.0f, 250.0f), RandomFloat(-250.0f, 250.0f));
+		while(Collision.TestBox(Core.m_Pos, CCharacterCore::PhysicalSizeVec2()));
+		Core.m_Solo = RandomInt(10) == 0;
+		Core.m_Super = RandomInt(10) == 0;
+		Core.m_CollisionDisabled = RandomInt(8) == 0;
+		Teams.Team(Id, s_aTeams[RandomInt(std::size(s_aTeams))]);
+		Teams.SetSolo(Id, RandomInt(10) == 0);
+		World.m_apCharacters[Id] = &Core;
+	}
+
+	SHA256_CTX Hash;
+	sha256_init(&Hash);
+	int NumPlayerHooks = 0;
+	for(int Tick = 0; Tick < 1000; Tick++)
+	{
+		for(auto &Core : aCores)
+		{
+			CNetObj_PlayerInput &Input = Core.m_Input;
+			if(RandomInt(8) == 0)
+				Input.m_Direction = RandomInt(3) - 1;
+			if(RandomInt(6) == 0)
+				Input.m_Jump = !Input.m_Jump;
+			if(RandomInt(6) == 0)
+				Input.m_Hook = !Input.m_Hook;
+			if(RandomInt(4) == 0)
+			{
+				Input.m_TargetX = RandomInt(401) - 200;
+				Input.m_TargetY = RandomInt(401) - 200;
+				if(Input.m_TargetX == 0 && Input.m_TargetY == 0)
+					Input.m_TargetY = -1;
+			}
+		}
+
+		for(auto &Core : aCores)
+			Core.Tick(true, !NoWeakHook);
+		if(NoWeakHook)
+		{
+			for(auto &Core : aCores)
+				Core.TickDeferred();
+		}
+		for(auto &Core : aCores)
+		{
+			Core.Move();
+			Core.Quantize();
+
+			// Write doesn't set the tick
+			CNetObj_CharacterCore Obj = {};
+			Core.Write(&Obj);
+			sha256_update(&Hash, &Obj, sizeof(Obj));
+			sha256_update(&Hash, &Core.m_TriggeredEvents, sizeof(Core.m_TriggeredEvents));
+			NumPlayerHooks += (Core.m_TriggeredEvents & COREEVENT_HOOK_ATTACH_PLAYER) != 0;
+		}
+	}
+	// the characters must interact for the hashes to cover player collision
+	EXPECT_GT(NumPlayerHooks, 0);
+
+	char aHash[SHA256_MAXSTRSIZE];
+	sha256_str(sha256_finish(&Hash), aHash, sizeof(aHash));
+	EXPECT_STREQ(aHash, pExpectedHash);
+}
+
+TEST(GameCore, RecordedReplay)
+{
+	ExpectRecordedReplay(false, "77e1f4d2b0212518b14826790a0e4c39496ccaca5241f08ffefb7a803587e9c0");
+}
+
+TEST(GameCore, RecordedReplayNoWeakHook)
+{
+	ExpectRecordedReplay(true, "aa201244e3644f3a0f59a4da5ec93b90f9d02f6e20d6e0aa9bc2fcbe7e2383ff");
+}
@@ -14,9 +14,11 @@
 #include <engine/shared/assertion_logger.h>
 #include <engine/shared/config.h>
 #include <game/generated/protocol.h>
+#include <game/prng.h>
 #include <game/server/entities/character.h>
 #include <game/server/gamecontext.h>
 #include <game/server/gameworld.h>
+#include <game/server/snapviews.h>
 #include <game/version.h>
 
 #include <memory>
@@ -248,3 +250,60 @@ TEST_F(CTestGameWorld, IntersectEntity)
 		nullptr /* pThisOnly */);
 	EXPECT_EQ(pIntersectedChar, pChrRight);
 }
+
+TEST(SnapViews, SameAsNetworkClipped)
+{
+	// the views as CPlayer stores them
+	vec2 aViewPos[MAX_CLIENTS];
+	vec2 aShowDistance[MAX_CLIENTS];
+	bool aShowAll[MAX_CLIENTS];
+	bool aHaveView[MAX_CLIENTS];
+
+	CPrng Prng;
+	uint64_t aSeed[2] = {0, 0};
+	Prng.Seed(aSeed);
+	auto &&Random = [&](float Max) { return Prng.RandomBits() / 4294967296.0f * Max; };
+
+	CSnapViews Views;
+	Views.Clear();
+	for(int i = 0; i < MAX_CLIENTS; i++)
+	{
+		// leave some slots empty, but the last one used
+		aHaveView[i] = i == 70 || (i < 70 && Prng.RandomBits() % 4 != 0);
+		aViewPos[i] = vec2(Random(2000.0f), Random(2000.0f));
+		aShowDistance[i] = vec2(Random(1500.0f), Random(1000.0f));
+		aShowAll[i] = Prng.RandomBits() % 8 == 0;
+		if(aHaveView[i])
+			Views.SetView(i, aViewPos[i], aShowDistance[i], aShowAll[i]);
+	}
+
+	for(int Round = 0; Round < 2000; Round++)
+	{
+		const vec2 Start(Random(2000.0f), Random(2000.0f));
+		// some lines without length
+		const vec2 End = Round % 10 == 0 ? Start : Start + vec2(Random(800.0f) - 400.0f, Random(800.0f) - 400.0f);
+		const CClientMask VisibleMask = Views.VisibleMask(Start);
+		const CClientMask VisibleLineMask = Views.VisibleLineMask(Start, End);
+		for(int i = 0; i < MAX_CLIENTS; i++)
+		{
+			if(!aHaveView[i])
+			{
+				EXPECT_FALSE(VisibleMask.test(i));
+				EXPECT_FALSE(VisibleLineMask.test(i));
+				continue;
+			}
+
+			// NetworkClipped and NetworkClippedLine without the snap views
+			bool Clipped = !aShowAll[i] && (absolute(aViewPos[i].x - Start.x) > aShowDistance[i].x || absolute(aViewPos[i].y - Start.y) > aShowDistance[i].y);
+			vec2 ClosestPoint;
+			const vec2 DistanceToLine = aViewPos[i] - (closest_point_on_line(Start, End, aViewPos[i], ClosestPoint) ? ClosestPoint : Start);
+			const float ClipDistance = maximum(aShowDistance[i].x, aShowDistance[i].y);
+			bool ClippedLine = !aShowAll[i] && (absolute(DistanceToLine.x) > ClipDistance || absolute(DistanceToLine.y) > ClipDistance);
+
+			EXPECT_EQ(Views.Clipped(i, Start), Clipped);
+			EXPECT_EQ(Views.ClippedLine(i, Start, End), ClippedLine);
+			EXPECT_EQ(VisibleMask.test(i), !Clipped);
+			EXPECT_EQ(VisibleLineMask.test(i), !ClippedLine);
+		}
+	}
+}
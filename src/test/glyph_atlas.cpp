@@ -0,0 +1,178 @@
+#include <gtest/gtest.h>
+
+#include <engine/gfx/glyph_atlas.h>
+
+#include <iterator>
+#include <vector>
+
+static const size_t DIMENSION = 128;
+static const size_t NUM_TEXTURES = 2;
+
+static uint8_t Pixel(size_t RectIndex, size_t TextureIndex, size_t x, size_t y)
+{
+	return 1 + (RectIndex * 7 + TextureIndex * 101 + x + y * 13) % 255;
+}
+
+// Glyph rectangles of a full atlas and the textures of their glyphs
+class CFullAtlas
+{
+public:
+	std::vector<SGlyphRect> m_vRects;
+	std::vector<uint8_t> m_avTextureData[NUM_TEXTURES];
+	std::vector<uint8_t> m_avNewTextureData[NUM_TEXTURES];
+
+	CFullAtlas(int KeepEvery)
+	{
+		for(auto &vTextureData : m_avTextureData)
+			vTextureData.resize(DIMENSION * DIMENSION, 0);
+		for(auto &vNewTextureData : m_avNewTextureData)
+			vNewTextureData.resize(DIMENSION * DIMENSION, 0);
+
+		CGlyphAtlas Atlas;
+		Atlas.Clear(DIMENSION);
+		for(size_t i = 0;; i++)
+		{
+			const size_t Width = 6 + i * 5 % 11;
+			const size_t Height = 8 + i * 3 % 13;
+			int X, Y;
+			if(!Atlas.Add(Width, Height, X, Y))
+				break;
+			const size_t RectIndex = m_vRects.size();
+			for(size_t TextureIndex = 0; TextureIndex < NUM_TEXTURES; TextureIndex++)
+			{
+				for(size_t y = 0; y < Height; y++)
+				{
+					for(size_t x = 0; x < Width; x++)
+						m_avTextureData[TextureIndex][X + x + (Y + y) * DIMENSION] = Pixel(RectIndex, TextureIndex, x, y);
+				}
+			}
+			m_vRects.push_back({GlyphRectKey(X, Y), (size_t)X, (size_t)Y, Width, Height, RectIndex, KeepEvery > 0 && RectIndex % KeepEvery == 0});
+		}
+	}
+
+	bool Compact(SGlyphAtlasCompaction &Compaction)
+	{
+		const uint8_t *apTextureData[NUM_TEXTURES];
+		uint8_t *apNewTextureData[NUM_TEXTURES];
+		for(size_t TextureIndex = 0; TextureIndex < NUM_TEXTURES; TextureIndex++)
+		{
+			apTextureData[TextureIndex] = m_avTextureData[TextureIndex].data();
+			apNewTextureData[TextureIndex] = m_avNewTextureData[TextureIndex].data();
+		}
+		std::vector<SGlyphRect> vRects = m_vRects;
+		return CompactGlyphAtlas(vRects, DIMENSION, apTextureData, apNewTextureData, NUM_TEXTURES, Compaction);
+	}
+};
+
+TEST(GlyphAtlas, Compact)
+{
+	CFullAtlas FullAtlas(5);
+	ASSERT_GT(FullAtlas.m_vRects.size(), 50u);
+	SGlyphAtlasCompaction Compaction;
+	ASSERT_TRUE(FullAtlas.Compact(Compaction));
+	EXPECT_FALSE(Compaction.m_EvictedRects.empty());
+	EXPECT_LE(Compaction.m_UsedArea, DIMENSION * DIMENSION / 2);
+
+	std::vector<int> vOwner(DIMENSION * DIMENSION, -1);
+	size_t UsedArea = 0;
+	uint64_t OldestMoved = UINT64_MAX;
+	uint64_t NewestEvicted = 0;
+	for(size_t RectIndex = 0; RectIndex < FullAtlas.m_vRects.size(); RectIndex++)
+	{
+		const SGlyphRect &Rect = FullAtlas.m_vRects[RectIndex];
+		const auto MovedIt = Compaction.m_MovedRects.find(Rect.m_Key);
+		const bool Evicted = Compaction.m_EvictedRects.count(Rect.m_Key) != 0;
+		ASSERT_NE(MovedIt == Compaction.m_MovedRects.end(), !Evicted) << RectIndex;
+		if(Evicted)
+		{
+			EXPECT_FALSE(Rect.m_Keep) << RectIndex;
+			NewestEvicted = std::max(NewestEvicted, Rect.m_LastUsed);
+			continue;
+		}
+		if(!Rect.m_Keep)
+			OldestMoved = std::min(OldestMoved, Rect.m_LastUsed);
+
+		// the new rectangle is inside the texture, not shared with another one
+		// and holds the same glyph
+		const size_t NewX = GlyphRectX(MovedIt->second);
+		const size_t NewY = GlyphRectY(MovedIt->second);
+		ASSERT_LE(NewX + Rect.m_Width, DIMENSION) << RectIndex;
+		ASSERT_LE(NewY + Rect.m_Height, DIMENSION) << RectIndex;
+		for(size_t y = 0; y < Rect.m_Height; y++)
+		{
+			for(size_t x = 0; x < Rect.m_Width; x++)
+			{
+				int &Owner = vOwner[NewX + x + (NewY + y) * DIMENSION];
+				ASSERT_EQ(Owner, -1) << RectIndex;
+				Owner = RectIndex;
+				for(size_t TextureIndex = 0; TextureIndex < NUM_TEXTURES; TextureIndex++)
+					ASSERT_EQ(FullAtlas.m_avNewTextureData[TextureIndex][NewX + x + (NewY + y) * DIMENSION], Pixel(RectIndex, TextureIndex, x, y)) << RectIndex;
+			}
+		}
+		UsedArea += Rect.m_Width * Rect.m_Height;
+	}
+	EXPECT_EQ(Compaction.m_UsedArea, UsedArea);
+	// the most recently used glyphs are kept
+	EXPECT_GT(OldestMoved, NewestEvicted);
+
+	// the compacted atlas can be filled again
+	int X, Y;
+	EXPECT_TRUE(Compaction.m_Atlas.Add(32, 32, X, Y));
+	for(size_t y = 0; y < 32; y++)
+	{
+		for(size_t x = 0; x < 32; x++)
+			ASSERT_EQ(vOwner[X + x + (Y + y) * DIMENSION], -1);
+	}
+}
+
+TEST(GlyphAtlas, CompactKeepsUsedGlyphs)
+{
+	// nothing can be evicted
+	CFullAtlas AllUsed(1);
+	SGlyphAtlasCompaction Compaction;
+	EXPECT_FALSE(AllUsed.Compact(Compaction));
+
+	CFullAtlas NoneUsed(0);
+	ASSERT_TRUE(NoneUsed.Compact(Compaction));
+	EXPECT_FALSE(Compaction.m_MovedRects.empty());
+}
+
+struct STestVertex
+{
+	float m_U;
+	float m_V;
+};
+
+TEST(GlyphAtlas, MoveGlyphQuad)
+{
+	CFullAtlas FullAtlas(3);
+	SGlyphAtlasCompaction Compaction;
+	ASSERT_TRUE(FullAtlas.Compact(Compaction));
+
+	for(const SGlyphRect &Rect : FullAtlas.m_vRects)
+	{
+		// the vertices of a text quad, like CTextRender creates them
+		const float U0 = Rect.m_X, V0 = Rect.m_Y;
+		const float U1 = Rect.m_X + Rect.m_Width, V1 = Rect.m_Y + Rect.m_Height;
+		STestVertex aVertices[4] = {{U0, V1}, {U1, V1}, {U1, V0}, {U0, V0}};
+		const auto MovedIt = Compaction.m_MovedRects.find(Rect.m_Key);
+		EXPECT_EQ(MoveGlyphQuad(aVertices, Compaction.m_MovedRects), MovedIt != Compaction.m_MovedRects.end());
+		if(MovedIt == Compaction.m_MovedRects.end())
+		{
+			EXPECT_EQ(aVertices[3].m_U, U0);
+			EXPECT_EQ(aVertices[3].m_V, V0);
+			continue;
+		}
+
+		const float NewU0 = GlyphRectX(MovedIt->second), NewV0 = GlyphRectY(MovedIt->second);
+		const float NewU1 = NewU0 + Rect.m_Width, NewV1 = NewV0 + Rect.m_Height;
+		const STestVertex aExpected[4] = {{NewU0, NewV1}, {NewU1, NewV1}, {NewU1, NewV0}, {NewU0, NewV0}};
+		for(size_t i = 0; i < std::size(aVertices); i++)
+		{
+			EXPECT_EQ(aVertices[i].m_U, aExpected[i].m_U);
+			EXPECT_EQ(aVertices[i].m_V, aExpected[i].m_V);
+		}
+		// the glyph is found again by its new rectangle
+		EXPECT_EQ(GlyphRectKey(aVertices[3].m_U, aVertices[3].m_V), MovedIt->second);
+	}
+}
@@ -7,6 +7,7 @@
 #include <engine/shared/jobs.h>
 
 #include <functional>
+#include <thread>
 
 static const int TEST_NUM_THREADS = 4;
 
@@ -163,3 +164,111 @@ TEST_F(Jobs, Many)
 	}
 	SetUp();
 }
+
+TEST_F(Jobs, Priority)
+{
+	CJobPool Pool;
+	Pool.Init(1);
+
+	// keep the only worker busy until both jobs are queued
+	SEMAPHORE Started;
+	SEMAPHORE Release;
+	sphore_init(&Started);
+	sphore_init(&Release);
+	Pool.Add(std::make_shared<CJob>([&] {
+		sphore_signal(&Started);
+		sphore_wait(&Release);
+	}));
+	sphore_wait(&Started);
+
+	std::atomic<int> Order(0);
+	int BackgroundOrder = -1;
+	int InteractiveOrder = -1;
+	auto pBackground = std::make_shared<CJob>([&] { BackgroundOrder = Order.fetch_add(1); });
+	auto pInteractive = std::make_shared<CJob>([&] { InteractiveOrder = Order.fetch_add(1); });
+	pInteractive->SetPriority(IJob::PRIORITY_INTERACTIVE);
+	EXPECT_EQ(pBackground->Priority(), IJob::PRIORITY_BACKGROUND);
+	Pool.Add(pBackground);
+	Pool.Add(pInteractive);
+	sphore_signal(&Release);
+
+	Pool.Shutdown();
+	EXPECT_EQ(InteractiveOrder, 0);
+	EXPECT_EQ(BackgroundOrder, 1);
+	sphore_destroy(&Started);
+	sphore_destroy(&Release);
+}
+
+TEST_F(Jobs, ParallelFor)
+{
+	for(int GrainSize : {1, 3, 64, 1000})
+	{
+		std::vector<std::atomic<int>> vVisited(1000);
+		m_Pool.ParallelFor(vVisited.size(), GrainSize, [&](int Begin, int End) {
+			EXPECT_LE(End - Begin, GrainSize);
+			for(int i = Begin; i < End; i++)
+				vVisited[i].fetch_add(1);
+		});
+		for(const auto &Visited : vVisited)
+			EXPECT_EQ(Visited.load(), 1);
+	}
+	m_Pool.ParallelFor(0, 1, [](int Begin, int End) { ADD_FAILURE(); });
+}
+
+TEST_F(Jobs, ParallelForNested)
+{
+	// every worker can be blocked in an outer range, the inner ranges must
+	// still finish
+	std::atomic<int> Sum(0);
+	m_Pool.ParallelFor(TEST_NUM_THREADS * 2, 1, [&](int OuterBegin, int OuterEnd) {
+		m_Pool.ParallelFor(100, 7, [&](int Begin, int End) {
+			Sum.fetch_add(End - Begin);
+		});
+	});
+	EXPECT_EQ(Sum.load(), TEST_NUM_THREADS * 2 * 100);
+}
+
+TEST_F(Jobs, Stress)
+{
+	// many small jobs, added from outside of the pool and from jobs
+	static const int NUM_ADDERS = 4;
+	static const int NUM_JOBS = 20000;
+	std::atomic<int> NumRun(0);
+	std::vector<std::shared_ptr<IJob>> vpJobs;
+	vpJobs.reserve(NUM_ADDERS * NUM_JOBS * 2);
+	for(int i = 0; i < NUM_ADDERS * NUM_JOBS; i++)
+	{
+		auto pChild = std::make_shared<CJob>([&] { NumRun.fetch_add(1); });
+		auto pParent = std::make_shared<CJob>([&, pChild] {
+			NumRun.fetch_add(1);
+			m_Pool.Add(pChild);
+		});
+		if(i % 8 == 0)
+			pParent->SetPriority(IJob::PRIORITY_INTERACTIVE);
+		vpJobs.push_back(pParent);
+		vpJobs.push_back(pChild);
+	}
+
+	const int64_t StartTime = time_get();
+	std::vector<std::thread> vAdders;
+	for(int Adder = 0; Adder < NUM_ADDERS; Adder++)
+	{
+		vAdders.emplace_back([&, Adder] {
+			for(int i = 0; i < NUM_JOBS; i++)
+				m_Pool.Add(vpJobs[(Adder * NUM_JOBS + i) * 2]);
+		});
+	}
+	for(auto &Adder : vAdders)
+		Adder.join();
+	while(NumRun.load() < NUM_ADDERS * NUM_JOBS * 2)
+		thread_yield();
+	const int64_t Duration = time_get() - StartTime;
+
+	for(auto &pJob : vpJobs)
+	{
+		while(pJob->State() == IJob::STATE_RUNNING)
+			thread_yield();
+		EXPECT_EQ(pJob->State(), IJob::STATE_DONE);
+	}
+	dbg_msg("test", "ran %d jobs in %.2f ms", NUM_ADDERS * NUM_JOBS * 2, Duration * 1000.0 / time_freq());
+}
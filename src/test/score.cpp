@@ -1,3 +1,4 @@
+#include "test.h"
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 
@@ -9,6 +10,10 @@
 
 #include <sqlite3.h>
 
+#include <chrono>
+#include <thread>
+#include <vector>
+
 #if defined(CONF_TEST_MYSQL)
 int DummyMysqlInit = (MysqlInit(), 1);
 #endif
@@ -609,6 +614,405 @@ TEST_P(RandomMap, UnfinishedDoesntExist)
 	EXPECT_STREQ(m_pRandomMapResult->m_aMessage, "nameless tee has no more unfinished maps on this server!");
 }
 
+struct RankIndexScore : public Score
+{
+	CRankIndex m_Global;
+	CRankIndex m_Regional;
+
+	void Insert(const char *pName, float Time, const char *pServer)
+	{
+		str_copy(g_Config.m_SvSqlServerName, pServer, sizeof(g_Config.m_SvSqlServerName));
+		CSqlScoreData ScoreData(std::make_shared<CScorePlayerResult>());
+		str_copy(ScoreData.m_aMap, "Kobra 3", sizeof(ScoreData.m_aMap));
+		str_copy(ScoreData.m_aGameUuid, "8d300ecf-5873-4297-bee5-95668fdff320", sizeof(ScoreData.m_aGameUuid));
+		str_copy(ScoreData.m_aName, pName, sizeof(ScoreData.m_aName));
+		ScoreData.m_ClientId = 0;
+		ScoreData.m_Time = Time;
+		str_copy(ScoreData.m_aTimestamp, "2021-11-24 19:24:08", sizeof(ScoreData.m_aTimestamp));
+		for(float &TimeCp : ScoreData.m_aCurrentTimeCp)
+			TimeCp = 0.0f;
+		str_copy(ScoreData.m_aRequestingPlayer, pName, sizeof(ScoreData.m_aRequestingPlayer));
+		ASSERT_TRUE(CScoreWorker::SaveScore(m_pConn, &ScoreData, Write::NORMAL, m_aError, sizeof(m_aError))) << m_aError;
+	}
+
+	void Load()
+	{
+		auto pResult = std::make_shared<CScoreRankIndexResult>();
+		CSqlRankIndexRequest Request(pResult);
+		str_copy(Request.m_aMap, "Kobra 3", sizeof(Request.m_aMap));
+		str_copy(Request.m_aServer, "GER", sizeof(Request.m_aServer));
+		ASSERT_TRUE(CScoreWorker::LoadRankIndex(m_pConn, &Request, m_aError, sizeof(m_aError))) << m_aError;
+		m_Global.Load(std::move(pResult->m_vGlobal));
+		m_Regional.Load(std::move(pResult->m_vRegional));
+	}
+
+	void ExpectSameRank(const char *pName)
+	{
+		auto pDbResult = std::make_shared<CScorePlayerResult>();
+		CSqlPlayerRequest Request(pDbResult);
+		str_copy(Request.m_aMap, "Kobra 3", sizeof(Request.m_aMap));
+		str_copy(Request.m_aName, pName, sizeof(Request.m_aName));
+		str_copy(Request.m_aRequestingPlayer, "brainless tee", sizeof(Request.m_aRequestingPlayer));
+		str_copy(Request.m_aServer, "GER", sizeof(Request.m_aServer));
+		ASSERT_TRUE(CScoreWorker::ShowRank(m_pConn, &Request, m_aError, sizeof(m_aError))) << m_aError;
+
+		auto pIndexResult = std::make_shared<CScorePlayerResult>();
+		int Rank, RegionalRank;
+		float Time, RegionalTime, PercentRank, RegionalPercentRank;
+		if(m_Global.Rank(pName, &Rank, &Time, &PercentRank))
+		{
+			char aRegionalRank[16];
+			if(m_Regional.Rank(pName, &RegionalRank, &RegionalTime, &RegionalPercentRank))
+				str_format(aRegionalRank, sizeof(aRegionalRank), "rank %d", RegionalRank);
+			else
+				str_copy(aRegionalRank, "unranked", sizeof(aRegionalRank));
+			CScoreWorker::FormatRank(pIndexResult.get(), &Request, Rank, Time, PercentRank, aRegionalRank);
+		}
+		else
+		{
+			CScoreWorker::FormatNotRanked(pIndexResult.get(), &Request);
+		}
+
+		EXPECT_EQ(pDbResult->m_MessageKind, pIndexResult->m_MessageKind);
+		for(int i = 0; i < CScorePlayerResult::MAX_MESSAGES; i++)
+			EXPECT_STREQ(pDbResult->m_Data.m_aaMessages[i], pIndexResult->m_Data.m_aaMessages[i]) << pName;
+	}
+
+	void ExpectSameTop(int Offset)
+	{
+		auto pDbResult = std::make_shared<CScorePlayerResult>();
+		CSqlPlayerRequest Request(pDbResult);
+		str_copy(Request.m_aMap, "Kobra 3", sizeof(Request.m_aMap));
+		str_copy(Request.m_aServer, "GER", sizeof(Request.m_aServer));
+		Request.m_Offset = Offset;
+		ASSERT_TRUE(CScoreWorker::ShowTop(m_pConn, &Request, m_aError, sizeof(m_aError))) << m_aError;
+
+		const CRankIndex::CEntry *apEntries[5];
+		int aRanks[5];
+		int Line = 1;
+		int Num = m_Global.Top(Offset, 5, apEntries, aRanks);
+		char aLine[512];
+		for(int i = 0; i < Num; i++)
+		{
+			CScoreWorker::FormatTopLine(aLine, sizeof(aLine), aRanks[i], apEntries[i]->m_aName, apEntries[i]->m_Time);
+			EXPECT_STREQ(pDbResult->m_Data.m_aaMessages[Line++], aLine) << Offset;
+		}
+		EXPECT_STREQ(pDbResult->m_Data.m_aaMessages[Line++], "------------ GER Top ------------");
+		Num = m_Regional.Top(Offset, 3, apEntries, aRanks);
+		for(int i = 0; i < Num; i++)
+		{
+			CScoreWorker::FormatTopLine(aLine, sizeof(aLine), aRanks[i], apEntries[i]->m_aName, apEntries[i]->m_Time);
+			EXPECT_STREQ(pDbResult->m_Data.m_aaMessages[Line++], aLine) << Offset;
+		}
+		if(Line < CScorePlayerResult::MAX_MESSAGES)
+		{
+			EXPECT_STREQ(pDbResult->m_Data.m_aaMessages[Line], "");
+		}
+	}
+};
+
+TEST_P(RankIndexScore, MatchesDatabase)
+{
+	g_Config.m_SvRegionalRankings = true;
+	g_Config.m_SvHideScore = false;
+	Insert("nameless tee", 120.0f, "GER");
+	Insert("brainless tee", 100.0f, "USA");
+	Insert("nameless tee", 90.5f, "USA");
+	Insert("headless tee", 110.25f, "GER2");
+	Insert("careless tee", 200.0f, "GER");
+	Insert("useless tee", 300.0f, "USA");
+	Load();
+	EXPECT_EQ(m_Global.NumRanked(), 5);
+	EXPECT_EQ(m_Regional.NumRanked(), 3);
+
+	for(const char *pName : {"nameless tee", "brainless tee", "headless tee", "careless tee", "useless tee", "pointless tee"})
+		ExpectSameRank(pName);
+	for(int Offset : {1, 2, 4, -1, -3})
+		ExpectSameTop(Offset);
+
+	// incremental updates have to match the database after the same finishes
+	Insert("pointless tee", 95.123f, "GER");
+	Insert("careless tee", 80.0f, "GER");
+	Insert("useless tee", 400.0f, "GER");
+	m_Global.Update("pointless tee", CRankIndex::RoundTime(95.123f));
+	m_Regional.Update("pointless tee", CRankIndex::RoundTime(95.123f));
+	m_Global.Update("careless tee", CRankIndex::RoundTime(80.0f));
+	m_Regional.Update("careless tee", CRankIndex::RoundTime(80.0f));
+	m_Global.Update("useless tee", CRankIndex::RoundTime(400.0f));
+	m_Regional.Update("useless tee", CRankIndex::RoundTime(400.0f));
+	for(const char *pName : {"nameless tee", "brainless tee", "headless tee", "careless tee", "useless tee", "pointless tee"})
+		ExpectSameRank(pName);
+	for(int Offset : {1, 2, -1})
+		ExpectSameTop(Offset);
+}
+
+TEST(RankIndex, EqualTimesShareRank)
+{
+	CRankIndex Index;
+	Index.Load({{10.0f, "a"}, {5.0f, "b"}, {10.0f, "c"}, {20.0f, "d"}});
+	int Rank;
+	float Time, PercentRank;
+	ASSERT_TRUE(Index.Rank("c", &Rank, &Time, &PercentRank));
+	EXPECT_EQ(Rank, 2);
+	EXPECT_FLOAT_EQ(PercentRank, 1.0f / 3.0f);
+	ASSERT_TRUE(Index.Rank("d", &Rank, &Time, &PercentRank));
+	EXPECT_EQ(Rank, 4);
+	EXPECT_FALSE(Index.Rank("e", &Rank, &Time, &PercentRank));
+
+	const CRankIndex::CEntry *apEntries[5];
+	int aRanks[5];
+	ASSERT_EQ(Index.Top(1, 5, apEntries, aRanks), 4);
+	EXPECT_EQ(aRanks[0], 1);
+	EXPECT_EQ(aRanks[1], 2);
+	EXPECT_EQ(aRanks[2], 2);
+	EXPECT_EQ(aRanks[3], 4);
+
+	Index.Update("d", 1.0f);
+	Index.Update("a", 30.0f);
+	ASSERT_TRUE(Index.Rank("d", &Rank, &Time, &PercentRank));
+	EXPECT_EQ(Rank, 1);
+	ASSERT_TRUE(Index.Rank("a", &Rank, &Time, &PercentRank));
+	EXPECT_EQ(Rank, 3);
+	EXPECT_FLOAT_EQ(Time, 10.0f);
+}
+
+// Runs the queries of finishing the map and asking for the rank repeatedly,
+// returns the time taken
+static std::chrono::nanoseconds RunScoreWorkload(IDbConnection *pConn, int Iterations, std::shared_ptr<CScorePlayerResult> &pLastResult)
+{
+	char aError[256] = {};
+	EXPECT_TRUE(pConn->Connect(aError, sizeof(aError))) << aError;
+	const auto Start = time_get_nanoseconds();
+	for(int i = 0; i < Iterations; i++)
+	{
+		CSqlScoreData ScoreData(std::make_shared<CScorePlayerResult>());
+		str_copy(ScoreData.m_aMap, "Kobra 3");
+		str_copy(ScoreData.m_aGameUuid, "8d300ecf-5873-4297-bee5-95668fdff320");
+		str_format(ScoreData.m_aName, sizeof(ScoreData.m_aName), "tee %d", i % 16);
+		ScoreData.m_ClientId = 0;
+		ScoreData.m_Time = 100.0f + i;
+		str_copy(ScoreData.m_aTimestamp, "2021-11-24 19:24:08");
+		for(float &TimeCp : ScoreData.m_aCurrentTimeCp)
+			TimeCp = 0.0f;
+		str_copy(ScoreData.m_aRequestingPlayer, ScoreData.m_aName);
+		EXPECT_TRUE(CScoreWorker::SaveScore(pConn, &ScoreData, Write::NORMAL, aError, sizeof(aError))) << aError;
+
+		pLastResult = std::make_shared<CScorePlayerResult>();
+		CSqlPlayerRequest PlayerRequest(pLastResult);
+		str_copy(PlayerRequest.m_aMap, "Kobra 3");
+		str_copy(PlayerRequest.m_aName, ScoreData.m_aName);
+		str_copy(PlayerRequest.m_aRequestingPlayer, ScoreData.m_aName);
+		str_copy(PlayerRequest.m_aServer, "GER");
+		EXPECT_TRUE(CScoreWorker::ShowRank(pConn, &PlayerRequest, aError, sizeof(aError))) << aError;
+		EXPECT_TRUE(CScoreWorker::ShowTop(pConn, &PlayerRequest, aError, sizeof(aError))) << aError;
+	}
+	const auto Duration = time_get_nanoseconds() - Start;
+	pConn->Disconnect();
+	return Duration;
+}
+
+TEST(SQLite, StatementCacheBenchmark)
+{
+	const int Iterations = 200;
+	g_Config.m_SvRegionalRankings = false;
+	CTestInfo Info;
+	char aUncachedFile[IO_MAX_PATH_LENGTH];
+	char aCachedFile[IO_MAX_PATH_LENGTH];
+	Info.Filename(aUncachedFile, sizeof(aUncachedFile), "-uncached.sqlite");
+	Info.Filename(aCachedFile, sizeof(aCachedFile), "-cached.sqlite");
+
+	std::shared_ptr<CScorePlayerResult> pUncachedResult;
+	std::shared_ptr<CScorePlayerResult> pCachedResult;
+	std::chrono::nanoseconds Uncached, Cached;
+	{
+		// a single statement is only reused for consecutive identical queries
+		auto pUncached = CreateSqliteConnection(aUncachedFile, true, 1);
+		auto pCached = CreateSqliteConnection(aCachedFile, true);
+		Uncached = RunScoreWorkload(pUncached.get(), Iterations, pUncachedResult);
+		Cached = RunScoreWorkload(pCached.get(), Iterations, pCachedResult);
+	}
+	dbg_msg("test", "score workload with %d iterations: %.2fms without statement cache, %.2fms with statement cache",
+		Iterations, Uncached.count() / 1e6, Cached.count() / 1e6);
+
+	// caching must not change any results
+	ASSERT_TRUE(pUncachedResult && pCachedResult);
+	for(int i = 0; i < CScorePlayerResult::MAX_MESSAGES; i++)
+		EXPECT_STREQ(pUncachedResult->m_Data.m_aaMessages[i], pCachedResult->m_Data.m_aaMessages[i]);
+
+	for(const char *pFile : {aUncachedFile, aCachedFile})
+	{
+		char aBuf[IO_MAX_PATH_LENGTH];
+		EXPECT_FALSE(fs_remove(pFile));
+		str_format(aBuf, sizeof(aBuf), "%s-wal", pFile);
+		fs_remove(aBuf);
+		str_format(aBuf, sizeof(aBuf), "%s-shm", pFile);
+		fs_remove(aBuf);
+	}
+}
+
+struct CTestWriteData : ISqlData
+{
+	CTestWriteData(int Value, bool Fail) :
+		ISqlData(std::make_shared<ISqlResult>()), m_Value(Value), m_Fail(Fail)
+	{
+	}
+
+	int m_Value;
+	bool m_Fail;
+};
+
+// writes the value like the score worker writes a finish, with a copy in
+// the backup table of the backup database until the write succeeded
+static bool TestWrite(IDbConnection *pSqlServer, const ISqlData *pGameData, Write w, char *pError, int ErrorSize)
+{
+	const auto *pData = dynamic_cast<const CTestWriteData *>(pGameData);
+	int NumUpdated;
+	switch(w)
+	{
+	case Write::BACKUP_FIRST:
+		if(!pSqlServer->PrepareStatement("INSERT INTO test_writes_backup(Value) VALUES (?)", pError, ErrorSize))
+			return false;
+		break;
+	case Write::NORMAL:
+		if(pData->m_Fail)
+		{
+			str_copy(pError, "failing on purpose", ErrorSize);
+			return false;
+		}
+		if(!pSqlServer->PrepareStatement("INSERT INTO test_writes(Value) VALUES (?)", pError, ErrorSize))
+			return false;
+		break;
+	case Write::NORMAL_SUCCEEDED:
+		if(!pSqlServer->PrepareStatement("DELETE FROM test_writes_backup WHERE Value = ?", pError, ErrorSize))
+			return false;
+		break;
+	case Write::NORMAL_FAILED:
+		if(!pSqlServer->PrepareStatement("INSERT INTO test_writes(Value) SELECT Value FROM test_writes_backup WHERE Value = ?", pError, ErrorSize))
+			return false;
+		pSqlServer->BindInt(1, pData->m_Value);
+		if(!pSqlServer->ExecuteUpdate(&NumUpdated, pError, ErrorSize))
+			return false;
+		if(!pSqlServer->PrepareStatement("DELETE FROM test_writes_backup WHERE Value = ?", pError, ErrorSize))
+			return false;
+		break;
+	}
+	pSqlServer->BindInt(1, pData->m_Value);
+	return pSqlServer->ExecuteUpdate(&NumUpdated, pError, ErrorSize);
+}
+
+// Queues writes on a connection pool with a sqlite write and backup database,
+// the writes are committed in one batch
+struct WriteBatch : public testing::Test
+{
+	CTestInfo m_Info;
+	char m_aWriteFile[64];
+	char m_aBackupFile[64];
+	char m_aError[256] = {};
+	int m_WriteBatch = g_Config.m_SvSqlWriteBatch;
+	int m_WriteBatchDelay = g_Config.m_SvSqlWriteBatchDelay;
+
+	WriteBatch()
+	{
+		m_Info.Filename(m_aWriteFile, sizeof(m_aWriteFile), "-write.sqlite");
+		m_Info.Filename(m_aBackupFile, sizeof(m_aBackupFile), "-backup.sqlite");
+		for(const char *pFile : {m_aWriteFile, m_aBackupFile})
+		{
+			auto pConn = CreateSqliteConnection(pFile, true);
+			EXPECT_TRUE(pConn->Connect(m_aError, sizeof(m_aError))) << m_aError;
+			int NumUpdated;
+			for(const char *pCreate : {"CREATE TABLE test_writes (Value INTEGER NOT NULL)", "CREATE TABLE test_writes_backup (Value INTEGER NOT NULL)"})
+			{
+				EXPECT_TRUE(pConn->PrepareStatement(pCreate, m_aError, sizeof(m_aError))) << m_aError;
+				EXPECT_TRUE(pConn->ExecuteUpdate(&NumUpdated, m_aError, sizeof(m_aError))) << m_aError;
+			}
+			pConn->Disconnect();
+		}
+	}
+
+	~WriteBatch()
+	{
+		g_Config.m_SvSqlWriteBatch = m_WriteBatch;
+		g_Config.m_SvSqlWriteBatchDelay = m_WriteBatchDelay;
+		for(const char *pFile : {m_aWriteFile, m_aBackupFile})
+		{
+			char aBuf[IO_MAX_PATH_LENGTH];
+			EXPECT_FALSE(fs_remove(pFile));
+			str_format(aBuf, sizeof(aBuf), "%s-wal", pFile);
+			fs_remove(aBuf);
+			str_format(aBuf, sizeof(aBuf), "%s-shm", pFile);
+			fs_remove(aBuf);
+		}
+	}
+
+	// executes the writes, the worker waits until all of them are queued
+	// and commits them in one transaction
+	void ExecuteWrites(std::initializer_list<bool> Fails)
+	{
+		g_Config.m_SvSqlWriteBatch = Fails.size();
+		g_Config.m_SvSqlWriteBatchDelay = 1000;
+		std::vector<std::shared_ptr<ISqlResult>> vpResults;
+		{
+			CDbConnectionPool Pool;
+			Pool.RegisterSqliteDatabase(CDbConnectionPool::WRITE, m_aWriteFile);
+			Pool.RegisterSqliteDatabase(CDbConnectionPool::WRITE_BACKUP, m_aBackupFile);
+			int Value = 1;
+			for(bool Fail : Fails)
+			{
+				auto pData = std::make_unique<CTestWriteData>(Value++, Fail);
+				vpResults.push_back(pData->m_pResult);
+				Pool.ExecuteWrite(TestWrite, std::move(pData), "test write");
+			}
+			// writes are moved to the backup database during shutdown,
+			// wait for them to finish first
+			const auto Deadline = time_get_nanoseconds() + std::chrono::seconds(10);
+			for(const auto &pResult : vpResults)
+			{
+				while(!pResult->m_Completed.load() && time_get_nanoseconds() < Deadline)
+					std::this_thread::sleep_for(std::chrono::milliseconds(1));
+			}
+		}
+		for(const auto &pResult : vpResults)
+		{
+			EXPECT_TRUE(pResult->m_Completed.load());
+			EXPECT_TRUE(pResult->m_Success);
+		}
+	}
+
+	std::vector<int> Values(const char *pFile, const char *pTable)
+	{
+		std::vector<int> vValues;
+		auto pConn = CreateSqliteConnection(pFile, false);
+		EXPECT_TRUE(pConn->Connect(m_aError, sizeof(m_aError))) << m_aError;
+		char aBuf[128];
+		str_format(aBuf, sizeof(aBuf), "SELECT Value FROM %s ORDER BY Value", pTable);
+		EXPECT_TRUE(pConn->PrepareStatement(aBuf, m_aError, sizeof(m_aError))) << m_aError;
+		bool End;
+		while(pConn->Step(&End, m_aError, sizeof(m_aError)) && !End)
+			vValues.push_back(pConn->GetInt(1));
+		pConn->Disconnect();
+		return vValues;
+	}
+};
+
+TEST_F(WriteBatch, Commit)
+{
+	ExecuteWrites({false, false, false, false});
+	EXPECT_EQ(Values(m_aWriteFile, "test_writes"), (std::vector<int>{1, 2, 3, 4}));
+	EXPECT_TRUE(Values(m_aBackupFile, "test_writes").empty());
+	EXPECT_TRUE(Values(m_aBackupFile, "test_writes_backup").empty());
+}
+
+TEST_F(WriteBatch, FailingWrite)
+{
+	// the third write fails the transaction, it is rolled back and the writes
+	// are executed one by one. the first two are written once, the failing
+	// one and the following ones in fail mode end up in the backup database
+	ExecuteWrites({false, false, true, false});
+	EXPECT_EQ(Values(m_aWriteFile, "test_writes"), (std::vector<int>{1, 2}));
+	EXPECT_EQ(Values(m_aBackupFile, "test_writes"), (std::vector<int>{3, 4}));
+	EXPECT_TRUE(Values(m_aBackupFile, "test_writes_backup").empty());
+}
+
 auto g_pSqliteConn = CreateSqliteConnection(":memory:", true);
 #if defined(CONF_TEST_MYSQL)
 CMysqlConfig gMysqlConfig{
@@ -650,3 +1054,4 @@ INSTANTIATE(MapInfo);
 INSTANTIATE(MapVote);
 INSTANTIATE(Points);
 INSTANTIATE(RandomMap);
+INSTANTIATE(RankIndexScore);
@@ -0,0 +1,87 @@
+#include <gtest/gtest.h>
+
+#include <engine/server/server.h>
+
+#include <vector>
+
+static std::vector<int> AckedSnapshots(const CServer::CClient &Client)
+{
+	return std::vector<int>(Client.m_aAckedSnapshots, Client.m_aAckedSnapshots + Client.m_NumAckedSnapshots);
+}
+
+TEST(ServerClient, AckSnapshotOutOfOrder)
+{
+	CServer::CClient Client;
+	Client.Reset();
+	Client.AckSnapshot(10);
+	Client.AckSnapshot(14);
+	Client.AckSnapshot(12);
+	EXPECT_EQ(AckedSnapshots(Client), (std::vector<int>{10, 12, 14}));
+	EXPECT_EQ(Client.m_LastAckedSnapshot, 12);
+	EXPECT_EQ(Client.m_SnapRate, (int)CServer::CClient::SNAPRATE_FULL);
+
+	Client.AckSnapshot(8);
+	EXPECT_EQ(AckedSnapshots(Client), (std::vector<int>{8, 10, 12, 14}));
+}
+
+TEST(ServerClient, AckSnapshotDuplicate)
+{
+	CServer::CClient Client;
+	Client.Reset();
+	Client.AckSnapshot(10);
+	Client.AckSnapshot(12);
+	Client.AckSnapshot(12);
+	Client.AckSnapshot(10);
+	EXPECT_EQ(AckedSnapshots(Client), (std::vector<int>{10, 12}));
+}
+
+TEST(ServerClient, AckSnapshotFull)
+{
+	CServer::CClient Client;
+	Client.Reset();
+	std::vector<int> vExpected;
+	for(int i = 0; i < CServer::CClient::MAX_ACKED_SNAPSHOTS; i++)
+	{
+		Client.AckSnapshot(20 + 2 * i);
+		vExpected.push_back(20 + 2 * i);
+	}
+	EXPECT_EQ(AckedSnapshots(Client), vExpected);
+
+	// older than all kept ticks, nothing to drop for it
+	Client.AckSnapshot(18);
+	EXPECT_EQ(AckedSnapshots(Client), vExpected);
+
+	// the oldest tick makes room for a newer one
+	Client.AckSnapshot(100);
+	vExpected.erase(vExpected.begin());
+	vExpected.push_back(100);
+	EXPECT_EQ(AckedSnapshots(Client), vExpected);
+
+	// also when the newer one arrives late
+	Client.AckSnapshot(23);
+	vExpected.erase(vExpected.begin());
+	vExpected.insert(vExpected.begin(), 23);
+	EXPECT_EQ(AckedSnapshots(Client), vExpected);
+	EXPECT_EQ(Client.m_NumAckedSnapshots, (int)CServer::CClient::MAX_ACKED_SNAPSHOTS);
+}
+
+TEST(ServerClient, AckSnapshotReset)
+{
+	CServer::CClient Client;
+	Client.Reset();
+	Client.AckSnapshot(10);
+	Client.AckSnapshot(12);
+	Client.m_LastDeltaTick = 12;
+
+	// the client lost its snapshots and wants a full one
+	Client.AckSnapshot(-1);
+	EXPECT_TRUE(AckedSnapshots(Client).empty());
+	EXPECT_EQ(Client.m_LastAckedSnapshot, -1);
+	EXPECT_EQ(Client.m_LastDeltaTick, -1);
+
+	Client.AckSnapshot(0);
+	EXPECT_TRUE(AckedSnapshots(Client).empty());
+
+	Client.AckSnapshot(30);
+	EXPECT_EQ(AckedSnapshots(Client), (std::vector<int>{30}));
+}
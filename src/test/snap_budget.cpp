@@ -0,0 +1,106 @@
+#include <gtest/gtest.h>
+
+#include <engine/server/snap_budget.h>
+#include <engine/shared/protocol.h>
+
+static const int TICK_SPEED = 50;
+
+TEST(SnapBudget, Loss)
+{
+	CSnapBudget Budget;
+	for(int Tick = 2; Tick <= 400; Tick += 2)
+	{
+		Budget.OnSnap(Tick, 100, 1);
+		// nothing arrives during the second half of every two seconds
+		if(Tick % 100 < 50)
+			Budget.OnAck(Tick, 50);
+	}
+	EXPECT_GT(Budget.LossPercent(), 15);
+	EXPECT_LT(Budget.LossPercent(), 35);
+	EXPECT_EQ(Budget.Latency(), 50);
+	EXPECT_EQ(Budget.AverageSize(), 100);
+	EXPECT_EQ(Budget.FragmentedPercent(), 0);
+
+	Budget.Reset();
+	EXPECT_EQ(Budget.LossPercent(), 0);
+}
+
+TEST(SnapBudget, NewerAck)
+{
+	CSnapBudget Budget;
+	for(int Tick = 2; Tick <= 400; Tick += 2)
+	{
+		Budget.OnSnap(Tick, 100, 1);
+		// the client only acknowledges every second snapshot and
+		// the acknowledgements arrive out of order
+		if(Tick % 8 == 0)
+		{
+			Budget.OnAck(Tick, 50);
+			Budget.OnAck(Tick - 4, 50);
+		}
+	}
+	EXPECT_EQ(Budget.LossPercent(), 0);
+	EXPECT_EQ(Budget.Latency(), 50);
+}
+
+TEST(SnapBudget, Interval)
+{
+	CSnapBudget Budget;
+	int Tick = 0;
+	int Sent = 0;
+	for(int i = 0; i < 50 * 10; i++)
+	{
+		Tick += 2;
+		if(!Budget.ShouldSnap())
+			continue;
+		Sent++;
+		Budget.OnSnap(Tick, 100, 1);
+		if(Sent % 20 == 0)
+			Budget.OnAck(Tick, 50);
+		Budget.Adapt(Tick, TICK_SPEED);
+	}
+	EXPECT_EQ(Budget.Interval(), (int)CSnapBudget::MAX_INTERVAL);
+
+	// the link recovers
+	for(int i = 0; i < 50 * 20; i++)
+	{
+		Tick += 2;
+		if(!Budget.ShouldSnap())
+			continue;
+		Budget.OnSnap(Tick, 100, 1);
+		Budget.OnAck(Tick, 50);
+		Budget.Adapt(Tick, TICK_SPEED);
+	}
+	EXPECT_EQ(Budget.Interval(), 1);
+}
+
+TEST(SnapBudget, ViewScale)
+{
+	CSnapBudget Budget;
+	int Tick = 0;
+	for(int i = 0; i < 10; i++)
+	{
+		Tick += 2;
+		Budget.OnSnap(Tick, MAX_SNAPSHOT_PACKSIZE * 2, 3);
+		Budget.OnAck(Tick, 50);
+		Budget.Adapt(Tick, TICK_SPEED);
+	}
+	EXPECT_LT(Budget.ViewScale(), 0.5f);
+	EXPECT_GT(Budget.FragmentedPercent(), 0);
+
+	// stays the same while the snapshots are close to the budget
+	const float Scale = Budget.ViewScale();
+	Tick += 2;
+	Budget.OnSnap(Tick, MAX_SNAPSHOT_PACKSIZE - 10, 1);
+	Budget.Adapt(Tick, TICK_SPEED);
+	EXPECT_EQ(Budget.ViewScale(), Scale);
+
+	for(int i = 0; i < 100; i++)
+	{
+		Tick += 2;
+		Budget.OnSnap(Tick, 100, 1);
+		Budget.OnAck(Tick, 50);
+		Budget.Adapt(Tick, TICK_SPEED);
+	}
+	EXPECT_EQ(Budget.ViewScale(), 1.0f);
+}
@@ -1,14 +1,19 @@
+#include "test.h"
 #include <gtest/gtest.h>
 
 #include <base/detect.h>
 #include <engine/external/json-parser/json.h>
 #include <engine/server.h>
 #include <engine/shared/config.h>
+#include <engine/shared/teehistorian_reader.h>
 #include <game/gamecore.h>
 #include <game/server/teehistorian.h>
+#include <game/server/teehistorian_writer.h>
 
 #include <vector>
 
+#include <zlib.h>
+
 void RegisterGameUuids(CUuidManager *pManager);
 
 class TeeHistorian : public ::testing::Test
@@ -904,3 +909,128 @@ TEST_F(TeeHistorian, PrevGameUuid)
 	EXPECT_STREQ(JsonPrevGameUuid, "fe19c218-f555-4002-a273-126c59ccc17a");
 	json_value_free(pJson);
 }
+
+TEST_F(TeeHistorian, CompressedWriter)
+{
+	for(int i = 1; i < 200; i++)
+	{
+		Tick(i);
+		Player(0, i, -i);
+		Player(1, 2 * i, 3);
+	}
+	Finish();
+
+	CTestInfo Info;
+	IOHANDLE File = io_open(Info.m_aFilename, IOFLAG_WRITE);
+	ASSERT_TRUE(File);
+	CTeeHistorianWriter Writer;
+	Writer.Open(File, 6);
+	const size_t Half = m_vBuffer.size() / 2;
+	Writer.Write(m_vBuffer.data(), Half);
+	Writer.Sync();
+	Writer.Write(m_vBuffer.data() + Half, m_vBuffer.size() - Half);
+	EXPECT_EQ(Writer.Close(), 0);
+
+	void *pCompressed;
+	unsigned CompressedSize;
+	File = io_open(Info.m_aFilename, IOFLAG_READ);
+	ASSERT_TRUE(File);
+	ASSERT_TRUE(io_read_all(File, &pCompressed, &CompressedSize));
+	io_close(File);
+	EXPECT_LT(CompressedSize, m_vBuffer.size());
+
+	std::vector<unsigned char> vDecompressed(m_vBuffer.size() + 1);
+	z_stream Stream;
+	mem_zero(&Stream, sizeof(Stream));
+	ASSERT_EQ(inflateInit2(&Stream, MAX_WBITS + 16), Z_OK);
+	Stream.next_in = (Bytef *)pCompressed;
+	Stream.avail_in = CompressedSize;
+	Stream.next_out = vDecompressed.data();
+	Stream.avail_out = vDecompressed.size();
+	EXPECT_EQ(inflate(&Stream, Z_FINISH), Z_STREAM_END);
+	vDecompressed.resize(Stream.total_out);
+	inflateEnd(&Stream);
+	free(pCompressed);
+
+	EXPECT_EQ(vDecompressed, m_vBuffer);
+	EXPECT_FALSE(fs_remove(Info.m_aFilename));
+}
+
+TEST_F(TeeHistorian, Reader)
+{
+	for(int i = 1; i < 300; i++)
+	{
+		Tick(i);
+		if(i % 7 == 0)
+			DeadPlayer(0);
+		else
+			Player(0, i, -i);
+		Player(3, 2 * i, 5);
+		Inputs();
+		CNetObj_PlayerInput Input;
+		mem_zero(&Input, sizeof(Input));
+		Input.m_Direction = i % 3 - 1;
+		Input.m_TargetX = i;
+		m_TH.RecordPlayerInput(3, 1, &Input);
+		if(i == 5)
+			m_TH.RecordPlayerName(3, "nameless tee");
+	}
+	Finish();
+
+	CTeeHistorianReader Reader;
+	ASSERT_TRUE(Reader.Load(m_vBuffer.data(), m_vBuffer.size()));
+	CTeeHistorianReader::CChunk Chunk;
+	int NumInputs = 0;
+	bool Finished = false;
+	while(Reader.Next(&Chunk))
+	{
+		const CTeeHistorianReader::CPlayer &Player = Reader.Player(maximum(Chunk.m_ClientId, 0));
+		switch(Chunk.m_Type)
+		{
+		case CTeeHistorianReader::CHUNK_PLAYER_NEW:
+		case CTeeHistorianReader::CHUNK_PLAYER_DIFF:
+			EXPECT_TRUE(Player.m_Alive);
+			EXPECT_EQ(Player.m_X, Chunk.m_ClientId == 0 ? Chunk.m_Tick : 2 * Chunk.m_Tick);
+			break;
+		case CTeeHistorianReader::CHUNK_PLAYER_OLD:
+			EXPECT_EQ(Chunk.m_ClientId, 0);
+			EXPECT_EQ(Chunk.m_Tick % 7, 0);
+			break;
+		case CTeeHistorianReader::CHUNK_INPUT_NEW:
+		case CTeeHistorianReader::CHUNK_INPUT_DIFF:
+			EXPECT_EQ(Chunk.m_ClientId, 3);
+			EXPECT_EQ(Player.m_aInput[0], Chunk.m_Tick % 3 - 1);
+			EXPECT_EQ(Player.m_aInput[1], Chunk.m_Tick);
+			NumInputs++;
+			break;
+		case CTeeHistorianReader::CHUNK_FINISH:
+			Finished = true;
+			break;
+		}
+	}
+	EXPECT_EQ(Reader.Error(), nullptr);
+	EXPECT_EQ(NumInputs, 299);
+	EXPECT_TRUE(Finished);
+
+	ASSERT_TRUE(Reader.BuildIndex(40));
+	EXPECT_GT(Reader.NumIndexEntries(), 5);
+	for(int SeekTick : {1, 123, 280, 140})
+	{
+		ASSERT_TRUE(Reader.Seek(SeekTick));
+		ASSERT_TRUE(Reader.Next(&Chunk));
+		EXPECT_EQ(Chunk.m_Tick, SeekTick);
+		bool SawInput = false;
+		do
+		{
+			if(Chunk.m_Type == CTeeHistorianReader::CHUNK_INPUT_DIFF || Chunk.m_Type == CTeeHistorianReader::CHUNK_INPUT_NEW)
+			{
+				EXPECT_EQ(Reader.Player(0).m_Alive, SeekTick % 7 != 0);
+				EXPECT_EQ(Reader.Player(3).m_X, 2 * SeekTick);
+				EXPECT_EQ(Reader.Player(3).m_aInput[1], SeekTick);
+				EXPECT_STREQ(Reader.Player(3).m_aName, SeekTick > 5 ? "nameless tee" : "");
+				SawInput = true;
+			}
+		} while(Reader.Next(&Chunk) && Chunk.m_Tick == SeekTick);
+		EXPECT_TRUE(SawInput);
+	}
+}
@@ -0,0 +1,115 @@
+#include <gtest/gtest.h>
+
+#include <base/system.h>
+#include <engine/message.h>
+#include <game/generated/protocol.h>
+#include <game/server/voteoptions.h>
+
+#include <vector>
+
+TEST(VoteOptions, Find)
+{
+	CVoteOptions Options;
+	Options.Add("Map: Tutorial", "change_map Tutorial");
+	Options.Add("Map: Kobra", "change_map Kobra");
+	EXPECT_EQ(Options.Num(), 2);
+	ASSERT_TRUE(Options.Find("map: kobra"));
+	EXPECT_STREQ(Options.Find("MAP: KOBRA")->m_aCommand, "change_map Kobra");
+	EXPECT_EQ(Options.Find("Map: Kobra2"), nullptr);
+	EXPECT_EQ(Options.Get(0), Options.Find("Map: Tutorial"));
+	EXPECT_EQ(Options.Get(2), nullptr);
+}
+
+TEST(VoteOptions, Remove)
+{
+	CVoteOptions Options;
+	char aDescription[VOTE_DESC_LENGTH];
+	for(int i = 0; i < 100; i++)
+	{
+		str_format(aDescription, sizeof(aDescription), "Option %d", i);
+		Options.Add(aDescription, "echo");
+	}
+	EXPECT_FALSE(Options.Remove("Option 100"));
+	// removes more than half of the options, which copies the rest
+	for(int i = 0; i < 100; i += 3)
+	{
+		str_format(aDescription, sizeof(aDescription), "OPTION %d", i);
+		EXPECT_TRUE(Options.Remove(aDescription));
+	}
+	for(int i = 1; i < 100; i += 3)
+	{
+		str_format(aDescription, sizeof(aDescription), "option %d", i);
+		EXPECT_TRUE(Options.Remove(aDescription));
+	}
+	ASSERT_EQ(Options.Num(), 33);
+
+	const CVoteOptionServer *pOption = Options.First();
+	for(int i = 0; i < Options.Num(); i++, pOption = pOption->m_pNext)
+	{
+		str_format(aDescription, sizeof(aDescription), "Option %d", 3 * i + 2);
+		ASSERT_EQ(Options.Get(i), pOption);
+		EXPECT_STREQ(pOption->m_aDescription, aDescription);
+		EXPECT_EQ(Options.Find(aDescription), pOption);
+	}
+	EXPECT_EQ(pOption, nullptr);
+
+	Options.Clear();
+	EXPECT_EQ(Options.Num(), 0);
+	EXPECT_EQ(Options.First(), nullptr);
+	EXPECT_EQ(Options.Find("Option 2"), nullptr);
+}
+
+TEST(VoteOptions, PackListAdd)
+{
+	CVoteOptions Options;
+	Options.Add("A", "echo a");
+	Options.Add("B", "echo b");
+	Options.Add("C", "echo c");
+
+	auto &&Expected = [&](int Index, int Num) {
+		CNetMsg_Sv_VoteOptionListAdd Msg;
+		Msg.m_NumOptions = Num;
+		const char *apDescription[15];
+		for(int i = 0; i < 15; i++)
+			apDescription[i] = i < Num ? Options.Get(Index + i)->m_aDescription : "";
+		Msg.m_pDescription0 = apDescription[0];
+		Msg.m_pDescription1 = apDescription[1];
+		Msg.m_pDescription2 = apDescription[2];
+		Msg.m_pDescription3 = apDescription[3];
+		Msg.m_pDescription4 = apDescription[4];
+		Msg.m_pDescription5 = apDescription[5];
+		Msg.m_pDescription6 = apDescription[6];
+		Msg.m_pDescription7 = apDescription[7];
+		Msg.m_pDescription8 = apDescription[8];
+		Msg.m_pDescription9 = apDescription[9];
+		Msg.m_pDescription10 = apDescription[10];
+		Msg.m_pDescription11 = apDescription[11];
+		Msg.m_pDescription12 = apDescription[12];
+		Msg.m_pDescription13 = apDescription[13];
+		Msg.m_pDescription14 = apDescription[14];
+		CMsgPacker Packer(&Msg);
+		Msg.Pack(&Packer);
+		return std::vector<unsigned char>(Packer.Data(), Packer.Data() + Packer.Size());
+	};
+	auto &&Packed = [&](int Index, int PerMsg, int ExpectedNum) {
+		CMsgPacker Packer(NETMSGTYPE_SV_VOTEOPTIONLISTADD, false);
+		EXPECT_EQ(Options.PackListAdd(Index, PerMsg, &Packer), ExpectedNum);
+		return std::vector<unsigned char>(Packer.Data(), Packer.Data() + Packer.Size());
+	};
+
+	EXPECT_EQ(Packed(0, 2, 2), Expected(0, 2));
+	EXPECT_EQ(Packed(2, 2, 1), Expected(2, 1));
+	// the last message gains the new option
+	Options.Add("D", "echo d");
+	EXPECT_EQ(Packed(0, 2, 2), Expected(0, 2));
+	EXPECT_EQ(Packed(2, 2, 2), Expected(2, 2));
+	// not aligned to the messages
+	EXPECT_EQ(Packed(1, 2, 2), Expected(1, 2));
+	EXPECT_EQ(Packed(3, 2, 1), Expected(3, 1));
+	EXPECT_EQ(Packed(4, 2, 0), std::vector<unsigned char>());
+	// different number of options per message
+	EXPECT_EQ(Packed(0, 15, 4), Expected(0, 4));
+	Options.Remove("a");
+	EXPECT_EQ(Packed(0, 15, 3), Expected(0, 3));
+	EXPECT_EQ(Packed(2, 2, 1), Expected(2, 1));
+}
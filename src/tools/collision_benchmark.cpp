@@ -0,0 +1,166 @@
+#include <base/logger.h>
+#include <base/system.h>
+
+#include <engine/map.h>
+#include <engine/storage.h>
+
+#include <game/collision.h>
+#include <game/layers.h>
+#include <game/prng.h>
+
+#include <memory>
+#include <vector>
+
+static const char *TOOL_NAME = "collision_benchmark";
+
+enum
+{
+	NUM_POSITIONS = 1 << 18,
+	NUM_ROUNDS = 8,
+};
+
+class CPositions
+{
+public:
+	std::vector<vec2> m_vPos;
+	std::vector<vec2> m_vOther;
+	std::vector<int> m_vIndex;
+};
+
+// Runs the query over all positions with the fast paths disabled and
+// enabled, the results must be the same.
+template<typename FQuery>
+static void Measure(const char *pMapName, const char *pQueryName, CCollision *pCollision, const CPositions &Positions, FQuery &&Query)
+{
+	int64_t aTime[2];
+	int64_t aSum[2];
+	for(int Fast = 0; Fast < 2; Fast++)
+	{
+		pCollision->SetUseTileFlags(Fast);
+		pCollision->SetLineSkipping(Fast);
+		int64_t Sum = 0;
+		const int64_t Start = time_get();
+		for(int Round = 0; Round < NUM_ROUNDS; Round++)
+			for(int i = 0; i < NUM_POSITIONS; i++)
+				Sum += Query(i);
+		aTime[Fast] = time_get() - Start;
+		aSum[Fast] = Sum;
+	}
+	const double NsPerQuery = 1e9 / time_freq() / ((double)NUM_POSITIONS * NUM_ROUNDS);
+	log_info(TOOL_NAME, "%s: %-24s %8.2f ns -> %8.2f ns%s", pMapName, pQueryName, aTime[0] * NsPerQuery, aTime[1] * NsPerQuery, aSum[0] != aSum[1] ? " RESULTS DIFFER" : "");
+}
+
+static bool BenchmarkMap(IEngineMap *pMap, const char *pMapName)
+{
+	CLayers Layers;
+	Layers.Init(pMap, false);
+	if(!Layers.GameLayer())
+	{
+		log_error(TOOL_NAME, "Map '%s' has no game layer", pMapName);
+		return false;
+	}
+	CCollision Collision;
+	Collision.Init(&Layers);
+
+	// positions all over the map and positions that a character could
+	// reach within a tick from there
+	CPrng Prng;
+	uint64_t aSeed[2] = {0, 0};
+	Prng.Seed(aSeed);
+	const float Width = Collision.GetWidth() * 32.0f;
+	const float Height = Collision.GetHeight() * 32.0f;
+	auto &&Random = [&](float Max) { return Prng.RandomBits() / 4294967296.0f * Max; };
+	CPositions Positions;
+	for(int i = 0; i < NUM_POSITIONS; i++)
+	{
+		const vec2 Pos(Random(Width), Random(Height));
+		Positions.m_vPos.push_back(Pos);
+		Positions.m_vOther.push_back(Pos + vec2(Random(160.0f) - 80.0f, Random(160.0f) - 80.0f));
+		Positions.m_vIndex.push_back(Collision.GetPureMapIndex(Pos));
+	}
+
+	const char *pName = fs_filename(pMapName);
+	Measure(pName, "IsSolid", &Collision, Positions, [&](int i) {
+		return Collision.CheckPoint(Positions.m_vPos[i]);
+	});
+	Measure(pName, "TileExists", &Collision, Positions, [&](int i) {
+		return Collision.TileExists(Positions.m_vIndex[i]);
+	});
+	Measure(pName, "GetMoveRestrictions", &Collision, Positions, [&](int i) {
+		return Collision.GetMoveRestrictions(Positions.m_vPos[i]);
+	});
+	Measure(pName, "IsThrough/IsHookBlocker", &Collision, Positions, [&](int i) {
+		const vec2 Pos = Positions.m_vPos[i];
+		const vec2 Other = Positions.m_vOther[i];
+		int OffsetX, OffsetY;
+		ThroughOffset(Pos, Other, &OffsetX, &OffsetY);
+		return Collision.IsThrough(round_to_int(Pos.x), round_to_int(Pos.y), OffsetX, OffsetY, Pos, Other) + 2 * Collision.IsHookBlocker(round_to_int(Pos.x), round_to_int(Pos.y), Pos, Other);
+	});
+	Measure(pName, "Tele/Speedup/Switch", &Collision, Positions, [&](int i) {
+		const int Index = Positions.m_vIndex[i];
+		return Collision.IsTeleport(Index) + Collision.IsTeleCheckpoint(Index) + Collision.IsSpeedup(Index) + Collision.GetSwitchType(Index);
+	});
+	Measure(pName, "IntersectLineTeleHook", &Collision, Positions, [&](int i) {
+		vec2 Collision1, Collision2;
+		int TeleNr;
+		const int Hit = Collision.IntersectLineTeleHook(Positions.m_vPos[i], Positions.m_vOther[i], &Collision1, &Collision2, &TeleNr);
+		return Hit + TeleNr + round_to_int(Collision1.x + Collision2.y);
+	});
+	return true;
+}
+
+static bool BenchmarkMap(IStorage *pStorage, const char *pMapName)
+{
+	void *pMapData;
+	unsigned MapSize;
+	if(!pStorage->ReadFile(pMapName, IStorage::TYPE_ALL, &pMapData, &MapSize))
+	{
+		log_error(TOOL_NAME, "Failed to read map '%s'", pMapName);
+		return false;
+	}
+	bool Success = false;
+	{
+		// the map must be unloaded before its data is freed
+		std::unique_ptr<IEngineMap> pMap(CreateEngineMap());
+		if(pMap->Prepare(pMapName, static_cast<unsigned char *>(pMapData), MapSize, nullptr, 0))
+		{
+			pMap->SwapPrepared();
+			Success = BenchmarkMap(pMap.get(), pMapName);
+		}
+		else
+		{
+			log_error(TOOL_NAME, "Failed to load map '%s'", pMapName);
+		}
+	}
+	free(pMapData);
+	return Success;
+}
+
+int main(int argc, const char **argv)
+{
+	const CCmdlineFix CmdlineFix(&argc, &argv);
+	log_set_global_logger_default();
+
+	if(argc < 2)
+	{
+		log_error(TOOL_NAME, "Usage: %s <map>...", TOOL_NAME);
+		log_error(TOOL_NAME, "Example: %s maps/Tutorial.map maps/ctf1.map", TOOL_NAME);
+		return -1;
+	}
+
+	std::unique_ptr<IStorage> pStorage = std::unique_ptr<IStorage>(CreateStorage(IStorage::EInitializationType::BASIC, argc, argv));
+	if(!pStorage)
+	{
+		log_error(TOOL_NAME, "Error creating basic storage");
+		return -1;
+	}
+
+	log_info(TOOL_NAME, "Time per query without -> with the tile flags and line skipping");
+	int Result = 0;
+	for(int i = 1; i < argc; i++)
+	{
+		if(!BenchmarkMap(pStorage.get(), argv[i]))
+			Result = -1;
+	}
+	return Result;
+}
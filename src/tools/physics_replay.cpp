@@ -0,0 +1,544 @@
+#include <base/hash_ctxt.h>
+#include <base/logger.h>
+#include <base/system.h>
+
+#include <engine/console.h>
+#include <engine/engine.h>
+#include <engine/kernel.h>
+#include <engine/map.h>
+#include <engine/server/databases/connection_pool.h>
+#include <engine/server/server.h>
+#include <engine/shared/config.h>
+#include <engine/shared/teehistorian_reader.h>
+#include <engine/storage.h>
+
+#include <game/gamecore.h>
+#include <game/generated/protocol.h>
+#include <game/prng.h>
+#include <game/server/entities/character.h>
+#include <game/server/entity.h>
+#include <game/server/gamecontext.h>
+#include <game/server/gameworld.h>
+#include <game/teamscore.h>
+#include <game/version.h>
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+static const char *TOOL_NAME = "physics_replay";
+
+bool IsInterrupted()
+{
+	return false;
+}
+
+class CReplayOptions
+{
+public:
+	const char *m_pMap = nullptr;
+	const char *m_pTeehistorian = nullptr;
+	int m_NumTicks = 50 * 60;
+	int m_NumBots = 32;
+	// bots per DDRace team, 0 to keep them in team 0
+	int m_TeamSize = 0;
+	int m_NumRuns = 2;
+	// percentage of lost snapshots, negative to not create snapshots
+	int m_SnapshotLoss = -1;
+	const char **m_ppCommands = nullptr;
+	int m_NumCommands = 0;
+};
+
+class CReplayResult
+{
+public:
+	int m_NumTicks = 0;
+	int64_t m_TickTime = 0;
+	int64_t m_aEntityTime[CGameWorld::NUM_ENTTYPES] = {0};
+	int64_t m_aNumEntities[CGameWorld::NUM_ENTTYPES] = {0};
+	SHA256_DIGEST m_Hash;
+	int m_NumPositions = 0;
+	int m_NumMatchingPositions = 0;
+	int64_t m_SnapshotBytes = 0;
+	int m_NumSnapshots = 0;
+	int m_NumSnapshotClients = 0;
+};
+
+// Server without networking, set up like the game server, that only runs
+// the game ticks. Snapshots can be created for the clients, their acks arrive
+// after a random delay and out of order.
+class CReplayServer
+{
+	std::unique_ptr<IKernel> m_pKernel;
+	CServer *m_pServer;
+	IGameServer *m_pGameServer;
+	CPrng m_Prng;
+
+	class CAck
+	{
+	public:
+		int m_ClientId;
+		int m_ArrivalTick;
+		int m_SnapshotTick;
+	};
+	int m_SnapshotLoss = -1;
+	CPrng m_NetPrng;
+	std::vector<CAck> m_vAcks;
+	int m_aReceivedSnapshot[MAX_CLIENTS];
+
+public:
+	CReplayServer(IStorage *pStorage)
+	{
+		m_pServer = CreateServer();
+		m_pKernel = std::unique_ptr<IKernel>(IKernel::Create());
+		m_pKernel->RegisterInterface(m_pServer);
+
+		IEngine *pEngine = CreateTestEngine(GAME_NAME);
+		m_pKernel->RegisterInterface(pEngine);
+		m_pKernel->RegisterInterface(pStorage, false);
+
+		IConsole *pConsole = CreateConsole(CFGFLAG_SERVER | CFGFLAG_ECON).release();
+		m_pKernel->RegisterInterface(pConsole);
+
+		IConfigManager *pConfigManager = CreateConfigManager();
+		m_pKernel->RegisterInterface(pConfigManager);
+
+		IEngineMap *pEngineMap = CreateEngineMap();
+		m_pKernel->RegisterInterface(pEngineMap);
+		m_pKernel->RegisterInterface(static_cast<IMap *>(pEngineMap), false);
+
+		IEngineAntibot *pEngineAntibot = CreateEngineAntibot();
+		m_pKernel->RegisterInterface(pEngineAntibot);
+		m_pKernel->RegisterInterface(static_cast<IAntibot *>(pEngineAntibot), false);
+
+		m_pGameServer = CreateGameServer();
+		m_pKernel->RegisterInterface(m_pGameServer);
+
+		pEngine->Init();
+		pConsole->Init();
+		pConfigManager->Init();
+		m_pServer->RegisterCommands();
+	}
+
+	~CReplayServer()
+	{
+		m_pGameServer->OnShutdown(nullptr);
+		m_pServer->m_Econ.Shutdown();
+		m_pServer->m_Fifo.Shutdown();
+		m_pServer->m_NetServer.Close();
+		m_pServer->m_pMap->Unload();
+		m_pServer->DbPool()->OnShutdown();
+	}
+
+	bool Init(const CReplayOptions &Options)
+	{
+		for(int i = 0; i < Options.m_NumCommands; i++)
+			m_pServer->Console()->ExecuteLine(Options.m_ppCommands[i]);
+
+		const int Size = m_pGameServer->PersistentClientDataSize();
+		for(auto &Client : m_pServer->m_aClients)
+		{
+			Client.m_HasPersistentData = false;
+			Client.m_pPersistentData = malloc(Size);
+		}
+		m_pServer->m_pPersistentData = malloc(m_pGameServer->PersistentDataSize());
+		if(!m_pServer->LoadMap(Options.m_pMap))
+		{
+			log_error(TOOL_NAME, "Failed to load map '%s'", Options.m_pMap);
+			return false;
+		}
+		// the socket is never read, but the client slots are owned by the net server
+		NETADDR BindAddr;
+		net_addr_from_str(&BindAddr, "127.0.0.1");
+		if(!m_pServer->m_NetServer.Open(BindAddr, &m_pServer->m_ServerBan, MAX_CLIENTS, MAX_CLIENTS))
+		{
+			log_error(TOOL_NAME, "Failed to open the net server");
+			return false;
+		}
+		m_pServer->m_RunServer = CServer::RUNNING;
+		m_pServer->m_AuthManager.Init();
+		if(!m_pServer->m_Http.Init(std::chrono::seconds{2}))
+			log_error(TOOL_NAME, "Failed to initialize the HTTP client");
+		m_pServer->m_Econ.Init(m_pServer->Config(), m_pServer->Console(), &m_pServer->m_ServerBan);
+		m_pServer->m_Fifo.Init(m_pServer->Console(), m_pServer->Config()->m_SvInputFifo, CFGFLAG_SERVER);
+		m_pServer->Antibot()->Init();
+		m_pGameServer->OnInit(nullptr);
+
+		// the same random numbers in every run
+		uint64_t aSeed[2] = {0, 0};
+		m_Prng.Seed(aSeed);
+		World()->m_Core.m_pPrng = &m_Prng;
+		World()->m_MeasureTickTime = true;
+
+		m_SnapshotLoss = Options.m_SnapshotLoss;
+		uint64_t aNetSeed[2] = {2, 0};
+		m_NetPrng.Seed(aNetSeed);
+		std::fill(std::begin(m_aReceivedSnapshot), std::end(m_aReceivedSnapshot), -1);
+		return true;
+	}
+
+	CServer *Server() { return m_pServer; }
+	CGameContext *GameServer() { return (CGameContext *)m_pGameServer; }
+	CGameWorld *World() { return &GameServer()->m_World; }
+
+	void Tick(CReplayResult *pResult, SHA256_CTX *pHash)
+	{
+		const int64_t StartTime = time_get();
+		m_pServer->GameTick();
+		pResult->m_TickTime += time_get() - StartTime;
+		pResult->m_NumTicks++;
+		if(m_SnapshotLoss >= 0)
+			Snap();
+
+		for(int Type = 0; Type < CGameWorld::NUM_ENTTYPES; Type++)
+		{
+			for(CEntity *pEnt = World()->FindFirst(Type); pEnt; pEnt = pEnt->TypeNext())
+			{
+				pResult->m_aNumEntities[Type]++;
+				const vec2 Pos = pEnt->GetPos();
+				sha256_update(pHash, &Type, sizeof(Type));
+				sha256_update(pHash, &Pos, sizeof(Pos));
+			}
+		}
+		for(int ClientId = 0; ClientId < MAX_CLIENTS; ClientId++)
+		{
+			CCharacter *pChr = GameServer()->GetPlayerChar(ClientId);
+			if(!pChr)
+				continue;
+			CNetObj_CharacterCore Core;
+			pChr->GetCore().Write(&Core);
+			sha256_update(pHash, &ClientId, sizeof(ClientId));
+			sha256_update(pHash, &Core, sizeof(Core));
+		}
+	}
+
+	void Snap()
+	{
+		const int Tick = m_pServer->Tick();
+		if(m_pServer->Config()->m_SvHighBandwidth || Tick % 2 == 0)
+		{
+			m_pServer->DoSnapshot();
+			for(int ClientId = 0; ClientId < MAX_CLIENTS; ClientId++)
+			{
+				if(m_pServer->m_aClients[ClientId].m_State == CServer::CClient::STATE_INGAME && (int)(m_NetPrng.RandomBits() % 100) >= m_SnapshotLoss)
+					m_aReceivedSnapshot[ClientId] = Tick;
+			}
+		}
+
+		// every client acks the newest snapshot it received with its input
+		for(int ClientId = 0; ClientId < MAX_CLIENTS; ClientId++)
+		{
+			if(m_pServer->m_aClients[ClientId].m_State != CServer::CClient::STATE_INGAME)
+				m_aReceivedSnapshot[ClientId] = -1;
+			else if(m_aReceivedSnapshot[ClientId] >= 0)
+				m_vAcks.push_back({ClientId, Tick + 1 + (int)(m_NetPrng.RandomBits() % 5), m_aReceivedSnapshot[ClientId]});
+		}
+		for(auto It = m_vAcks.begin(); It != m_vAcks.end();)
+		{
+			if(It->m_ArrivalTick > Tick)
+			{
+				++It;
+				continue;
+			}
+			CServer::CClient &Client = m_pServer->m_aClients[It->m_ClientId];
+			if(Client.m_State == CServer::CClient::STATE_INGAME)
+				Client.AckSnapshot(It->m_SnapshotTick);
+			It = m_vAcks.erase(It);
+		}
+	}
+
+	void AddSnapshotStats(CReplayResult *pResult) const
+	{
+		for(const auto &Client : m_pServer->m_aClients)
+		{
+			if(Client.m_State != CServer::CClient::STATE_INGAME || !Client.m_SnapBudget.NumSnaps())
+				continue;
+			pResult->m_SnapshotBytes += Client.m_SnapBudget.TotalSize();
+			pResult->m_NumSnapshots += Client.m_SnapBudget.NumSnaps();
+			pResult->m_NumSnapshotClients++;
+		}
+	}
+};
+
+// Bots that run, jump, hook and shoot at random.
+static void ReplayBots(CReplayServer *pReplay, const CReplayOptions &Options, CReplayResult *pResult, SHA256_CTX *pHash)
+{
+	CPrng Prng;
+	uint64_t aSeed[2] = {1, 0};
+	Prng.Seed(aSeed);
+	const int NumBots = minimum(Options.m_NumBots, (int)MAX_CLIENTS);
+	std::vector<CNetObj_PlayerInput> vInputs(NumBots);
+	for(int ClientId = 0; ClientId < NumBots; ClientId++)
+	{
+		char aName[MAX_NAME_LENGTH];
+		str_format(aName, sizeof(aName), "Bot %d", ClientId + 1);
+		pReplay->Server()->AddDebugDummy(ClientId, aName);
+		vInputs[ClientId] = {};
+		vInputs[ClientId].m_TargetY = -1;
+	}
+
+	for(int Tick = 0; Tick < Options.m_NumTicks; Tick++)
+	{
+		for(int ClientId = 0; ClientId < NumBots; ClientId++)
+		{
+			// the team is reset until the character spawned
+			const int Team = Options.m_TeamSize > 0 ? minimum(1 + ClientId / Options.m_TeamSize, (int)TEAM_SUPER - 1) : (int)TEAM_FLOCK;
+			if(pReplay->GameServer()->GetPlayerChar(ClientId) && pReplay->GameServer()->GetDDRaceTeam(ClientId) != Team)
+			{
+				char aCommand[64];
+				str_format(aCommand, sizeof(aCommand), "set_team_ddr %d %d", ClientId, Team);
+				pReplay->Server()->Console()->ExecuteLine(aCommand);
+			}
+
+			CNetObj_PlayerInput &Input = vInputs[ClientId];
+			if(Prng.RandomBits() % 16 == 0)
+				Input.m_Direction = (int)(Prng.RandomBits() % 3) - 1;
+			if(Prng.RandomBits() % 8 == 0)
+				Input.m_Jump = !Input.m_Jump;
+			if(Prng.RandomBits() % 8 == 0)
+				Input.m_Hook = !Input.m_Hook;
+			if(Prng.RandomBits() % 32 == 0)
+			{
+				Input.m_Fire = (Input.m_Fire + 1) & INPUT_STATE_MASK;
+				Input.m_WantedWeapon = 1 + Prng.RandomBits() % NUM_WEAPONS;
+			}
+			if(Prng.RandomBits() % 8 == 0)
+			{
+				Input.m_TargetX = (int)(Prng.RandomBits() % 401) - 200;
+				Input.m_TargetY = (int)(Prng.RandomBits() % 401) - 200;
+				if(Input.m_TargetX == 0 && Input.m_TargetY == 0)
+					Input.m_TargetY = -1;
+			}
+			pReplay->Server()->SetDebugDummyInput(ClientId, &Input);
+		}
+		pReplay->Tick(pResult, pHash);
+	}
+}
+
+// Players, inputs and chat commands of a teehistorian file. The positions of
+// the file are compared to the replayed ones at the end of each tick.
+static bool ReplayTeehistorian(CReplayServer *pReplay, const CReplayOptions &Options, CReplayResult *pResult, SHA256_CTX *pHash)
+{
+	IOHANDLE File = io_open(Options.m_pTeehistorian, IOFLAG_READ);
+	if(!File)
+	{
+		log_error(TOOL_NAME, "Failed to open '%s'", Options.m_pTeehistorian);
+		return false;
+	}
+	CTeeHistorianReader Reader;
+	const bool Loaded = Reader.Load(File);
+	io_close(File);
+	if(!Loaded)
+	{
+		log_error(TOOL_NAME, "Failed to load '%s': %s", Options.m_pTeehistorian, Reader.Error());
+		return false;
+	}
+
+	CServer *pServer = pReplay->Server();
+	auto &&AddPlayer = [&](int ClientId) {
+		if(pServer->m_aClients[ClientId].m_State != CServer::CClient::STATE_EMPTY)
+			return;
+		char aName[MAX_NAME_LENGTH];
+		str_format(aName, sizeof(aName), "Player %d", ClientId);
+		pServer->AddDebugDummy(ClientId, aName);
+	};
+	bool First = true;
+	int TickOffset = 0;
+	CTeeHistorianReader::CChunk Chunk;
+	while(Reader.Next(&Chunk))
+	{
+		if(First)
+		{
+			TickOffset = pServer->Tick() - Chunk.m_Tick;
+			First = false;
+		}
+		while(pServer->Tick() < Chunk.m_Tick + TickOffset && pResult->m_NumTicks < Options.m_NumTicks)
+			pReplay->Tick(pResult, pHash);
+		if(pResult->m_NumTicks >= Options.m_NumTicks)
+			break;
+
+		const int ClientId = Chunk.m_ClientId;
+		const CTeeHistorianReader::CPlayer &Player = Reader.Player(maximum(ClientId, 0));
+		switch(Chunk.m_Type)
+		{
+		case CTeeHistorianReader::CHUNK_JOIN:
+			AddPlayer(ClientId);
+			break;
+		case CTeeHistorianReader::CHUNK_DROP:
+			if(pServer->m_aClients[ClientId].m_State != CServer::CClient::STATE_EMPTY)
+				CServer::DelClientCallback(ClientId, Chunk.m_pString, pServer);
+			break;
+		case CTeeHistorianReader::CHUNK_INPUT_NEW:
+		case CTeeHistorianReader::CHUNK_INPUT_DIFF:
+		{
+			// players that were already connected when the recording started
+			// have no join chunk
+			AddPlayer(ClientId);
+			CNetObj_PlayerInput Input;
+			static_assert(sizeof(Input) == sizeof(Player.m_aInput));
+			mem_copy(&Input, Player.m_aInput, sizeof(Input));
+			pServer->SetDebugDummyInput(ClientId, &Input);
+			break;
+		}
+		case CTeeHistorianReader::CHUNK_PLAYER_NEW:
+		case CTeeHistorianReader::CHUNK_PLAYER_DIFF:
+		{
+			CCharacter *pChr = pReplay->GameServer()->GetPlayerChar(ClientId);
+			pResult->m_NumPositions++;
+			if(pChr && round_to_int(pChr->GetCore().m_Pos.x) == Player.m_X && round_to_int(pChr->GetCore().m_Pos.y) == Player.m_Y)
+				pResult->m_NumMatchingPositions++;
+			break;
+		}
+		case CTeeHistorianReader::CHUNK_CONSOLE_COMMAND:
+			if(ClientId >= 0 && pServer->m_aClients[ClientId].m_State == CServer::CClient::STATE_INGAME)
+			{
+				char aLine[512];
+				str_copy(aLine, Chunk.m_pString);
+				const char *pArg = Chunk.m_pArgs;
+				for(int i = 0; i < Chunk.m_NumArgs; i++)
+				{
+					char aArg[256];
+					char *pDst = aArg;
+					*pDst++ = '"';
+					str_escape(&pDst, pArg, aArg + sizeof(aArg) - 1);
+					*pDst++ = '"';
+					*pDst = '\0';
+					str_append(aLine, " ");
+					str_append(aLine, aArg);
+					pArg += str_length(pArg) + 1;
+				}
+				pServer->Console()->ExecuteLineFlag(aLine, Chunk.m_FlagMask, ClientId, false);
+			}
+			break;
+		}
+	}
+	if(Reader.Error())
+	{
+		log_error(TOOL_NAME, "Failed to read '%s': %s", Options.m_pTeehistorian, Reader.Error());
+		return false;
+	}
+	return true;
+}
+
+static bool Replay(IStorage *pStorage, const CReplayOptions &Options, CReplayResult *pResult)
+{
+	CReplayServer ReplayServer(pStorage);
+	if(!ReplayServer.Init(Options))
+		return false;
+
+	SHA256_CTX Hash;
+	sha256_init(&Hash);
+	bool Success = true;
+	if(Options.m_pTeehistorian)
+		Success = ReplayTeehistorian(&ReplayServer, Options, pResult, &Hash);
+	else
+		ReplayBots(&ReplayServer, Options, pResult, &Hash);
+	pResult->m_Hash = sha256_finish(&Hash);
+	mem_copy(pResult->m_aEntityTime, ReplayServer.World()->m_aTickTime, sizeof(pResult->m_aEntityTime));
+	ReplayServer.AddSnapshotStats(pResult);
+	return Success;
+}
+
+static void PrintResult(int Run, const CReplayResult &Result)
+{
+	static const char *s_apEntityTypes[CGameWorld::NUM_ENTTYPES] = {"projectile", "laser", "pickup", "flag", "character"};
+	static_assert(CGameWorld::ENTTYPE_CHARACTER == 4);
+
+	const double Seconds = Result.m_TickTime / (double)time_freq();
+	const int NumTicks = maximum(Result.m_NumTicks, 1);
+	char aHash[SHA256_MAXSTRSIZE];
+	sha256_str(Result.m_Hash, aHash, sizeof(aHash));
+	log_info(TOOL_NAME, "run %d: %d ticks in %.3f s, %.0f ticks/s, %.1f us/tick, hash %s", Run + 1, Result.m_NumTicks, Seconds, Seconds > 0 ? Result.m_NumTicks / Seconds : 0.0, Seconds * 1e6 / NumTicks, aHash);
+	for(int Type = 0; Type < CGameWorld::NUM_ENTTYPES; Type++)
+	{
+		const double TypeSeconds = Result.m_aEntityTime[Type] / (double)time_freq();
+		const double AverageEntities = Result.m_aNumEntities[Type] / (double)NumTicks;
+		log_info(TOOL_NAME, "  %-10s %6.1f entities %8.2f us/tick %8.1f ns/entity %5.1f%%", s_apEntityTypes[Type], AverageEntities, TypeSeconds * 1e6 / NumTicks,
+			Result.m_aNumEntities[Type] ? TypeSeconds * 1e9 / Result.m_aNumEntities[Type] : 0.0, Seconds > 0 ? 100.0 * TypeSeconds / Seconds : 0.0);
+	}
+	if(Result.m_NumPositions)
+		log_info(TOOL_NAME, "  %d of %d recorded positions reproduced", Result.m_NumMatchingPositions, Result.m_NumPositions);
+	if(Result.m_NumSnapshotClients)
+	{
+		const double SnapshotSeconds = Result.m_NumTicks / (double)SERVER_TICK_SPEED;
+		log_info(TOOL_NAME, "  snapshots: %.0f bytes/s per client, %.0f bytes per snapshot", Result.m_SnapshotBytes / (double)Result.m_NumSnapshotClients / SnapshotSeconds,
+			Result.m_SnapshotBytes / (double)maximum(Result.m_NumSnapshots, 1));
+	}
+}
+
+static void Usage()
+{
+	log_error(TOOL_NAME, "Usage: %s [-t <ticks>] [-b <bots>] [-s <team size>] [-r <runs>] [-l <snapshot loss percent>] [-f <teehistorian>] <map> [<command>...]", TOOL_NAME);
+	log_error(TOOL_NAME, "Example: %s -b 64 -t 3000 Tutorial \"sv_no_weak_hook 1\"", TOOL_NAME);
+	log_error(TOOL_NAME, "Snapshots are only created with -l, their acks arrive out of order");
+}
+
+int main(int argc, const char **argv)
+{
+	const CCmdlineFix CmdlineFix(&argc, &argv);
+	log_set_global_logger_default();
+
+	CReplayOptions Options;
+	int Arg = 1;
+	for(; Arg + 1 < argc && argv[Arg][0] == '-'; Arg += 2)
+	{
+		if(str_comp(argv[Arg], "-t") == 0)
+			Options.m_NumTicks = str_toint(argv[Arg + 1]);
+		else if(str_comp(argv[Arg], "-b") == 0)
+			Options.m_NumBots = str_toint(argv[Arg + 1]);
+		else if(str_comp(argv[Arg], "-s") == 0)
+			Options.m_TeamSize = str_toint(argv[Arg + 1]);
+		else if(str_comp(argv[Arg], "-r") == 0)
+			Options.m_NumRuns = str_toint(argv[Arg + 1]);
+		else if(str_comp(argv[Arg], "-l") == 0)
+			Options.m_SnapshotLoss = clamp(str_toint(argv[Arg + 1]), 0, 100);
+		else if(str_comp(argv[Arg], "-f") == 0)
+			Options.m_pTeehistorian = argv[Arg + 1];
+		else
+		{
+			Usage();
+			return -1;
+		}
+	}
+	if(Arg >= argc || Options.m_NumTicks <= 0 || Options.m_NumRuns <= 0)
+	{
+		Usage();
+		return -1;
+	}
+	Options.m_pMap = argv[Arg];
+	Options.m_ppCommands = &argv[Arg + 1];
+	Options.m_NumCommands = argc - Arg - 1;
+
+	net_init();
+	if(secure_random_init() != 0)
+	{
+		log_error(TOOL_NAME, "Could not initialize secure RNG");
+		return -1;
+	}
+
+	std::unique_ptr<IStorage> pStorage = std::unique_ptr<IStorage>(CreateStorage(IStorage::EInitializationType::SERVER, argc, argv));
+	if(!pStorage)
+	{
+		log_error(TOOL_NAME, "Error creating server storage");
+		return -1;
+	}
+
+	// every run starts a new server, the same inputs must result in the
+	// same hash
+	std::vector<CReplayResult> vResults(Options.m_NumRuns);
+	for(int Run = 0; Run < Options.m_NumRuns; Run++)
+	{
+		if(!Replay(pStorage.get(), Options, &vResults[Run]))
+			return -1;
+		PrintResult(Run, vResults[Run]);
+	}
+	for(int Run = 1; Run < Options.m_NumRuns; Run++)
+	{
+		if(vResults[Run].m_Hash != vResults[0].m_Hash)
+		{
+			log_error(TOOL_NAME, "run %d is not deterministic, its hash differs from the first run", Run + 1);
+			return 1;
+		}
+	}
+	return 0;
+}
@@ -0,0 +1,215 @@
+#include <base/logger.h>
+#include <base/math.h>
+#include <base/system.h>
+
+#include <engine/shared/packer.h>
+#include <engine/shared/teehistorian_ex.h>
+#include <engine/shared/teehistorian_reader.h>
+
+#include <atomic>
+#include <cstdarg>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+static const char *TOOL_NAME = "teehistorian_extract";
+
+enum
+{
+	MODE_INPUTS,
+	MODE_FINISHES,
+	MODE_INDEX,
+};
+
+class CExtractOptions
+{
+public:
+	int m_Mode;
+	int m_FirstTick = 0;
+	int m_LastTick = -1;
+	int m_IndexInterval = 50 * 60;
+};
+
+static void AppendLine(std::string &Output, const char *pFormat, ...)
+	GNUC_ATTRIBUTE((format(printf, 2, 3)));
+
+static void AppendLine(std::string &Output, const char *pFormat, ...)
+{
+	char aBuf[512];
+	va_list Args;
+	va_start(Args, pFormat);
+	str_format_v(aBuf, sizeof(aBuf), pFormat, Args);
+	va_end(Args);
+	Output += aBuf;
+	Output += '\n';
+}
+
+static bool ExtractFile(const char *pFilename, const CExtractOptions &Options, std::string &Output, size_t *pDataSize)
+{
+	IOHANDLE File = io_open(pFilename, IOFLAG_READ);
+	if(!File)
+	{
+		log_error(TOOL_NAME, "Failed to open '%s'", pFilename);
+		return false;
+	}
+	CTeeHistorianReader Reader;
+	const bool Loaded = Reader.Load(File);
+	io_close(File);
+	if(!Loaded)
+	{
+		log_error(TOOL_NAME, "Failed to load '%s': %s", pFilename, Reader.Error());
+		return false;
+	}
+	*pDataSize = Reader.DataSize();
+
+	if(Options.m_Mode == MODE_INDEX)
+	{
+		if(!Reader.BuildIndex(Options.m_IndexInterval))
+		{
+			log_error(TOOL_NAME, "Failed to index '%s': %s", pFilename, Reader.Error());
+			return false;
+		}
+		CTeeHistorianReader::CChunk Chunk;
+		for(int i = 0; i < Reader.NumIndexEntries(); i++)
+		{
+			if(!Reader.Seek(Reader.IndexTick(i)) || !Reader.Next(&Chunk))
+				break;
+			int NumAlive = 0;
+			for(int ClientId = 0; ClientId < MAX_CLIENTS; ClientId++)
+				NumAlive += Reader.Player(ClientId).m_Alive;
+			AppendLine(Output, "index,%s,%d,%d", pFilename, Chunk.m_Tick, NumAlive);
+		}
+		return true;
+	}
+
+	if(Options.m_FirstTick > 0 && !Reader.Seek(Options.m_FirstTick))
+		return Reader.Error() == nullptr;
+
+	CTeeHistorianReader::CChunk Chunk;
+	while(Reader.Next(&Chunk))
+	{
+		if(Options.m_LastTick >= 0 && Chunk.m_Tick > Options.m_LastTick)
+			break;
+
+		if(Options.m_Mode == MODE_INPUTS && (Chunk.m_Type == CTeeHistorianReader::CHUNK_INPUT_NEW || Chunk.m_Type == CTeeHistorianReader::CHUNK_INPUT_DIFF))
+		{
+			const CTeeHistorianReader::CPlayer &Player = Reader.Player(Chunk.m_ClientId);
+			const int *pInput = Player.m_aInput;
+			AppendLine(Output, "input,%s,%d,%d,\"%s\",%d,%d,%d,%d,%d,%d,%d,%d,%d,%d", pFilename, Chunk.m_Tick, Chunk.m_ClientId, Player.m_aName,
+				pInput[0], pInput[1], pInput[2], pInput[3], pInput[4], pInput[5], pInput[6], pInput[7], pInput[8], pInput[9]);
+		}
+		else if(Options.m_Mode == MODE_FINISHES && Chunk.m_Type == CTeeHistorianReader::CHUNK_EX &&
+			(Chunk.m_ExType == TEEHISTORIAN_PLAYER_FINISH || Chunk.m_ExType == TEEHISTORIAN_TEAM_FINISH))
+		{
+			CUnpacker Unpacker;
+			Unpacker.Reset(Chunk.m_pData, Chunk.m_DataSize);
+			const int Id = Unpacker.GetInt();
+			const int TimeTicks = Unpacker.GetInt();
+			if(Unpacker.Error())
+				continue;
+			if(Chunk.m_ExType == TEEHISTORIAN_PLAYER_FINISH)
+			{
+				if(Id < 0 || Id >= MAX_CLIENTS)
+					continue;
+				AppendLine(Output, "finish,%s,%d,%d,\"%s\",%d", pFilename, Chunk.m_Tick, Id, Reader.Player(Id).m_aName, TimeTicks);
+			}
+			else
+			{
+				AppendLine(Output, "team_finish,%s,%d,%d,,%d", pFilename, Chunk.m_Tick, Id, TimeTicks);
+			}
+		}
+	}
+	if(Reader.Error())
+	{
+		log_error(TOOL_NAME, "Failed to read '%s': %s", pFilename, Reader.Error());
+		return false;
+	}
+	return true;
+}
+
+static void Usage()
+{
+	log_error(TOOL_NAME, "Usage: %s [-j <threads>] [-t <first_tick>:<last_tick>] [-i <index_interval>] <inputs|finishes|index> <file>...", TOOL_NAME);
+}
+
+int main(int argc, const char *argv[])
+{
+	CCmdlineFix CmdlineFix(&argc, &argv);
+	log_set_global_logger_default();
+
+	CExtractOptions Options;
+	int NumThreads = std::thread::hardware_concurrency();
+	int Arg = 1;
+	for(; Arg + 1 < argc && argv[Arg][0] == '-'; Arg += 2)
+	{
+		if(str_comp(argv[Arg], "-j") == 0)
+		{
+			NumThreads = str_toint(argv[Arg + 1]);
+		}
+		else if(str_comp(argv[Arg], "-i") == 0)
+		{
+			Options.m_IndexInterval = str_toint(argv[Arg + 1]);
+		}
+		else if(str_comp(argv[Arg], "-t") == 0)
+		{
+			const char *pLast = str_find(argv[Arg + 1], ":");
+			Options.m_FirstTick = str_toint(argv[Arg + 1]);
+			Options.m_LastTick = pLast ? str_toint(pLast + 1) : -1;
+		}
+		else
+		{
+			Usage();
+			return -1;
+		}
+	}
+	if(Arg + 1 >= argc || NumThreads <= 0 || Options.m_IndexInterval <= 0)
+	{
+		Usage();
+		return -1;
+	}
+	if(str_comp(argv[Arg], "inputs") == 0)
+		Options.m_Mode = MODE_INPUTS;
+	else if(str_comp(argv[Arg], "finishes") == 0)
+		Options.m_Mode = MODE_FINISHES;
+	else if(str_comp(argv[Arg], "index") == 0)
+		Options.m_Mode = MODE_INDEX;
+	else
+	{
+		Usage();
+		return -1;
+	}
+	const char **ppFiles = &argv[Arg + 1];
+	const int NumFiles = argc - Arg - 1;
+
+	// every thread takes the next file, the output of a file is written at once
+	std::atomic_int NextFile{0};
+	std::atomic_int NumFailed{0};
+	std::atomic<size_t> TotalSize{0};
+	std::mutex OutputMutex;
+	const int64_t StartTime = time_get();
+	auto &&Worker = [&]() {
+		std::string Output;
+		for(int i = NextFile.fetch_add(1); i < NumFiles; i = NextFile.fetch_add(1))
+		{
+			Output.clear();
+			size_t DataSize = 0;
+			if(!ExtractFile(ppFiles[i], Options, Output, &DataSize))
+				NumFailed.fetch_add(1);
+			TotalSize.fetch_add(DataSize);
+			const std::lock_guard<std::mutex> Lock(OutputMutex);
+			fwrite(Output.data(), 1, Output.size(), stdout);
+		}
+	};
+	std::vector<std::thread> vThreads;
+	for(int i = 0; i < minimum(NumThreads, NumFiles); i++)
+		vThreads.emplace_back(Worker);
+	for(auto &Thread : vThreads)
+		Thread.join();
+	fflush(stdout);
+
+	const double Seconds = (time_get() - StartTime) / (double)time_freq();
+	const double MiB = TotalSize.load() / (1024.0 * 1024.0);
+	log_info(TOOL_NAME, "Processed %d files, %.1f MiB uncompressed in %.2f s (%.1f MiB/s)", NumFiles, MiB, Seconds, Seconds > 0 ? MiB / Seconds : 0.0);
+	return NumFailed.load() == 0 ? 0 : 1;
+}